@@ -0,0 +1,52 @@
+# Copyright (C) 2026 Google Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+{
+  'variables': {
+    'benchmark_root%': '/usr',
+    'benchmark_lib%': '-lbenchmark',
+  },
+  'targets': [
+    {
+      'target_name': 'benchmark',
+      'type': 'none',
+      'all_dependent_settings': {
+        'include_dirs': [
+          '<(benchmark_root)/include',
+        ],
+        'library_dirs': [
+          '<(benchmark_root)/lib',
+        ],
+        'libraries': [
+          '<(benchmark_lib)',
+        ],
+        'conditions': [
+          ['OS == "linux"', {
+            'ldflags': [
+              '-pthread', # Google Benchmark needs to link to pthread on Linux.
+            ],
+          }],
+          [ 'OS == "mac"', {
+            'link_settings': {
+              'xcode_settings': {
+                'OTHER_LDFLAGS': [
+                  '<(benchmark_lib)',
+                ],
+              },
+            }
+          }],
+        ],
+      },
+    },
+  ],
+}
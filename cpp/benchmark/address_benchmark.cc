@@ -0,0 +1,184 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Benchmarks of the operations on the addresses of the corpus.
+
+#include <libaddressinput/address_data.h>
+#include <libaddressinput/address_formatter.h>
+#include <libaddressinput/address_input_helper.h>
+#include <libaddressinput/address_normalizer.h>
+#include <libaddressinput/address_ui.h>
+#include <libaddressinput/address_ui_component.h>
+#include <libaddressinput/address_validator.h>
+#include <libaddressinput/callback.h>
+#include <libaddressinput/localization.h>
+#include <libaddressinput/preload_supplier.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "benchmark_util.h"
+#include "lookup_key.h"
+#include "util/size.h"
+
+namespace {
+
+using i18n::addressinput::AddressData;
+using i18n::addressinput::AddressInputHelper;
+using i18n::addressinput::AddressNormalizer;
+using i18n::addressinput::AddressUiComponent;
+using i18n::addressinput::AddressValidator;
+using i18n::addressinput::BuildCallback;
+using i18n::addressinput::BuildComponents;
+using i18n::addressinput::FieldProblemMap;
+using i18n::addressinput::GetAddressCorpus;
+using i18n::addressinput::GetCorpusRegionCodes;
+using i18n::addressinput::GetCorpusSupplier;
+using i18n::addressinput::GetFormattedNationalAddress;
+using i18n::addressinput::Localization;
+using i18n::addressinput::LookupKey;
+using i18n::addressinput::MemoryCounters;
+
+// Validates addresses, counting the problems found.
+class Validator {
+ public:
+  Validator(const Validator&) = delete;
+  Validator& operator=(const Validator&) = delete;
+
+  Validator()
+      : validator_(GetCorpusSupplier()),
+        validated_(BuildCallback(this, &Validator::OnValidated)),
+        problem_count_(0) {}
+
+  void Validate(const AddressData& address) {
+    FieldProblemMap problems;
+    validator_.Validate(address, true, true, nullptr, &problems, *validated_);
+  }
+
+  size_t problem_count() const { return problem_count_; }
+
+ private:
+  void OnValidated(bool success, const AddressData&,
+                   const FieldProblemMap& problems) {
+    problem_count_ += problems.size();
+  }
+
+  const AddressValidator validator_;
+  const std::unique_ptr<const AddressValidator::Callback> validated_;
+  size_t problem_count_;
+};
+
+void BM_Validate(benchmark::State& state) {
+  const std::vector<AddressData>& corpus = GetAddressCorpus();
+  Validator validator;
+  {
+    MemoryCounters counters(&state, corpus.size());
+    for (auto _ : state) {
+      for (const auto& address : corpus) {
+        validator.Validate(address);
+      }
+    }
+  }
+  state.counters["problems"] = benchmark::Counter(
+      validator.problem_count(), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_Validate);
+
+// Includes copying the address, so that each iteration normalizes the same
+// input.
+void BM_Normalize(benchmark::State& state) {
+  const std::vector<AddressData>& corpus = GetAddressCorpus();
+  const AddressNormalizer normalizer(GetCorpusSupplier());
+  MemoryCounters counters(&state, corpus.size());
+  for (auto _ : state) {
+    for (const auto& address : corpus) {
+      AddressData normalized(address);
+      normalizer.Normalize(&normalized);
+      benchmark::DoNotOptimize(normalized);
+    }
+  }
+}
+BENCHMARK(BM_Normalize);
+
+// Fills in the administrative areas, localities and dependent localities of
+// the corpus addresses from their postal codes. Includes copying the address.
+void BM_FillAddress(benchmark::State& state) {
+  std::vector<AddressData> corpus = GetAddressCorpus();
+  for (auto& address : corpus) {
+    address.administrative_area.clear();
+    address.locality.clear();
+    address.dependent_locality.clear();
+  }
+  const AddressInputHelper helper(GetCorpusSupplier());
+  MemoryCounters counters(&state, corpus.size());
+  for (auto _ : state) {
+    for (const auto& address : corpus) {
+      AddressData filled(address);
+      helper.FillAddress(&filled);
+      benchmark::DoNotOptimize(filled);
+    }
+  }
+}
+BENCHMARK(BM_FillAddress);
+
+void BM_GetFormattedNationalAddress(benchmark::State& state) {
+  const std::vector<AddressData>& corpus = GetAddressCorpus();
+  std::vector<std::string> lines;
+  MemoryCounters counters(&state, corpus.size());
+  for (auto _ : state) {
+    for (const auto& address : corpus) {
+      GetFormattedNationalAddress(address, &lines);
+      benchmark::DoNotOptimize(lines.data());
+    }
+  }
+}
+BENCHMARK(BM_GetFormattedNationalAddress);
+
+void BM_BuildComponents(benchmark::State& state) {
+  const std::vector<std::string>& region_codes = GetCorpusRegionCodes();
+  const Localization localization;
+  std::string best_language;
+  MemoryCounters counters(&state, region_codes.size());
+  for (auto _ : state) {
+    for (const auto& region_code : region_codes) {
+      std::vector<AddressUiComponent> components =
+          BuildComponents(region_code, localization, "en", &best_language);
+      benchmark::DoNotOptimize(components.data());
+    }
+  }
+}
+BENCHMARK(BM_BuildComponents);
+
+// Builds the lookup keys of the corpus addresses and their key strings at all
+// depths.
+void BM_LookupKeyToKeyString(benchmark::State& state) {
+  const std::vector<AddressData>& corpus = GetAddressCorpus();
+  MemoryCounters counters(&state, corpus.size());
+  for (auto _ : state) {
+    for (const auto& address : corpus) {
+      LookupKey lookup_key;
+      lookup_key.FromAddress(address);
+      for (size_t depth = 0; depth < size(LookupKey::kHierarchy); ++depth) {
+        benchmark::DoNotOptimize(lookup_key.ToKeyString(depth).data());
+      }
+    }
+  }
+}
+BENCHMARK(BM_LookupKeyToKeyString);
+
+}  // namespace
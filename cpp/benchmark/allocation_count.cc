@@ -0,0 +1,54 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Counts the heap allocations by replacing the global allocation functions.
+// The other forms of operator new and operator delete call these. Nothing else
+// is in this file, so that the compiler never sees these functions paired with
+// a new-expression.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include "benchmark_util.h"
+
+namespace {
+
+std::atomic<size_t> allocation_count(0);
+
+}  // namespace
+
+void* operator new(size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  void* pointer = std::malloc(size != 0 ? size : 1);
+  if (pointer == nullptr) {
+    throw std::bad_alloc();
+  }
+  return pointer;
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+
+void operator delete(void* pointer, size_t) noexcept { std::free(pointer); }
+
+namespace i18n {
+namespace addressinput {
+
+size_t GetAllocationCount() {
+  return allocation_count.load(std::memory_order_relaxed);
+}
+
+}  // namespace addressinput
+}  // namespace i18n
@@ -0,0 +1,210 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "benchmark_util.h"
+
+#include <libaddressinput/address_data.h>
+#include <libaddressinput/callback.h>
+#include <libaddressinput/null_storage.h>
+#include <libaddressinput/preload_supplier.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include <benchmark/benchmark.h>
+
+#include "testdata_source.h"
+
+namespace i18n {
+namespace addressinput {
+
+namespace {
+
+size_t GetPeakRss() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return usage.ru_maxrss;  // In bytes.
+#else
+  return usage.ru_maxrss * 1024;  // In kilobytes.
+#endif
+}
+
+// Loads the rules of all the corpus regions into a supplier.
+class CorpusLoader {
+ public:
+  CorpusLoader(const CorpusLoader&) = delete;
+  CorpusLoader& operator=(const CorpusLoader&) = delete;
+
+  // Does not take ownership of |supplier|.
+  explicit CorpusLoader(PreloadSupplier* supplier)
+      : supplier_(supplier),
+        loaded_(BuildCallback(this, &CorpusLoader::OnLoaded)) {
+    assert(supplier_ != nullptr);
+  }
+
+  void Load() {
+    for (const auto& region_code : GetCorpusRegionCodes()) {
+      supplier_->LoadRules(region_code, *loaded_);
+    }
+  }
+
+ private:
+  void OnLoaded(bool success, const std::string& region_code, int) {
+    if (!success) {
+      std::abort();
+    }
+  }
+
+  PreloadSupplier* const supplier_;
+  const std::unique_ptr<const PreloadSupplier::Callback> loaded_;
+};
+
+}  // namespace
+
+const std::vector<AddressData>& GetAddressCorpus() {
+  static const std::vector<AddressData> kCorpus{
+      {.region_code = "US",
+       .address_line{"1600 Amphitheatre Parkway"},
+       .administrative_area = "CA",
+       .locality = "Mountain View",
+       .postal_code = "94043",
+       .organization = "Google",
+       .recipient = "Jane Doe"},
+      {.region_code = "CA",
+       .address_line{"111 Richmond Street West"},
+       .administrative_area = "ON",
+       .locality = "Toronto",
+       .postal_code = "M5H 2G4",
+       .recipient = "John Smith"},
+      {.region_code = "GB",
+       .address_line{"Flat 2", "10 Downing Street"},
+       .locality = "London",
+       .postal_code = "SW1A 2AA",
+       .recipient = "Mary Jones"},
+      {.region_code = "DE",
+       .address_line{"Unter den Linden 77"},
+       .locality = "Berlin",
+       .postal_code = "10117",
+       .recipient = "Max Mustermann"},
+      {.region_code = "FR",
+       .address_line{"55 Rue du Faubourg Saint-Honoré"},
+       .locality = "Paris",
+       .postal_code = "75008",
+       .recipient = "Jean Dupont"},
+      {.region_code = "CH",
+       .address_line{"Brandschenkestrasse 110"},
+       .locality = "Zürich",
+       .postal_code = "8002",
+       .recipient = "Hans Muster"},
+      {.region_code = "JP",
+       .address_line{"六本木6-10-1"},
+       .administrative_area = "東京都",
+       .locality = "港区",
+       .postal_code = "106-6108",
+       .language_code = "ja",
+       .recipient = "山田太郎"},
+      {.region_code = "CN",
+       .address_line{"珠江新城华夏路8号"},
+       .administrative_area = "广东省",
+       .locality = "广州市",
+       .dependent_locality = "天河区",
+       .postal_code = "510623",
+       .language_code = "zh-Hans",
+       .recipient = "张三"},
+      {.region_code = "KR",
+       .address_line{"테헤란로 152"},
+       .administrative_area = "서울특별시",
+       .locality = "강남구",
+       .postal_code = "06236",
+       .language_code = "ko",
+       .recipient = "홍길동"},
+      {.region_code = "BR",
+       .address_line{"Avenida Paulista, 1578"},
+       .administrative_area = "SP",
+       .locality = "São Paulo",
+       .dependent_locality = "Bela Vista",
+       .postal_code = "01310-200",
+       .recipient = "João Silva"},
+      {.region_code = "IN",
+       .address_line{"No. 3, RMZ Infinity", "Old Madras Road"},
+       .administrative_area = "Karnataka",
+       .locality = "Bengaluru",
+       .postal_code = "560016",
+       .recipient = "Ravi Kumar"},
+      {.region_code = "AU",
+       .address_line{"48 Pirrama Road"},
+       .administrative_area = "NSW",
+       .locality = "Pyrmont",
+       .postal_code = "2009",
+       .recipient = "Jack Brown"},
+  };
+  return kCorpus;
+}
+
+const std::vector<std::string>& GetCorpusRegionCodes() {
+  static const std::vector<std::string>* const kRegionCodes = [] {
+    auto* region_codes = new std::vector<std::string>;
+    for (const auto& address : GetAddressCorpus()) {
+      if (std::find(region_codes->begin(), region_codes->end(),
+                    address.region_code) == region_codes->end()) {
+        region_codes->push_back(address.region_code);
+      }
+    }
+    return region_codes;
+  }();
+  return *kRegionCodes;
+}
+
+PreloadSupplier* GetCorpusSupplier() {
+  static PreloadSupplier* const kSupplier = [] {
+    auto* supplier =
+        new PreloadSupplier(new TestdataSource(true), new NullStorage);
+    CorpusLoader(supplier).Load();
+    return supplier;
+  }();
+  return kSupplier;
+}
+
+MemoryCounters::MemoryCounters(benchmark::State* state,
+                               size_t items_per_iteration)
+    : state_(state),
+      items_per_iteration_(items_per_iteration),
+      allocations_begin_(GetAllocationCount()) {
+  assert(state_ != nullptr);
+  assert(items_per_iteration_ > 0);
+}
+
+MemoryCounters::~MemoryCounters() {
+  size_t allocations = GetAllocationCount() - allocations_begin_;
+  size_t items = state_->iterations() * items_per_iteration_;
+  state_->SetItemsProcessed(items);
+  state_->counters["allocs_per_item"] = benchmark::Counter(
+      items > 0 ? static_cast<double>(allocations) / items : 0);
+  state_->counters["peak_rss"] =
+      benchmark::Counter(GetPeakRss(), benchmark::Counter::kDefaults,
+                         benchmark::Counter::OneK::kIs1024);
+}
+
+}  // namespace addressinput
+}  // namespace i18n
+
+BENCHMARK_MAIN();
@@ -0,0 +1,77 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// The address corpus and the measurements shared by all the benchmarks.
+
+#ifndef I18N_ADDRESSINPUT_BENCHMARK_BENCHMARK_UTIL_H_
+#define I18N_ADDRESSINPUT_BENCHMARK_BENCHMARK_UTIL_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace i18n {
+namespace addressinput {
+
+class PreloadSupplier;
+struct AddressData;
+
+// Returns complete addresses in a sample of countries with different formats,
+// scripts and depths of administrative subdivisions.
+const std::vector<AddressData>& GetAddressCorpus();
+
+// Returns the region codes of the addresses in GetAddressCorpus(), each once.
+const std::vector<std::string>& GetCorpusRegionCodes();
+
+// Returns a supplier with the rules of the regions of GetCorpusRegionCodes()
+// loaded from the test data file. The supplier is shared by all benchmarks.
+PreloadSupplier* GetCorpusSupplier();
+
+// Returns the number of heap allocations made by the process so far.
+size_t GetAllocationCount();
+
+// Measures a benchmark from its construction to its destruction, which should
+// enclose the benchmark loop, and reports the throughput, the number of heap
+// allocations per item and the peak resident set size of the process. Sample
+// usage:
+//    void BM_Something(benchmark::State& state) {
+//      MemoryCounters counters(&state, items.size());
+//      for (auto _ : state) {
+//        for (const auto& item : items) {
+//          DoSomething(item);
+//        }
+//      }
+//    }
+class MemoryCounters {
+ public:
+  MemoryCounters(const MemoryCounters&) = delete;
+  MemoryCounters& operator=(const MemoryCounters&) = delete;
+
+  // Does not take ownership of |state|. Each iteration of the benchmark loop
+  // processes |items_per_iteration| items.
+  MemoryCounters(benchmark::State* state, size_t items_per_iteration);
+  ~MemoryCounters();
+
+ private:
+  benchmark::State* const state_;
+  const size_t items_per_iteration_;
+  const size_t allocations_begin_;
+};
+
+}  // namespace addressinput
+}  // namespace i18n
+
+#endif  // I18N_ADDRESSINPUT_BENCHMARK_BENCHMARK_UTIL_H_
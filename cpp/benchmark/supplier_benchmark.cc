@@ -0,0 +1,159 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Benchmarks of loading the rules and building the region trees.
+
+#include <libaddressinput/callback.h>
+#include <libaddressinput/memory_usage.h>
+#include <libaddressinput/null_storage.h>
+#include <libaddressinput/preload_supplier.h>
+#include <libaddressinput/region_data.h>
+#include <libaddressinput/region_data_builder.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "benchmark_util.h"
+#include "region_data_constants.h"
+#include "testdata_source.h"
+
+namespace {
+
+using i18n::addressinput::BuildCallback;
+using i18n::addressinput::GetCorpusRegionCodes;
+using i18n::addressinput::GetCorpusSupplier;
+using i18n::addressinput::MemoryCounters;
+using i18n::addressinput::MemoryUsageMap;
+using i18n::addressinput::NullStorage;
+using i18n::addressinput::PreloadSupplier;
+using i18n::addressinput::RegionData;
+using i18n::addressinput::RegionDataBuilder;
+using i18n::addressinput::RegionDataConstants;
+using i18n::addressinput::TestdataSource;
+
+// Loads rules into new suppliers, counting the rules that were loaded.
+class Loader {
+ public:
+  Loader(const Loader&) = delete;
+  Loader& operator=(const Loader&) = delete;
+
+  Loader()
+      : loaded_(BuildCallback(this, &Loader::OnLoaded)),
+        rule_count_(0) {}
+
+  void Load(const std::vector<std::string>& region_codes) {
+    PreloadSupplier supplier(new TestdataSource(true), new NullStorage);
+    for (const auto& region_code : region_codes) {
+      supplier.LoadRules(region_code, *loaded_);
+    }
+  }
+
+  size_t rule_count() const { return rule_count_; }
+
+ private:
+  void OnLoaded(bool success, const std::string&, int num_rules) {
+    if (success) {
+      rule_count_ += num_rules;
+    }
+  }
+
+  const std::unique_ptr<const PreloadSupplier::Callback> loaded_;
+  size_t rule_count_;
+};
+
+// The rules of one corpus region, selected by the benchmark argument.
+void BM_LoadRules(benchmark::State& state) {
+  const std::vector<std::string> region_codes{
+      GetCorpusRegionCodes()[state.range(0)]};
+  state.SetLabel(region_codes.front());
+  Loader loader;
+  {
+    MemoryCounters counters(&state, 1);
+    for (auto _ : state) {
+      loader.Load(region_codes);
+    }
+  }
+  state.counters["rules"] = benchmark::Counter(
+      loader.rule_count(), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_LoadRules)->Apply([](benchmark::internal::Benchmark* benchmark) {
+  for (size_t i = 0; i < GetCorpusRegionCodes().size(); ++i) {
+    benchmark->Arg(i);
+  }
+});
+
+// The rules of all the regions of the world.
+void BM_LoadAllRules(benchmark::State& state) {
+  const std::vector<std::string>& region_codes =
+      RegionDataConstants::GetRegionCodes();
+  Loader loader;
+  MemoryCounters counters(&state, region_codes.size());
+  for (auto _ : state) {
+    loader.Load(region_codes);
+  }
+}
+BENCHMARK(BM_LoadAllRules)->Unit(benchmark::kMillisecond);
+
+// Building the region trees of all corpus regions from scratch.
+void BM_RegionDataBuilderBuild(benchmark::State& state) {
+  PreloadSupplier* supplier = GetCorpusSupplier();
+  const std::vector<std::string>& region_codes = GetCorpusRegionCodes();
+  std::string best_language;
+  MemoryCounters counters(&state, region_codes.size());
+  for (auto _ : state) {
+    RegionDataBuilder builder(supplier);
+    for (const auto& region_code : region_codes) {
+      const RegionData& tree = builder.Build(region_code, "en", &best_language);
+      benchmark::DoNotOptimize(&tree);
+    }
+  }
+}
+BENCHMARK(BM_RegionDataBuilderBuild);
+
+// Getting the region trees of all corpus regions from the builder cache.
+void BM_RegionDataBuilderBuildCached(benchmark::State& state) {
+  PreloadSupplier* supplier = GetCorpusSupplier();
+  const std::vector<std::string>& region_codes = GetCorpusRegionCodes();
+  std::string best_language;
+  RegionDataBuilder builder(supplier);
+  for (const auto& region_code : region_codes) {
+    builder.Build(region_code, "en", &best_language);
+  }
+  MemoryCounters counters(&state, region_codes.size());
+  for (auto _ : state) {
+    for (const auto& region_code : region_codes) {
+      const RegionData& tree = builder.Build(region_code, "en", &best_language);
+      benchmark::DoNotOptimize(&tree);
+    }
+  }
+}
+BENCHMARK(BM_RegionDataBuilderBuildCached);
+
+// Accounting the memory used by the rules of all corpus regions, as a metrics
+// endpoint would.
+void BM_PreloadSupplierGetMemoryUsage(benchmark::State& state) {
+  const PreloadSupplier* supplier = GetCorpusSupplier();
+  MemoryCounters counters(&state, 1);
+  for (auto _ : state) {
+    MemoryUsageMap usage = supplier->GetMemoryUsage();
+    benchmark::DoNotOptimize(usage.size());
+  }
+}
+BENCHMARK(BM_PreloadSupplierGetMemoryUsage)->Unit(benchmark::kMicrosecond);
+
+}  // namespace
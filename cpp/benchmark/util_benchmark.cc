@@ -0,0 +1,92 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Benchmarks of the string comparison and of the validation of cached data.
+
+#include <libaddressinput/address_data.h>
+
+#include <cstddef>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "benchmark_util.h"
+#include "util/string_compare.h"
+#include "validating_util.h"
+
+namespace {
+
+using i18n::addressinput::AddressData;
+using i18n::addressinput::GetAddressCorpus;
+using i18n::addressinput::MemoryCounters;
+using i18n::addressinput::StringCompare;
+using i18n::addressinput::ValidatingUtil;
+
+// Compares the localities of the corpus addresses with themselves in upper
+// case, as when matching user input against the names of the rules.
+void BM_StringCompareNaturalEquals(benchmark::State& state) {
+  const std::vector<AddressData>& corpus = GetAddressCorpus();
+  std::vector<std::string> upper_case;
+  for (const auto& address : corpus) {
+    std::string locality(address.locality);
+    for (char& c : locality) {
+      if ('a' <= c && c <= 'z') {
+        c += 'A' - 'a';
+      }
+    }
+    upper_case.push_back(locality);
+  }
+  const StringCompare compare;
+  MemoryCounters counters(&state, corpus.size());
+  for (auto _ : state) {
+    for (size_t i = 0; i < corpus.size(); ++i) {
+      benchmark::DoNotOptimize(
+          compare.NaturalEquals(corpus[i].locality, upper_case[i]));
+    }
+  }
+}
+BENCHMARK(BM_StringCompareNaturalEquals);
+
+void BM_StringCompareNaturalLess(benchmark::State& state) {
+  const std::vector<AddressData>& corpus = GetAddressCorpus();
+  const StringCompare compare;
+  MemoryCounters counters(&state, corpus.size());
+  for (auto _ : state) {
+    for (size_t i = 0; i < corpus.size(); ++i) {
+      benchmark::DoNotOptimize(compare.NaturalLess(
+          corpus[i].locality, corpus[(i + 1) % corpus.size()].locality));
+    }
+  }
+}
+BENCHMARK(BM_StringCompareNaturalLess);
+
+// Wraps and unwraps data of the size of the benchmark argument, as the storage
+// does with every rule that it caches.
+void BM_ValidatingUtil(benchmark::State& state) {
+  const std::string data(state.range(0), 'x');
+  const time_t now = time(nullptr);
+  MemoryCounters counters(&state, 1);
+  for (auto _ : state) {
+    std::string wrapped(data);
+    ValidatingUtil::Wrap(now, &wrapped);
+    benchmark::DoNotOptimize(ValidatingUtil::UnwrapTimestamp(&wrapped, now));
+    benchmark::DoNotOptimize(ValidatingUtil::UnwrapChecksum(&wrapped));
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_ValidatingUtil)->Range(64, 64 << 10);
+
+}  // namespace
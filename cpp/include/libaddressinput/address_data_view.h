@@ -0,0 +1,117 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// A view of the fields of an address, for validating, formatting and looking up
+// addresses that are already stored elsewhere without copying them into an
+// AddressData struct first.
+
+#ifndef I18N_ADDRESSINPUT_ADDRESS_DATA_VIEW_H_
+#define I18N_ADDRESSINPUT_ADDRESS_DATA_VIEW_H_
+
+#include <libaddressinput/address_field.h>
+
+#include <cassert>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace i18n {
+namespace addressinput {
+
+struct AddressData;
+
+// The street address lines of an AddressDataView, which refer either to the
+// strings of a vector, like AddressData::address_line, or to an array of views.
+// Like std::string_view, this doesn't own the lines, which therefore must be
+// kept available for as long as it's used.
+class AddressLinesView {
+ public:
+  AddressLinesView() : strings_(nullptr), views_(nullptr), size_(0) {}
+
+  AddressLinesView(const std::vector<std::string>& lines)
+      : strings_(lines.data()), views_(nullptr), size_(lines.size()) {}
+
+  AddressLinesView(const std::vector<std::string_view>& lines)
+      : strings_(nullptr), views_(lines.data()), size_(lines.size()) {}
+
+  // Refers to the |size| lines starting at |lines|.
+  AddressLinesView(const std::string_view* lines, size_t size)
+      : strings_(nullptr), views_(lines), size_(size) {
+    assert(lines != nullptr || size == 0);
+  }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  std::string_view operator[](size_t index) const {
+    assert(index < size_);
+    return strings_ != nullptr ? std::string_view(strings_[index])
+                               : views_[index];
+  }
+
+  std::string_view front() const { return (*this)[0]; }
+  std::string_view back() const { return (*this)[size_ - 1]; }
+
+ private:
+  // At most one of these is not nullptr.
+  const std::string* strings_;
+  const std::string_view* views_;
+  size_t size_;
+};
+
+// The same fields as AddressData, as views of strings that are owned by the
+// caller and must be kept available for as long as the view is used. Every
+// AddressData converts implicitly into a view of its fields, without copying
+// any of them. Sample usage:
+//    AddressDataView address;
+//    address.region_code = columns.region_code[row];
+//    address.address_line = AddressLinesView(&columns.street[row], 1);
+//    address.locality = columns.locality[row];
+//    AddressValidator::ValidateNow(supplier, address, false, false, nullptr,
+//                                  &problems);
+//
+// The APIs that modify an address, like AddressNormalizer::Normalize(), still
+// require an AddressData, which ToAddressData() copies the view into.
+struct AddressDataView {
+  AddressDataView() = default;
+  AddressDataView(const AddressData& address);
+
+  std::string_view region_code;
+  AddressLinesView address_line;
+  std::string_view administrative_area;
+  std::string_view locality;
+  std::string_view dependent_locality;
+  std::string_view postal_code;
+  std::string_view sorting_code;
+  std::string_view language_code;
+  std::string_view organization;
+  std::string_view recipient;
+
+  // Returns whether the |field| is empty, in the same way as
+  // AddressData::IsFieldEmpty() does.
+  bool IsFieldEmpty(AddressField field) const;
+
+  // Returns the value of the |field|. The parameter must not be STREET_ADDRESS,
+  // which comprises multiple fields (will crash otherwise).
+  std::string_view GetFieldValue(AddressField field) const;
+
+  // Returns a copy of all the fields.
+  AddressData ToAddressData() const;
+};
+
+}  // namespace addressinput
+}  // namespace i18n
+
+#endif  // I18N_ADDRESSINPUT_ADDRESS_DATA_VIEW_H_
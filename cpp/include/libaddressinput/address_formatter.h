@@ -12,7 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 //
-// Utility functions for formatting the addresses represented as AddressData.
+// Utility functions for formatting the addresses represented as AddressData, or
+// as an AddressDataView of strings that are stored elsewhere.
 //
 // Note these work best if the address has a language code specified - this can
 // be obtained when building the UI components (calling BuildComponents on
@@ -21,29 +22,92 @@
 #ifndef I18N_ADDRESSINPUT_ADDRESS_FORMATTER_H_
 #define I18N_ADDRESSINPUT_ADDRESS_FORMATTER_H_
 
+#include <libaddressinput/address_data_view.h>
+
+#include <cstddef>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace i18n {
 namespace addressinput {
 
+class TaskRunner;
 struct AddressData;
 
 // Formats the address onto multiple lines. This formats the address in national
 // format; without the country.
 void GetFormattedNationalAddress(
-    const AddressData& address_data, std::vector<std::string>* lines);
+    const AddressDataView& address_data, std::vector<std::string>* lines);
 
 // Formats the address as a single line. This formats the address in national
 // format; without the country.
 void GetFormattedNationalAddressLine(
-    const AddressData& address_data, std::string* line);
+    const AddressDataView& address_data, std::string* line);
+
+// Formats the address onto multiple lines like GetFormattedNationalAddress(),
+// but appends them to |text| with a "\n" between the lines, so that the same
+// buffer can be reused for many addresses without any further allocation.
+void AppendFormattedNationalAddress(
+    const AddressDataView& address_data, std::string* text);
+
+// Formats the address as a single line like GetFormattedNationalAddressLine(),
+// but appends it to |line|, so that the same buffer can be reused for many
+// addresses without any further allocation.
+void AppendFormattedNationalAddressLine(
+    const AddressDataView& address_data, std::string* line);
+
+// The kinds of output that FormatBatch() can produce for each address.
+enum FormatBatchMode {
+  FORMAT_BATCH_LINES,        // As GetFormattedNationalAddress().
+  FORMAT_BATCH_SINGLE_LINE,  // As GetFormattedNationalAddressLine().
+};
+
+// The formatted lines of a batch of addresses, stored in one contiguous buffer.
+// In FORMAT_BATCH_SINGLE_LINE mode, every address has exactly one line.
+struct FormattedAddressBatch {
+  // Returns the number of lines of the address at |index| in the batch.
+  size_t GetLineCount(size_t index) const {
+    return address_offsets[index + 1] - address_offsets[index];
+  }
+
+  // Returns the line with number |line| of the address at |index| in the
+  // batch. The result refers to |text| and is valid until it's modified.
+  std::string_view GetLine(size_t index, size_t line) const {
+    size_t i = address_offsets[index] + line;
+    return std::string_view(text).substr(line_offsets[i],
+                                         line_offsets[i + 1] - line_offsets[i]);
+  }
+
+  // All the lines of all the addresses, in order, without any separators.
+  std::string text;
+
+  // The lines of the address at index i are the lines with numbers in
+  // [address_offsets[i], address_offsets[i + 1]). Has one more element than
+  // there are addresses.
+  std::vector<size_t> address_offsets;
+
+  // The line with number j is [line_offsets[j], line_offsets[j + 1]) in |text|.
+  // Has one more element than there are lines.
+  std::vector<size_t> line_offsets;
+};
+
+// Formats |address_count| addresses starting at |addresses| into |batch|, with
+// the same result as formatting each of them with GetFormattedNationalAddress()
+// or GetFormattedNationalAddressLine(), depending on |mode|. The addresses are
+// grouped by region, so that the format of a region is looked up once per
+// group, and the groups are formatted as tasks on |runner|, which may be
+// nullptr to do all the work on the calling thread. Does not take ownership of
+// |runner|.
+void FormatBatch(const AddressData* addresses, size_t address_count,
+                 FormatBatchMode mode, TaskRunner* runner,
+                 FormattedAddressBatch* batch);
 
 // Formats the street-level part of an address as a single line. For example,
 // two lines of "Apt 1", "10 Red St." will be concatenated in a
 // language-appropriate way, to give something like "Apt 1, 10 Red St".
 void GetStreetAddressLinesAsSingleLine(
-    const AddressData& address_data, std::string* line);
+    const AddressDataView& address_data, std::string* line);
 
 }  // namespace addressinput
 }  // namespace i18n
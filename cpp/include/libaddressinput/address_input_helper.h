@@ -15,13 +15,14 @@
 #ifndef I18N_ADDRESSINPUT_ADDRESS_INPUT_HELPER_H_
 #define I18N_ADDRESSINPUT_ADDRESS_INPUT_HELPER_H_
 
+#include <cstddef>
 #include <vector>
 
 namespace i18n {
 namespace addressinput {
 
-class LookupKey;
 class PreloadSupplier;
+class RuleTree;
 struct AddressData;
 struct Node;
 
@@ -52,7 +53,7 @@ class AddressInputHelper {
 
  private:
   void CheckChildrenForPostCodeMatches(
-      const AddressData& address, const LookupKey& lookup_key,
+      const AddressData& address, const RuleTree& tree, size_t tree_node,
       const Node* parent, std::vector<Node>* hierarchy) const;
 
   // We don't own the supplier_.
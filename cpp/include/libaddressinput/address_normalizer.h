@@ -35,7 +35,8 @@ class AddressNormalizer {
 
   // Converts the names of different fields in the address into their canonical
   // form. Should be called only when supplier->IsLoaded() returns true for
-  // the region code of the |address|.
+  // the region code of the |address|. Leaves the |address| unchanged if the
+  // region has been unloaded (or evicted) since.
   void Normalize(AddressData* address) const;
 
  private:
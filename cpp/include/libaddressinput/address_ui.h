@@ -15,6 +15,7 @@
 #ifndef I18N_ADDRESSINPUT_ADDRESS_UI_H_
 #define I18N_ADDRESSINPUT_ADDRESS_UI_H_
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -49,6 +50,50 @@ std::vector<AddressUiComponent> BuildComponentsWithLiterals(
     const std::string& region_code, const Localization& localization,
     const std::string& ui_language_tag, std::string* best_address_language_tag);
 
+// Caches the results of BuildComponents() and BuildComponentsWithLiterals(),
+// for services that need the same layouts over and over. Sample usage:
+//    AddressUiCache cache(&localization);
+//    cache.WarmUp();
+//    ...
+//    std::string best_address_language_tag;
+//    std::shared_ptr<const std::vector<AddressUiComponent>> components =
+//        cache.GetComponents("CH", "fr", false, &best_address_language_tag);
+//
+// The layouts are built with the strings of the localization, so they are
+// rebuilt after each call to Localization::SetGetter() or SetCatalog(). All
+// methods are safe to call concurrently from multiple threads, but not
+// concurrently with Localization::SetGetter() or SetCatalog().
+class AddressUiCache {
+ public:
+  AddressUiCache(const AddressUiCache&) = delete;
+  AddressUiCache& operator=(const AddressUiCache&) = delete;
+
+  // Does not take ownership of |localization|, which must outlive the cache.
+  explicit AddressUiCache(const Localization* localization);
+  ~AddressUiCache();
+
+  // Returns the same components as BuildComponentsWithLiterals() if
+  // |include_literals| is true, or as BuildComponents() otherwise. The result
+  // is never nullptr, and is shared with all other callers that get the same
+  // layout.
+  std::shared_ptr<const std::vector<AddressUiComponent>> GetComponents(
+      const std::string& region_code,
+      const std::string& ui_language_tag,
+      bool include_literals,
+      std::string* best_address_language_tag);
+
+  // Builds all the layouts of all regions, so that later calls to
+  // GetComponents() never have to build one.
+  void WarmUp();
+
+ private:
+  // Holds the layouts and the lock that guards them, which don't need to be
+  // visible here.
+  class Impl;
+
+  const std::unique_ptr<Impl> impl_;
+};
+
 }  // namespace addressinput
 }  // namespace i18n
 
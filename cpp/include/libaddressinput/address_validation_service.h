@@ -0,0 +1,156 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// A service that validates, normalizes and formats addresses on a pool of
+// worker threads, using the rules of a PreloadSupplier that are loaded before
+// the service is started.
+
+#ifndef I18N_ADDRESSINPUT_ADDRESS_VALIDATION_SERVICE_H_
+#define I18N_ADDRESSINPUT_ADDRESS_VALIDATION_SERVICE_H_
+
+#include <libaddressinput/address_data.h>
+#include <libaddressinput/address_normalizer.h>
+#include <libaddressinput/address_validator.h>
+#include <libaddressinput/async.h>
+#include <libaddressinput/future.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace i18n {
+namespace addressinput {
+
+class PreloadSupplier;
+
+// The result of AddressValidationService::Normalize().
+struct NormalizationResult {
+  // False if the rules of the region of the address aren't loaded, in which
+  // case the address is returned unchanged.
+  bool success = false;
+  AddressData address;
+};
+
+// The result of AddressValidationService::Format().
+struct FormattingResult {
+  bool success = false;
+  std::vector<std::string> lines;
+};
+
+// Runs validation, normalization and formatting jobs on |thread_count| worker
+// threads, which share one PreloadSupplier. The supplier is frozen: no rules
+// are loaded into it once the service has it, so the workers can read it
+// without locking. Jobs for regions whose rules weren't loaded fail.
+//
+// The jobs wait in a queue of at most |queue_capacity| jobs. When the queue is
+// full, the methods that submit jobs block until a worker takes one, which
+// slows down the submitting threads to the pace of the workers. The methods
+// can be called from any thread. Sample usage:
+//    PreloadSupplier* supplier = new PreloadSupplier(source, storage);
+//    for (const std::string& region_code : GetRegionCodes()) {
+//      LoadRulesAsync(supplier, region_code).Wait();
+//    }
+//    AddressValidationService service(supplier, 8, 1024);
+//    service.Validate(address, true, true, nullptr)
+//        .Then([response](const ValidationResult& result) {
+//          response->Send(result.success, result.problems);
+//        });
+//
+// The destructor waits for the queued jobs to finish.
+class AddressValidationService {
+ public:
+  // The counters of the service since it was constructed. The throughput is
+  // the difference between two values of |completed_jobs| divided by the time
+  // between them.
+  struct Stats {
+    // The jobs waiting in the queue.
+    size_t queue_depth = 0;
+
+    // The largest |queue_depth| so far, which is at most the capacity.
+    size_t peak_queue_depth = 0;
+
+    // The jobs submitted, including the jobs that are waiting or running.
+    uint64_t submitted_jobs = 0;
+
+    // The jobs finished.
+    uint64_t completed_jobs = 0;
+
+    // The submissions that blocked because the queue was full.
+    uint64_t blocked_submissions = 0;
+  };
+
+  AddressValidationService(const AddressValidationService&) = delete;
+  AddressValidationService& operator=(const AddressValidationService&) = delete;
+
+  // Takes ownership of |supplier|, which must not be loading any rules.
+  AddressValidationService(PreloadSupplier* supplier,
+                           size_t thread_count,
+                           size_t queue_capacity);
+  ~AddressValidationService();
+
+  // Validates a copy of |address| like AddressValidator::ValidateNow() does.
+  // The |filter| is copied, and may be nullptr.
+  Future<ValidationResult> Validate(const AddressData& address,
+                                    bool allow_postal,
+                                    bool require_name,
+                                    const FieldProblemMap* filter);
+
+  // Normalizes a copy of |address| like AddressNormalizer::Normalize() does.
+  Future<NormalizationResult> Normalize(const AddressData& address);
+
+  // Formats a copy of |address| like GetFormattedNationalAddress() does.
+  Future<FormattingResult> Format(const AddressData& address);
+
+  Stats GetStats() const;
+
+  const PreloadSupplier& supplier() const { return *supplier_; }
+
+ private:
+  class Job;
+  class ValidationJob;
+  class NormalizationJob;
+  class FormattingJob;
+
+  // Adds |job| to the queue, waiting while the queue is full.
+  void Push(Job* job);
+
+  // Runs the jobs from the queue until the service is destroyed.
+  void RunWorker();
+
+  const std::unique_ptr<const PreloadSupplier> supplier_;
+  const AddressNormalizer normalizer_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
+
+  // A ring buffer of |queue_size_| jobs starting at |queue_front_|.
+  std::vector<Job*> queue_;
+  size_t queue_front_;
+  size_t queue_size_;
+  bool stopping_;
+  Stats stats_;
+
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace addressinput
+}  // namespace i18n
+
+#endif  // I18N_ADDRESSINPUT_ADDRESS_VALIDATION_SERVICE_H_
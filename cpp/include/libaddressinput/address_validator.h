@@ -19,6 +19,7 @@
 #ifndef I18N_ADDRESSINPUT_ADDRESS_VALIDATOR_H_
 #define I18N_ADDRESSINPUT_ADDRESS_VALIDATOR_H_
 
+#include <libaddressinput/address_data_view.h>
 #include <libaddressinput/address_field.h>
 #include <libaddressinput/address_problem.h>
 #include <libaddressinput/callback.h>
@@ -28,6 +29,8 @@
 namespace i18n {
 namespace addressinput {
 
+class CancellationToken;
+class PreloadSupplier;
 class Supplier;
 struct AddressData;
 
@@ -102,6 +105,35 @@ class AddressValidator {
                 FieldProblemMap* problems,
                 const Callback& validated) const;
 
+  // Like the above, but once |token| is cancelled, |problems| is no longer
+  // written to and |validated| is no longer called, so that the caller can
+  // delete all the objects passed as parameters right after cancelling. The
+  // metadata that isn't loaded yet isn't requested anymore either.
+  void Validate(const AddressData& address,
+                bool allow_postal,
+                bool require_name,
+                const FieldProblemMap* filter,
+                FieldProblemMap* problems,
+                const Callback& validated,
+                const CancellationToken& token) const;
+
+  // Validates the |address| synchronously, using only the address metadata
+  // already loaded into |supplier|, and populates |problems| the same way as
+  // Validate() does. Returns the value that Validate() would pass as |success|
+  // to its callback.
+  //
+  // No callback objects or other heap memory (apart from the |problems| found)
+  // are allocated, and this can be called concurrently from multiple threads as
+  // long as no rules are being loaded into |supplier| at the same time. The
+  // |address| can be an AddressDataView of strings that are stored elsewhere,
+  // so that they don't need to be copied into an AddressData first.
+  static bool ValidateNow(const PreloadSupplier& supplier,
+                          const AddressDataView& address,
+                          bool allow_postal,
+                          bool require_name,
+                          const FieldProblemMap* filter,
+                          FieldProblemMap* problems);
+
  private:
   Supplier* const supplier_;
 };
@@ -0,0 +1,102 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Versions of the asynchronous calls of the library that return a Future of
+// their result instead of taking a Callback. Each call allocates one object,
+// which holds the copies of the parameters that must outlive the call, the
+// callback and the result, so that the caller doesn't need to keep anything
+// alive until the call has finished. Sample usage:
+//    Future<ValidationResult> future =
+//        ValidateAsync(validator, request.address(), true, true, nullptr);
+//    future.Then([response](const ValidationResult& result) {
+//      response->Send(result.success, result.problems);
+//    });
+//
+// The objects that the calls are made on, like the AddressValidator and its
+// Supplier, must still outlive the calls.
+
+#ifndef I18N_ADDRESSINPUT_ASYNC_H_
+#define I18N_ADDRESSINPUT_ASYNC_H_
+
+#include <libaddressinput/address_data.h>
+#include <libaddressinput/address_validator.h>
+#include <libaddressinput/future.h>
+#include <libaddressinput/supplier.h>
+
+#include <optional>
+#include <string>
+
+namespace i18n {
+namespace addressinput {
+
+class PreloadSupplier;
+class Source;
+class Storage;
+
+// The result of AddressValidator::Validate().
+struct ValidationResult {
+  bool success = false;
+  AddressData address;
+  FieldProblemMap problems;
+};
+
+// The result of PreloadSupplier::LoadRules().
+struct LoadRulesResult {
+  bool success = false;
+  std::string region_code;
+  int rule_count = 0;
+};
+
+// The result of Supplier::Supply() or Supplier::SupplyGlobally(). The rules
+// are owned by the Supplier.
+struct SupplyResult {
+  bool success = false;
+  Supplier::RuleHierarchy hierarchy;
+};
+
+// The result of Source::Get() or Storage::Get().
+struct DataResult {
+  bool success = false;
+  std::string key;
+  std::optional<std::string> data;
+};
+
+// Calls validator.Validate() with copies of |address| and |filter|, which may
+// be nullptr.
+Future<ValidationResult> ValidateAsync(const AddressValidator& validator,
+                                       const AddressData& address,
+                                       bool allow_postal,
+                                       bool require_name,
+                                       const FieldProblemMap* filter);
+
+// Calls supplier->LoadRules(), unless the rules of |region_code| are being
+// loaded already, in which case the call finishes right away with status
+// false.
+Future<LoadRulesResult> LoadRulesAsync(PreloadSupplier* supplier,
+                                       const std::string& region_code);
+
+// Calls supplier->Supply(), or supplier->SupplyGlobally() if |search_globally|
+// is true, for the lookup key of |address|.
+Future<SupplyResult> SupplyAsync(Supplier* supplier,
+                                 const AddressData& address,
+                                 bool search_globally);
+
+// Calls source.Get() or storage.Get() for |key|.
+Future<DataResult> GetAsync(const Source& source, const std::string& key);
+Future<DataResult> GetAsync(const Storage& storage, const std::string& key);
+
+}  // namespace addressinput
+}  // namespace i18n
+
+#endif  // I18N_ADDRESSINPUT_ASYNC_H_
@@ -22,6 +22,7 @@
 
 #include <cassert>
 #include <cstddef>
+#include <utility>
 
 namespace i18n {
 namespace addressinput {
@@ -69,8 +70,10 @@ class CallbackImpl : public Callback<Key, Data> {
 
   ~CallbackImpl() override = default;
 
+  // Passes on the |data| that is taken by value without copying it, so that a
+  // buffer can be moved all the way from a Source to its final owner.
   void operator()(bool success, Key key, Data data) const override {
-    (observer_->*observe_event_)(success, key, data);
+    (observer_->*observe_event_)(success, key, std::forward<Data>(data));
   }
 
  private:
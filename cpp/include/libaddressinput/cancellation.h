@@ -0,0 +1,66 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// A token to cancel asynchronous calls that are no longer needed, like the
+// validation of an address that the user has already navigated away from.
+
+#ifndef I18N_ADDRESSINPUT_CANCELLATION_H_
+#define I18N_ADDRESSINPUT_CANCELLATION_H_
+
+#include <memory>
+
+namespace i18n {
+namespace addressinput {
+
+// Cancels the calls that were given the token, or a copy of it, all of which
+// share the same state. A call that is cancelled stops requesting data from
+// its Source, but still stores the data that it has received already. Sample
+// usage:
+//    CancellationToken token;
+//    validator.Validate(address, true, true, nullptr, &problems, *validated_,
+//                       token);
+//    ...
+//    token.Cancel();  // The |validated_| callback won't be called anymore.
+//
+// See AddressValidator::Validate(), Supplier::Supply() and
+// Supplier::SupplyGlobally() for what each call does when it's cancelled.
+class CancellationToken {
+ public:
+  // Creates a token that isn't cancelled.
+  CancellationToken();
+  ~CancellationToken();
+
+  CancellationToken(const CancellationToken&) = default;
+  CancellationToken& operator=(const CancellationToken&) = default;
+
+  // Cancels the calls. Can be called on any thread, any number of times, and
+  // from within a callback of a call. If a callback of a call is running on
+  // another thread, then waits for it to return, so that no callback that the
+  // cancellation suppresses is called after this has returned.
+  void Cancel();
+
+  // Returns true if Cancel() has been called on this token or a copy of it.
+  bool IsCancelled() const;
+
+ private:
+  friend class CancellationLock;
+  struct State;
+
+  std::shared_ptr<State> state_;
+};
+
+}  // namespace addressinput
+}  // namespace i18n
+
+#endif  // I18N_ADDRESSINPUT_CANCELLATION_H_
@@ -0,0 +1,236 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// A minimal future for the result of an asynchronous call, as an alternative
+// to passing a Callback that must outlive the call. See async.h for the calls
+// that return one.
+
+#ifndef I18N_ADDRESSINPUT_FUTURE_H_
+#define I18N_ADDRESSINPUT_FUTURE_H_
+
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <utility>
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+#include <coroutine>
+#endif
+
+namespace i18n {
+namespace addressinput {
+
+template <typename Result>
+class Future;
+
+// The state shared by a call and the Future of its result, which is deleted
+// when both are done with it. An asynchronous call allocates one object of a
+// subclass, which holds everything that the call needs to outlive it and which
+// typically is also the callback of the call, so that the future costs no
+// other allocation. The call fills in the result and then calls Complete().
+template <typename Result>
+class FutureState {
+ public:
+  FutureState(const FutureState&) = delete;
+  FutureState& operator=(const FutureState&) = delete;
+
+ protected:
+  FutureState()
+      : references_(2),
+        mutex_(),
+        ready_condition_(),
+        is_ready_(false),
+        continuation_(),
+        result_() {}
+
+  virtual ~FutureState() = default;
+
+  // Returns the future of this state, which can be called only once.
+  Future<Result> GetFuture() { return Future<Result>(this); }
+
+  // Returns the result, which the call fills in before calling Complete().
+  Result* result() { return &result_; }
+
+  // Makes the result available to the future, calls the continuation, if any,
+  // and releases the reference of the call. The call must not access this
+  // object afterwards.
+  void Complete() {
+    std::function<void(const Result&)> continuation;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      assert(!is_ready_.load(std::memory_order_relaxed));
+      is_ready_.store(true, std::memory_order_release);
+      continuation.swap(continuation_);
+    }
+    ready_condition_.notify_all();
+    if (continuation) {
+      continuation(result_);
+    }
+    Release();
+  }
+
+ private:
+  friend class Future<Result>;
+
+  void Release() {
+    if (references_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete this;
+    }
+  }
+
+  bool IsReady() const { return is_ready_.load(std::memory_order_acquire); }
+
+  void Wait() const {
+    std::unique_lock<std::mutex> lock(mutex_);
+    ready_condition_.wait(lock, [this] { return IsReady(); });
+  }
+
+  // Stores |continuation| to be called by Complete(), unless the result is
+  // ready already, in which case it returns false and doesn't store it.
+  template <typename Function>
+  bool SetContinuation(Function&& continuation) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (IsReady()) {
+      return false;
+    }
+    assert(!continuation_);  // Only one continuation.
+    continuation_ = std::forward<Function>(continuation);
+    return true;
+  }
+
+  std::atomic<int> references_;
+  mutable std::mutex mutex_;
+  mutable std::condition_variable ready_condition_;
+  std::atomic<bool> is_ready_;
+  std::function<void(const Result&)> continuation_;
+  Result result_;
+};
+
+// The result of an asynchronous call, which becomes ready when the call has
+// finished, on whatever thread finishes it. A future can be moved but not
+// copied, and is valid until it's moved from. The result can be waited for,
+// or passed to a continuation. Sample usage:
+//    Future<ValidationResult> future =
+//        ValidateAsync(validator, address, true, true, nullptr);
+//    future.Then([this](const ValidationResult& result) {
+//      Reply(result.success, result.problems);
+//    });
+//
+// In a C++20 coroutine, a future can be awaited, which resumes the coroutine
+// on the thread that finishes the call, with the result moved out of the
+// future:
+//    ValidationResult result =
+//        co_await ValidateAsync(validator, address, true, true, nullptr);
+template <typename Result>
+class Future {
+ public:
+  Future(const Future&) = delete;
+  Future& operator=(const Future&) = delete;
+
+  Future(Future&& other) noexcept : state_(other.state_) {
+    other.state_ = nullptr;
+  }
+
+  Future& operator=(Future&& other) noexcept {
+    std::swap(state_, other.state_);
+    return *this;
+  }
+
+  ~Future() {
+    if (state_ != nullptr) {
+      state_->Release();
+    }
+  }
+
+  // Returns false if this future has been moved from.
+  bool IsValid() const { return state_ != nullptr; }
+
+  // Returns whether the result is available.
+  bool IsReady() const {
+    assert(state_ != nullptr);
+    return state_->IsReady();
+  }
+
+  // Blocks until the result is available. A call that never finishes, like
+  // one that is waiting for a Source that never calls back, blocks forever.
+  void Wait() const {
+    assert(state_ != nullptr);
+    state_->Wait();
+  }
+
+  // Waits for the result and returns it. The result remains valid as long as
+  // this future.
+  const Result& Get() const& {
+    Wait();
+    return state_->result_;
+  }
+
+  // The result of a temporary future would dangle.
+  const Result& Get() const&& = delete;
+
+  // Calls |continuation| with the result when it's available: right away on
+  // this thread if it's available already, or else on the thread that finishes
+  // the call. Can be called only once. A |continuation| that captures no more
+  // than two pointers usually is stored without allocating. The result
+  // remains valid during the call to |continuation| even if this future is
+  // destroyed meanwhile.
+  template <typename Function>
+  void Then(Function&& continuation) {
+    assert(state_ != nullptr);
+    if (!state_->SetContinuation(continuation)) {
+      continuation(state_->result_);
+    }
+  }
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+  class Awaiter {
+   public:
+    explicit Awaiter(Future future) : future_(std::move(future)) {}
+
+    bool await_ready() const { return future_.IsReady(); }
+
+    bool await_suspend(std::coroutine_handle<> handle) {
+      return future_.state_->SetContinuation(
+          [handle](const Result&) { handle.resume(); });
+    }
+
+    // The awaiter owns the only future of the result, so it can be moved.
+    Result await_resume() { return std::move(future_.state_->result_); }
+
+   private:
+    Future future_;
+  };
+
+  Awaiter operator co_await() && {
+    assert(state_ != nullptr);
+    return Awaiter(std::move(*this));
+  }
+#endif
+
+ private:
+  friend class FutureState<Result>;
+
+  explicit Future(FutureState<Result>* state) : state_(state) {
+    assert(state_ != nullptr);
+  }
+
+  FutureState<Result>* state_;
+};
+
+}  // namespace addressinput
+}  // namespace i18n
+
+#endif  // I18N_ADDRESSINPUT_FUTURE_H_
@@ -18,12 +18,15 @@
 #include <libaddressinput/address_field.h>
 #include <libaddressinput/address_problem.h>
 
+#include <cstddef>
 #include <string>
+#include <vector>
 
 namespace i18n {
 namespace addressinput {
 
 struct AddressData;
+class MessageCatalog;
 
 // The object to retrieve localized strings based on message IDs. It returns
 // English by default. Sample usage:
@@ -36,6 +39,10 @@ struct AddressData;
 //    localization.SetGetter(&MyStringGetter);
 //    std::string best_language_tag;
 //    Process(BuildComponents("CA", localization, "fr-CA", &best_language_tag));
+//
+// Or with messages from a catalog, which can be shared by many objects:
+//    Localization localization;
+//    localization.SetCatalog(&catalog, "fr");
 class Localization {
  public:
   Localization(const Localization&) = delete;
@@ -71,6 +78,18 @@ class Localization {
   // application locale.
   void SetGetter(std::string (*getter)(int));
 
+  // Uses the messages of the locale |language_tag| in |catalog| instead of the
+  // string getter, until the next call to SetGetter() or SetCatalog(). Does not
+  // take ownership of |catalog|, which must outlive this object. Returns false
+  // and changes nothing if |catalog| has no such locale.
+  bool SetCatalog(const MessageCatalog* catalog,
+                  const std::string& language_tag);
+
+  // Returns a number that changes every time that SetGetter() or SetCatalog()
+  // changes the strings, so that strings that were obtained from GetString()
+  // can be cached.
+  size_t GetGeneration() const { return generation_; }
+
  private:
   // Returns the error message where the address field is a postal code. Helper
   // to |GetErrorMessage|. If |postal_code_example| is empty, then the error
@@ -84,8 +103,20 @@ class Localization {
       const std::string& postal_code_example,
       const std::string& post_service_url) const;
 
+  // Returns the message |message_id| with its placeholders replaced by
+  // |parameters|.
+  std::string FormatMessage(int message_id,
+                            const std::vector<std::string>& parameters) const;
+
   // The string getter.
   std::string (*get_string_)(int);
+
+  // The catalog and locale to use instead of |get_string_|, if not nullptr.
+  const MessageCatalog* catalog_;
+  size_t catalog_locale_;
+
+  // The number of calls to SetGetter() and successful calls to SetCatalog().
+  size_t generation_;
 };
 
 }  // namespace addressinput
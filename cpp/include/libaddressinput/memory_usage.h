@@ -0,0 +1,70 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// The memory used by the address metadata of each region, as reported by
+// PreloadSupplier, OndemandSupplier and RegionDataBuilder. The numbers are
+// estimates, computed from the sizes and capacities of the objects without
+// asking the allocator, which are meant to be within a few tens of percent of
+// what the allocator has handed out. Sample usage:
+//    MemoryUsageMap usage = supplier.GetMemoryUsage();
+//    for (const auto& pair : usage) {
+//      ReportGauge("address_metadata_bytes", pair.first,
+//                  pair.second.GetTotal());
+//    }
+
+#ifndef I18N_ADDRESSINPUT_MEMORY_USAGE_H_
+#define I18N_ADDRESSINPUT_MEMORY_USAGE_H_
+
+#include <cstddef>
+#include <map>
+#include <string>
+
+namespace i18n {
+namespace addressinput {
+
+// The estimated bytes of memory used by the address metadata of a region, by
+// what uses them.
+struct MemoryUsage {
+  // The Rule objects, with their strings and vectors.
+  size_t rules = 0;
+
+  // The compiled postal code regular expressions. The matchers are shared by
+  // all rules with the same pattern, so a matcher used by the rules of several
+  // regions is counted for each of them.
+  size_t postal_code_matchers = 0;
+
+  // The entries of the indexes of a PreloadSupplier, which map the IDs, names
+  // and Latin-script names of the rules to the rules.
+  size_t rule_index = 0;
+
+  // The maps of rule IDs to rules of a PreloadSupplier or an OndemandSupplier,
+  // and the trees of the rules of a PreloadSupplier.
+  size_t region_rules = 0;
+
+  // The trees built and cached by a RegionDataBuilder.
+  size_t region_data = 0;
+
+  // Returns the sum of all the above.
+  size_t GetTotal() const;
+
+  MemoryUsage& operator+=(const MemoryUsage& other);
+};
+
+// The memory usage of every region, by region code.
+using MemoryUsageMap = std::map<std::string, MemoryUsage>;
+
+}  // namespace addressinput
+}  // namespace i18n
+
+#endif  // I18N_ADDRESSINPUT_MEMORY_USAGE_H_
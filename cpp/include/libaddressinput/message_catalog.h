@@ -0,0 +1,131 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// The localized messages of any number of locales, compiled into a single block
+// of memory that can be shared by all users of the library in a process.
+
+#ifndef I18N_ADDRESSINPUT_MESSAGE_CATALOG_H_
+#define I18N_ADDRESSINPUT_MESSAGE_CATALOG_H_
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace i18n {
+namespace addressinput {
+
+// Looks up messages by locale and message identifier without copying them.
+// Sample usage:
+//    std::map<std::string, MessageCatalog::Messages> messages;
+//    messages["fr"][IDS_LIBADDRESSINPUT_LOCALITY_LABEL] = "Ville";
+//    ...
+//    WriteFile("messages.bin", MessageCatalog::Compile(messages));
+//
+// And then at startup:
+//    std::string_view data = MapFile("messages.bin");
+//    MessageCatalog catalog;
+//    if (!catalog.Load(data)) { ... }
+//    Localization localization;
+//    localization.SetCatalog(&catalog, "fr");
+//
+// Message templates are split into literal and placeholder segments when they
+// are loaded, so that formatting a message only appends the segments.
+class MessageCatalog {
+ public:
+  MessageCatalog(const MessageCatalog&) = delete;
+  MessageCatalog& operator=(const MessageCatalog&) = delete;
+
+  // The messages of one locale, by message identifier.
+  typedef std::map<int, std::string> Messages;
+
+  // The return value of FindLocale() for locales that aren't in the catalog.
+  static const size_t kNoLocale;
+
+  // Creates an empty catalog.
+  MessageCatalog();
+  ~MessageCatalog();
+
+  // Returns the compiled form of |messages|, which maps language tags to the
+  // messages in that language, to be passed to Load().
+  static std::string Compile(const std::map<std::string, Messages>& messages);
+
+  // Replaces the contents of the catalog with the output of Compile() in
+  // |data|. Does not copy |data|, which must remain valid and unchanged as long
+  // as this catalog is used, for example a memory mapped file. Returns false
+  // and leaves the catalog empty if |data| is malformed.
+  bool Load(std::string_view data);
+
+  size_t GetLocaleCount() const { return locales_.size(); }
+
+  // Returns the language tag of the locale at |locale|.
+  std::string_view GetLanguageTag(size_t locale) const;
+
+  // Returns the index of the locale with exactly |language_tag|, or kNoLocale.
+  size_t FindLocale(std::string_view language_tag) const;
+
+  // Returns the message identified by |message_id| in |locale|, or an empty
+  // string if there is no such message. The returned string points into the
+  // data passed to Load().
+  std::string_view GetString(size_t locale, int message_id) const;
+
+  // Appends the message identified by |message_id| in |locale| to |output|,
+  // with the placeholders $1, $2, ... replaced by the corresponding elements of
+  // |parameters|, and "$$" replaced by "$".
+  void AppendMessage(size_t locale,
+                     int message_id,
+                     const std::vector<std::string>& parameters,
+                     std::string* output) const;
+
+ private:
+  // A piece of a message template: either a literal string or a placeholder.
+  struct Segment {
+    std::string_view literal;
+    // The index of the parameter to insert, or kNoParameter for a literal.
+    size_t parameter;
+  };
+
+  struct Message {
+    int id;
+    std::string_view text;
+    // The range of the segments of |text| in |segments_|.
+    size_t segment_begin;
+    size_t segment_end;
+  };
+
+  struct Locale {
+    std::string_view language_tag;
+    // The range of the messages of this locale in |messages_|, sorted by id.
+    size_t message_begin;
+    size_t message_end;
+  };
+
+  static const size_t kNoParameter;
+
+  // Returns the message identified by |message_id| in |locale|, or nullptr.
+  const Message* FindMessage(size_t locale, int message_id) const;
+
+  // Splits |text| into segments and appends them to |segments_|.
+  void Tokenize(std::string_view text);
+
+  std::vector<Locale> locales_;
+  std::vector<Message> messages_;
+  std::vector<Segment> segments_;
+};
+
+}  // namespace addressinput
+}  // namespace i18n
+
+#endif  // I18N_ADDRESSINPUT_MESSAGE_CATALOG_H_
@@ -0,0 +1,134 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// An optional sink for the counters and histograms of the library, to export
+// them to a monitoring system. When no sink is installed, reporting a metric
+// costs no more than checking whether there is a sink.
+
+#ifndef I18N_ADDRESSINPUT_METRICS_H_
+#define I18N_ADDRESSINPUT_METRICS_H_
+
+#include <cstdint>
+#include <iosfwd>
+#include <string_view>
+
+namespace i18n {
+namespace addressinput {
+
+// The metrics reported to a MetricsSink, with the label that each of them is
+// reported with. The times are in microseconds.
+enum Metric {
+  // Histogram of the time that PreloadSupplier::LoadRules() or ReloadRules()
+  // takes to load the rules of a region, by region code.
+  PRELOAD_LOAD_TIME,
+
+  // Counter of the rules built by PreloadSupplier::LoadRules() or, for the
+  // rules that have changed, by ReloadRules(), by region code.
+  PRELOAD_RULES_LOADED,
+
+  // Histogram of the number of entries in the rule index of a PreloadSupplier
+  // after loading the rules of a region, by region code.
+  PRELOAD_INDEX_SIZE,
+
+  // Counter of the regions that a PreloadSupplier unloads to keep its rules
+  // within its memory budget, by region code.
+  PRELOAD_REGIONS_EVICTED,
+
+  // Counters of the rules that OndemandSupplier::Supply() finds or doesn't
+  // find in its cache, by region code.
+  ONDEMAND_CACHE_HITS,
+  ONDEMAND_CACHE_MISSES,
+
+  // Counter of the OndemandSupplier::Supply() requests that are waiting for
+  // rules to be retrieved, which is decremented when they are done, with no
+  // label.
+  ONDEMAND_PENDING_TASKS,
+
+  // Counters of what the Retriever finds in its storage: valid data, stale
+  // data, corrupted data or nothing at all, with no label.
+  RETRIEVER_STORAGE_HITS,
+  RETRIEVER_STORAGE_STALE,
+  RETRIEVER_STORAGE_CORRUPT,
+  RETRIEVER_STORAGE_MISSES,
+
+  // Histogram of the time that the source takes to return data to the
+  // Retriever, with no label.
+  RETRIEVER_SOURCE_TIME,
+
+  // Counter of the bytes that the Retriever gets from the source, with no
+  // label.
+  RETRIEVER_SOURCE_BYTES,
+
+  // Counter of the requests to the source that fail, with no label.
+  RETRIEVER_SOURCE_FAILURES,
+
+  // Counter of the addresses validated by AddressValidator, by outcome: "valid"
+  // if no problems were found, "invalid" if there were problems, or "failed" if
+  // the rules could not be supplied.
+  VALIDATOR_VALIDATIONS,
+
+  // Counter of the problems found by AddressValidator, by the check that found
+  // them, which is the name of the AddressProblem, for example "UNKNOWN_VALUE".
+  VALIDATOR_PROBLEMS
+};
+
+// Receives the metrics of all the objects of the library. The methods can be
+// called from any thread that uses the library, so they must be thread-safe.
+// Sample usage:
+//    class MyMetricsSink : public MetricsSink {
+//     public:
+//      void AddToCounter(Metric metric, std::string_view label,
+//                        int64_t value) override {
+//        monitoring_->GetCounter(metric, label)->Add(value);
+//      }
+//      ...
+//    };
+//
+//    static MyMetricsSink* sink = new MyMetricsSink;
+//    SetMetricsSink(sink);
+class MetricsSink {
+ public:
+  virtual ~MetricsSink() = default;
+
+  // Adds |value|, which may be negative, to the counter of |metric| with
+  // |label|.
+  virtual void AddToCounter(Metric metric,
+                            std::string_view label,
+                            int64_t value) = 0;
+
+  // Adds a sample of |value| to the histogram of |metric| with |label|.
+  virtual void AddToHistogram(Metric metric,
+                              std::string_view label,
+                              int64_t value) = 0;
+};
+
+// Installs |sink| to receive the metrics of the whole process, replacing any
+// sink installed before. A nullptr |sink| stops the reporting. Does not take
+// ownership of |sink|, which should remain valid as long as the library is in
+// use, because a call that started before the sink was replaced may still
+// report to it.
+void SetMetricsSink(MetricsSink* sink);
+
+// Returns the sink installed by SetMetricsSink(), or nullptr.
+MetricsSink* GetMetricsSink();
+
+}  // namespace addressinput
+}  // namespace i18n
+
+// Produces human-readable output in logging, for example in unit tests. Prints
+// what you would expect for valid values, e.g. "PRELOAD_LOAD_TIME" for
+// PRELOAD_LOAD_TIME. For invalid values, prints "[INVALID ENUM VALUE x]".
+std::ostream& operator<<(std::ostream& o, i18n::addressinput::Metric metric);
+
+#endif  // I18N_ADDRESSINPUT_METRICS_H_
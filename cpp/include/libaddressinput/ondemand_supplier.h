@@ -16,6 +16,7 @@
 #define I18N_ADDRESSINPUT_ONDEMAND_SUPPLIER_H_
 
 #include <libaddressinput/callback.h>
+#include <libaddressinput/memory_usage.h>
 #include <libaddressinput/supplier.h>
 
 #include <map>
@@ -25,6 +26,7 @@
 namespace i18n {
 namespace addressinput {
 
+class CancellationToken;
 class LookupKey;
 class Retriever;
 class Rule;
@@ -57,10 +59,31 @@ class OndemandSupplier : public Supplier {
   // For now, this is identical to Supply.
   void SupplyGlobally(const LookupKey& lookup_key,
                       const Callback& supplied) override;
+
+  // Like the above, but the data that isn't in the storage isn't requested
+  // from the source anymore once |token| is cancelled.
+  void Supply(const LookupKey& lookup_key,
+              const Callback& supplied,
+              const CancellationToken& token) override;
+  void SupplyGlobally(const LookupKey& lookup_key,
+                      const Callback& supplied,
+                      const CancellationToken& token) override;
   // OnDemandSupplier doesn't care about UNSUPPORTED fields.
   size_t GetLoadedRuleDepth(const std::string& region_code) const override;
 
+  // Returns the estimated memory used by the cached rules of every region.
+  // Walks all the rules without copying them, which is cheap enough to do for
+  // every scrape of a metrics endpoint, but must not be done while rules are
+  // being supplied.
+  MemoryUsageMap GetMemoryUsage() const;
+
  private:
+  // Starts an OndemandSupplyTask for |lookup_key|, which |token| cancels if
+  // it isn't nullptr.
+  void StartTask(const LookupKey& lookup_key,
+                 const Callback& supplied,
+                 const CancellationToken* token);
+
   const std::unique_ptr<const Retriever> retriever_;
   std::map<std::string, const Rule*> rule_cache_;
 };
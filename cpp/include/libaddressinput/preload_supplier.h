@@ -16,8 +16,10 @@
 #define I18N_ADDRESSINPUT_PRELOAD_SUPPLIER_H_
 
 #include <libaddressinput/callback.h>
+#include <libaddressinput/memory_usage.h>
 #include <libaddressinput/supplier.h>
 
+#include <cstddef>
 #include <map>
 #include <memory>
 #include <set>
@@ -27,10 +29,11 @@
 namespace i18n {
 namespace addressinput {
 
-class IndexMap;
 class LookupKey;
 class Retriever;
 class Rule;
+class RuleCache;
+class RuleTree;
 class Source;
 class Storage;
 
@@ -46,18 +49,60 @@ class Storage;
 //
 // The maximum size of this cache is naturally limited to the amount of data
 // available from the data server. (Currently this is less than 12,000 items of
-// in total less than 2 MB of JSON data.)
+// in total less than 2 MB of JSON data.) It can be limited further with a
+// memory budget, or by unloading regions explicitly.
+//
+// The rules of a region are loaded, reloaded, unloaded and evicted by replacing
+// an immutable snapshot of the loaded regions, so the methods that read the
+// rules can be called concurrently from multiple threads, also while rules are
+// being loaded or unloaded (which must be done from one thread at a time). The
+// rules of a region are deleted only once nothing refers to them anymore: the
+// rules of a RuleHierarchy and of a tree returned by GetRuleTree() remain valid
+// for as long as these are kept.
+//
+// Evicting a region for the memory budget unloads it like UnloadRules() does,
+// and can happen whenever another region is loaded. Code that may run while
+// rules are loaded should therefore not rely on IsLoaded() staying true, but
+// handle the rules of a region being gone, as the methods below do.
 class PreloadSupplier : public Supplier {
  public:
   using Callback = i18n::addressinput::Callback<const std::string&, int>;
 
+  // The IDs of the rules that ReloadRules() found to be new, modified or gone
+  // from the data of a region, in sorted order.
+  struct RuleChanges {
+    std::vector<std::string> added;
+    std::vector<std::string> changed;
+    std::vector<std::string> removed;
+  };
+
+  using ReloadCallback =
+      i18n::addressinput::Callback<const std::string&, const RuleChanges&>;
+
+  // The memory budget of a supplier that keeps all the rules that it loads.
+  static const size_t kUnlimitedMemory;
+
   PreloadSupplier(const PreloadSupplier&) = delete;
   PreloadSupplier& operator=(const PreloadSupplier&) = delete;
 
   // Takes ownership of |source| and |storage|.
   PreloadSupplier(const Source* source, Storage* storage);
+
+  // Keeps the rules of the loaded regions until their estimated size in bytes
+  // exceeds |memory_budget|, and then unloads the least recently used regions,
+  // other than the one that was loaded last. A region is used when its rules
+  // are read, e.g. by Supply() or GetRuleTree(), or when LoadRules() is called
+  // for it. To keep reading cheap, the uses of regions are only told apart by
+  // the regions that are loaded in between them, so the regions that have been
+  // used since the same load are unloaded in the order of LoadRules() calls.
+  PreloadSupplier(const Source* source, Storage* storage, size_t memory_budget);
   ~PreloadSupplier() override;
 
+  // The metadata is supplied before Supply() returns, so the default versions
+  // that take a CancellationToken suffice.
+  using Supplier::Supply;
+  using Supplier::SupplyGlobally;
+
   // Collects the metadata needed for |lookup_key| from the cache, then calls
   // |supplied|. If the metadata needed isn't found in the cache, it will call
   // the callback with status false.
@@ -72,7 +117,9 @@ class PreloadSupplier : public Supplier {
 
   // Should be called only when IsLoaded() returns true for the region code of
   // the |lookup_key|. Can return nullptr if the |lookup_key| does not
-  // correspond to any rule data. The caller does not own the result.
+  // correspond to any rule data, or if the region has been unloaded since. The
+  // caller does not own the result, which remains valid until the rules of the
+  // region are unloaded (or evicted) or reloaded.
   const Rule* GetRule(const LookupKey& lookup_key) const;
 
   // Loads all address metadata available for |region_code|. (A typical data
@@ -82,11 +129,63 @@ class PreloadSupplier : public Supplier {
   // Calls |loaded| when the loading has finished.
   void LoadRules(const std::string& region_code, const Callback& loaded);
 
+  // Like LoadRules() above, but builds only the rules down to |max_depth| of
+  // LookupKey::kHierarchy (e.g. 1 for ADMIN_AREA), skipping the rules and index
+  // entries below it. The data of the whole region is still downloaded, but
+  // for regions like CN, JP or KR nearly all of the rules are localities.
+  //
+  // Validation reports the fields below |max_depth| as UNSUPPORTED_FIELD, in
+  // the same way as for regions without data for them. Loading a region that
+  // was loaded down to a smaller depth again builds the missing rules only.
+  void LoadRules(const std::string& region_code,
+                 size_t max_depth,
+                 const Callback& loaded);
+
+  // Unloads the rules of |region_code|, which are deleted once nothing refers
+  // to them anymore. Returns false if they weren't loaded. Doesn't cancel
+  // loading rules that are in progress of being loaded.
+  bool UnloadRules(const std::string& region_code);
+
+  // Downloads the address metadata for |region_code| again, bypassing the
+  // storage, and replaces only the rules whose data has changed, down to the
+  // depth that the region is loaded to. The rules are compared by the MD5
+  // digests of their data, so unchanged rules are neither built again nor
+  // indexed again, and readers keep using the old rules until all the changes
+  // are published at once. Loads the whole region if it isn't loaded yet.
+  //
+  // If the rules are already in progress of being loaded, it does nothing.
+  // Calls |reloaded| with the changes when the reloading has finished, or with
+  // status false and no changes if the download failed, in which case the
+  // loaded rules are kept.
+  void ReloadRules(const std::string& region_code,
+                   const ReloadCallback& reloaded);
+
   // Returns a mapping of lookup keys to rules. Should be called only when
-  // IsLoaded() returns true for the |region_code|.
+  // IsLoaded() returns true for the |region_code|, and returns an empty map if
+  // the region has been unloaded since. The result remains valid until the
+  // rules of the region are unloaded (or evicted) or reloaded, so while rules
+  // can be loaded concurrently, use GetSharedRulesForRegion() instead.
   const std::map<std::string, const Rule*>& GetRulesForRegion(
       const std::string& region_code) const;
 
+  // Returns the same mapping as GetRulesForRegion(), or nullptr if no rules
+  // are loaded for |region_code|. The mapping and its rules remain valid for as
+  // long as the result is referenced, even after they have been unloaded.
+  std::shared_ptr<const std::map<std::string, const Rule*>>
+  GetSharedRulesForRegion(const std::string& region_code) const;
+
+  // Returns the rules of |region_code| as a tree that can be walked by node
+  // IDs instead of lookup key strings, or nullptr if no rules have been loaded
+  // for |region_code|. The tree and its rules remain valid for as long as the
+  // result is referenced, even after they have been unloaded.
+  std::shared_ptr<const RuleTree> GetRuleTree(
+      const std::string& region_code) const;
+
+  // Returns a number that changes every time that the rules of any region are
+  // loaded, reloaded, unloaded or evicted, so that what is built from them can
+  // be cached and checked for being stale cheaply.
+  size_t GetGeneration() const;
+
   bool IsLoaded(const std::string& region_code) const;
   bool IsPending(const std::string& region_code) const;
 
@@ -96,18 +195,32 @@ class PreloadSupplier : public Supplier {
   // locality the depth would be 3.
   size_t GetLoadedRuleDepth(const std::string& region_code) const override;
 
- private:
+  // Collects the metadata needed for |lookup_key| from the cache into
+  // |hierarchy|, by looking at all available languages if |search_globally| is
+  // true, then returns the status that Supply() or SupplyGlobally() would pass
+  // to its callback. This is safe to call concurrently from multiple threads.
   bool GetRuleHierarchy(const LookupKey& lookup_key, RuleHierarchy* hierarchy,
                         bool search_globally) const;
-  bool IsLoadedKey(const std::string& key) const;
+
+  // Like GetRuleHierarchy() above, but also sets |loaded_depth| to what
+  // GetLoadedRuleDepth() returns for the region of |lookup_key|, from the same
+  // rules, which could otherwise be unloaded or loaded again in between.
+  bool GetRuleHierarchy(const LookupKey& lookup_key, RuleHierarchy* hierarchy,
+                        bool search_globally, size_t* loaded_depth) const;
+
+  // Returns the estimated memory used by the rules of every region that has
+  // been loaded, with their indexes and trees. The estimates are made when the
+  // rules are loaded, so this walks the rules only for the postal code
+  // matchers that have been compiled since, which is cheap enough to do for
+  // every scrape of a metrics endpoint.
+  MemoryUsageMap GetMemoryUsage() const;
+
+ private:
   bool IsPendingKey(const std::string& key) const;
 
   const std::unique_ptr<const Retriever> retriever_;
   std::set<std::string> pending_;
-  const std::unique_ptr<IndexMap> rule_index_;
-  const std::unique_ptr<IndexMap> language_rule_index_;
-  std::vector<const Rule*> rule_storage_;
-  std::map<std::string, std::map<std::string, const Rule*> > region_rules_;
+  const std::unique_ptr<RuleCache> cache_;
 };
 
 }  // namespace addressinput
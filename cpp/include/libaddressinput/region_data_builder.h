@@ -15,22 +15,54 @@
 #ifndef I18N_ADDRESSINPUT_REGION_DATA_BUILDER_H_
 #define I18N_ADDRESSINPUT_REGION_DATA_BUILDER_H_
 
+#include <libaddressinput/memory_usage.h>
+#include <libaddressinput/region_tree.h>
+
+#include <cstddef>
+#include <list>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <tuple>
+#include <utility>
 
 namespace i18n {
 namespace addressinput {
 
 class PreloadSupplier;
 class RegionData;
+class Rule;
+struct Language;
+
+// A region tree serialized by RegionTree::Serialize().
+struct SerializedRegionTree {
+  std::string data;
+  // The hexadecimal MD5 checksum of |data|, which changes only when |data|
+  // changes, for example to use as an HTTP entity tag.
+  std::string content_hash;
+};
 
+// The methods of a RegionDataBuilder can be called from several threads at the
+// same time, but not while the supplier is loading rules. Each tree is built
+// only once, by the first thread that asks for it, while the other threads that
+// ask for the same tree wait for it.
 class RegionDataBuilder {
  public:
   RegionDataBuilder(const RegionDataBuilder&) = delete;
   RegionDataBuilder& operator=(const RegionDataBuilder&) = delete;
 
+  // The memory budget of a builder that keeps everything that it builds.
+  static const size_t kUnlimitedMemory;
+
   // Does not take ownership of |supplier|, which should not be nullptr.
   explicit RegionDataBuilder(PreloadSupplier* supplier);
+
+  // Keeps the trees returned by Build(), BuildShared() and BuildSerialized()
+  // until their estimated size in bytes exceeds |memory_budget|, and then drops
+  // the least recently used ones. A tree that has been dropped is built again
+  // the next time it is asked for.
+  RegionDataBuilder(PreloadSupplier* supplier, size_t memory_budget);
   ~RegionDataBuilder();
 
   // Returns a tree of administrative subdivisions for the |region_code|.
@@ -59,18 +91,132 @@ class RegionDataBuilder {
   // subdivisions. If the UI language is French, then the French names are used.
   // The |best_region_tree_language_tag| value may be an empty string.
   //
-  // Should be called only if supplier->IsLoaded(region_code) returns true. The
-  // |best_region_tree_language_tag| parameter should not be nullptr.
+  // Should be called only if supplier->IsLoaded(region_code) returns true. If
+  // the region has been unloaded (or evicted) since, the tree has no
+  // sub-regions. The |best_region_tree_language_tag| parameter should not be
+  // nullptr.
+  //
+  // The returned tree remains valid until it is dropped from the cache, which
+  // a builder with kUnlimitedMemory does only in DropRegion(), or once the
+  // supplier's rules of the region change, see DropRegion(). With a memory
+  // budget, any other call can drop it, so use BuildShared() instead.
   const RegionData& Build(const std::string& region_code,
                           const std::string& ui_language_tag,
                           std::string* best_region_tree_language_tag);
 
+  // Returns the same tree as Build(), which remains valid as long as it is
+  // referenced, even after it has been dropped from the cache, or the supplier
+  // has unloaded the rules of the region. The same conditions apply to the
+  // parameters.
+  std::shared_ptr<const RegionData> BuildShared(
+      const std::string& region_code,
+      const std::string& ui_language_tag,
+      std::string* best_region_tree_language_tag);
+
+  // Returns the same tree as Build(), in the compact form of RegionTree, which
+  // is much cheaper to build. The same conditions apply to the parameters. The
+  // compact trees are not dropped for the memory budget, so they remain valid
+  // as long as the results of Build() with kUnlimitedMemory, as they keep the
+  // rules of the region from being deleted.
+  const RegionTree& BuildTree(const std::string& region_code,
+                              const std::string& ui_language_tag,
+                              std::string* best_region_tree_language_tag);
+
+  // Returns the tree that BuildTree() returns, serialized in |format|. The
+  // result is cached like that of Build(), so it is serialized only once until
+  // it is dropped. The same conditions apply to the parameters.
+  std::shared_ptr<const SerializedRegionTree> BuildSerialized(
+      const std::string& region_code,
+      const std::string& ui_language_tag,
+      RegionTreeFormat format,
+      std::string* best_region_tree_language_tag);
+
+  // Drops everything that has been built for |region_code|, which invalidates
+  // the references that Build() and BuildTree() have returned for it. What is
+  // built from rules that the supplier has since loaded to a greater depth,
+  // reloaded, unloaded or evicted is also dropped by the next call to any of
+  // the Build methods, which lets the old rules be deleted.
+  void DropRegion(const std::string& region_code);
+
+  // Returns the estimated size in bytes of the cached results of Build(),
+  // BuildShared() and BuildSerialized().
+  size_t GetCachedSize() const;
+
+  // Returns the estimated memory used for every region by the cached results
+  // of Build(), BuildShared(), BuildTree() and BuildSerialized(), counted as
+  // region data, and by the country rules parsed to choose the languages of
+  // the trees, counted as rules. A result of BuildShared() is not counted after
+  // it has been dropped from the cache, even if it is still referenced.
+  MemoryUsageMap GetMemoryUsage() const;
+
  private:
-  using LanguageRegionMap = std::map<std::string, const RegionData*>;
-  using RegionCodeDataMap = std::map<std::string, LanguageRegionMap*>;
+  struct CacheEntry;
+  struct CachedTree;
+
+  // Identifies a cached result by region code, whether it prefers Latin-script
+  // names, which is all that the best language changes in a tree, and either
+  // kRegionDataContent or the RegionTreeFormat of a serialized tree.
+  using CacheKey = std::tuple<std::string, bool, int>;
+  // The least recently used key first.
+  using CacheKeyList = std::list<CacheKey>;
+  using CacheMap = std::map<CacheKey, std::shared_ptr<CacheEntry>>;
+  using RegionTreeMap = std::map<std::pair<std::string, bool>,
+                                 std::shared_ptr<const CachedTree>>;
+  using RuleMap = std::map<std::string, std::unique_ptr<const Rule>>;
+
+  static const int kRegionDataContent;
+
+  // Returns the best language for the tree of |region_code| for a user of
+  // |ui_language_tag|. Must be called with |mutex_| locked.
+  std::shared_ptr<const Language> ChooseBestLanguage(
+      const std::string& region_code, const std::string& ui_language_tag);
+
+  // Returns the tree of |region_code| from the cache, building it if needed,
+  // or if the supplier's rules of the region have changed since it was built.
+  // The tree keeps the rules that it refers to. Must be called with |mutex_|
+  // locked.
+  std::shared_ptr<const RegionTree> GetRegionTree(
+      const std::string& region_code,
+      bool prefer_latin_name);
+
+  // Drops the trees built from rules that the supplier no longer has, if the
+  // supplier's rules have changed since the last call. Must be called with
+  // |mutex_| locked.
+  void DropStaleTrees();
+
+  // Drops the tree of |region_code| that prefers Latin-script names or not,
+  // and everything built from it. Must be called with |mutex_| locked.
+  void DropTree(const std::string& region_code, bool prefer_latin_name);
+
+  // Returns the entry for |key|, which is built by |build| unless it already
+  // has been. |build| is called without |mutex_| locked, with the tree to
+  // build from, and returns the estimated size of what it stored in the entry.
+  template <typename BuildFunction>
+  std::shared_ptr<CacheEntry> GetCacheEntry(
+      const std::string& region_code,
+      const std::string& ui_language_tag,
+      int content,
+      std::string* best_region_tree_language_tag,
+      BuildFunction build);
+
+  // Drops the least recently used entries that have been built, other than
+  // |keep|, until the cache fits into the memory budget. Must be called with
+  // |mutex_| locked.
+  void Evict(const CacheKey& keep);
 
   PreloadSupplier* const supplier_;  // Not owned.
-  RegionCodeDataMap cache_;
+  const size_t memory_budget_;
+  mutable std::mutex mutex_;
+  CacheMap cache_;
+  CacheKeyList cache_order_;
+  size_t cached_size_;
+  RegionTreeMap tree_cache_;
+  // The value of PreloadSupplier::GetGeneration() when the trees were checked
+  // for being stale.
+  size_t supplier_generation_;
+  // The parsed rules of the countries, only with what ChooseBestLanguage()
+  // needs from them.
+  RuleMap country_rules_;
 };
 
 }  // namespace addressinput
@@ -0,0 +1,103 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef I18N_ADDRESSINPUT_REGION_TREE_H_
+#define I18N_ADDRESSINPUT_REGION_TREE_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace i18n {
+namespace addressinput {
+
+class RuleTree;
+
+// The formats that a RegionTree can be serialized to.
+enum RegionTreeFormat {
+  // Nested JSON objects, with the sub-regions of a node only if it has any:
+  //    {"key":"US","name":"US","sub_regions":[
+  //        {"key":"AL","name":"Alabama"},{"key":"AK","name":"Alaska"},...]}
+  REGION_TREE_JSON,
+
+  // The nodes in depth-first order, each as the key, the name and the number
+  // of sub-regions. The strings are prefixed with their size in bytes. All
+  // numbers are unsigned LEB128 variable-length integers.
+  REGION_TREE_BINARY
+};
+
+// The same tree of administrative subdivisions as RegionData, in a compact
+// form: the nodes are identified by index and the children of every node are
+// a contiguous range of indexes. Nothing is allocated per node, the keys and
+// names are those of the rules of the region. Sample usage:
+//    const RegionTree& tree = builder.BuildTree("CN", "zh-Hans", &language);
+//    size_t province = tree.FindChild(RegionTree::kRoot, "广东省");
+//    for (size_t city = tree.GetFirstChild(province);
+//         city < tree.GetChildEnd(province); ++city) {
+//      Process(tree.GetKey(city), tree.GetName(city));
+//    }
+class RegionTree {
+ public:
+  static const size_t kRoot;
+  static const size_t kNoNode;
+
+  RegionTree(const RegionTree&) = delete;
+  RegionTree& operator=(const RegionTree&) = delete;
+
+  // Does not take ownership of |rule_tree|, which must outlive this object.
+  // Uses the Latin-script names of the rules, where there are any, if
+  // |prefer_latin_name| is true. Only the nodes down to |max_depth| have
+  // children.
+  RegionTree(const RuleTree* rule_tree, bool prefer_latin_name,
+             size_t max_depth);
+  ~RegionTree();
+
+  // Returns the key of |node|, for example "AL" for Alabama, or the region
+  // code for the root node.
+  const std::string& GetKey(size_t node) const;
+
+  // Returns the display name of |node|, for example "Alabama", or the region
+  // code for the root node.
+  const std::string& GetName(size_t node) const;
+
+  // Returns the parent of |node|, or kNoNode for the root node.
+  size_t GetParent(size_t node) const;
+
+  // Returns the range [GetFirstChild(), GetChildEnd()) of the children of
+  // |node|, which is empty if the node has no children.
+  size_t GetFirstChild(size_t node) const;
+  size_t GetChildEnd(size_t node) const { return child_ends_[node]; }
+
+  // Returns the child of |node| with key |key|, or kNoNode if there is none.
+  size_t FindChild(size_t node, const std::string& key) const;
+
+  // Appends the whole tree to |output|, in |format|.
+  void Serialize(RegionTreeFormat format, std::string* output) const;
+
+  // Returns the estimated bytes of memory used by this object, not including
+  // the rules that it refers to.
+  size_t EstimateMemoryUsage() const;
+
+ private:
+  const RuleTree* const rule_tree_;  // Not owned.
+  const bool prefer_latin_name_;
+  // The end of the range of the children of every node, which stops before
+  // any child that has no rule or that is deeper than the maximum depth.
+  std::vector<size_t> child_ends_;
+};
+
+}  // namespace addressinput
+}  // namespace i18n
+
+#endif  // I18N_ADDRESSINPUT_REGION_TREE_H_
@@ -27,16 +27,17 @@
 namespace i18n {
 namespace addressinput {
 
-// Gets address metadata. The callback data must be allocated on the heap,
-// passing ownership to the callback. Sample usage:
+// Gets address metadata. The callback takes ownership of the data, which should
+// be moved into it, so that the buffer the data was received in is passed on
+// without being copied all the way to where it's parsed. Sample usage:
 //
 //    class MySource : public Source {
 //     public:
 //      virtual void Get(const std::string& key,
 //                       const Callback& data_ready) const {
 //        bool success = ...
-//        std::string* data = new ...
-//        data_ready(success, key, data);
+//        std::optional<std::string> data = ...
+//        data_ready(success, key, std::move(data));
 //      }
 //    };
 class Source {
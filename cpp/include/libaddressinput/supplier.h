@@ -16,11 +16,14 @@
 #define I18N_ADDRESSINPUT_SUPPLIER_H_
 
 #include <libaddressinput/callback.h>
+
+#include <memory>
 #include <string>
 
 namespace i18n {
 namespace addressinput {
 
+class CancellationToken;
 class LookupKey;
 class Rule;
 
@@ -48,6 +51,18 @@ class Supplier {
   virtual void SupplyGlobally(const LookupKey& lookup_key,
                               const Callback& supplied) = 0;
 
+  // Like Supply() and SupplyGlobally(), but if |token| is cancelled before the
+  // metadata has been loaded, then stops loading where possible and calls
+  // |supplied| with |success| false. The |supplied| callback is always called
+  // exactly once, because its owner typically deletes itself then. The default
+  // implementations check |token| only before calling the methods above.
+  virtual void Supply(const LookupKey& lookup_key,
+                      const Callback& supplied,
+                      const CancellationToken& token);
+  virtual void SupplyGlobally(const LookupKey& lookup_key,
+                              const Callback& supplied,
+                              const CancellationToken& token);
+
   // Looking at the metadata, returns the depths of the available rules for the
   // region code. For example, if for a certain |region_code|, |rule_index_| has
   // the list of values for admin area and city, but not for the dependent
@@ -59,8 +74,11 @@ class Supplier {
   // A RuleHierarchy object encapsulates the hierarchical list of Rule objects
   // that corresponds to a particular LookupKey.
   struct RuleHierarchy {
-    RuleHierarchy() : rule() {}
+    RuleHierarchy() : rule(), owner() {}
     const Rule* rule[4];  // Cf. LookupKey::kHierarchy.
+    // Keeps the rules from being deleted for as long as the hierarchy is kept,
+    // if the supplier can unload them meanwhile. Otherwise nullptr.
+    std::shared_ptr<const void> owner;
   };
 };
 
@@ -0,0 +1,52 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// The interface to be implemented by the user of the library to let bulk
+// operations spread their work across the threads of the user's thread pool.
+
+#ifndef I18N_ADDRESSINPUT_TASK_RUNNER_H_
+#define I18N_ADDRESSINPUT_TASK_RUNNER_H_
+
+#include <cstddef>
+#include <functional>
+
+namespace i18n {
+namespace addressinput {
+
+// Runs independent tasks, possibly concurrently. Sample usage:
+//
+//    class MyTaskRunner : public TaskRunner {
+//     public:
+//      virtual void RunTasks(size_t task_count,
+//                            const std::function<void(size_t)>& task) {
+//        for (size_t i = 0; i < task_count; ++i) {
+//          my_thread_pool_.Post([&task, i] { task(i); });
+//        }
+//        my_thread_pool_.WaitForAll();
+//      }
+//    };
+class TaskRunner {
+ public:
+  virtual ~TaskRunner() = default;
+
+  // Calls |task| once with every index in [0, |task_count|), in any order and
+  // on any threads, and returns when all the calls have returned.
+  virtual void RunTasks(size_t task_count,
+                        const std::function<void(size_t)>& task) = 0;
+};
+
+}  // namespace addressinput
+}  // namespace i18n
+
+#endif  // I18N_ADDRESSINPUT_TASK_RUNNER_H_
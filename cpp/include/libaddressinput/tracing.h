@@ -0,0 +1,132 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Optional trace spans for each hop of the asynchronous operations of the
+// library, to find out where the time of a slow validation or rule load goes.
+
+#ifndef I18N_ADDRESSINPUT_TRACING_H_
+#define I18N_ADDRESSINPUT_TRACING_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace i18n {
+namespace addressinput {
+
+// The hops traced. A validation is traced as:
+//    TRACE_VALIDATE
+//      TRACE_RETRIEVE (for each rule that isn't cached)
+//        TRACE_STORAGE_GET
+//        TRACE_SOURCE_GET (if the storage has no valid data)
+//      TRACE_SUPPLY_LOAD (for each rule retrieved)
+//      TRACE_STORAGE_PUT (if the source returned data)
+//
+// The data from the source is stored only after it has been passed on, so
+// TRACE_STORAGE_PUT follows TRACE_RETRIEVE and may even follow TRACE_VALIDATE.
+// A rule load is traced the same way, with TRACE_LOAD_RULES instead of
+// TRACE_VALIDATE and without TRACE_SUPPLY_LOAD.
+enum TraceSpanKind {
+  TRACE_VALIDATE,      // AddressValidator::Validate(), by region code.
+  TRACE_LOAD_RULES,    // PreloadSupplier::LoadRules() or ReloadRules(), by
+                       // region code.
+  TRACE_RETRIEVE,      // Retrieving data from storage or source, by key.
+  TRACE_STORAGE_GET,   // Storage::Get(), by key.
+  TRACE_SOURCE_GET,    // Source::Get(), by key.
+  TRACE_STORAGE_PUT,   // Storage::Put(), by key.
+  TRACE_SUPPLY_LOAD    // Parsing a rule for OndemandSupplier, by key.
+};
+
+// A span as reported to a TraceSink.
+struct TraceSpan {
+  // Unique for every span in the process.
+  uint64_t id;
+  // The same for all the spans of one AddressValidator::Validate() or
+  // PreloadSupplier::LoadRules() call.
+  uint64_t correlation_id;
+  TraceSpanKind kind;
+  // The region code or the key that the span works on.
+  std::string_view key;
+  // Whether the hop succeeded, and how many bytes of data it returned or
+  // stored. Set only when the span ends.
+  bool success;
+  size_t bytes;
+};
+
+// Receives the spans of all the objects of the library. The methods can be
+// called from any thread that uses the library and from the threads that call
+// the callbacks of a Source or Storage, so they must be thread-safe.
+class TraceSink {
+ public:
+  virtual ~TraceSink() = default;
+
+  virtual void BeginSpan(const TraceSpan& span) = 0;
+  virtual void EndSpan(const TraceSpan& span) = 0;
+};
+
+// Installs |sink| to receive the spans of the whole process, replacing any sink
+// installed before. A nullptr |sink| stops the tracing. Does not take ownership
+// of |sink|, which should remain valid as long as the library is in use,
+// because a span that began before the sink was replaced ends in it.
+void SetTraceSink(TraceSink* sink);
+
+// Returns the sink installed by SetTraceSink(), or nullptr.
+TraceSink* GetTraceSink();
+
+// Collects spans, to export them in the Chrome trace event format, which can
+// be viewed in chrome://tracing or https://ui.perfetto.dev as a waterfall with
+// one track per correlation ID. Sample usage:
+//    ChromeTraceExporter exporter;
+//    SetTraceSink(&exporter);
+//    ...
+//    SetTraceSink(nullptr);
+//    WriteFile("trace.json", exporter.GetJson());
+class ChromeTraceExporter : public TraceSink {
+ public:
+  ChromeTraceExporter(const ChromeTraceExporter&) = delete;
+  ChromeTraceExporter& operator=(const ChromeTraceExporter&) = delete;
+
+  ChromeTraceExporter();
+  ~ChromeTraceExporter() override;
+
+  void BeginSpan(const TraceSpan& span) override;
+  void EndSpan(const TraceSpan& span) override;
+
+  // Returns the spans collected so far as a JSON object, with the times in
+  // microseconds since the exporter was constructed.
+  std::string GetJson() const;
+
+ private:
+  struct Event {
+    bool begin;
+    TraceSpan span;
+    std::string key;
+    int64_t timestamp;
+  };
+
+  void AddEvent(bool begin, const TraceSpan& span);
+
+  const std::chrono::steady_clock::time_point start_;
+  mutable std::mutex mutex_;
+  std::vector<Event> events_;
+};
+
+}  // namespace addressinput
+}  // namespace i18n
+
+#endif  // I18N_ADDRESSINPUT_TRACING_H_
@@ -18,13 +18,13 @@
   'includes': ['libaddressinput.gypi'],
   'target_defaults': {
     'cflags_cc': [
-      '-std=c++11',
+      '-std=c++17',
     ],
     'conditions': [
       [ 'OS == "mac"', {
         'xcode_settings': {
           'OTHER_CPLUSPLUSFLAGS': [
-            '-std=c++11',
+            '-std=c++17',
           ],
         },
       }],
@@ -90,5 +90,23 @@
         }],
       ],
     },
+    {
+      'target_name': 'benchmarks',
+      'type': 'executable',
+      'sources': [
+        '<@(libaddressinput_benchmark_files)',
+      ],
+      'defines': [
+        'TEST_DATA_DIR="../testdata"',
+      ],
+      'include_dirs': [
+        'src',
+        'test',
+      ],
+      'dependencies': [
+        'libaddressinput',
+        'benchmark.gyp:benchmark',
+      ],
+    },
   ],
 }
@@ -14,17 +14,15 @@
 
 #include <libaddressinput/address_data.h>
 
+#include <libaddressinput/address_data_view.h>
 #include <libaddressinput/address_field.h>
 
-#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <ostream>
 #include <string>
 #include <vector>
 
-#include <re2/re2.h>
-
 #include "util/size.h"
 
 namespace i18n {
@@ -61,26 +59,12 @@ const std::vector<std::string> AddressData::*kVectorStringField[] = {
 static_assert(size(kStringField) == size(kVectorStringField),
               "field_mapping_array_size_mismatch");
 
-// A string is considered to be "empty" not only if it actually is empty, but
-// also if it contains nothing but whitespace.
-bool IsStringEmpty(const std::string& str) {
-  static const RE2 kMatcher(R"(\S)");
-  return str.empty() || !RE2::PartialMatch(str, kMatcher);
-}
-
 }  // namespace
 
 bool AddressData::IsFieldEmpty(AddressField field) const {
   assert(field >= 0);
   assert(static_cast<size_t>(field) < size(kStringField));
-  if (kStringField[field] != nullptr) {
-    const auto& value = GetFieldValue(field);
-    return IsStringEmpty(value);
-  } else {
-    const auto& value = GetRepeatedFieldValue(field);
-    return std::find_if_not(value.begin(), value.end(), IsStringEmpty) ==
-           value.end();
-  }
+  return AddressDataView(*this).IsFieldEmpty(field);
 }
 
 const std::string& AddressData::GetFieldValue(AddressField field) const {
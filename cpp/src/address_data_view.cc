@@ -0,0 +1,109 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libaddressinput/address_data_view.h>
+
+#include <libaddressinput/address_data.h>
+#include <libaddressinput/address_field.h>
+
+#include <cassert>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include <re2/re2.h>
+
+#include "util/size.h"
+
+namespace i18n {
+namespace addressinput {
+
+namespace {
+
+// Mapping from AddressField value to pointer to AddressDataView member.
+std::string_view AddressDataView::*kStringField[] = {
+    &AddressDataView::region_code,
+    &AddressDataView::administrative_area,
+    &AddressDataView::locality,
+    &AddressDataView::dependent_locality,
+    &AddressDataView::sorting_code,
+    &AddressDataView::postal_code,
+    nullptr,
+    &AddressDataView::organization,
+    &AddressDataView::recipient,
+};
+
+// A string is considered to be "empty" not only if it actually is empty, but
+// also if it contains nothing but whitespace.
+bool IsStringEmpty(std::string_view str) {
+  static const RE2 kMatcher(R"(\S)");
+  return str.empty() || !RE2::PartialMatch(str, kMatcher);
+}
+
+}  // namespace
+
+AddressDataView::AddressDataView(const AddressData& address)
+    : region_code(address.region_code),
+      address_line(address.address_line),
+      administrative_area(address.administrative_area),
+      locality(address.locality),
+      dependent_locality(address.dependent_locality),
+      postal_code(address.postal_code),
+      sorting_code(address.sorting_code),
+      language_code(address.language_code),
+      organization(address.organization),
+      recipient(address.recipient) {}
+
+bool AddressDataView::IsFieldEmpty(AddressField field) const {
+  assert(field >= 0);
+  assert(static_cast<size_t>(field) < size(kStringField));
+  if (kStringField[field] != nullptr) {
+    return IsStringEmpty(this->*kStringField[field]);
+  }
+  for (size_t i = 0; i < address_line.size(); ++i) {
+    if (!IsStringEmpty(address_line[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::string_view AddressDataView::GetFieldValue(AddressField field) const {
+  assert(field >= 0);
+  assert(static_cast<size_t>(field) < size(kStringField));
+  assert(kStringField[field] != nullptr);
+  return this->*kStringField[field];
+}
+
+AddressData AddressDataView::ToAddressData() const {
+  AddressData address{
+      .region_code = std::string(region_code),
+      .administrative_area = std::string(administrative_area),
+      .locality = std::string(locality),
+      .dependent_locality = std::string(dependent_locality),
+      .postal_code = std::string(postal_code),
+      .sorting_code = std::string(sorting_code),
+      .language_code = std::string(language_code),
+      .organization = std::string(organization),
+      .recipient = std::string(recipient),
+  };
+  address.address_line.reserve(address_line.size());
+  for (size_t i = 0; i < address_line.size(); ++i) {
+    address.address_line.emplace_back(address_line[i]);
+  }
+  return address;
+}
+
+}  // namespace addressinput
+}  // namespace i18n
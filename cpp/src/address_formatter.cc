@@ -15,21 +15,21 @@
 #include <libaddressinput/address_formatter.h>
 
 #include <libaddressinput/address_data.h>
-#include <libaddressinput/address_field.h>
+#include <libaddressinput/address_data_view.h>
+#include <libaddressinput/task_runner.h>
 
 #include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <functional>
+#include <memory>
+#include <numeric>
 #include <string>
+#include <string_view>
 #include <vector>
 
-#include "format_element.h"
+#include "format_program.h"
 #include "language.h"
-#include "region_data_constants.h"
-#include "rule.h"
-#include "util/cctype_tolower_equal.h"
-#include "util/size.h"
 
 namespace i18n {
 namespace addressinput {
@@ -40,181 +40,200 @@ const char kCommaSeparator[] = ", ";
 const char kSpaceSeparator[] = " ";
 const char kArabicCommaSeparator[] = "، ";
 
-const char kLanguagesThatUseSpace[][3] = {
-    "th",
-    "ko",
-};
-
-const char kLanguagesThatHaveNoSeparator[][3] = {
-    "ja",
-    "zh",  // All Chinese variants.
-};
-
-// This data is based on CLDR, cross-checked with data provided by Chrome
-// linguists, for languages that are in official use in some country, where
-// Arabic is the most likely script tag.
-// TODO: Consider supporting variants such as tr-Arab by detecting the script
-// code.
-const char kLanguagesThatUseAnArabicComma[][3] = {
-    "ar",
-    "fa",
-    "ku",
-    "ps",
-    "ur",
-};
-
-std::string GetLineSeparatorForLanguage(const std::string& language_tag) {
-  Language address_language(language_tag);
-
-  // First deal with explicit script tags.
-  if (address_language.has_latin_script) {
-    return kCommaSeparator;
-  }
-
-  // Now guess something appropriate based on the base language.
-  const std::string& base_language = address_language.base;
-  using std::placeholders::_1;
-  if (std::find_if(kLanguagesThatUseSpace,
-                   kLanguagesThatUseSpace + size(kLanguagesThatUseSpace),
-                   std::bind(&EqualToTolowerString, _1, base_language)) !=
-      kLanguagesThatUseSpace + size(kLanguagesThatUseSpace)) {
-    return kSpaceSeparator;
-  } else if (std::find_if(
-                 kLanguagesThatHaveNoSeparator,
-                 kLanguagesThatHaveNoSeparator +
-                     size(kLanguagesThatHaveNoSeparator),
-                 std::bind(&EqualToTolowerString, _1, base_language)) !=
-             kLanguagesThatHaveNoSeparator +
-                 size(kLanguagesThatHaveNoSeparator)) {
-    return "";
-  } else if (std::find_if(
-                 kLanguagesThatUseAnArabicComma,
-                 kLanguagesThatUseAnArabicComma +
-                     size(kLanguagesThatUseAnArabicComma),
-                 std::bind(&EqualToTolowerString, _1, base_language)) !=
-             kLanguagesThatUseAnArabicComma +
-                 size(kLanguagesThatUseAnArabicComma)) {
-    return kArabicCommaSeparator;
+const char* GetLineSeparatorForLanguage(const Language& address_language) {
+  switch (address_language.line_separator) {
+    case SPACE_SEPARATOR:
+      return kSpaceSeparator;
+    case NO_SEPARATOR:
+      return "";
+    case ARABIC_COMMA_SEPARATOR:
+      return kArabicCommaSeparator;
+    case COMMA_SEPARATOR:
+      break;
   }
-  // Either the language is a Latin-script language, or no language was
-  // specified. In the latter case we still return ", " as the most common
-  // separator in use. In countries that don't use this, e.g. Thailand,
-  // addresses are often written in Latin script where this would still be
-  // appropriate, so this is a reasonable default in the absence of information.
   return kCommaSeparator;
 }
 
-void CombineLinesForLanguage(const std::vector<std::string>& lines,
-                             const std::string& language_tag,
+void CombineLinesForLanguage(const AddressLinesView& lines,
+                             std::string_view language_tag,
                              std::string* line) {
   line->clear();
-  std::string separator = GetLineSeparatorForLanguage(language_tag);
-  for (auto it = lines.begin(); it != lines.end(); ++it) {
-    if (it != lines.begin()) {
+  const char* separator =
+      GetLineSeparatorForLanguage(*Language::Get(language_tag));
+  for (size_t i = 0; i < lines.size(); ++i) {
+    if (i > 0) {
       line->append(separator);
     }
-    line->append(*it);
+    line->append(lines[i]);
+  }
+}
+
+// The number of addresses that FormatBatch() formats in one task.
+const size_t kAddressesPerTask = 256;
+
+// The output of one task of FormatBatch(), for a range of the addresses in the
+// order that they are formatted in.
+struct BatchPart {
+  std::string text;
+  // The end offsets in |text| of all the lines.
+  std::vector<size_t> line_ends;
+  // The number of lines and the end offset in |text|, after each address.
+  std::vector<size_t> address_line_ends;
+  std::vector<size_t> address_ends;
+};
+
+// Runs |task| on |runner|, or on the calling thread if |runner| is nullptr.
+void RunTasks(TaskRunner* runner, size_t task_count,
+              const std::function<void(size_t)>& task) {
+  if (runner != nullptr) {
+    runner->RunTasks(task_count, task);
+  } else {
+    for (size_t i = 0; i < task_count; ++i) {
+      task(i);
+    }
   }
 }
 
 }  // namespace
 
 void GetFormattedNationalAddress(
-    const AddressData& address_data, std::vector<std::string>* lines) {
+    const AddressDataView& address_data, std::vector<std::string>* lines) {
   assert(lines != nullptr);
   lines->clear();
 
-  Rule rule;
-  rule.CopyFrom(Rule::GetDefault());
-  // TODO: Eventually, we should get the best rule for this country and
-  // language, rather than just for the country.
-  rule.ParseSerializedRule(
-      RegionDataConstants::GetRegionData(address_data.region_code));
-
-  Language language(address_data.language_code);
-
   // If Latin-script rules are available and the |language_code| of this address
   // is explicitly tagged as being Latin, then use the Latin-script formatting
   // rules.
-  const std::vector<FormatElement>& format =
-      language.has_latin_script && !rule.GetLatinFormat().empty()
-          ? rule.GetLatinFormat()
-          : rule.GetFormat();
-
-  // Address format without the unnecessary elements (based on which address
-  // fields are empty). We assume all literal strings that are not at the start
-  // or end of a line are separators, and therefore only relevant if the
-  // surrounding fields are filled in. This works with the data we have
-  // currently.
-  std::vector<FormatElement> pruned_format;
-  for (auto element_it = format.begin();
-       element_it != format.end();
-       ++element_it) {
-    // Always keep the newlines.
-    if (element_it->IsNewline() ||
-        // Always keep the non-empty address fields.
-        (element_it->IsField() &&
-         !address_data.IsFieldEmpty(element_it->GetField())) ||
-        // Only keep literals that satisfy these 2 conditions:
-        (!element_it->IsField() &&
-         // (1) Not preceding an empty field.
-         (element_it + 1 == format.end() ||
-          !(element_it + 1)->IsField() ||
-          !address_data.IsFieldEmpty((element_it + 1)->GetField())) &&
-         // (2) Not following a removed field.
-         (element_it == format.begin() ||
-          !(element_it - 1)->IsField() ||
-          (!pruned_format.empty() && pruned_format.back().IsField())))) {
-      pruned_format.push_back(*element_it);
-    }
-  }
+  std::shared_ptr<const Language> language =
+      Language::Get(address_data.language_code);
+  FormatProgram::Get(std::string(address_data.region_code),
+                     language->has_latin_script)
+      .AppendLines(address_data, lines);
+}
+
+void GetFormattedNationalAddressLine(
+    const AddressDataView& address_data, std::string* line) {
+  assert(line != nullptr);
+  line->clear();
+  AppendFormattedNationalAddressLine(address_data, line);
+}
+
+void AppendFormattedNationalAddress(const AddressDataView& address_data,
+                                    std::string* text) {
+  assert(text != nullptr);
+  static const std::string kNewline("\n");
+  std::shared_ptr<const Language> language =
+      Language::Get(address_data.language_code);
+  FormatProgram::Get(std::string(address_data.region_code),
+                     language->has_latin_script)
+      .AppendJoined(address_data, kNewline, text);
+}
+
+void AppendFormattedNationalAddressLine(const AddressDataView& address_data,
+                                        std::string* line) {
+  assert(line != nullptr);
+  std::shared_ptr<const Language> language =
+      Language::Get(address_data.language_code);
+  const std::string separator(GetLineSeparatorForLanguage(*language));
+  FormatProgram::Get(std::string(address_data.region_code),
+                     language->has_latin_script)
+      .AppendJoined(address_data, separator, line);
+}
 
-  std::string line;
-  for (const auto& element : pruned_format) {
-    if (element.IsNewline()) {
-      if (!line.empty()) {
-        lines->push_back(line);
-        line.clear();
+void FormatBatch(const AddressData* addresses, size_t address_count,
+                 FormatBatchMode mode, TaskRunner* runner,
+                 FormattedAddressBatch* batch) {
+  assert(addresses != nullptr || address_count == 0);
+  assert(batch != nullptr);
+
+  // Format the addresses grouped by region, so that consecutive addresses in
+  // a task can reuse the same program.
+  std::vector<size_t> order(address_count);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [addresses](size_t a, size_t b) {
+    return addresses[a].region_code < addresses[b].region_code;
+  });
+
+  const size_t task_count =
+      (address_count + kAddressesPerTask - 1) / kAddressesPerTask;
+  std::vector<BatchPart> parts(task_count);
+  RunTasks(runner, task_count, [&](size_t task) {
+    BatchPart* part = &parts[task];
+    const FormatProgram* program = nullptr;
+    const std::string* region_code = nullptr;
+    bool latin_script = false;
+    size_t end = std::min(address_count, (task + 1) * kAddressesPerTask);
+    for (size_t i = task * kAddressesPerTask; i < end; ++i) {
+      const AddressData& address = addresses[order[i]];
+      std::shared_ptr<const Language> language =
+          Language::Get(address.language_code);
+      if (program == nullptr || *region_code != address.region_code ||
+          latin_script != language->has_latin_script) {
+        region_code = &address.region_code;
+        latin_script = language->has_latin_script;
+        program = &FormatProgram::Get(*region_code, latin_script);
       }
-    } else if (element.IsField()) {
-      AddressField field = element.GetField();
-      if (field == STREET_ADDRESS) {
-        // The field "street address" represents the street address lines of an
-        // address, so there can be multiple values.
-        if (!address_data.IsFieldEmpty(field)) {
-          line.append(address_data.address_line.front());
-          if (address_data.address_line.size() > 1U) {
-            lines->push_back(line);
-            line.clear();
-            const auto last_element_iterator =
-                address_data.address_line.begin() +
-                address_data.address_line.size() - 1;
-            lines->insert(lines->end(), address_data.address_line.begin() + 1,
-                          last_element_iterator);
-            line.append(*last_element_iterator);
-          }
-        }
+      if (mode == FORMAT_BATCH_LINES) {
+        program->AppendLines(address, &part->text, &part->line_ends);
       } else {
-        line.append(address_data.GetFieldValue(field));
+        const std::string separator(GetLineSeparatorForLanguage(*language));
+        program->AppendJoined(address, separator, &part->text);
+        part->line_ends.push_back(part->text.size());
       }
-    } else {
-      line.append(element.GetLiteral());
+      part->address_line_ends.push_back(part->line_ends.size());
+      part->address_ends.push_back(part->text.size());
     }
+  });
+
+  // Lay out the addresses in their original order.
+  std::vector<size_t> line_counts(address_count);
+  std::vector<size_t> text_sizes(address_count);
+  for (size_t i = 0; i < address_count; ++i) {
+    const BatchPart& part = parts[i / kAddressesPerTask];
+    size_t j = i % kAddressesPerTask;
+    line_counts[order[i]] =
+        part.address_line_ends[j] - (j > 0 ? part.address_line_ends[j - 1] : 0);
+    text_sizes[order[i]] =
+        part.address_ends[j] - (j > 0 ? part.address_ends[j - 1] : 0);
   }
-  if (!line.empty()) {
-    lines->push_back(line);
+  std::vector<size_t> text_offsets(address_count + 1);
+  batch->address_offsets.resize(address_count + 1);
+  batch->address_offsets[0] = 0;
+  text_offsets[0] = 0;
+  for (size_t i = 0; i < address_count; ++i) {
+    batch->address_offsets[i + 1] = batch->address_offsets[i] + line_counts[i];
+    text_offsets[i + 1] = text_offsets[i] + text_sizes[i];
   }
-}
-
-void GetFormattedNationalAddressLine(
-    const AddressData& address_data, std::string* line) {
-  std::vector<std::string> address_lines;
-  GetFormattedNationalAddress(address_data, &address_lines);
-  CombineLinesForLanguage(address_lines, address_data.language_code, line);
+  batch->text.resize(text_offsets[address_count]);
+  batch->line_offsets.resize(batch->address_offsets[address_count] + 1);
+  batch->line_offsets[0] = 0;
+
+  // Copy the output of each task into place, where no two tasks write to the
+  // same memory.
+  RunTasks(runner, task_count, [&](size_t task) {
+    const BatchPart& part = parts[task];
+    size_t begin = task * kAddressesPerTask;
+    size_t end = std::min(address_count, begin + kAddressesPerTask);
+    size_t line = 0;
+    size_t part_offset = 0;
+    for (size_t i = begin; i < end; ++i) {
+      size_t index = order[i];
+      size_t offset = text_offsets[index];
+      std::copy(part.text.begin() + part_offset,
+                part.text.begin() + part_offset + text_sizes[index],
+                batch->text.begin() + offset);
+      size_t* line_offsets =
+          &batch->line_offsets[batch->address_offsets[index] + 1];
+      for (size_t k = 0; k < line_counts[index]; ++k, ++line) {
+        line_offsets[k] = offset + part.line_ends[line] - part_offset;
+      }
+      part_offset += text_sizes[index];
+    }
+  });
 }
 
 void GetStreetAddressLinesAsSingleLine(
-    const AddressData& address_data, std::string* line) {
+    const AddressDataView& address_data, std::string* line) {
   CombineLinesForLanguage(
       address_data.address_line, address_data.language_code, line);
 }
@@ -21,6 +21,7 @@
 
 #include <cassert>
 #include <cstddef>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -30,6 +31,7 @@
 #include "lookup_key.h"
 #include "region_data_constants.h"
 #include "rule.h"
+#include "rule_tree.h"
 #include "util/re2ptr.h"
 #include "util/size.h"
 
@@ -75,7 +77,8 @@ void FillAddressFromMatchedRules(
   assert(address != nullptr);
   // We skip region code, because we never try and fill that in if it isn't
   // already set.
-  Language language(address->language_code);
+  std::shared_ptr<const Language> language =
+      Language::Get(address->language_code);
   for (size_t depth = kHierarchyDepth - 1; depth > 0; --depth) {
     // If there is only one match at this depth, then we should populate the
     // address, using this rule and its parents.
@@ -88,7 +91,7 @@ void FillAddressFromMatchedRules(
         AddressField field = LookupKey::kHierarchy[depth];
         // Note only empty fields are permitted to be overwritten.
         if (address->IsFieldEmpty(field)) {
-          address->SetFieldValue(field, GetBestName(language, *rule));
+          address->SetFieldValue(field, GetBestName(*language, *rule));
         }
       }
       break;
@@ -112,14 +115,13 @@ void AddressInputHelper::FillAddress(AddressData* address) const {
     return;
   }
 
-  AddressData lookup_key_address;
-  lookup_key_address.region_code = region_code;
   // First try and fill in the postal code if it is missing.
-  LookupKey lookup_key;
-  lookup_key.FromAddress(lookup_key_address);
-  const Rule* region_rule = supplier_->GetRule(lookup_key);
+  const std::shared_ptr<const RuleTree> tree =
+      supplier_->GetRuleTree(region_code);
   // We have already checked that the region is supported; and users of this
   // method must have called LoadRules() first, so we check this here.
+  assert(tree != nullptr);
+  const Rule* region_rule = tree->GetRule(RuleTree::kRoot);
   assert(region_rule != nullptr);
 
   const RE2ptr* postal_code_reg_exp = region_rule->GetPostalCodeMatcher();
@@ -136,7 +138,8 @@ void AddressInputHelper::FillAddress(AddressData* address) const {
       // This hierarchy is used to store rules that represent possible matches
       // at each level of the hierarchy.
       std::vector<Node> hierarchy[kHierarchyDepth];
-      CheckChildrenForPostCodeMatches(*address, lookup_key, nullptr, hierarchy);
+      CheckChildrenForPostCodeMatches(*address, *tree, RuleTree::kRoot, nullptr,
+                                      hierarchy);
 
       FillAddressFromMatchedRules(hierarchy, address);
     }
@@ -148,17 +151,18 @@ void AddressInputHelper::FillAddress(AddressData* address) const {
 
 void AddressInputHelper::CheckChildrenForPostCodeMatches(
     const AddressData& address,
-    const LookupKey& lookup_key,
+    const RuleTree& tree,
+    size_t tree_node,
     const Node* parent,
     // An array of vectors.
     std::vector<Node>* hierarchy) const {
-  const Rule* rule = supplier_->GetRule(lookup_key);
+  const Rule* rule = tree.GetRule(tree_node);
   assert(rule != nullptr);
 
   const RE2ptr* postal_code_prefix = rule->GetPostalCodeMatcher();
   if (postal_code_prefix == nullptr ||
       RE2::PartialMatch(address.postal_code, *postal_code_prefix->ptr)) {
-    size_t depth = lookup_key.GetDepth();
+    size_t depth = tree.GetDepth(tree_node);
     assert(depth < size(LookupKey::kHierarchy));
 
     // This was a match, so store it and its parent in the hierarchy.
@@ -170,10 +174,9 @@ void AddressInputHelper::CheckChildrenForPostCodeMatches(
     if (depth < size(LookupKey::kHierarchy) - 1 &&
         IsFieldUsed(LookupKey::kHierarchy[depth + 1], address.region_code)) {
       // If children are used and present, check them too.
-      for (const auto& sub_key : rule->GetSubKeys()) {
-        LookupKey child_key;
-        child_key.FromLookupKey(lookup_key, sub_key);
-        CheckChildrenForPostCodeMatches(address, child_key, node, hierarchy);
+      for (size_t child = tree.GetFirstChild(tree_node);
+           child < tree.GetChildEnd(tree_node); ++child) {
+        CheckChildrenForPostCodeMatches(address, tree, child, node, hierarchy);
       }
     }
   }
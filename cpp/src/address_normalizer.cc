@@ -20,11 +20,12 @@
 
 #include <cassert>
 #include <cstddef>
+#include <memory>
 #include <string>
-#include <vector>
 
 #include "lookup_key.h"
 #include "rule.h"
+#include "rule_tree.h"
 #include "util/size.h"
 #include "util/string_compare.h"
 
@@ -41,26 +42,20 @@ AddressNormalizer::~AddressNormalizer() = default;
 
 void AddressNormalizer::Normalize(AddressData* address) const {
   assert(address != nullptr);
-  assert(supplier_->IsLoaded(address->region_code));
 
-  AddressData region_address;
-  region_address.region_code = address->region_code;
-  LookupKey parent_key;
-  parent_key.FromAddress(region_address);
-  const Rule* parent_rule = supplier_->GetRule(parent_key);
-  // Since we only set the |region_code| in the |region_address|, and the rule
-  // for the |region_code| is already loaded, |parent_rule| should not be null.
-  assert(parent_rule != nullptr);
-
-  std::vector<std::string> languages(parent_rule->GetLanguages());
-
-  if (languages.empty()) {
-    languages.emplace_back("");
-  } else {
-    languages[0] = "";  // The default language doesn't need a tag on the id.
+  // The tree keeps the rules, even if another thread unloads them meanwhile.
+  const std::shared_ptr<const RuleTree> tree =
+      supplier_->GetRuleTree(address->region_code);
+  if (tree == nullptr) {
+    return;
   }
+  // Since the rules for the |region_code| are loaded, there should be a rule
+  // for the root node.
+  assert(tree->GetRule(RuleTree::kRoot) != nullptr);
 
-  LookupKey lookup_key;
+  // The languages of the tree are indexed in the order of the languages of the
+  // region, where the default language comes first.
+  size_t parent = RuleTree::kRoot;
   for (size_t depth = 1; depth < size(LookupKey::kHierarchy); ++depth) {
     AddressField field = LookupKey::kHierarchy[depth];
     if (address->IsFieldEmpty(field)) {
@@ -69,17 +64,15 @@ void AddressNormalizer::Normalize(AddressData* address) const {
     const std::string& field_value = address->GetFieldValue(field);
     bool no_match_found_yet = true;
 
-    for (const auto& sub_key : parent_rule->GetSubKeys()) {
-      if (!no_match_found_yet) {
-        break;
-      }
-      for (const std::string& language_tag : languages) {
-        lookup_key.set_language(language_tag);
-        lookup_key.FromLookupKey(parent_key, sub_key);
-        const Rule* rule = supplier_->GetRule(lookup_key);
+    for (size_t child = tree->GetFirstChild(parent);
+         child < tree->GetChildEnd(parent) && no_match_found_yet; ++child) {
+      const std::string& sub_key = tree->GetSubKey(child);
+      for (size_t language = 0; language < tree->GetLanguageCount();
+           ++language) {
+        const Rule* rule = tree->GetRule(child, language);
 
-        // A rule with key = sub_key and specified language_tag was expected to
-        // be found in a certain format (e.g. data/CA/QC--fr), but it was not.
+        // A rule with key = sub_key and specified language was expected to be
+        // found in a certain format (e.g. data/CA/QC--fr), but it was not.
         // This is due to a possible inconsistency in the data format.
         if (rule == nullptr) continue;
 
@@ -92,9 +85,8 @@ void AddressNormalizer::Normalize(AddressData* address) const {
           address->SetFieldValue(
               field, matches_latin_name ? rule->GetLatinName() : sub_key);
           no_match_found_yet = false;
-          parent_key.FromLookupKey(parent_key, sub_key);
-          parent_rule = supplier_->GetRule(parent_key);
-          assert(parent_rule != nullptr);
+          parent = child;
+          assert(tree->GetRule(parent) != nullptr);
           break;
         }
       }
@@ -20,7 +20,11 @@
 
 #include <cassert>
 #include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <set>
+#include <shared_mutex>
 #include <string>
 #include <vector>
 
@@ -77,28 +81,16 @@ std::string GetLabelForField(const Localization& localization,
   return localization.GetString(message_id);
 }
 
-std::vector<AddressUiComponent> BuildComponents(
-    const std::string& region_code, const Localization& localization,
-    const std::string& ui_language_tag, bool include_literals,
-    std::string* best_address_language_tag) {
-  assert(best_address_language_tag != nullptr);
+// Returns the components of the Latin-script format of |rule| if |latin_script|
+// is true, or of its local format otherwise.
+std::vector<AddressUiComponent> BuildLayout(const Rule& rule,
+                                            bool latin_script,
+                                            const Localization& localization,
+                                            bool include_literals) {
   std::vector<AddressUiComponent> result;
 
-  Rule rule;
-  rule.CopyFrom(Rule::GetDefault());
-  if (!rule.ParseSerializedRule(
-          RegionDataConstants::GetRegionData(region_code))) {
-    return result;
-  }
-
-  const Language best_address_language =
-      ChooseBestAddressLanguage(rule, Language(ui_language_tag));
-  *best_address_language_tag = best_address_language.tag;
-
   const std::vector<FormatElement>& format =
-      !rule.GetLatinFormat().empty() && best_address_language.has_latin_script
-          ? rule.GetLatinFormat()
-          : rule.GetFormat();
+      latin_script ? rule.GetLatinFormat() : rule.GetFormat();
 
   // For avoiding showing an input field twice, when the field is displayed
   // twice on an envelope.
@@ -141,8 +133,221 @@ std::vector<AddressUiComponent> BuildComponents(
   return result;
 }
 
+// Returns whether the components for |language| should be built from the
+// Latin-script format of |rule|.
+bool UseLatinFormat(const Rule& rule, const Language& language) {
+  return !rule.GetLatinFormat().empty() && language.has_latin_script;
+}
+
+std::vector<AddressUiComponent> BuildComponents(
+    const std::string& region_code, const Localization& localization,
+    const std::string& ui_language_tag, bool include_literals,
+    std::string* best_address_language_tag) {
+  assert(best_address_language_tag != nullptr);
+
+  Rule rule;
+  rule.CopyFrom(Rule::GetDefault());
+  if (!rule.ParseSerializedRule(
+          RegionDataConstants::GetRegionData(region_code))) {
+    return std::vector<AddressUiComponent>();
+  }
+
+  std::shared_ptr<const Language> best_address_language =
+      ChooseBestAddressLanguage(rule, *Language::Get(ui_language_tag));
+  *best_address_language_tag = best_address_language->tag;
+
+  return BuildLayout(rule, UseLatinFormat(rule, *best_address_language),
+                     localization, include_literals);
+}
+
+// Returns the layout shared by all regions whose rule fails to parse.
+std::shared_ptr<const std::vector<AddressUiComponent>> GetEmptyLayout() {
+  static const auto* const kEmptyLayout =
+      new std::shared_ptr<const std::vector<AddressUiComponent>>(
+          std::make_shared<const std::vector<AddressUiComponent>>());
+  return *kEmptyLayout;
+}
+
+// The parsed rule of a region, and the layouts built from it so far, indexed
+// by [latin_script][include_literals].
+struct RegionLayouts {
+  RegionLayouts(const RegionLayouts&) = delete;
+  RegionLayouts& operator=(const RegionLayouts&) = delete;
+
+  RegionLayouts() : rule(), valid(false), layouts() {}
+
+  Rule rule;
+  // False if the rule failed to parse, in which case there are no components.
+  bool valid;
+  std::shared_ptr<const std::vector<AddressUiComponent>> layouts[2][2];
+};
+
 }  // namespace
 
+class AddressUiCache::Impl {
+ public:
+  Impl(const Impl&) = delete;
+  Impl& operator=(const Impl&) = delete;
+
+  explicit Impl(const Localization* localization)
+      : localization_(localization),
+        localization_generation_(0),
+        mutex_(),
+        regions_() {
+    assert(localization_ != nullptr);
+    localization_generation_ = localization_->GetGeneration();
+  }
+
+  ~Impl() = default;
+
+  std::shared_ptr<const std::vector<AddressUiComponent>> GetComponents(
+      const std::string& region_code,
+      const std::string& ui_language_tag,
+      bool include_literals,
+      std::string* best_address_language_tag);
+
+  void WarmUp();
+
+ private:
+  // Returns the entry for |key|, creating it if needed. Discards all layouts
+  // first if the getter of the localization has changed. The caller must hold
+  // an exclusive lock on |mutex_|.
+  RegionLayouts* GetRegionLayouts(const std::string& key);
+
+  // Returns the layout of |region|, building it if needed. The caller must hold
+  // an exclusive lock on |mutex_|.
+  std::shared_ptr<const std::vector<AddressUiComponent>> GetLayout(
+      RegionLayouts* region, bool latin_script, bool include_literals) const;
+
+  const Localization* const localization_;
+  // The value of Localization::GetGeneration() when the layouts were built.
+  size_t localization_generation_;
+  std::shared_mutex mutex_;
+  std::map<std::string, std::unique_ptr<RegionLayouts>> regions_;
+};
+
+AddressUiCache::AddressUiCache(const Localization* localization)
+    : impl_(new Impl(localization)) {}
+
+AddressUiCache::~AddressUiCache() = default;
+
+std::shared_ptr<const std::vector<AddressUiComponent>>
+AddressUiCache::GetComponents(const std::string& region_code,
+                              const std::string& ui_language_tag,
+                              bool include_literals,
+                              std::string* best_address_language_tag) {
+  return impl_->GetComponents(region_code, ui_language_tag, include_literals,
+                              best_address_language_tag);
+}
+
+void AddressUiCache::WarmUp() {
+  impl_->WarmUp();
+}
+
+std::shared_ptr<const std::vector<AddressUiComponent>>
+AddressUiCache::Impl::GetComponents(const std::string& region_code,
+                                    const std::string& ui_language_tag,
+                                    bool include_literals,
+                                    std::string* best_address_language_tag) {
+  assert(best_address_language_tag != nullptr);
+  // All unsupported region codes get the default rule, so they share one entry
+  // and can't make the cache grow without bounds.
+  const std::string key =
+      RegionDataConstants::IsSupported(region_code) ? region_code : "";
+
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (localization_generation_ == localization_->GetGeneration()) {
+      auto it = regions_.find(key);
+      if (it != regions_.end()) {
+        const RegionLayouts& region = *it->second;
+        if (!region.valid) {
+          return GetEmptyLayout();
+        }
+        std::shared_ptr<const Language> best_address_language =
+            ChooseBestAddressLanguage(region.rule,
+                                      *Language::Get(ui_language_tag));
+        const auto& layout =
+            region.layouts[UseLatinFormat(region.rule, *best_address_language)]
+                          [include_literals];
+        if (layout != nullptr) {
+          *best_address_language_tag = best_address_language->tag;
+          return layout;
+        }
+      }
+    }
+  }
+
+  std::lock_guard<std::shared_mutex> lock(mutex_);
+  RegionLayouts* region = GetRegionLayouts(key);
+  if (!region->valid) {
+    return GetEmptyLayout();
+  }
+  std::shared_ptr<const Language> best_address_language =
+      ChooseBestAddressLanguage(region->rule, *Language::Get(ui_language_tag));
+  *best_address_language_tag = best_address_language->tag;
+  return GetLayout(region, UseLatinFormat(region->rule, *best_address_language),
+                   include_literals);
+}
+
+void AddressUiCache::Impl::WarmUp() {
+  std::lock_guard<std::shared_mutex> lock(mutex_);
+  for (const auto& region_code : GetRegionCodes()) {
+    RegionLayouts* region = GetRegionLayouts(region_code);
+    if (!region->valid) {
+      continue;
+    }
+    for (bool latin_script : {false, true}) {
+      if (latin_script && region->rule.GetLatinFormat().empty()) {
+        continue;
+      }
+      for (bool include_literals : {false, true}) {
+        GetLayout(region, latin_script, include_literals);
+      }
+    }
+  }
+}
+
+RegionLayouts* AddressUiCache::Impl::GetRegionLayouts(const std::string& key) {
+  // The layouts contain the strings of the localization, so they all become
+  // stale when its getter changes. The parsed rules remain valid.
+  size_t generation = localization_->GetGeneration();
+  if (localization_generation_ != generation) {
+    localization_generation_ = generation;
+    for (const auto& entry : regions_) {
+      for (auto& layouts : entry.second->layouts) {
+        for (auto& layout : layouts) {
+          layout.reset();
+        }
+      }
+    }
+  }
+
+  auto it = regions_.find(key);
+  if (it == regions_.end()) {
+    auto* region = new RegionLayouts;
+    region->rule.CopyFrom(Rule::GetDefault());
+    region->valid = region->rule.ParseSerializedRule(
+        RegionDataConstants::GetRegionData(key));
+    it = regions_.emplace(key, std::unique_ptr<RegionLayouts>(region)).first;
+  }
+  return it->second.get();
+}
+
+std::shared_ptr<const std::vector<AddressUiComponent>>
+AddressUiCache::Impl::GetLayout(RegionLayouts* region,
+                                bool latin_script,
+                                bool include_literals) const {
+  assert(region != nullptr);
+  auto& layout = region->layouts[latin_script][include_literals];
+  if (layout == nullptr) {
+    layout = std::make_shared<const std::vector<AddressUiComponent>>(
+        BuildLayout(region->rule, latin_script, *localization_,
+                    include_literals));
+  }
+  return layout;
+}
+
 const std::vector<std::string>& GetRegionCodes() {
   return RegionDataConstants::GetRegionCodes();
 }
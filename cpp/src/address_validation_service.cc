@@ -0,0 +1,240 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libaddressinput/address_validation_service.h>
+
+#include <libaddressinput/address_data.h>
+#include <libaddressinput/address_formatter.h>
+#include <libaddressinput/address_validator.h>
+#include <libaddressinput/async.h>
+#include <libaddressinput/future.h>
+#include <libaddressinput/preload_supplier.h>
+
+#include <cassert>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace i18n {
+namespace addressinput {
+
+// A job in the queue, which is also the state of the future of its result. The
+// worker calls Run() to compute the result, and then Finish() to make it
+// available, which deletes the job once the future is done with it too.
+class AddressValidationService::Job {
+ public:
+  Job(const Job&) = delete;
+  Job& operator=(const Job&) = delete;
+
+  virtual void Run(const AddressValidationService& service) = 0;
+  virtual void Finish() = 0;
+
+ protected:
+  Job() = default;
+  virtual ~Job() = default;
+};
+
+class AddressValidationService::ValidationJob
+    : public FutureState<ValidationResult>, public Job {
+ public:
+  ValidationJob(const AddressData& address,
+                bool allow_postal,
+                bool require_name,
+                const FieldProblemMap* filter)
+      : allow_postal_(allow_postal),
+        require_name_(require_name),
+        filter_(filter != nullptr ? std::make_optional(*filter)
+                                  : std::nullopt) {
+    result()->address = address;
+  }
+
+  Future<ValidationResult> TakeFuture() { return GetFuture(); }
+
+  void Run(const AddressValidationService& service) override {
+    result()->success = AddressValidator::ValidateNow(
+        *service.supplier_, result()->address, allow_postal_, require_name_,
+        filter_ ? &*filter_ : nullptr, &result()->problems);
+  }
+
+  void Finish() override { Complete(); }
+
+ private:
+  ~ValidationJob() override = default;
+
+  const bool allow_postal_;
+  const bool require_name_;
+  const std::optional<FieldProblemMap> filter_;
+};
+
+class AddressValidationService::NormalizationJob
+    : public FutureState<NormalizationResult>, public Job {
+ public:
+  explicit NormalizationJob(const AddressData& address) {
+    result()->address = address;
+  }
+
+  Future<NormalizationResult> TakeFuture() { return GetFuture(); }
+
+  void Run(const AddressValidationService& service) override {
+    // AddressNormalizer is to be called for loaded regions only. If the region
+    // is evicted right after this check, the address is left unchanged.
+    if (service.supplier_->IsLoaded(result()->address.region_code)) {
+      service.normalizer_.Normalize(&result()->address);
+      result()->success = true;
+    }
+  }
+
+  void Finish() override { Complete(); }
+
+ private:
+  ~NormalizationJob() override = default;
+};
+
+class AddressValidationService::FormattingJob
+    : public FutureState<FormattingResult>, public Job {
+ public:
+  explicit FormattingJob(const AddressData& address) : address_(address) {}
+
+  Future<FormattingResult> TakeFuture() { return GetFuture(); }
+
+  void Run(const AddressValidationService& service) override {
+    GetFormattedNationalAddress(address_, &result()->lines);
+    result()->success = true;
+  }
+
+  void Finish() override { Complete(); }
+
+ private:
+  ~FormattingJob() override = default;
+
+  const AddressData address_;
+};
+
+AddressValidationService::AddressValidationService(PreloadSupplier* supplier,
+                                                   size_t thread_count,
+                                                   size_t queue_capacity)
+    : supplier_(supplier),
+      normalizer_(supplier),
+      mutex_(),
+      not_empty_(),
+      not_full_(),
+      queue_(queue_capacity),
+      queue_front_(0),
+      queue_size_(0),
+      stopping_(false),
+      stats_(),
+      workers_() {
+  assert(supplier_ != nullptr);
+  assert(thread_count > 0);
+  assert(queue_capacity > 0);
+  workers_.reserve(thread_count);
+  for (size_t i = 0; i < thread_count; ++i) {
+    workers_.emplace_back(&AddressValidationService::RunWorker, this);
+  }
+}
+
+AddressValidationService::~AddressValidationService() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  not_empty_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+  assert(queue_size_ == 0);
+}
+
+Future<ValidationResult> AddressValidationService::Validate(
+    const AddressData& address,
+    bool allow_postal,
+    bool require_name,
+    const FieldProblemMap* filter) {
+  auto* job = new ValidationJob(address, allow_postal, require_name, filter);
+  Future<ValidationResult> future = job->TakeFuture();
+  Push(job);
+  return future;
+}
+
+Future<NormalizationResult> AddressValidationService::Normalize(
+    const AddressData& address) {
+  auto* job = new NormalizationJob(address);
+  Future<NormalizationResult> future = job->TakeFuture();
+  Push(job);
+  return future;
+}
+
+Future<FormattingResult> AddressValidationService::Format(
+    const AddressData& address) {
+  auto* job = new FormattingJob(address);
+  Future<FormattingResult> future = job->TakeFuture();
+  Push(job);
+  return future;
+}
+
+AddressValidationService::Stats AddressValidationService::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Stats stats = stats_;
+  stats.queue_depth = queue_size_;
+  return stats;
+}
+
+void AddressValidationService::Push(Job* job) {
+  assert(job != nullptr);
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    assert(!stopping_);
+    if (queue_size_ == queue_.size()) {
+      ++stats_.blocked_submissions;
+      not_full_.wait(lock, [this] { return queue_size_ < queue_.size(); });
+    }
+    queue_[(queue_front_ + queue_size_) % queue_.size()] = job;
+    ++queue_size_;
+    ++stats_.submitted_jobs;
+    if (queue_size_ > stats_.peak_queue_depth) {
+      stats_.peak_queue_depth = queue_size_;
+    }
+  }
+  not_empty_.notify_one();
+}
+
+void AddressValidationService::RunWorker() {
+  for (;;) {
+    Job* job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      not_empty_.wait(lock, [this] { return queue_size_ > 0 || stopping_; });
+      if (queue_size_ == 0) {
+        return;  // Stopping, and all the jobs are done.
+      }
+      job = queue_[queue_front_];
+      queue_front_ = (queue_front_ + 1) % queue_.size();
+      --queue_size_;
+    }
+    not_full_.notify_one();
+
+    job->Run(*this);
+    {
+      // Counted before the result is available, so that whoever gets the
+      // result sees the job counted.
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++stats_.completed_jobs;
+    }
+    job->Finish();
+  }
+}
+
+}  // namespace addressinput
+}  // namespace i18n
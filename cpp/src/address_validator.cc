@@ -14,9 +14,12 @@
 
 #include <libaddressinput/address_validator.h>
 
+#include <libaddressinput/cancellation.h>
+
 #include <cassert>
 #include <cstddef>
 
+#include "tracing_util.h"
 #include "validation_task.h"
 
 namespace i18n {
@@ -32,6 +35,9 @@ void AddressValidator::Validate(const AddressData& address,
                                 const FieldProblemMap* filter,
                                 FieldProblemMap* problems,
                                 const Callback& validated) const {
+  // The spans of the whole validation share the correlation ID, which the
+  // objects that continue it in callbacks take from the current one.
+  ScopedCorrelationId correlation(NewCorrelationId());
   // The ValidationTask object will delete itself after Run() has finished.
   (new ValidationTask(
        address,
@@ -39,7 +45,37 @@ void AddressValidator::Validate(const AddressData& address,
        require_name,
        filter,
        problems,
-       validated))->Run(supplier_);
+       validated,
+       nullptr))->Run(supplier_);
+}
+
+void AddressValidator::Validate(const AddressData& address,
+                                bool allow_postal,
+                                bool require_name,
+                                const FieldProblemMap* filter,
+                                FieldProblemMap* problems,
+                                const Callback& validated,
+                                const CancellationToken& token) const {
+  ScopedCorrelationId correlation(NewCorrelationId());
+  (new ValidationTask(
+       address,
+       allow_postal,
+       require_name,
+       filter,
+       problems,
+       validated,
+       &token))->Run(supplier_);
+}
+
+// static
+bool AddressValidator::ValidateNow(const PreloadSupplier& supplier,
+                                   const AddressDataView& address,
+                                   bool allow_postal,
+                                   bool require_name,
+                                   const FieldProblemMap* filter,
+                                   FieldProblemMap* problems) {
+  ValidationTask task(address, allow_postal, require_name, filter, problems);
+  return task.RunNow(supplier);
 }
 
 }  // namespace addressinput
@@ -0,0 +1,219 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libaddressinput/async.h>
+
+#include <libaddressinput/address_data.h>
+#include <libaddressinput/address_validator.h>
+#include <libaddressinput/callback.h>
+#include <libaddressinput/future.h>
+#include <libaddressinput/preload_supplier.h>
+#include <libaddressinput/source.h>
+#include <libaddressinput/storage.h>
+#include <libaddressinput/supplier.h>
+
+#include <cassert>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "lookup_key.h"
+
+namespace i18n {
+namespace addressinput {
+
+namespace {
+
+// Each of the states below is allocated by a call and deletes itself when both
+// the call and the future are done with it. The future is taken before the
+// call is started, because the call may finish before Start() returns, and the
+// state must not be accessed after starting the call.
+
+class ValidationState : public FutureState<ValidationResult> {
+ public:
+  ValidationState(const ValidationState&) = delete;
+  ValidationState& operator=(const ValidationState&) = delete;
+
+  ValidationState(const AddressData& address, const FieldProblemMap* filter)
+      : filter_(filter != nullptr ? std::make_optional(*filter)
+                                  : std::nullopt),
+        validated_(this, &ValidationState::Validated) {
+    result()->address = address;
+  }
+
+  Future<ValidationResult> Start(const AddressValidator& validator,
+                                 bool allow_postal,
+                                 bool require_name) {
+    Future<ValidationResult> future = GetFuture();
+    validator.Validate(result()->address, allow_postal, require_name,
+                       filter_ ? &*filter_ : nullptr, &result()->problems,
+                       validated_);
+    return future;
+  }
+
+ private:
+  ~ValidationState() override = default;
+
+  void Validated(bool success,
+                 const AddressData& address,
+                 const FieldProblemMap& problems) {
+    result()->success = success;
+    Complete();
+  }
+
+  const std::optional<FieldProblemMap> filter_;
+  const CallbackImpl<ValidationState, const AddressData&,
+                     const FieldProblemMap&> validated_;
+};
+
+class LoadRulesState : public FutureState<LoadRulesResult> {
+ public:
+  LoadRulesState(const LoadRulesState&) = delete;
+  LoadRulesState& operator=(const LoadRulesState&) = delete;
+
+  LoadRulesState() : loaded_(this, &LoadRulesState::Loaded) {}
+
+  Future<LoadRulesResult> Start(PreloadSupplier* supplier,
+                                const std::string& region_code) {
+    Future<LoadRulesResult> future = GetFuture();
+    // LoadRules() doesn't call back while the rules are being loaded already.
+    if (supplier->IsPending(region_code)) {
+      Loaded(false, region_code, 0);
+      return future;
+    }
+    supplier->LoadRules(region_code, loaded_);
+    return future;
+  }
+
+ private:
+  ~LoadRulesState() override = default;
+
+  void Loaded(bool success, const std::string& region_code, int rule_count) {
+    result()->success = success;
+    result()->region_code = region_code;
+    result()->rule_count = rule_count;
+    Complete();
+  }
+
+  const CallbackImpl<LoadRulesState, const std::string&, int> loaded_;
+};
+
+class SupplyState : public FutureState<SupplyResult> {
+ public:
+  SupplyState(const SupplyState&) = delete;
+  SupplyState& operator=(const SupplyState&) = delete;
+
+  // The lookup key refers to the strings of |address_|, which is copied
+  // because the caller's address may be gone before the rules are supplied.
+  explicit SupplyState(const AddressData& address)
+      : address_(address),
+        lookup_key_(),
+        supplied_(this, &SupplyState::Supplied) {
+    lookup_key_.FromAddress(address_);
+  }
+
+  Future<SupplyResult> Start(Supplier* supplier, bool search_globally) {
+    Future<SupplyResult> future = GetFuture();
+    if (search_globally) {
+      supplier->SupplyGlobally(lookup_key_, supplied_);
+    } else {
+      supplier->Supply(lookup_key_, supplied_);
+    }
+    return future;
+  }
+
+ private:
+  ~SupplyState() override = default;
+
+  void Supplied(bool success,
+                const LookupKey& lookup_key,
+                const Supplier::RuleHierarchy& hierarchy) {
+    result()->success = success;
+    result()->hierarchy = hierarchy;
+    Complete();
+  }
+
+  const AddressData address_;
+  LookupKey lookup_key_;
+  const CallbackImpl<SupplyState, const LookupKey&,
+                     const Supplier::RuleHierarchy&> supplied_;
+};
+
+// Source::Callback and Storage::Callback are the same type.
+class DataState : public FutureState<DataResult> {
+ public:
+  DataState(const DataState&) = delete;
+  DataState& operator=(const DataState&) = delete;
+
+  explicit DataState(const std::string& key)
+      : data_ready_(this, &DataState::DataReady) {
+    result()->key = key;
+  }
+
+  template <typename Getter>
+  Future<DataResult> Start(const Getter& getter) {
+    Future<DataResult> future = GetFuture();
+    getter.Get(result()->key, data_ready_);
+    return future;
+  }
+
+ private:
+  ~DataState() override = default;
+
+  void DataReady(bool success,
+                 const std::string& key,
+                 std::optional<std::string> data) {
+    result()->success = success;
+    result()->data = std::move(data);
+    Complete();
+  }
+
+  const CallbackImpl<DataState, const std::string&,
+                     std::optional<std::string>> data_ready_;
+};
+
+}  // namespace
+
+Future<ValidationResult> ValidateAsync(const AddressValidator& validator,
+                                       const AddressData& address,
+                                       bool allow_postal,
+                                       bool require_name,
+                                       const FieldProblemMap* filter) {
+  return (new ValidationState(address, filter))
+      ->Start(validator, allow_postal, require_name);
+}
+
+Future<LoadRulesResult> LoadRulesAsync(PreloadSupplier* supplier,
+                                       const std::string& region_code) {
+  assert(supplier != nullptr);
+  return (new LoadRulesState)->Start(supplier, region_code);
+}
+
+Future<SupplyResult> SupplyAsync(Supplier* supplier,
+                                 const AddressData& address,
+                                 bool search_globally) {
+  assert(supplier != nullptr);
+  return (new SupplyState(address))->Start(supplier, search_globally);
+}
+
+Future<DataResult> GetAsync(const Source& source, const std::string& key) {
+  return (new DataState(key))->Start(source);
+}
+
+Future<DataResult> GetAsync(const Storage& storage, const std::string& key) {
+  return (new DataState(key))->Start(storage);
+}
+
+}  // namespace addressinput
+}  // namespace i18n
@@ -0,0 +1,40 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libaddressinput/cancellation.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include "cancellation_util.h"
+
+namespace i18n {
+namespace addressinput {
+
+CancellationToken::CancellationToken() : state_(std::make_shared<State>()) {}
+
+CancellationToken::~CancellationToken() = default;
+
+void CancellationToken::Cancel() {
+  std::lock_guard<std::recursive_mutex> lock(state_->mutex);
+  state_->is_cancelled.store(true, std::memory_order_release);
+}
+
+bool CancellationToken::IsCancelled() const {
+  return state_->is_cancelled.load(std::memory_order_acquire);
+}
+
+}  // namespace addressinput
+}  // namespace i18n
@@ -0,0 +1,89 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// The internals of CancellationToken, for the objects that check it. These
+// objects keep a copy of the token of the call, if the call was given one, in
+// an std::optional.
+
+#ifndef I18N_ADDRESSINPUT_CANCELLATION_UTIL_H_
+#define I18N_ADDRESSINPUT_CANCELLATION_UTIL_H_
+
+#include <libaddressinput/cancellation.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+namespace i18n {
+namespace addressinput {
+
+struct CancellationToken::State {
+  // Held by Cancel() and by CancellationLock. Recursive so that Cancel() can be
+  // called from within a callback that is called under a CancellationLock.
+  std::recursive_mutex mutex;
+  std::atomic<bool> is_cancelled{false};
+};
+
+// Returns true if |token| is set and cancelled.
+inline bool IsCancelled(const std::optional<CancellationToken>& token) {
+  return token.has_value() && token->IsCancelled();
+}
+
+// Returns an optional copy of |token|, which may be nullptr.
+inline std::optional<CancellationToken> CopyToken(
+    const CancellationToken* token) {
+  return token != nullptr ? std::make_optional(*token) : std::nullopt;
+}
+
+// Keeps the token of a call from being cancelled while a callback is called,
+// so that Cancel() on another thread returns only after the callback. Keeps its
+// own reference to the state of the token, so that the object that holds the
+// token can delete itself while locked. Sample usage:
+//    CancellationLock lock(token_);
+//    if (!lock.IsCancelled()) {
+//      callback_(success, key, data);
+//    }
+//    delete this;
+class CancellationLock {
+ public:
+  CancellationLock(const CancellationLock&) = delete;
+  CancellationLock& operator=(const CancellationLock&) = delete;
+
+  explicit CancellationLock(const std::optional<CancellationToken>& token)
+      : state_(token.has_value() ? token->state_ : nullptr) {
+    if (state_ != nullptr) {
+      state_->mutex.lock();
+    }
+  }
+
+  ~CancellationLock() {
+    if (state_ != nullptr) {
+      state_->mutex.unlock();
+    }
+  }
+
+  bool IsCancelled() const {
+    return state_ != nullptr &&
+           state_->is_cancelled.load(std::memory_order_relaxed);
+  }
+
+ private:
+  const std::shared_ptr<CancellationToken::State> state_;
+};
+
+}  // namespace addressinput
+}  // namespace i18n
+
+#endif  // I18N_ADDRESSINPUT_CANCELLATION_UTIL_H_
@@ -0,0 +1,295 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "format_program.h"
+
+#include <libaddressinput/address_data_view.h>
+#include <libaddressinput/address_field.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "format_element.h"
+#include "region_data_constants.h"
+#include "rule.h"
+
+namespace i18n {
+namespace addressinput {
+
+namespace {
+
+// Collects the output of FormatProgram::Run() as separate lines.
+class LinesSink {
+ public:
+  LinesSink(const LinesSink&) = delete;
+  LinesSink& operator=(const LinesSink&) = delete;
+
+  // Does not take ownership of |lines|.
+  explicit LinesSink(std::vector<std::string>* lines)
+      : lines_(lines), line_() {
+    assert(lines_ != nullptr);
+  }
+
+  bool line_open() const { return !line_.empty(); }
+
+  void Append(std::string_view text) { line_.append(text); }
+
+  void EndLine() {
+    lines_->push_back(line_);
+    line_.clear();
+  }
+
+ private:
+  std::vector<std::string>* const lines_;
+  std::string line_;
+};
+
+// Appends the output of FormatProgram::Run() to a single string, recording
+// where each line ends.
+class TextLinesSink {
+ public:
+  TextLinesSink(const TextLinesSink&) = delete;
+  TextLinesSink& operator=(const TextLinesSink&) = delete;
+
+  // Does not take ownership of |text| or |line_ends|.
+  TextLinesSink(std::string* text, std::vector<size_t>* line_ends)
+      : text_(text), line_ends_(line_ends), line_begin_(text->size()) {
+    assert(line_ends_ != nullptr);
+  }
+
+  bool line_open() const { return text_->size() > line_begin_; }
+
+  void Append(std::string_view text) { text_->append(text); }
+
+  void EndLine() {
+    line_begin_ = text_->size();
+    line_ends_->push_back(line_begin_);
+  }
+
+ private:
+  std::string* const text_;
+  std::vector<size_t>* const line_ends_;
+  size_t line_begin_;
+};
+
+// Appends the output of FormatProgram::Run() to a single string, with a
+// separator between the lines.
+class JoinedSink {
+ public:
+  JoinedSink(const JoinedSink&) = delete;
+  JoinedSink& operator=(const JoinedSink&) = delete;
+
+  // Does not take ownership of |output|.
+  JoinedSink(const std::string& separator, std::string* output)
+      : separator_(separator), output_(output), line_open_(false),
+        line_count_(0) {
+    assert(output_ != nullptr);
+  }
+
+  bool line_open() const { return line_open_; }
+
+  void Append(std::string_view text) {
+    if (text.empty()) {
+      return;
+    }
+    if (!line_open_) {
+      BeginLine();
+    }
+    output_->append(text);
+  }
+
+  void EndLine() {
+    if (!line_open_) {
+      BeginLine();
+    }
+    line_open_ = false;
+    ++line_count_;
+  }
+
+ private:
+  void BeginLine() {
+    if (line_count_ > 0) {
+      output_->append(separator_);
+    }
+    line_open_ = true;
+  }
+
+  const std::string& separator_;
+  std::string* const output_;
+  bool line_open_;
+  size_t line_count_;
+};
+
+}  // namespace
+
+// static
+const FormatProgram& FormatProgram::Get(const std::string& region_code,
+                                        bool latin_script) {
+  // All unsupported region codes get the default format, so they share one
+  // program and can't make the cache grow without bounds.
+  const auto key = std::make_pair(
+      RegionDataConstants::IsSupported(region_code) ? region_code : "",
+      latin_script);
+  // Lookups vastly outnumber insertions, which only happen the first time that
+  // a format is used, so they only need to share the lock.
+  static std::shared_mutex mutex;
+  static auto* const programs =
+      new std::map<std::pair<std::string, bool>, const FormatProgram*>;
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    auto it = programs->find(key);
+    if (it != programs->end()) {
+      return *it->second;
+    }
+  }
+  std::lock_guard<std::shared_mutex> lock(mutex);
+  auto it = programs->find(key);
+  if (it == programs->end()) {
+    Rule rule;
+    rule.CopyFrom(Rule::GetDefault());
+    // TODO: Eventually, we should get the best rule for this country and
+    // language, rather than just for the country.
+    rule.ParseSerializedRule(RegionDataConstants::GetRegionData(region_code));
+
+    // If Latin-script rules are available and Latin script is requested, then
+    // use the Latin-script formatting rules.
+    const std::vector<FormatElement>& format =
+        latin_script && !rule.GetLatinFormat().empty() ? rule.GetLatinFormat()
+                                                       : rule.GetFormat();
+    it = programs->emplace(key, new FormatProgram(format)).first;
+  }
+  return *it->second;
+}
+
+template <typename Sink>
+void FormatProgram::Run(const AddressDataView& address, Sink* sink) const {
+  assert(sink != nullptr);
+  // Whether the last element that was kept is a field, which is what decides
+  // whether a literal following a removed field is kept.
+  bool last_kept_is_field = false;
+  for (auto element_it = format_.begin(); element_it != format_.end();
+       ++element_it) {
+    if (element_it->IsNewline()) {
+      // Always keep the newlines.
+      last_kept_is_field = false;
+      if (sink->line_open()) {
+        sink->EndLine();
+      }
+    } else if (element_it->IsField()) {
+      // Always keep the non-empty address fields.
+      AddressField field = element_it->GetField();
+      if (address.IsFieldEmpty(field)) {
+        continue;
+      }
+      last_kept_is_field = true;
+      if (field == STREET_ADDRESS) {
+        // The field "street address" represents the street address lines of an
+        // address, so there can be multiple values.
+        const AddressLinesView& address_line = address.address_line;
+        sink->Append(address_line.front());
+        if (address_line.size() > 1U) {
+          sink->EndLine();
+          for (size_t i = 1; i < address_line.size() - 1; ++i) {
+            sink->Append(address_line[i]);
+            sink->EndLine();
+          }
+          sink->Append(address_line.back());
+        }
+      } else {
+        sink->Append(address.GetFieldValue(field));
+      }
+    } else if (
+        // Only keep literals that satisfy these 2 conditions:
+        // (1) Not preceding an empty field.
+        (element_it + 1 == format_.end() || !(element_it + 1)->IsField() ||
+         !address.IsFieldEmpty((element_it + 1)->GetField())) &&
+        // (2) Not following a removed field.
+        (element_it == format_.begin() || !(element_it - 1)->IsField() ||
+         last_kept_is_field)) {
+      last_kept_is_field = false;
+      sink->Append(element_it->GetLiteral());
+    }
+  }
+  if (sink->line_open()) {
+    sink->EndLine();
+  }
+}
+
+void FormatProgram::AppendLines(const AddressDataView& address,
+                                std::vector<std::string>* lines) const {
+  LinesSink sink(lines);
+  Run(address, &sink);
+}
+
+void FormatProgram::AppendLines(const AddressDataView& address,
+                                std::string* text,
+                                std::vector<size_t>* line_ends) const {
+  assert(text != nullptr);
+  text->reserve(text->size() + EstimateSize(address, 0));
+  TextLinesSink sink(text, line_ends);
+  Run(address, &sink);
+}
+
+void FormatProgram::AppendJoined(const AddressDataView& address,
+                                 const std::string& separator,
+                                 std::string* output) const {
+  assert(output != nullptr);
+  output->reserve(output->size() + EstimateSize(address, separator.size()));
+  JoinedSink sink(separator, output);
+  Run(address, &sink);
+}
+
+size_t FormatProgram::EstimateSize(const AddressDataView& address,
+                                   size_t separator_size) const {
+  size_t size = literal_size_;
+  size_t line_count = newline_count_ + 1;
+  for (AddressField field : fields_) {
+    if (field == STREET_ADDRESS) {
+      for (size_t i = 0; i < address.address_line.size(); ++i) {
+        size += address.address_line[i].size();
+      }
+      line_count += address.address_line.size();
+    } else {
+      size += address.GetFieldValue(field).size();
+    }
+  }
+  return size + separator_size * line_count;
+}
+
+FormatProgram::FormatProgram(const std::vector<FormatElement>& format)
+    : format_(format), fields_(), literal_size_(0), newline_count_(0) {
+  for (const auto& element : format_) {
+    if (element.IsNewline()) {
+      ++newline_count_;
+    } else if (element.IsField()) {
+      if (std::find(fields_.begin(), fields_.end(), element.GetField()) ==
+          fields_.end()) {
+        fields_.push_back(element.GetField());
+      }
+    } else {
+      literal_size_ += element.GetLiteral().size();
+    }
+  }
+}
+
+}  // namespace addressinput
+}  // namespace i18n
@@ -0,0 +1,95 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// The address format of a region, compiled once for formatting any number of
+// addresses.
+
+#ifndef I18N_ADDRESSINPUT_FORMAT_PROGRAM_H_
+#define I18N_ADDRESSINPUT_FORMAT_PROGRAM_H_
+
+#include <libaddressinput/address_data_view.h>
+#include <libaddressinput/address_field.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "format_element.h"
+
+namespace i18n {
+namespace addressinput {
+
+// Formats addresses in national format, without the country, in a single pass
+// over the format elements of a region. Sample usage:
+//    const FormatProgram& program = FormatProgram::Get("CH", false);
+//    std::string text;
+//    program.AppendJoined(address, ", ", &text);
+//
+// The format is pruned of the elements that aren't needed for an address (based
+// on which address fields are empty) while it's being executed: all literal
+// strings that are not at the start or end of a line are assumed to be
+// separators, and therefore only relevant if the surrounding fields are filled
+// in.
+class FormatProgram {
+ public:
+  FormatProgram(const FormatProgram&) = delete;
+  FormatProgram& operator=(const FormatProgram&) = delete;
+
+  // Returns the program for the format of |region_code|, or its Latin-script
+  // format if |latin_script| is true and there is one. Programs are compiled
+  // on first use and cached for the lifetime of the process. This is safe to
+  // call concurrently from multiple threads.
+  static const FormatProgram& Get(const std::string& region_code,
+                                  bool latin_script);
+
+  // Appends the formatted lines of |address| to |lines|.
+  void AppendLines(const AddressDataView& address,
+                   std::vector<std::string>* lines) const;
+
+  // Appends the formatted lines of |address| to |text|, without anything
+  // between them, and the end offset of each line in |text| to |line_ends|.
+  void AppendLines(const AddressDataView& address, std::string* text,
+                   std::vector<size_t>* line_ends) const;
+
+  // Appends the formatted lines of |address| to |output|, with |separator|
+  // between them. Reserves space for the result first, so that |output| is
+  // reallocated at most once.
+  void AppendJoined(const AddressDataView& address,
+                    const std::string& separator, std::string* output) const;
+
+  // Returns an upper bound of the size of the output of AppendJoined() with a
+  // separator of |separator_size| bytes.
+  size_t EstimateSize(const AddressDataView& address,
+                      size_t separator_size) const;
+
+  const std::vector<FormatElement>& GetFormat() const { return format_; }
+
+ private:
+  explicit FormatProgram(const std::vector<FormatElement>& format);
+
+  template <typename Sink>
+  void Run(const AddressDataView& address, Sink* sink) const;
+
+  const std::vector<FormatElement> format_;
+  // The distinct fields of |format_|.
+  std::vector<AddressField> fields_;
+  // The total size of all literals, and the number of newlines, in |format_|.
+  size_t literal_size_;
+  size_t newline_count_;
+};
+
+}  // namespace addressinput
+}  // namespace i18n
+
+#endif  // I18N_ADDRESSINPUT_FORMAT_PROGRAM_H_
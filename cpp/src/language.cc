@@ -16,7 +16,13 @@
 
 #include <algorithm>
 #include <cctype>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "rule.h"
@@ -25,9 +31,69 @@
 namespace i18n {
 namespace addressinput {
 
-Language::Language(const std::string& language_tag) : tag(language_tag),
-                                                      base(),
-                                                      has_latin_script(false) {
+namespace {
+
+const char kLanguagesThatUseSpace[][3] = {
+    "th",
+    "ko",
+};
+
+const char kLanguagesThatHaveNoSeparator[][3] = {
+    "ja",
+    "zh",  // All Chinese variants.
+};
+
+// This data is based on CLDR, cross-checked with data provided by Chrome
+// linguists, for languages that are in official use in some country, where
+// Arabic is the most likely script tag.
+// TODO: Consider supporting variants such as tr-Arab by detecting the script
+// code.
+const char kLanguagesThatUseAnArabicComma[][3] = {
+    "ar",
+    "fa",
+    "ku",
+    "ps",
+    "ur",
+};
+
+template <size_t N>
+bool Contains(const char (&languages)[N][3], const std::string& base) {
+  return std::find(languages, languages + N, base) != languages + N;
+}
+
+LineSeparator GetLineSeparator(const std::string& base,
+                               bool has_latin_script) {
+  // First deal with explicit script tags.
+  if (has_latin_script) {
+    return COMMA_SEPARATOR;
+  }
+
+  // Now guess something appropriate based on the base language.
+  if (Contains(kLanguagesThatUseSpace, base)) {
+    return SPACE_SEPARATOR;
+  } else if (Contains(kLanguagesThatHaveNoSeparator, base)) {
+    return NO_SEPARATOR;
+  } else if (Contains(kLanguagesThatUseAnArabicComma, base)) {
+    return ARABIC_COMMA_SEPARATOR;
+  }
+  // Either the language is a Latin-script language, or no language was
+  // specified. In the latter case we still return ", " as the most common
+  // separator in use. In countries that don't use this, e.g. Thailand,
+  // addresses are often written in Latin script where this would still be
+  // appropriate, so this is a reasonable default in the absence of information.
+  return COMMA_SEPARATOR;
+}
+
+}  // namespace
+
+// static
+const size_t Language::kMaxInternedTags = 1024;
+
+Language::Language(const std::string& language_tag)
+    : tag(language_tag),
+      base(),
+      has_latin_script(false),
+      line_separator(COMMA_SEPARATOR) {
   // Character '-' is the separator for subtags in the BCP 47. However, some
   // legacy code generates tags with '_' instead of '-'.
   static const char kSubtagsSeparator = '-';
@@ -51,23 +117,54 @@ Language::Language(const std::string& language_tag) : tag(language_tag),
   has_latin_script =
       (subtags.size() > 1 && subtags[1] == kLowercaseLatinScript) ||
       (subtags.size() > 2 && subtags[2] == kLowercaseLatinScript);
+
+  line_separator = GetLineSeparator(base, has_latin_script);
 }
 
 Language::~Language() = default;
 
-Language ChooseBestAddressLanguage(const Rule& address_region_rule,
-                                   const Language& ui_language) {
-  if (address_region_rule.GetLanguages().empty()) {
-    return ui_language;
+// static
+std::shared_ptr<const Language> Language::Get(std::string_view language_tag) {
+  // Lookups vastly outnumber insertions, which only happen the first time that
+  // a tag is seen, so they only need to share the lock. The interned objects
+  // are leaked on shutdown, so the results that point to them don't need to
+  // own them, which spares them the reference counting.
+  static std::shared_mutex mutex;
+  static auto* const languages =
+      new std::map<std::string, const Language*, std::less<>>;
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    auto it = languages->find(language_tag);
+    if (it != languages->end()) {
+      return std::shared_ptr<const Language>(std::shared_ptr<const Language>(),
+                                             it->second);
+    }
   }
+  const std::string tag(language_tag);
+  std::lock_guard<std::shared_mutex> lock(mutex);
+  auto it = languages->find(language_tag);
+  if (it == languages->end()) {
+    if (languages->size() >= kMaxInternedTags) {
+      return std::make_shared<const Language>(tag);
+    }
+    it = languages->emplace(tag, new Language(tag)).first;
+  }
+  return std::shared_ptr<const Language>(std::shared_ptr<const Language>(),
+                                         it->second);
+}
 
-  std::vector<Language> available_languages;
-  for (const auto& language_tag : address_region_rule.GetLanguages()) {
-    available_languages.emplace_back(language_tag);
+std::shared_ptr<const Language> ChooseBestAddressLanguage(
+    const Rule& address_region_rule, const Language& ui_language) {
+  const std::vector<std::string>& language_tags =
+      address_region_rule.GetLanguages();
+  if (language_tags.empty()) {
+    return Language::Get(ui_language.tag);
   }
 
+  std::shared_ptr<const Language> default_language =
+      Language::Get(language_tags.front());
   if (ui_language.tag.empty()) {
-    return available_languages.front();
+    return default_language;
   }
 
   bool has_latin_format = !address_region_rule.GetLatinFormat().empty();
@@ -75,22 +172,23 @@ Language ChooseBestAddressLanguage(const Rule& address_region_rule,
   // The conventionally formatted BCP 47 Latin script with a preceding subtag
   // separator.
   static const char kLatinScriptSuffix[] = "-Latn";
-  Language latin_script_language(
-      available_languages.front().base + kLatinScriptSuffix);
   if (has_latin_format && ui_language.has_latin_script) {
-    return latin_script_language;
+    return Language::Get(default_language->base + kLatinScriptSuffix);
   }
 
-  for (const auto& language : available_languages) {
+  for (const auto& language_tag : language_tags) {
+    std::shared_ptr<const Language> language = Language::Get(language_tag);
     // Base language comparison works because no region supports the same base
     // language with different scripts, for now. For example, no region supports
     // "zh-Hant" and "zh-Hans" at the same time.
-    if (ui_language.base == language.base) {
+    if (ui_language.base == language->base) {
       return language;
     }
   }
 
-  return has_latin_format ? latin_script_language : available_languages.front();
+  return has_latin_format
+             ? Language::Get(default_language->base + kLatinScriptSuffix)
+             : default_language;
 }
 
 }  // namespace addressinput
@@ -15,19 +15,42 @@
 #ifndef I18N_ADDRESSINPUT_LANGUAGE_H_
 #define I18N_ADDRESSINPUT_LANGUAGE_H_
 
+#include <cstddef>
+#include <memory>
 #include <string>
+#include <string_view>
 
 namespace i18n {
 namespace addressinput {
 
 class Rule;
 
+// The separator to use between the lines of an address that is written on a
+// single line, for example "1098 Alta Ave, Mountain View, CA 94043".
+enum LineSeparator {
+  COMMA_SEPARATOR,         // ", "
+  ARABIC_COMMA_SEPARATOR,  // "، "
+  SPACE_SEPARATOR,         // " "
+  NO_SEPARATOR             // ""
+};
+
 // Helper for working with a BCP 47 language tag.
 // http://tools.ietf.org/html/bcp47
 struct Language {
   explicit Language(const std::string& language_tag);
   ~Language();
 
+  // Returns the parsed |language_tag|. The first kMaxInternedTags distinct tags
+  // are parsed only once and then kept for the lifetime of the process. Any
+  // other tag, which could come from untrusted input, is parsed again on every
+  // call, into an object that only the result owns. This is safe to call
+  // concurrently from multiple threads.
+  static std::shared_ptr<const Language> Get(std::string_view language_tag);
+
+  // The number of distinct tags that Get() keeps, which is several times the
+  // number of languages in the region data.
+  static const size_t kMaxInternedTags;
+
   // The language tag (with '_' replaced with '-'), for example "zh-Latn-CN".
   std::string tag;
 
@@ -38,10 +61,15 @@ struct Language {
   // is true for "zh-Latn", but false for "zh". Only the second and third subtag
   // positions are supported for script.
   bool has_latin_script;
+
+  // The separator between address lines written in this language.
+  LineSeparator line_separator;
 };
 
-Language ChooseBestAddressLanguage(const Rule& address_region_rule,
-                                   const Language& ui_language);
+// Returns the language that an address in the region of |address_region_rule|
+// is best displayed in for a user of |ui_language|, see Language::Get().
+std::shared_ptr<const Language> ChooseBestAddressLanguage(
+    const Rule& address_region_rule, const Language& ui_language);
 
 }  // namespace addressinput
 }  // namespace i18n
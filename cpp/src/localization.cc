@@ -17,9 +17,12 @@
 #include <libaddressinput/address_data.h>
 #include <libaddressinput/address_field.h>
 #include <libaddressinput/address_problem.h>
+#include <libaddressinput/message_catalog.h>
 
 #include <cassert>
 #include <cstddef>
+#include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -52,11 +55,63 @@ std::string GetEnglishString(int message_id) {
   return str != nullptr ? std::string(str) : std::string();
 }
 
+// The parts of the rule of a region that postal code error messages use.
+struct PostalCodeInfo {
+  // False if the rule of the region could not be parsed, in which case the
+  // other fields come from the default rule.
+  bool valid;
+  std::string example;
+  std::string post_service_url;
+  bool uses_postal_code_as_label;
+};
+
+// Returns the postal code info for |region_code|. The rule of each region is
+// parsed only once, and the result is kept for the lifetime of the process.
+const PostalCodeInfo& GetPostalCodeInfo(const std::string& region_code) {
+  // All unsupported region codes fail to parse in the same way, so they share
+  // one entry and can't make the cache grow without bounds.
+  const std::string key =
+      RegionDataConstants::IsSupported(region_code) ? region_code : "";
+  static std::mutex mutex;
+  static auto* const infos = new std::map<std::string, PostalCodeInfo>;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = infos->find(key);
+  if (it == infos->end()) {
+    Rule rule;
+    rule.CopyFrom(Rule::GetDefault());
+    PostalCodeInfo info;
+    info.valid =
+        rule.ParseSerializedRule(RegionDataConstants::GetRegionData(key));
+    if (info.valid) {
+      std::vector<std::string> examples_list;
+      SplitString(rule.GetPostalCodeExample(), ',', &examples_list);
+      if (!examples_list.empty()) {
+        info.example = examples_list.front();
+      }
+      info.post_service_url = rule.GetPostServiceUrl();
+    }
+    // If we can't parse the serialized rule |uses_postal_code_as_label| will be
+    // determined from the default rule.
+    info.uses_postal_code_as_label =
+        rule.GetPostalCodeNameMessageId() ==
+        IDS_LIBADDRESSINPUT_POSTAL_CODE_LABEL;
+    it = infos->emplace(key, info).first;
+  }
+  return it->second;
+}
+
 }  // namespace
 
-Localization::Localization() : get_string_(&GetEnglishString) {}
+Localization::Localization()
+    : get_string_(&GetEnglishString),
+      catalog_(nullptr),
+      catalog_locale_(0),
+      generation_(0) {}
 
 std::string Localization::GetString(int message_id) const {
+  if (catalog_ != nullptr) {
+    return std::string(catalog_->GetString(catalog_locale_, message_id));
+  }
   return get_string_(message_id);
 }
 
@@ -66,34 +121,16 @@ std::string Localization::GetErrorMessage(const AddressData& address,
                                           bool enable_examples,
                                           bool enable_links) const {
   if (field == POSTAL_CODE) {
-    Rule rule;
-    rule.CopyFrom(Rule::GetDefault());
-    std::string postal_code_example, post_service_url;
-    if (rule.ParseSerializedRule(
-            RegionDataConstants::GetRegionData(address.region_code))) {
-      if (enable_examples) {
-        std::vector<std::string> examples_list;
-        SplitString(rule.GetPostalCodeExample(), ',', &examples_list);
-        if (!examples_list.empty()) {
-          postal_code_example = examples_list.front();
-        }
-      }
-      if (enable_links) {
-        post_service_url = rule.GetPostServiceUrl();
-      }
-    } else {
-      assert(false);
-    }
-    // If we can't parse the serialized rule |uses_postal_code_as_label| will be
-    // determined from the default rule.
-    bool uses_postal_code_as_label =
-        rule.GetPostalCodeNameMessageId() ==
-        IDS_LIBADDRESSINPUT_POSTAL_CODE_LABEL;
-    return GetErrorMessageForPostalCode(problem, uses_postal_code_as_label,
-                                        postal_code_example, post_service_url);
+    const PostalCodeInfo& info = GetPostalCodeInfo(address.region_code);
+    assert(info.valid);
+    static const std::string kEmptyString;
+    return GetErrorMessageForPostalCode(
+        problem, info.uses_postal_code_as_label,
+        enable_examples ? info.example : kEmptyString,
+        enable_links ? info.post_service_url : kEmptyString);
   } else {
     if (problem == MISSING_REQUIRED_FIELD) {
-      return get_string_(IDS_LIBADDRESSINPUT_MISSING_REQUIRED_FIELD);
+      return GetString(IDS_LIBADDRESSINPUT_MISSING_REQUIRED_FIELD);
     } else if (problem == UNKNOWN_VALUE) {
       std::vector<std::string> parameters;
       if (AddressData::IsRepeatedFieldValue(field)) {
@@ -103,10 +140,9 @@ std::string Localization::GetErrorMessage(const AddressData& address,
       } else {
         parameters.push_back(address.GetFieldValue(field));
       }
-      return DoReplaceStringPlaceholders(
-          get_string_(IDS_LIBADDRESSINPUT_UNKNOWN_VALUE), parameters);
+      return FormatMessage(IDS_LIBADDRESSINPUT_UNKNOWN_VALUE, parameters);
     } else if (problem == USES_P_O_BOX) {
-      return get_string_(IDS_LIBADDRESSINPUT_PO_BOX_FORBIDDEN_VALUE);
+      return GetString(IDS_LIBADDRESSINPUT_PO_BOX_FORBIDDEN_VALUE);
     } else {
       // Keep the default under "else" so the compiler helps us check that all
       // handled cases return and don't fall through.
@@ -119,6 +155,21 @@ std::string Localization::GetErrorMessage(const AddressData& address,
 void Localization::SetGetter(std::string (*getter)(int)) {
   assert(getter != nullptr);
   get_string_ = getter;
+  catalog_ = nullptr;
+  ++generation_;
+}
+
+bool Localization::SetCatalog(const MessageCatalog* catalog,
+                              const std::string& language_tag) {
+  assert(catalog != nullptr);
+  size_t locale = catalog->FindLocale(language_tag);
+  if (locale == MessageCatalog::kNoLocale) {
+    return false;
+  }
+  catalog_ = catalog;
+  catalog_locale_ = locale;
+  ++generation_;
+  return true;
 }
 
 std::string Localization::GetErrorMessageForPostalCode(
@@ -143,7 +194,7 @@ std::string Localization::GetErrorMessageForPostalCode(
     } else {
       message_id = IDS_LIBADDRESSINPUT_MISSING_REQUIRED_FIELD;
     }
-    return DoReplaceStringPlaceholders(get_string_(message_id), parameters);
+    return FormatMessage(message_id, parameters);
   } else if (problem == INVALID_FORMAT) {
     if (!postal_code_example.empty() && !post_service_url.empty()) {
       message_id = uses_postal_code_as_label ?
@@ -161,7 +212,7 @@ std::string Localization::GetErrorMessageForPostalCode(
           IDS_LIBADDRESSINPUT_UNRECOGNIZED_FORMAT_POSTAL_CODE :
           IDS_LIBADDRESSINPUT_UNRECOGNIZED_FORMAT_ZIP;
     }
-    return DoReplaceStringPlaceholders(get_string_(message_id), parameters);
+    return FormatMessage(message_id, parameters);
   } else if (problem == MISMATCHING_VALUE) {
     if (!post_service_url.empty()) {
       message_id = uses_postal_code_as_label ?
@@ -173,7 +224,7 @@ std::string Localization::GetErrorMessageForPostalCode(
           IDS_LIBADDRESSINPUT_MISMATCHING_VALUE_POSTAL_CODE :
           IDS_LIBADDRESSINPUT_MISMATCHING_VALUE_ZIP;
     }
-    return DoReplaceStringPlaceholders(get_string_(message_id), parameters);
+    return FormatMessage(message_id, parameters);
   } else {
     // Keep the default under "else" so the compiler helps us check that all
     // handled cases return and don't fall through.
@@ -182,5 +233,16 @@ std::string Localization::GetErrorMessageForPostalCode(
   }
 }
 
+std::string Localization::FormatMessage(
+    int message_id,
+    const std::vector<std::string>& parameters) const {
+  if (catalog_ != nullptr) {
+    std::string message;
+    catalog_->AppendMessage(catalog_locale_, message_id, parameters, &message);
+    return message;
+  }
+  return DoReplaceStringPlaceholders(get_string_(message_id), parameters);
+}
+
 }  // namespace addressinput
 }  // namespace i18n
@@ -14,14 +14,18 @@
 
 #include "lookup_key.h"
 
-#include <libaddressinput/address_data.h>
+#include <libaddressinput/address_data_view.h>
 #include <libaddressinput/address_field.h>
 
 #include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <functional>
+#include <map>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include "language.h"
 #include "region_data_constants.h"
@@ -39,21 +43,40 @@ const char kDashDelim[] = "--";
 const char kData[] = "data";
 const char kUnknown[] = "ZZ";
 
+// Maps region codes to the languages of the region, for the regions that have
+// any sub-region data at all.
+using RegionLanguageMap =
+    std::map<std::string, std::vector<std::string>, std::less<>>;
+
+RegionLanguageMap InitRegionLanguages() {
+  RegionLanguageMap region_languages;
+  for (const auto& region_code : RegionDataConstants::GetRegionCodes()) {
+    if (RegionDataConstants::GetMaxLookupKeyDepth(region_code) == 0) {
+      continue;
+    }
+    // No need to copy from default rule first, because only languages are
+    // going to be used, which do not exist in the default rule.
+    Rule rule;
+    if (rule.ParseSerializedRule(
+            RegionDataConstants::GetRegionData(region_code))) {
+      region_languages.emplace(region_code, rule.GetLanguages());
+    }
+  }
+  return region_languages;
+}
+
+// Returns the languages of |region_code|, or nullptr if there is no sub-region
+// data for |region_code|. The rules are parsed only once per process.
+const std::vector<std::string>* GetRegionLanguages(
+    std::string_view region_code) {
+  static const RegionLanguageMap kRegionLanguages(InitRegionLanguages());
+  auto it = kRegionLanguages.find(region_code);
+  return it != kRegionLanguages.end() ? &it->second : nullptr;
+}
+
 // Assume the language_tag has had "Latn" script removed when this is called.
 bool ShouldSetLanguageForKey(const std::string& language_tag,
-                             const std::string& region_code) {
-  // We only need a language in the key if there is subregion data at all.
-  if (RegionDataConstants::GetMaxLookupKeyDepth(region_code) == 0) {
-    return false;
-  }
-  Rule rule;
-  rule.CopyFrom(Rule::GetDefault());
-  // TODO: Pre-parse the rules and have a map from region code to rule.
-  if (!rule.ParseSerializedRule(
-          RegionDataConstants::GetRegionData(region_code))) {
-    return false;
-  }
-  const auto& languages = rule.GetLanguages();
+                             const std::vector<std::string>& languages) {
   // Do not add the default language (we want "data/US", not "data/US--en").
   // (empty should not happen here because we have some sub-region data).
   if (languages.empty() || languages[0] == language_tag) {
@@ -75,80 +98,133 @@ const AddressField LookupKey::kHierarchy[] = {
     DEPENDENT_LOCALITY,
 };
 
-LookupKey::LookupKey() = default;
+LookupKey::LookupKey()
+    : region_code_(),
+      nodes_(),
+      node_count_(0),
+      language_(),
+      key_(),
+      key_begin_(),
+      key_size_() {}
+
 LookupKey::~LookupKey() = default;
 
-void LookupKey::FromAddress(const AddressData& address) {
-  nodes_.clear();
+void LookupKey::FromAddress(const AddressDataView& address) {
+  node_count_ = 0;
+  language_.clear();
   if (address.region_code.empty()) {
-    nodes_.emplace(COUNTRY, kUnknown);
+    region_code_ = kUnknown;
+    nodes_[node_count_++] = region_code_;
   } else {
     for (AddressField field : kHierarchy) {
       if (address.IsFieldEmpty(field)) {
         // It would be impossible to find any data for an empty field value.
         break;
       }
-      const std::string& value = address.GetFieldValue(field);
-      if (value.find('/') != std::string::npos) {
+      std::string_view value = address.GetFieldValue(field);
+      if (value.find('/') != std::string_view::npos) {
         // The address metadata server does not have data for any fields with a
         // slash in their value. The slash is used as a syntax character in the
         // lookup key format.
         break;
       }
-      nodes_.emplace(field, value);
+      if (field == COUNTRY) {
+        region_code_ = value;
+        nodes_[node_count_++] = region_code_;
+      } else {
+        nodes_[node_count_++] = value;
+      }
     }
   }
-  Language address_language(address.language_code);
-  std::string language_tag_no_latn = address_language.has_latin_script
-                                         ? address_language.base
-                                         : address_language.tag;
-  if (ShouldSetLanguageForKey(language_tag_no_latn, address.region_code)) {
-    language_ = language_tag_no_latn;
+  // We only need a language in the key if there is sub-region data at all.
+  const std::vector<std::string>* languages =
+      GetRegionLanguages(address.region_code);
+  if (languages != nullptr && !address.language_code.empty()) {
+    std::shared_ptr<const Language> address_language =
+        Language::Get(address.language_code);
+    const std::string& language_tag_no_latn =
+        address_language->has_latin_script ? address_language->base
+                                           : address_language->tag;
+    if (ShouldSetLanguageForKey(language_tag_no_latn, *languages)) {
+      language_ = language_tag_no_latn;
+    }
   }
+  BuildKeyStrings();
 }
 
 void LookupKey::FromLookupKey(const LookupKey& parent,
                               const std::string& child_node) {
-  assert(parent.nodes_.size() < size(kHierarchy));
+  assert(parent.node_count_ > 0);
+  assert(parent.node_count_ < size(kHierarchy));
   assert(!child_node.empty());
 
   // Copy its nodes if this isn't the parent object.
-  if (this != &parent) nodes_ = parent.nodes_;
-  AddressField child_field = kHierarchy[nodes_.size()];
-  nodes_.emplace(child_field, child_node);
+  if (this != &parent) {
+    region_code_ = parent.region_code_;
+    nodes_[0] = region_code_;
+    std::copy(parent.nodes_ + 1, parent.nodes_ + parent.node_count_,
+              nodes_ + 1);
+    node_count_ = parent.node_count_;
+  }
+  nodes_[node_count_++] = child_node;
+  BuildKeyStrings();
 }
 
-std::string LookupKey::ToKeyString(size_t max_depth) const {
+std::string_view LookupKey::ToKeyString(size_t max_depth) const {
   assert(max_depth < size(kHierarchy));
-  std::string key_string(kData);
-
-  for (size_t i = 0; i <= max_depth; ++i) {
-    AddressField field = kHierarchy[i];
-    auto it = nodes_.find(field);
-    if (it == nodes_.end()) {
-      break;
-    }
-    key_string.append(kSlashDelim);
-    key_string.append(it->second);
-  }
-  if (!language_.empty()) {
-    key_string.append(kDashDelim);
-    key_string.append(language_);
-  }
-  return key_string;
+  size_t count = std::min(max_depth + 1, node_count_);
+  return std::string_view(key_).substr(key_begin_[count], key_size_[count]);
 }
 
 const std::string& LookupKey::GetRegionCode() const {
-  auto it = nodes_.find(COUNTRY);
-  assert(it != nodes_.end());
-  return it->second;
+  assert(node_count_ > 0);
+  return region_code_;
 }
 
 size_t LookupKey::GetDepth() const {
-  size_t depth = nodes_.size() - 1;
+  size_t depth = node_count_ - 1;
   assert(depth < size(kHierarchy));
   return depth;
 }
 
+std::string_view LookupKey::GetNode(size_t depth) const {
+  assert(depth < node_count_);
+  return nodes_[depth];
+}
+
+void LookupKey::set_language(const std::string& language) {
+  language_ = language;
+  BuildKeyStrings();
+}
+
+void LookupKey::BuildKeyStrings() {
+  key_.assign(kData);
+  key_begin_[0] = 0;
+  key_size_[0] = key_.size();
+  for (size_t i = 0; i < node_count_; ++i) {
+    key_.append(kSlashDelim);
+    key_.append(nodes_[i].data(), nodes_[i].size());
+    key_begin_[i + 1] = 0;
+    key_size_[i + 1] = key_.size();
+  }
+  if (!language_.empty()) {
+    const size_t suffix_size = sizeof kDashDelim - 1 + language_.size();
+    size_t total_size = key_.size();
+    for (size_t i = 0; i <= node_count_; ++i) {
+      total_size += key_size_[i] + suffix_size;
+    }
+    key_.reserve(total_size);
+    for (size_t i = 0; i <= node_count_; ++i) {
+      size_t begin = key_.size();
+      // No reallocation can happen here, so key_.data() remains valid.
+      key_.append(key_.data(), key_size_[i]);
+      key_.append(kDashDelim);
+      key_.append(language_);
+      key_begin_[i] = begin;
+      key_size_[i] = key_.size() - begin;
+    }
+  }
+}
+
 }  // namespace addressinput
 }  // namespace i18n
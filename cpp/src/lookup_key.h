@@ -15,21 +15,27 @@
 #ifndef I18N_ADDRESSINPUT_LOOKUP_KEY_H_
 #define I18N_ADDRESSINPUT_LOOKUP_KEY_H_
 
+#include <libaddressinput/address_data_view.h>
 #include <libaddressinput/address_field.h>
 
 #include <cstddef>
-#include <map>
 #include <string>
+#include <string_view>
 
 #include "util/size.h"
 
 namespace i18n {
 namespace addressinput {
 
-struct AddressData;
-
 // A LookupKey maps between an AddressData struct and the key string used to
 // request address data from an address data server.
+//
+// A LookupKey doesn't copy the field values it's built from, but refers to the
+// strings that the AddressData object or AddressDataView (or the |child_node|
+// strings) passed to it refers to, which therefore must be kept available for
+// as long as the LookupKey is used.
+// The key strings for all depths are built once, into a single buffer that is
+// reused when the object is re-initialized.
 class LookupKey {
  public:
   // The array length is explicitly specified here, to make it possible to get
@@ -43,7 +49,7 @@ class LookupKey {
   ~LookupKey();
 
   // Initializes this object by parsing |address|.
-  void FromAddress(const AddressData& address);
+  void FromAddress(const AddressDataView& address);
 
   // Initializes this object to be a copy of |parent| key that's one level
   // deeper with the next level node being |child_node|.
@@ -55,8 +61,9 @@ class LookupKey {
   // empty.
   void FromLookupKey(const LookupKey& parent, const std::string& child_node);
 
-  // Returns the lookup key string (of |max_depth|).
-  std::string ToKeyString(size_t max_depth) const;
+  // Returns the lookup key string (of |max_depth|). The result refers to a
+  // buffer owned by this object and is valid until this object is modified.
+  std::string_view ToKeyString(size_t max_depth) const;
 
   // Returns the region code. Must not be called on an empty object.
   const std::string& GetRegionCode() const;
@@ -64,13 +71,33 @@ class LookupKey {
   // Returns the depth. Must not be called on an empty object.
   size_t GetDepth() const;
 
-  void set_language(const std::string& language) { language_ = language; }
+  // Returns the node value at |depth|, which must not be greater than the
+  // depth of this object. The node at depth 0 is the region code.
+  std::string_view GetNode(size_t depth) const;
+
+  // Returns the language of the key, which is empty for the default language.
+  const std::string& GetLanguage() const { return language_; }
+
+  void set_language(const std::string& language);
 
  private:
-  std::map<AddressField, std::string> nodes_;
+  // Rebuilds |key_| (and the offsets into it) from |nodes_| and |language_|.
+  void BuildKeyStrings();
+
+  // The region code is copied, as it's always short enough to not require any
+  // memory allocation, so that GetRegionCode() can return a reference.
+  std::string region_code_;
+  std::string_view nodes_[4];  // Cf. kHierarchy.
+  size_t node_count_;
   // The language of the key, obtained from the address (empty for default
   // language).
   std::string language_;
+  // The key strings of all depths. Without a language, the shorter key strings
+  // are prefixes of the longest one. With a language, which must be appended
+  // after the last node, each depth has its own copy of the key string.
+  std::string key_;
+  size_t key_begin_[5];  // Indexed by number of nodes.
+  size_t key_size_[5];   // Indexed by number of nodes.
 };
 
 }  // namespace addressinput
@@ -0,0 +1,37 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libaddressinput/memory_usage.h>
+
+#include <cstddef>
+
+namespace i18n {
+namespace addressinput {
+
+size_t MemoryUsage::GetTotal() const {
+  return rules + postal_code_matchers + rule_index + region_rules +
+         region_data;
+}
+
+MemoryUsage& MemoryUsage::operator+=(const MemoryUsage& other) {
+  rules += other.rules;
+  postal_code_matchers += other.postal_code_matchers;
+  rule_index += other.rule_index;
+  region_rules += other.region_rules;
+  region_data += other.region_data;
+  return *this;
+}
+
+}  // namespace addressinput
+}  // namespace i18n
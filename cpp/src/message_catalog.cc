@@ -0,0 +1,299 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// The compiled format of a catalog, with all integers as unsigned 32-bit
+// little-endian numbers and all offsets from the start of the data:
+//
+//    "AIMC"
+//    The number of locales.
+//    For each locale, sorted by language tag:
+//      The offset and size of the language tag, and the number of messages.
+//    For each locale, for each message sorted by identifier:
+//      The message identifier, and the offset and size of its text.
+//    The language tags and the message texts.
+
+#include <libaddressinput/message_catalog.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace i18n {
+namespace addressinput {
+
+namespace {
+
+const char kMagic[] = "AIMC";
+const size_t kMagicSize = sizeof kMagic - 1;
+
+void AppendUint32(uint32_t value, std::string* data) {
+  for (int i = 0; i < 4; ++i) {
+    data->push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+  }
+}
+
+void WriteUint32(uint32_t value, size_t offset, std::string* data) {
+  for (int i = 0; i < 4; ++i) {
+    (*data)[offset + i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+  }
+}
+
+// Reads the compiled format, checking that it stays within bounds.
+class Reader {
+ public:
+  Reader(const Reader&) = delete;
+  Reader& operator=(const Reader&) = delete;
+
+  explicit Reader(std::string_view data) : data_(data), position_(0) {}
+
+  bool ReadMagic() {
+    if (data_.substr(0, kMagicSize) != std::string_view(kMagic, kMagicSize)) {
+      return false;
+    }
+    position_ = kMagicSize;
+    return true;
+  }
+
+  bool ReadUint32(uint32_t* value) {
+    assert(value != nullptr);
+    if (data_.size() - position_ < 4) {
+      return false;
+    }
+    *value = 0;
+    for (int i = 3; i >= 0; --i) {
+      *value = (*value << 8) |
+               static_cast<unsigned char>(data_[position_ + i]);
+    }
+    position_ += 4;
+    return true;
+  }
+
+  // Reads the offset and size of a string, and returns the string.
+  bool ReadString(std::string_view* value) {
+    assert(value != nullptr);
+    uint32_t offset, size;
+    if (!ReadUint32(&offset) || !ReadUint32(&size) ||
+        offset > data_.size() || size > data_.size() - offset) {
+      return false;
+    }
+    *value = data_.substr(offset, size);
+    return true;
+  }
+
+ private:
+  const std::string_view data_;
+  size_t position_;
+};
+
+}  // namespace
+
+// static
+const size_t MessageCatalog::kNoLocale = std::numeric_limits<size_t>::max();
+
+// static
+const size_t MessageCatalog::kNoParameter =
+    std::numeric_limits<size_t>::max();
+
+MessageCatalog::MessageCatalog() : locales_(), messages_(), segments_() {}
+
+MessageCatalog::~MessageCatalog() = default;
+
+// static
+std::string MessageCatalog::Compile(
+    const std::map<std::string, Messages>& messages) {
+  std::string data(kMagic, kMagicSize);
+  AppendUint32(messages.size(), &data);
+
+  // Write the tables with placeholder offsets, to be patched once the strings
+  // have been appended.
+  std::vector<std::pair<size_t, const std::string*>> strings;
+  for (const auto& locale : messages) {
+    strings.emplace_back(data.size(), &locale.first);
+    AppendUint32(0, &data);
+    AppendUint32(locale.first.size(), &data);
+    AppendUint32(locale.second.size(), &data);
+  }
+  for (const auto& locale : messages) {
+    for (const auto& message : locale.second) {
+      AppendUint32(message.first, &data);
+      strings.emplace_back(data.size(), &message.second);
+      AppendUint32(0, &data);
+      AppendUint32(message.second.size(), &data);
+    }
+  }
+
+  for (const auto& string : strings) {
+    WriteUint32(data.size(), string.first, &data);
+    data.append(*string.second);
+  }
+  return data;
+}
+
+bool MessageCatalog::Load(std::string_view data) {
+  locales_.clear();
+  messages_.clear();
+  segments_.clear();
+
+  Reader reader(data);
+  uint32_t locale_count;
+  if (!reader.ReadMagic() || !reader.ReadUint32(&locale_count)) {
+    return false;
+  }
+
+  std::vector<uint32_t> message_counts;
+  for (uint32_t i = 0; i < locale_count; ++i) {
+    Locale locale;
+    uint32_t message_count;
+    if (!reader.ReadString(&locale.language_tag) ||
+        !reader.ReadUint32(&message_count) ||
+        // The language tags must be unique and sorted, for FindLocale().
+        (!locales_.empty() &&
+         locales_.back().language_tag >= locale.language_tag)) {
+      locales_.clear();
+      return false;
+    }
+    locales_.push_back(locale);
+    message_counts.push_back(message_count);
+  }
+
+  for (size_t i = 0; i < locales_.size(); ++i) {
+    locales_[i].message_begin = messages_.size();
+    for (uint32_t j = 0; j < message_counts[i]; ++j) {
+      uint32_t id;
+      Message message;
+      if (!reader.ReadUint32(&id) || !reader.ReadString(&message.text) ||
+          id > static_cast<uint32_t>(std::numeric_limits<int>::max()) ||
+          // The identifiers must be unique and sorted, for FindMessage().
+          (j > 0 && messages_.back().id >= static_cast<int>(id))) {
+        locales_.clear();
+        messages_.clear();
+        segments_.clear();
+        return false;
+      }
+      message.id = static_cast<int>(id);
+      message.segment_begin = segments_.size();
+      Tokenize(message.text);
+      message.segment_end = segments_.size();
+      messages_.push_back(message);
+    }
+    locales_[i].message_end = messages_.size();
+  }
+
+  return true;
+}
+
+std::string_view MessageCatalog::GetLanguageTag(size_t locale) const {
+  assert(locale < locales_.size());
+  return locales_[locale].language_tag;
+}
+
+size_t MessageCatalog::FindLocale(std::string_view language_tag) const {
+  auto it = std::lower_bound(locales_.begin(), locales_.end(), language_tag,
+                             [](const Locale& locale, std::string_view tag) {
+                               return locale.language_tag < tag;
+                             });
+  return it != locales_.end() && it->language_tag == language_tag
+             ? it - locales_.begin()
+             : kNoLocale;
+}
+
+std::string_view MessageCatalog::GetString(size_t locale,
+                                           int message_id) const {
+  const Message* message = FindMessage(locale, message_id);
+  return message != nullptr ? message->text : std::string_view();
+}
+
+void MessageCatalog::AppendMessage(size_t locale,
+                                   int message_id,
+                                   const std::vector<std::string>& parameters,
+                                   std::string* output) const {
+  assert(output != nullptr);
+  const Message* message = FindMessage(locale, message_id);
+  if (message == nullptr) {
+    return;
+  }
+  for (size_t i = message->segment_begin; i < message->segment_end; ++i) {
+    const Segment& segment = segments_[i];
+    if (segment.parameter == kNoParameter) {
+      output->append(segment.literal);
+    } else if (segment.parameter < parameters.size()) {
+      output->append(parameters[segment.parameter]);
+    }
+  }
+}
+
+const MessageCatalog::Message* MessageCatalog::FindMessage(
+    size_t locale,
+    int message_id) const {
+  assert(locale < locales_.size());
+  auto begin = messages_.begin() + locales_[locale].message_begin;
+  auto end = messages_.begin() + locales_[locale].message_end;
+  auto it = std::lower_bound(begin, end, message_id,
+                             [](const Message& message, int id) {
+                               return message.id < id;
+                             });
+  return it != end && it->id == message_id ? &*it : nullptr;
+}
+
+void MessageCatalog::Tokenize(std::string_view text) {
+  // The placeholder syntax is that of DoReplaceStringPlaceholders(): "$N" is
+  // replaced by parameter N, counting from 1, and a run of "$" characters
+  // stands for one "$" less. A "$" followed by anything else is dropped.
+  auto add_literal = [this](std::string_view literal) {
+    if (!literal.empty()) {
+      segments_.push_back({literal, kNoParameter});
+    }
+  };
+
+  size_t literal_begin = 0;
+  size_t i = 0;
+  while (i < text.size()) {
+    if (text[i] != '$') {
+      ++i;
+      continue;
+    }
+    add_literal(text.substr(literal_begin, i - literal_begin));
+    ++i;
+    if (i < text.size() && text[i] == '$') {
+      size_t run_begin = i;
+      while (i < text.size() && text[i] == '$') {
+        ++i;
+      }
+      add_literal(text.substr(run_begin, i - run_begin));
+    } else {
+      size_t digits_begin = i;
+      size_t index = 0;
+      while (i < text.size() && '0' <= text[i] && text[i] <= '9') {
+        index = index * 10 + (text[i] - '0');
+        ++i;
+      }
+      // "$0" refers to no parameter at all.
+      if (i > digits_begin && index > 0) {
+        segments_.push_back({std::string_view(), index - 1});
+      }
+    }
+    literal_begin = i;
+  }
+  add_literal(text.substr(literal_begin));
+}
+
+}  // namespace addressinput
+}  // namespace i18n
@@ -0,0 +1,73 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libaddressinput/metrics.h>
+
+#include <atomic>
+#include <cstddef>
+#include <ostream>
+
+#include "metrics_util.h"
+#include "util/size.h"
+
+namespace i18n {
+namespace addressinput {
+
+std::atomic<MetricsSink*> installed_metrics_sink(nullptr);
+
+void SetMetricsSink(MetricsSink* sink) {
+  installed_metrics_sink.store(sink, std::memory_order_release);
+}
+
+MetricsSink* GetMetricsSink() {
+  return installed_metrics_sink.load(std::memory_order_acquire);
+}
+
+}  // namespace addressinput
+}  // namespace i18n
+
+using i18n::addressinput::Metric;
+using i18n::addressinput::PRELOAD_LOAD_TIME;
+using i18n::addressinput::size;
+using i18n::addressinput::VALIDATOR_PROBLEMS;
+
+std::ostream& operator<<(std::ostream& o, Metric metric) {
+  static const char* const kMetricNames[] = {
+      "PRELOAD_LOAD_TIME",
+      "PRELOAD_RULES_LOADED",
+      "PRELOAD_INDEX_SIZE",
+      "PRELOAD_REGIONS_EVICTED",
+      "ONDEMAND_CACHE_HITS",
+      "ONDEMAND_CACHE_MISSES",
+      "ONDEMAND_PENDING_TASKS",
+      "RETRIEVER_STORAGE_HITS",
+      "RETRIEVER_STORAGE_STALE",
+      "RETRIEVER_STORAGE_CORRUPT",
+      "RETRIEVER_STORAGE_MISSES",
+      "RETRIEVER_SOURCE_TIME",
+      "RETRIEVER_SOURCE_BYTES",
+      "RETRIEVER_SOURCE_FAILURES",
+      "VALIDATOR_VALIDATIONS",
+      "VALIDATOR_PROBLEMS",
+  };
+  static_assert(PRELOAD_LOAD_TIME == 0, "bad_base");
+  static_assert(VALIDATOR_PROBLEMS == size(kMetricNames) - 1, "bad_length");
+
+  if (metric < 0 || static_cast<size_t>(metric) >= size(kMetricNames)) {
+    o << "[INVALID ENUM VALUE " << static_cast<int>(metric) << "]";
+  } else {
+    o << kMetricNames[metric];
+  }
+  return o;
+}
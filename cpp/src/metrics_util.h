@@ -0,0 +1,87 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Reports metrics to the sink installed by SetMetricsSink(). The functions are
+// inline, so that when there is no sink a metric costs only an atomic load.
+
+#ifndef I18N_ADDRESSINPUT_METRICS_UTIL_H_
+#define I18N_ADDRESSINPUT_METRICS_UTIL_H_
+
+#include <libaddressinput/metrics.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+
+namespace i18n {
+namespace addressinput {
+
+// The sink installed by SetMetricsSink(). Use GetMetricsSink() outside of the
+// functions in this file.
+extern std::atomic<MetricsSink*> installed_metrics_sink;
+
+inline void AddToCounter(Metric metric, std::string_view label,
+                         int64_t value) {
+  MetricsSink* sink = installed_metrics_sink.load(std::memory_order_acquire);
+  if (sink != nullptr) {
+    sink->AddToCounter(metric, label, value);
+  }
+}
+
+inline void AddToHistogram(Metric metric, std::string_view label,
+                           int64_t value) {
+  MetricsSink* sink = installed_metrics_sink.load(std::memory_order_acquire);
+  if (sink != nullptr) {
+    sink->AddToHistogram(metric, label, value);
+  }
+}
+
+// Measures the time between its construction and Record(), which may be called
+// from a callback on another thread. The clock is read only if a sink is
+// installed when the timer is constructed. Sample usage:
+//    MetricsTimer timer;
+//    DoSomething();
+//    timer.Record(PRELOAD_LOAD_TIME, region_code);
+class MetricsTimer {
+ public:
+  MetricsTimer(const MetricsTimer&) = delete;
+  MetricsTimer& operator=(const MetricsTimer&) = delete;
+
+  MetricsTimer()
+      : running_(installed_metrics_sink.load(std::memory_order_acquire) !=
+                 nullptr),
+        start_(running_ ? std::chrono::steady_clock::now()
+                        : std::chrono::steady_clock::time_point()) {}
+
+  // Adds the time elapsed since construction, in microseconds, to the
+  // histogram of |metric| with |label|.
+  void Record(Metric metric, std::string_view label) const {
+    if (running_) {
+      AddToHistogram(metric, label,
+                     std::chrono::duration_cast<std::chrono::microseconds>(
+                         std::chrono::steady_clock::now() - start_)
+                         .count());
+    }
+  }
+
+ private:
+  const bool running_;
+  const std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace addressinput
+}  // namespace i18n
+
+#endif  // I18N_ADDRESSINPUT_METRICS_UTIL_H_
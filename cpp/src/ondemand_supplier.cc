@@ -14,15 +14,24 @@
 
 #include <libaddressinput/ondemand_supplier.h>
 
+#include <libaddressinput/cancellation.h>
+#include <libaddressinput/memory_usage.h>
+#include <libaddressinput/metrics.h>
+
 #include <algorithm>
 #include <cstddef>
+#include <map>
+#include <set>
 #include <string>
+#include <utility>
 
 #include "lookup_key.h"
+#include "metrics_util.h"
 #include "ondemand_supply_task.h"
 #include "region_data_constants.h"
 #include "retriever.h"
 #include "rule.h"
+#include "util/memory_usage.h"
 
 namespace i18n {
 namespace addressinput {
@@ -39,12 +48,31 @@ OndemandSupplier::~OndemandSupplier() {
 
 void OndemandSupplier::SupplyGlobally(const LookupKey& lookup_key,
                                       const Callback& supplied) {
-  Supply(lookup_key, supplied);
+  StartTask(lookup_key, supplied, nullptr);
 }
 
 void OndemandSupplier::Supply(const LookupKey& lookup_key,
                               const Callback& supplied) {
-  auto* task = new OndemandSupplyTask(lookup_key, &rule_cache_, supplied);
+  StartTask(lookup_key, supplied, nullptr);
+}
+
+void OndemandSupplier::Supply(const LookupKey& lookup_key,
+                              const Callback& supplied,
+                              const CancellationToken& token) {
+  StartTask(lookup_key, supplied, &token);
+}
+
+void OndemandSupplier::SupplyGlobally(const LookupKey& lookup_key,
+                                      const Callback& supplied,
+                                      const CancellationToken& token) {
+  StartTask(lookup_key, supplied, &token);
+}
+
+void OndemandSupplier::StartTask(const LookupKey& lookup_key,
+                                 const Callback& supplied,
+                                 const CancellationToken* token) {
+  auto* task =
+      new OndemandSupplyTask(lookup_key, &rule_cache_, supplied, token);
 
   if (RegionDataConstants::IsSupported(lookup_key.GetRegionCode())) {
     size_t max_depth = std::min(
@@ -52,11 +80,13 @@ void OndemandSupplier::Supply(const LookupKey& lookup_key,
         RegionDataConstants::GetMaxLookupKeyDepth(lookup_key.GetRegionCode()));
 
     for (size_t depth = 0; depth <= max_depth; ++depth) {
-      const std::string key = lookup_key.ToKeyString(depth);
+      const std::string key(lookup_key.ToKeyString(depth));
       auto it = rule_cache_.find(key);
       if (it != rule_cache_.end()) {
+        AddToCounter(ONDEMAND_CACHE_HITS, lookup_key.GetRegionCode(), 1);
         task->hierarchy_.rule[depth] = it->second;
       } else {
+        AddToCounter(ONDEMAND_CACHE_MISSES, lookup_key.GetRegionCode(), 1);
         task->Queue(key);  // If not in the cache, it needs to be loaded.
       }
     }
@@ -70,5 +100,23 @@ size_t OndemandSupplier::GetLoadedRuleDepth(
   return size(LookupKey::kHierarchy);
 }
 
+MemoryUsageMap OndemandSupplier::GetMemoryUsage() const {
+  MemoryUsageMap usage;
+  // The matchers counted for each region.
+  std::set<std::pair<const MemoryUsage*, const RE2ptr*>> matchers;
+  for (const auto& pair : rule_cache_) {
+    MemoryUsage* region_usage = &usage[GetRegionCodeOfKey(pair.first)];
+    region_usage->rules += pair.second->EstimateMemoryUsage();
+    const RE2ptr* matcher = pair.second->GetCompiledPostalCodeMatcher();
+    if (matcher != nullptr &&
+        matchers.emplace(region_usage, matcher).second) {
+      region_usage->postal_code_matchers += Rule::EstimateMemoryUsage(*matcher);
+    }
+    region_usage->region_rules +=
+        GetTreeNodeSize<decltype(rule_cache_)>() + GetHeapSize(pair.first);
+  }
+  return usage;
+}
+
 }  // namespace addressinput
 }  // namespace i18n
@@ -16,6 +16,8 @@
 
 #include <libaddressinput/address_field.h>
 #include <libaddressinput/callback.h>
+#include <libaddressinput/cancellation.h>
+#include <libaddressinput/metrics.h>
 #include <libaddressinput/supplier.h>
 
 #include <algorithm>
@@ -23,10 +25,14 @@
 #include <cstddef>
 #include <map>
 #include <string>
+#include <string_view>
 
+#include "cancellation_util.h"
 #include "lookup_key.h"
+#include "metrics_util.h"
 #include "retriever.h"
 #include "rule.h"
+#include "tracing_util.h"
 #include "util/size.h"
 
 namespace i18n {
@@ -35,13 +41,15 @@ namespace addressinput {
 OndemandSupplyTask::OndemandSupplyTask(
     const LookupKey& lookup_key,
     std::map<std::string, const Rule*>* rules,
-    const Supplier::Callback& supplied)
+    const Supplier::Callback& supplied,
+    const CancellationToken* token)
     : hierarchy_(),
       pending_(),
       lookup_key_(lookup_key),
       rule_cache_(rules),
       supplied_(supplied),
       retrieved_(BuildCallback(this, &OndemandSupplyTask::Load)),
+      token_(CopyToken(token)),
       success_(true) {
   assert(rule_cache_ != nullptr);
   assert(retrieved_ != nullptr);
@@ -66,18 +74,25 @@ void OndemandSupplyTask::Retrieve(const Retriever& retriever) {
     // then), and the condition statement of the loop must therefore not use the
     // otherwise obvious it != pending_.end() but instead test a local variable
     // that isn't affected by the object being deleted.
+    AddToCounter(ONDEMAND_PENDING_TASKS, std::string_view(), 1);
     bool done = false;
     for (auto it = pending_.begin(); !done;) {
       const std::string& key = *it++;
       done = it == pending_.end();
-      retriever.Retrieve(key, *retrieved_);
+      if (token_.has_value()) {
+        retriever.Retrieve(key, *retrieved_, *token_);
+      } else {
+        retriever.Retrieve(key, *retrieved_);
+      }
     }
   }
 }
 
 void OndemandSupplyTask::Load(bool success,
                               const std::string& key,
-                              const std::string& data) {
+                              std::string* data) {
+  assert(data != nullptr);
+  TraceSpanRecorder span(TRACE_SUPPLY_LOAD, key);
   size_t depth = std::count(key.begin(), key.end(), '/') - 1;
   assert(depth < size(LookupKey::kHierarchy));
 
@@ -89,13 +104,13 @@ void OndemandSupplyTask::Load(bool success,
   if (success) {
     // The address metadata server will return the empty JSON "{}" when it
     // successfully performed a lookup, but didn't find any data for that key.
-    if (data != "{}") {
+    if (*data != "{}") {
       auto* rule = new Rule;
       if (LookupKey::kHierarchy[depth] == COUNTRY) {
         // All rules on the COUNTRY level inherit from the default rule.
         rule->CopyFrom(Rule::GetDefault());
       }
-      if (rule->ParseSerializedRule(data)) {
+      if (rule->ParseSerializedRuleInSitu(data)) {
         // Try inserting the Rule object into the rule_cache_ map, or else find
         // the already existing Rule object with the same ID already in the map.
         // It is possible that a key was queued even though the corresponding
@@ -114,20 +129,23 @@ void OndemandSupplyTask::Load(bool success,
         hierarchy_.rule[depth] = result.first->second;
       } else {
         delete rule;
+        success = false;
         success_ = false;
       }
     }
   } else {
     success_ = false;
   }
+  span.End(success, data->size());
 
   if (pending_.empty()) {
+    AddToCounter(ONDEMAND_PENDING_TASKS, std::string_view(), -1);
     Loaded();
   }
 }
 
 void OndemandSupplyTask::Loaded() {
-  supplied_(success_, lookup_key_, hierarchy_);
+  supplied_(success_ && !IsCancelled(token_), lookup_key_, hierarchy_);
   delete this;
 }
 
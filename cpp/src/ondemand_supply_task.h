@@ -15,10 +15,12 @@
 #ifndef I18N_ADDRESSINPUT_ONDEMAND_SUPPLY_TASK_H_
 #define I18N_ADDRESSINPUT_ONDEMAND_SUPPLY_TASK_H_
 
+#include <libaddressinput/cancellation.h>
 #include <libaddressinput/supplier.h>
 
 #include <map>
 #include <memory>
+#include <optional>
 #include <set>
 #include <string>
 
@@ -35,14 +37,21 @@ class Rule;
 // callback when that has been done. Calling the Retrieve() method will load
 // required metadata, then call the callback and delete the OndemandSupplyTask
 // object itself.
+//
+// If the task is given a CancellationToken, then once the token is cancelled
+// the keys that aren't in the storage aren't requested from the source anymore,
+// and the callback is called with |success| false when the requests already
+// sent have returned. The rules received are cached all the same.
 class OndemandSupplyTask {
  public:
   OndemandSupplyTask(const OndemandSupplyTask&) = delete;
   OndemandSupplyTask& operator=(const OndemandSupplyTask&) = delete;
 
+  // Copies |token| if it isn't nullptr.
   OndemandSupplyTask(const LookupKey& lookup_key,
                      std::map<std::string, const Rule*>* rules,
-                     const Supplier::Callback& supplied);
+                     const Supplier::Callback& supplied,
+                     const CancellationToken* token);
   ~OndemandSupplyTask();
 
   // Adds lookup key string |key| to the queue of data to be retrieved.
@@ -54,7 +63,7 @@ class OndemandSupplyTask {
   Supplier::RuleHierarchy hierarchy_;
 
  private:
-  void Load(bool success, const std::string& key, const std::string& data);
+  void Load(bool success, const std::string& key, std::string* data);
   void Loaded();
 
   std::set<std::string> pending_;
@@ -62,6 +71,7 @@ class OndemandSupplyTask {
   std::map<std::string, const Rule*>* const rule_cache_;
   const Supplier::Callback& supplied_;
   const std::unique_ptr<const Retriever::Callback> retrieved_;
+  const std::optional<CancellationToken> token_;
   bool success_;
 };
 
@@ -163,17 +163,17 @@ std::vector<const RE2PlainPtr*> PostBoxMatchers::GetMatchers(
     const Rule& country_rule) {
   static const StaticRE2Array kMatchers;
 
+  std::vector<const RE2PlainPtr*> result;
+
   // Always add any expressions defined for "und" (English-like defaults).
-  std::vector<std::string> languages{"und"};
-  for (const auto& language_tag : country_rule.GetLanguages()) {
-    Language language(language_tag);
-    languages.push_back(language.base);
+  static const std::string kUndefinedLanguage("und");
+  const RE2PlainPtr* matcher = kMatchers.FindMatcherFor(kUndefinedLanguage);
+  if (matcher != nullptr) {
+    result.push_back(matcher);
   }
 
-  std::vector<const RE2PlainPtr*> result;
-
-  for (const auto& language_tag : languages) {
-    const RE2PlainPtr* matcher = kMatchers.FindMatcherFor(language_tag);
+  for (const auto& language_tag : country_rule.GetLanguages()) {
+    matcher = kMatchers.FindMatcherFor(Language::Get(language_tag)->base);
     if (matcher != nullptr) {
       result.push_back(matcher);
     }
@@ -17,23 +17,40 @@
 #include <libaddressinput/address_data.h>
 #include <libaddressinput/address_field.h>
 #include <libaddressinput/callback.h>
+#include <libaddressinput/memory_usage.h>
+#include <libaddressinput/metrics.h>
 #include <libaddressinput/supplier.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cctype>
 #include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <list>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <stack>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "lookup_key.h"
+#include "metrics_util.h"
 #include "region_data_constants.h"
 #include "retriever.h"
 #include "rule.h"
+#include "rule_tree.h"
+#include "tracing_util.h"
 #include "util/json.h"
+#include "util/md5.h"
+#include "util/memory_usage.h"
 #include "util/size.h"
 #include "util/string_compare.h"
 
@@ -54,35 +71,693 @@ class IndexLess {
   }
 };
 
+using IndexKeys = std::set<std::string, IndexLess>;
+
 }  // namespace
 
 class IndexMap : public std::map<std::string, const Rule*, IndexLess> {};
 
+// The rules of a loaded region, with their indexes and tree, which are never
+// modified once the region has been published to a RuleCache.
+struct RegionRules {
+  // Owns the rules, which the other members refer to. A region that is loaded
+  // to a greater depth shares the rules that were loaded already.
+  std::vector<std::shared_ptr<const Rule>> rules;
+
+  // The MD5 digests of the data of the |rules|, in the same order, with which
+  // ReloadRules() finds the rules whose data has changed.
+  std::vector<MD5Digest> digests;
+
+  // The rules by ID, with exact string comparison.
+  std::map<std::string, const Rule*> rules_by_id;
+
+  // The rules by ID and by the human readable and Latin script names of their
+  // hierarchies, with natural string comparison. The names with a language tag
+  // are also in |language_index| without the tag.
+  IndexMap index;
+  IndexMap language_index;
+
+  // The keys of |index| and |language_index| that more than one rule was
+  // indexed by, of which the first one in the data is kept. After a reload,
+  // these can include keys that only one rule is indexed by anymore.
+  IndexKeys collisions;
+
+  std::unique_ptr<const RuleTree> tree;
+
+  // The depth of LookupKey::kHierarchy down to which the rules are loaded.
+  size_t max_depth = 0;
+
+  // The estimated memory used by all of the above, apart from the postal code
+  // matchers, which are compiled only once they are used.
+  MemoryUsage usage;
+
+  // The generation of the RuleCache when the rules were last used, which is
+  // the only member that still changes once the region has been published.
+  mutable std::atomic<size_t> last_use{0};
+};
+
+// Returns |region_code| in upper case, which is how the regions are looked up,
+// so that a region code matches the loaded region whatever its case. Region
+// codes are ASCII and short enough not to be allocated on the heap.
+std::string NormalizeRegionCode(const std::string& region_code) {
+  std::string normalized(region_code);
+  for (char& c : normalized) {
+    c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+  }
+  return normalized;
+}
+
+// The loaded regions, as immutable snapshots which are replaced every time a
+// region is loaded or unloaded, so that readers can keep using a snapshot
+// meanwhile. Also keeps track of when the regions were used, to evict the
+// least recently used ones when the rules use more memory than the budget.
+// Only GetSnapshot(), GetGeneration() and Find() can be called concurrently.
+class RuleCache {
+ public:
+  // Keyed by normalized region code.
+  using Snapshot = std::map<std::string, std::shared_ptr<const RegionRules>>;
+
+  RuleCache(const RuleCache&) = delete;
+  RuleCache& operator=(const RuleCache&) = delete;
+
+  explicit RuleCache(size_t memory_budget)
+      : memory_budget_(memory_budget),
+        mutex_(),
+        snapshot_(std::make_shared<const Snapshot>()),
+        generation_(0),
+        order_(),
+        size_(0) {}
+
+  std::shared_ptr<const Snapshot> GetSnapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return snapshot_;
+  }
+
+  // Returns a number that changes every time that a snapshot is published.
+  size_t GetGeneration() const {
+    return generation_.load(std::memory_order_acquire);
+  }
+
+  // Returns the rules of |region_code|, or nullptr if they aren't loaded, and
+  // records that they are used.
+  std::shared_ptr<const RegionRules> Find(
+      const std::string& region_code) const {
+    std::shared_ptr<const Snapshot> snapshot = GetSnapshot();
+    auto it = snapshot->find(NormalizeRegionCode(region_code));
+    if (it == snapshot->end()) {
+      return nullptr;
+    }
+    // A use is recorded as the current generation, which changes only when a
+    // snapshot is published, so the threads that use the same region mostly
+    // only read |last_use|, without contending for its cache line.
+    size_t generation = GetGeneration();
+    if (it->second->last_use.load(std::memory_order_relaxed) != generation) {
+      it->second->last_use.store(generation, std::memory_order_relaxed);
+    }
+    return it->second;
+  }
+
+  // Adds the |rules| of |region_code|, replacing any rules that were loaded
+  // before, as the most recently used region. Then evicts the least recently
+  // used other regions until the rules fit into the memory budget.
+  void Publish(const std::string& region_code,
+               std::shared_ptr<const RegionRules> rules) {
+    assert(rules != nullptr);
+    const std::string key = NormalizeRegionCode(region_code);
+    auto snapshot = std::make_shared<Snapshot>(*GetSnapshot());
+    Erase(key, snapshot.get());
+    size_ += rules->usage.GetTotal();
+    rules->last_use.store(GetGeneration(), std::memory_order_relaxed);
+    snapshot->emplace(key, std::move(rules));
+    order_.push_back(key);
+
+    while (size_ > memory_budget_) {
+      const std::string* least_recently_used = nullptr;
+      size_t least_recent_use = std::numeric_limits<size_t>::max();
+      // The regions that were last used in the same generation are evicted in
+      // the order in which they were loaded.
+      for (const auto& other : order_) {
+        size_t use = snapshot->at(other)->last_use.load(
+            std::memory_order_relaxed);
+        if (other != key && use < least_recent_use) {
+          least_recently_used = &other;
+          least_recent_use = use;
+        }
+      }
+      if (least_recently_used == nullptr) {
+        break;
+      }
+      const std::string evicted = *least_recently_used;
+      AddToCounter(PRELOAD_REGIONS_EVICTED, evicted, 1);
+      Erase(evicted, snapshot.get());
+    }
+    Replace(std::move(snapshot));
+  }
+
+  // Removes the rules of |region_code|. Returns false if they weren't loaded.
+  bool Remove(const std::string& region_code) {
+    if (Find(region_code) == nullptr) {
+      return false;
+    }
+    auto snapshot = std::make_shared<Snapshot>(*GetSnapshot());
+    Erase(NormalizeRegionCode(region_code), snapshot.get());
+    Replace(std::move(snapshot));
+    return true;
+  }
+
+  // Makes |region_code| the most recently loaded region, if it's loaded, so
+  // that it's evicted after the other regions that were last used in the same
+  // generation.
+  void Touch(const std::string& region_code) {
+    std::shared_ptr<const Snapshot> snapshot = GetSnapshot();
+    auto it = snapshot->find(NormalizeRegionCode(region_code));
+    if (it != snapshot->end()) {
+      auto position = std::find(order_.begin(), order_.end(), it->first);
+      assert(position != order_.end());
+      order_.splice(order_.end(), order_, position);
+    }
+  }
+
+ private:
+  // Erases the normalized |key| from |snapshot| and from the order of use.
+  void Erase(const std::string& key, Snapshot* snapshot) {
+    assert(snapshot != nullptr);
+    auto it = snapshot->find(key);
+    if (it != snapshot->end()) {
+      size_ -= it->second->usage.GetTotal();
+      order_.remove(it->first);
+      snapshot->erase(it);
+    }
+  }
+
+  // Publishes |snapshot|. The previous snapshot is released outside of the
+  // lock, as it may be the last reference to the rules of a region.
+  void Replace(std::shared_ptr<const Snapshot> snapshot) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      snapshot_.swap(snapshot);
+    }
+    generation_.fetch_add(1, std::memory_order_release);
+  }
+
+  const size_t memory_budget_;
+  mutable std::mutex mutex_;  // Guards |snapshot_|.
+  std::shared_ptr<const Snapshot> snapshot_;
+  std::atomic<size_t> generation_;
+  // The codes of the loaded regions, the least recently loaded (or touched)
+  // first.
+  std::list<std::string> order_;
+  // The sum of the estimated memory used by the loaded regions.
+  size_t size_;
+};
+
 namespace {
 
+// The bytes that std::make_shared() allocates besides the object itself: the
+// pointer to the virtual table and the use and weak counts.
+const size_t kSharedCountSize = sizeof(void*) + 2 * sizeof(int);
+
+// Estimates the memory used by |region|, as its rules are never modified after
+// they are loaded, apart from compiling their postal code matchers.
+MemoryUsage EstimateMemoryUsage(const RegionRules& region) {
+  using RuleMap = std::map<std::string, const Rule*>;
+  MemoryUsage usage;
+  for (const auto& rule : region.rules) {
+    // The rule, with its count and its pointer in |rules|.
+    usage.rules += rule->EstimateMemoryUsage() + kSharedCountSize +
+                   sizeof(std::shared_ptr<const Rule>);
+  }
+  usage.region_rules +=
+      sizeof region + region.digests.capacity() * sizeof(MD5Digest);
+  for (const auto& pair : region.rules_by_id) {
+    usage.region_rules += GetTreeNodeSize<RuleMap>() + GetHeapSize(pair.first);
+  }
+  if (region.tree != nullptr) {
+    usage.region_rules += region.tree->EstimateMemoryUsage();
+  }
+  for (const IndexMap* index : {&region.index, &region.language_index}) {
+    for (const auto& pair : *index) {
+      usage.rule_index += GetTreeNodeSize<IndexMap>() + GetHeapSize(pair.first);
+    }
+  }
+  for (const std::string& key : region.collisions) {
+    usage.rule_index += GetTreeNodeSize<IndexKeys>() + GetHeapSize(key);
+  }
+  return usage;
+}
+
+// Collects the rules of |lookup_key| up to |max_depth| into |hierarchy| by
+// walking the rule tree of the region, which succeeds only if all the nodes
+// of the key are exact sub-keys of their parents.
+bool GetRuleHierarchyFromTree(const RuleTree& tree,
+                              const LookupKey& lookup_key,
+                              size_t max_depth,
+                              Supplier::RuleHierarchy* hierarchy) {
+  assert(hierarchy != nullptr);
+  size_t language = tree.FindLanguage(lookup_key.GetLanguage());
+  if (language == RuleTree::kNoLanguage) {
+    return false;
+  }
+  size_t node = RuleTree::kRoot;
+  for (size_t depth = 0; depth <= max_depth; ++depth) {
+    if (depth > 0) {
+      node = tree.FindChild(node, lookup_key.GetNode(depth));
+      if (node == RuleTree::kNoNode) {
+        return false;
+      }
+    }
+    const Rule* rule = tree.GetRule(node, language);
+    if (rule == nullptr) {
+      return false;
+    }
+    hierarchy->rule[depth] = rule;
+  }
+  return true;
+}
+
+// Returns the depth of the rules in |tree|, which is the depth of its first
+// leaf that has a rule.
+size_t GetLoadedDepth(const RuleTree& tree) {
+  size_t depth = 0;
+  for (size_t node = RuleTree::kRoot; tree.GetRule(node) != nullptr;
+       node = tree.GetFirstChild(node)) {
+    depth++;
+    if (tree.GetFirstChild(node) == tree.GetChildEnd(node)) break;
+  }
+  return depth;
+}
+
+bool IsSameDigest(const MD5Digest& a, const MD5Digest& b) {
+  return std::equal(std::begin(a.a), std::end(a.a), std::begin(b.a));
+}
+
+// Builds Rule objects directly from the stream of aggregated JSON data, where
+// every rule is a sub dictionary keyed by its ID. The rules outside of the
+// depths from |min_depth| to |max_depth| are skipped without building them.
+//
+// The fields of a rule are kept until the end of its sub dictionary, where the
+// MD5 digest of its data is known, so that the rules of the |previous| rules of
+// the region whose data hasn't changed can be reused instead of built again.
+class RuleReader : public Json::SubDictionaryHandler {
+ public:
+  RuleReader(const RuleReader&) = delete;
+  RuleReader& operator=(const RuleReader&) = delete;
+
+  // Does not take ownership of |previous|, which can be nullptr if there are
+  // no rules to reuse and no changes to find.
+  RuleReader(size_t min_depth, size_t max_depth, const RegionRules* previous)
+      : min_depth_(min_depth),
+        max_depth_(max_depth),
+        previous_(previous),
+        previous_index_(),
+        seen_(),
+        rules_(),
+        digests_(),
+        built_(),
+        added_(),
+        changed_(),
+        key_(),
+        fields_(),
+        context_(),
+        country_(false),
+        skipping_(true),
+        success_(true) {
+    if (previous_ != nullptr) {
+      previous_index_.reserve(previous_->rules.size());
+      for (size_t i = 0; i < previous_->rules.size(); ++i) {
+        previous_index_.emplace(previous_->rules[i]->GetId(), i);
+      }
+      seen_.resize(previous_->rules.size());
+    }
+  }
+
+  ~RuleReader() override = default;
+
+  void BeginSubDictionary(const std::string& key) override {
+    size_t depth = std::count(key.begin(), key.end(), '/') - 1;
+    assert(depth < size(LookupKey::kHierarchy));
+    skipping_ = depth < min_depth_ || depth > max_depth_;
+    if (skipping_) {
+      return;
+    }
+    // All rules on the COUNTRY level inherit from the default rule.
+    country_ = LookupKey::kHierarchy[depth] == COUNTRY;
+    key_ = key;
+    MD5Init(&context_);
+  }
+
+  void StringValue(const std::string& key, std::string* value) override {
+    if (skipping_) {
+      return;
+    }
+    static const std::string kSeparator(1, '\0');
+    MD5Update(&context_, key);
+    MD5Update(&context_, kSeparator);
+    MD5Update(&context_, *value);
+    MD5Update(&context_, kSeparator);
+    fields_.emplace_back(key, std::string());
+    fields_.back().second.swap(*value);
+  }
+
+  void EndSubDictionary() override {
+    if (skipping_) {
+      return;
+    }
+    skipping_ = true;
+    MD5Digest digest;
+    MD5Final(&digest, &context_);
+    digests_.push_back(digest);
+
+    if (previous_ != nullptr) {
+      auto it = previous_index_.find(key_);
+      if (it == previous_index_.end()) {
+        added_.push_back(key_);
+      } else {
+        seen_[it->second] = true;
+        if (IsSameDigest(previous_->digests[it->second], digest)) {
+          rules_.push_back(previous_->rules[it->second]);
+          fields_.clear();
+          return;
+        }
+        changed_.push_back(key_);
+      }
+    }
+
+    auto rule = std::make_shared<Rule>();
+    if (country_) {
+      rule->CopyFrom(Rule::GetDefault());
+    }
+    for (auto& field : fields_) {
+      rule->ParseJsonField(field.first, &field.second);
+    }
+    fields_.clear();
+    if (rule->GetId().empty()) {
+      success_ = false;
+    }
+    built_.push_back(rule.get());
+    rules_.push_back(std::move(rule));
+  }
+
+  // Returns false if any of the rules didn't have an ID.
+  bool success() const { return success_; }
+
+  // Returns the rules that were built instead of reused, which are owned by
+  // the rules that ReleaseRules() returns.
+  const std::vector<const Rule*>& built() const { return built_; }
+
+  // Sets |changes| to how the rules differ from the |previous| rules, which
+  // must not be nullptr.
+  void GetChanges(PreloadSupplier::RuleChanges* changes) const {
+    assert(changes != nullptr);
+    assert(previous_ != nullptr);
+    changes->added = added_;
+    changes->changed = changed_;
+    changes->removed.clear();
+    for (size_t i = 0; i < seen_.size(); ++i) {
+      if (!seen_[i]) {
+        changes->removed.push_back(previous_->rules[i]->GetId());
+      }
+    }
+    std::sort(changes->added.begin(), changes->added.end());
+    std::sort(changes->changed.begin(), changes->changed.end());
+    std::sort(changes->removed.begin(), changes->removed.end());
+  }
+
+  // Transfers ownership of the rules to the caller, with the digests of their
+  // data in the same order.
+  void ReleaseRules(std::vector<std::shared_ptr<const Rule>>* rules,
+                    std::vector<MD5Digest>* digests) {
+    assert(rules != nullptr);
+    assert(digests != nullptr);
+    rules->swap(rules_);
+    digests->swap(digests_);
+  }
+
+ private:
+  const size_t min_depth_;
+  const size_t max_depth_;
+  const RegionRules* const previous_;
+  // The indexes in |previous_| of the rules by ID, and whether each of them
+  // was found in the data.
+  std::unordered_map<std::string_view, size_t> previous_index_;
+  std::vector<bool> seen_;
+  std::vector<std::shared_ptr<const Rule>> rules_;
+  std::vector<MD5Digest> digests_;
+  std::vector<const Rule*> built_;
+  std::vector<std::string> added_;
+  std::vector<std::string> changed_;
+  // The ID and the fields of the rule being read.
+  std::string key_;
+  std::vector<std::pair<std::string, std::string>> fields_;
+  MD5Context context_;
+  bool country_;
+  bool skipping_;
+  bool success_;
+};
+
+// The IDs of a sub rule in the indexes of its region, which are built from the
+// names of the rules of its hierarchy.
+struct NameIds {
+  // The human readable ID, with the language tag of the rule, if any.
+  std::string human;
+  // The human readable ID without the language tag, or empty if there is none.
+  std::string language;
+  // The Latin script ID, or empty unless a Latin script name could be found for
+  // every part of the ID.
+  std::string latin;
+};
+
+// Builds the |ids| of the sub |rule| from the names of the rules on the
+// |hierarchy| stack, which are popped from the topmost parent down to |rule|.
+void BuildNameIds(const Rule& rule,
+                  std::stack<const Rule*>* hierarchy,
+                  NameIds* ids) {
+  assert(hierarchy != nullptr);
+  assert(ids != nullptr);
+  ids->human.assign(rule.GetId(), 0, sizeof "data/ZZ" - 1);
+  ids->latin = ids->human;
+
+  // Append the names from all Rule objects on the hierarchy stack.
+  for (; !hierarchy->empty(); hierarchy->pop()) {
+    const Rule* parent = hierarchy->top();
+
+    ids->human.push_back('/');
+    if (!parent->GetName().empty()) {
+      ids->human.append(parent->GetName());
+    } else {
+      // If the "name" field is empty, the name is the last part of the ID.
+      const std::string& id = parent->GetId();
+      std::string::size_type pos = id.rfind('/');
+      assert(pos != std::string::npos);
+      ids->human.append(id, pos + 1, std::string::npos);
+    }
+
+    if (!parent->GetLatinName().empty()) {
+      ids->latin.push_back('/');
+      ids->latin.append(parent->GetLatinName());
+    }
+  }
+
+  // If the ID has a language tag, copy it.
+  const std::string& id = rule.GetId();
+  std::string::size_type pos = id.rfind("--");
+  if (pos != std::string::npos) {
+    ids->language = ids->human;
+    ids->human.append(id, pos, id.size() - pos);
+  } else {
+    ids->language.clear();
+  }
+
+  if (std::count(ids->human.begin(), ids->human.end(), '/') !=
+      std::count(ids->latin.begin(), ids->latin.end(), '/')) {
+    ids->latin.clear();
+  }
+}
+
+// Adds |key| to |index| for |rule|, unless |only_keys| is non-null and doesn't
+// contain it, using |hint| as for std::map::emplace_hint(). Adds |key| to
+// |collisions| if |index| keeps another rule for it.
+void AddToIndex(const std::string& key, const Rule* rule,
+                const IndexKeys* only_keys, IndexKeys* collisions,
+                IndexMap* index, IndexMap::iterator* hint) {
+  assert(collisions != nullptr);
+  assert(index != nullptr);
+  assert(hint != nullptr);
+  if (only_keys != nullptr && only_keys->count(key) == 0) {
+    return;
+  }
+  *hint = index->emplace_hint(*hint, key, rule);
+  if ((*hint)->second != rule) {
+    collisions->insert(key);
+  }
+}
+
+// Adds the IDs built from the names of the |sub_rules| to the indexes of
+// |region|, where the parents of the sub rules must be indexed by ID already.
+// Adds only the IDs in |only_keys|, unless it's nullptr. Adds the IDs that
+// another rule is indexed by already to |collisions|.
+void AddNamesToIndex(const std::vector<const Rule*>& sub_rules,
+                     const IndexKeys* only_keys,
+                     IndexKeys* collisions,
+                     RegionRules* region) {
+  assert(collisions != nullptr);
+  assert(region != nullptr);
+  //
+  // Normally the address metadata server takes care of mapping from natural
+  // language names to metadata IDs (eg. "São Paulo" -> "SP") and from Latin
+  // script names to local script names (eg. "Tokushima" -> "徳島県").
+  //
+  // As the PreloadSupplier doesn't contact the metadata server upon each
+  // Supply() request, it instead has an internal lookup table (the rule index
+  // of every region) that contains such mappings.
+  //
+  // This lookup table is populated by iterating over all sub rules and for
+  // each of them construct ID strings using human readable names (eg. "São
+  // Paulo") and using Latin script names (eg. "Tokushima").
+  //
+  IndexMap* const rule_index = &region->index;
+  auto last_index_it = rule_index->end();
+  auto last_latin_it = rule_index->end();
+  auto language_index_it = region->language_index.end();
+
+  IndexMap::const_iterator hints[size(LookupKey::kHierarchy) - 1];
+  std::fill(hints, hints + size(hints), rule_index->end());
+
+  NameIds ids;
+  for (auto ptr : sub_rules) {
+    assert(ptr != nullptr);
+    std::stack<const Rule*> hierarchy;
+    hierarchy.push(ptr);
+
+    // Push pointers to all parent Rule objects onto the hierarchy stack.
+    for (std::string parent_id(ptr->GetId());;) {
+      // Strip the last part of parent_id. Break if COUNTRY level is reached.
+      std::string::size_type pos = parent_id.rfind('/');
+      if (pos == sizeof "data/ZZ" - 1) {
+        break;
+      }
+      parent_id.resize(pos);
+
+      IndexMap::const_iterator* const hint = &hints[hierarchy.size() - 1];
+      if (*hint == rule_index->end() || (*hint)->first != parent_id) {
+        *hint = rule_index->find(parent_id);
+      }
+      assert(*hint != rule_index->end());
+      hierarchy.push((*hint)->second);
+    }
+
+    BuildNameIds(*ptr, &hierarchy, &ids);
+    if (!ids.language.empty()) {
+      AddToIndex(ids.language, ptr, only_keys, collisions,
+                 &region->language_index, &language_index_it);
+    }
+
+    AddToIndex(ids.human, ptr, only_keys, collisions, rule_index,
+               &last_index_it);
+
+    // Add the Latin script ID, if a Latin script name could be found for
+    // every part of the ID.
+    if (!ids.latin.empty()) {
+      AddToIndex(ids.latin, ptr, only_keys, collisions, rule_index,
+                 &last_latin_it);
+    }
+  }
+}
+
+// Erases |key| from |index| if it maps to |rule|, as the rule that an ID built
+// from names maps to is the first one that was indexed by it.
+void EraseFromIndex(const std::string& key, const Rule* rule, IndexMap* index) {
+  assert(index != nullptr);
+  auto it = index->find(key);
+  if (it != index->end() && it->second == rule) {
+    index->erase(it);
+  }
+}
+
+// Erases the IDs built from the names of the sub |rule| from the indexes of
+// |region|, looking up the parents of the rule in |rules_by_id|. Adds the IDs
+// that other rules can be indexed by to |reindex|.
+void RemoveNamesFromIndex(const Rule& rule,
+                          const std::map<std::string, const Rule*>& rules_by_id,
+                          IndexKeys* reindex,
+                          RegionRules* region) {
+  assert(reindex != nullptr);
+  assert(region != nullptr);
+  std::stack<const Rule*> hierarchy;
+  hierarchy.push(&rule);
+  for (std::string parent_id(rule.GetId());;) {
+    std::string::size_type pos = parent_id.rfind('/');
+    if (pos == sizeof "data/ZZ" - 1) {
+      break;
+    }
+    parent_id.resize(pos);
+    auto it = rules_by_id.find(parent_id);
+    assert(it != rules_by_id.end());
+    hierarchy.push(it->second);
+  }
+
+  NameIds ids;
+  BuildNameIds(rule, &hierarchy, &ids);
+  if (!ids.language.empty()) {
+    EraseFromIndex(ids.language, &rule, &region->language_index);
+  }
+  EraseFromIndex(ids.human, &rule, &region->index);
+  if (!ids.latin.empty()) {
+    EraseFromIndex(ids.latin, &rule, &region->index);
+  }
+  for (const std::string* id : {&ids.language, &ids.human, &ids.latin}) {
+    if (!id->empty() && region->collisions.count(*id) != 0) {
+      reindex->insert(*id);
+    }
+  }
+}
+
+// Adds the rule with |id| in |rules_by_id|, if any, and the rules below it to
+// |subtree|.
+void GetSubtree(const std::map<std::string, const Rule*>& rules_by_id,
+                const std::string& id,
+                std::map<std::string, const Rule*>* subtree) {
+  assert(subtree != nullptr);
+  auto it = rules_by_id.find(id);
+  if (it != rules_by_id.end()) {
+    subtree->insert(*it);
+  }
+  const std::string prefix = id + '/';
+  for (it = rules_by_id.lower_bound(prefix);
+       it != rules_by_id.end() &&
+       it->first.compare(0, prefix.size(), prefix) == 0;
+       ++it) {
+    subtree->insert(*it);
+  }
+}
+
+bool IsSubRule(const Rule& rule) {
+  const std::string& id = rule.GetId();
+  return std::count(id.begin(), id.end(), '/') > 1;
+}
+
 class Helper {
  public:
   Helper(const Helper&) = delete;
   Helper& operator=(const Helper&) = delete;
 
-  // Does not take ownership of its parameters.
+  // Does not take ownership of its parameters. Builds the rules down to
+  // |max_depth|, keeping the rules of the region that are loaded down to a
+  // smaller depth when the data arrives, if any.
   Helper(const std::string& region_code, const std::string& key,
-         const PreloadSupplier::Callback& loaded, const Retriever& retriever,
-         std::set<std::string>* pending, IndexMap* rule_index,
-         IndexMap* language_rule_index, std::vector<const Rule*>* rule_storage,
-         std::map<std::string, const Rule*>* region_rules)
+         size_t max_depth, const PreloadSupplier::Callback& loaded,
+         const Retriever& retriever, std::set<std::string>* pending,
+         RuleCache* cache)
       : region_code_(region_code),
+        max_depth_(max_depth),
         loaded_(loaded),
         pending_(pending),
-        rule_index_(rule_index),
-        language_rule_index_(language_rule_index),
-        rule_storage_(rule_storage),
-        region_rules_(region_rules),
-        retrieved_(BuildCallback(this, &Helper::OnRetrieved)) {
+        cache_(cache),
+        retrieved_(BuildCallback(this, &Helper::OnRetrieved)),
+        timer_(),
+        span_(TRACE_LOAD_RULES, region_code) {
     assert(pending_ != nullptr);
-    assert(rule_index_ != nullptr);
-    assert(rule_storage_ != nullptr);
-    assert(region_rules_ != nullptr);
+    assert(cache_ != nullptr);
     assert(retrieved_ != nullptr);
     pending_->insert(key);
     retriever.Retrieve(key, *retrieved_);
@@ -91,164 +766,277 @@ class Helper {
  private:
   ~Helper() = default;
 
-  void OnRetrieved(bool success, const std::string& key,
-                   const std::string& data) {
+  void OnRetrieved(bool success, const std::string& key, std::string* data) {
+    assert(data != nullptr);
     int rule_count = 0;
+    const size_t data_size = data->size();
 
     size_t status = pending_->erase(key);
     assert(status == 1);  // There will always be one item erased from the set.
     (void)status;  // Prevent unused variable if assert() is optimized away.
 
-    Json json;
-    std::string id;
+    // The rules that are loaded when the data arrives are kept, as the region
+    // can have been unloaded or evicted meanwhile, in which case all of its
+    // rules are built.
+    const std::shared_ptr<const RegionRules> loaded_rules =
+        cache_->Find(region_code_);
+    RuleReader reader(
+        loaded_rules != nullptr ? loaded_rules->max_depth + 1 : 0,
+        max_depth_, nullptr);
+    std::vector<std::shared_ptr<const Rule>> rules;
+    std::vector<MD5Digest> digests;
     std::vector<const Rule*> sub_rules;
 
-    auto last_index_it = rule_index_->end();
-    auto last_latin_it = rule_index_->end();
-    auto language_index_it = language_rule_index_->end();
-    auto last_region_it = region_rules_->end();
+    // The rules that were loaded already are shared, but their indexes are
+    // copied, as the published indexes can't be modified.
+    auto region = std::make_shared<RegionRules>();
+    if (loaded_rules != nullptr) {
+      region->rules = loaded_rules->rules;
+      region->digests = loaded_rules->digests;
+      region->rules_by_id = loaded_rules->rules_by_id;
+      region->index = loaded_rules->index;
+      region->language_index = loaded_rules->language_index;
+      region->collisions = loaded_rules->collisions;
+    }
+    IndexMap* const rule_index = &region->index;
 
-    IndexMap::const_iterator hints[size(LookupKey::kHierarchy) - 1];
-    std::fill(hints, hints + size(hints), rule_index_->end());
+    auto last_index_it = rule_index->end();
+    auto last_region_it = region->rules_by_id.end();
 
     if (!success) {
       goto callback;
     }
 
-    if (!json.ParseObject(data)) {
+    // The rules are built while parsing the JSON in situ, without a document,
+    // so that no string is copied more than once on its way into a rule.
+    if (!Json::ParseSubDictionariesInSitu(data, &reader) ||
+        !reader.success()) {
       success = false;
       goto callback;
     }
+    reader.ReleaseRules(&rules, &digests);
 
-    for (auto ptr : json.GetSubDictionaries()) {
-      assert(ptr != nullptr);
-      if (!ptr->GetStringValueForKey("id", &id)) {
-        success = false;
-        goto callback;
-      }
+    for (auto& rule : rules) {
+      assert(rule != nullptr);
+      const std::string& id = rule->GetId();
       assert(!id.empty());
 
-      size_t depth = std::count(id.begin(), id.end(), '/') - 1;
-      assert(depth < size(LookupKey::kHierarchy));
-      AddressField field = LookupKey::kHierarchy[depth];
-
-      auto* rule = new Rule;
-      if (field == COUNTRY) {
-        // All rules on the COUNTRY level inherit from the default rule.
-        rule->CopyFrom(Rule::GetDefault());
-      }
-      rule->ParseJsonRule(*ptr);
-      assert(id == rule->GetId());  // Sanity check.
-
-      rule_storage_->push_back(rule);
-      if (depth > 0) {
-        sub_rules.push_back(rule);
+      if (IsSubRule(*rule)) {
+        sub_rules.push_back(rule.get());
       }
 
       // Add the ID of this Rule object to the rule index with natural string
       // comparison for keys.
-      last_index_it = rule_index_->emplace_hint(last_index_it, id, rule);
+      AddToIndex(id, rule.get(), nullptr, &region->collisions, rule_index,
+                 &last_index_it);
 
       // Add the ID of this Rule object to the region-specific rule index with
       // exact string comparison for keys.
-      last_region_it = region_rules_->emplace_hint(last_region_it, id, rule);
+      last_region_it =
+          region->rules_by_id.emplace_hint(last_region_it, id, rule.get());
 
+      region->rules.push_back(std::move(rule));
       ++rule_count;
     }
+    region->digests.insert(region->digests.end(), digests.begin(),
+                           digests.end());
 
-    //
-    // Normally the address metadata server takes care of mapping from natural
-    // language names to metadata IDs (eg. "São Paulo" -> "SP") and from Latin
-    // script names to local script names (eg. "Tokushima" -> "徳島県").
-    //
-    // As the PreloadSupplier doesn't contact the metadata server upon each
-    // Supply() request, it instead has an internal lookup table (rule_index_)
-    // that contains such mappings.
-    //
-    // This lookup table is populated by iterating over all sub rules and for
-    // each of them construct ID strings using human readable names (eg. "São
-    // Paulo") and using Latin script names (eg. "Tokushima").
-    //
-    for (auto ptr : sub_rules) {
-      assert(ptr != nullptr);
-      std::stack<const Rule*> hierarchy;
-      hierarchy.push(ptr);
-
-      // Push pointers to all parent Rule objects onto the hierarchy stack.
-      for (std::string parent_id(ptr->GetId());;) {
-        // Strip the last part of parent_id. Break if COUNTRY level is reached.
-        std::string::size_type pos = parent_id.rfind('/');
-        if (pos == sizeof "data/ZZ" - 1) {
-          break;
-        }
-        parent_id.resize(pos);
+    AddNamesToIndex(sub_rules, nullptr, &region->collisions, region.get());
 
-        IndexMap::const_iterator* const hint = &hints[hierarchy.size() - 1];
-        if (*hint == rule_index_->end() || (*hint)->first != parent_id) {
-          *hint = rule_index_->find(parent_id);
-        }
-        assert(*hint != rule_index_->end());
-        hierarchy.push((*hint)->second);
+    region->tree.reset(new RuleTree(region_code_, region->rules_by_id));
+    region->max_depth = max_depth_;
+    region->usage = EstimateMemoryUsage(*region);
+    cache_->Publish(region_code_, region);
+
+  callback:
+    timer_.Record(PRELOAD_LOAD_TIME, region_code_);
+    AddToCounter(PRELOAD_RULES_LOADED, region_code_, rule_count);
+    AddToHistogram(PRELOAD_INDEX_SIZE, region_code_, rule_index->size());
+    span_.End(success, data_size);
+    loaded_(success, region_code_, rule_count);
+    delete this;
+  }
+
+  const std::string region_code_;
+  const size_t max_depth_;
+  const PreloadSupplier::Callback& loaded_;
+  std::set<std::string>* const pending_;
+  RuleCache* const cache_;
+  const std::unique_ptr<const Retriever::Callback> retrieved_;
+  const MetricsTimer timer_;
+  TraceSpanRecorder span_;
+};
+
+class ReloadHelper {
+ public:
+  ReloadHelper(const ReloadHelper&) = delete;
+  ReloadHelper& operator=(const ReloadHelper&) = delete;
+
+  // Does not take ownership of its parameters.
+  ReloadHelper(const std::string& region_code, const std::string& key,
+               const PreloadSupplier::ReloadCallback& reloaded,
+               const Retriever& retriever, std::set<std::string>* pending,
+               RuleCache* cache)
+      : region_code_(region_code),
+        reloaded_(reloaded),
+        pending_(pending),
+        cache_(cache),
+        retrieved_(BuildCallback(this, &ReloadHelper::OnRetrieved)),
+        timer_(),
+        span_(TRACE_LOAD_RULES, region_code) {
+    assert(pending_ != nullptr);
+    assert(cache_ != nullptr);
+    assert(retrieved_ != nullptr);
+    pending_->insert(key);
+    retriever.RetrieveFromSource(key, *retrieved_);
+  }
+
+ private:
+  ~ReloadHelper() = default;
+
+  void OnRetrieved(bool success, const std::string& key, std::string* data) {
+    assert(data != nullptr);
+    const size_t data_size = data->size();
+
+    size_t status = pending_->erase(key);
+    assert(status == 1);  // There will always be one item erased from the set.
+    (void)status;  // Prevent unused variable if assert() is optimized away.
+
+    // The data is compared with the rules that are loaded when it arrives, as
+    // these can have been unloaded meanwhile. A region that isn't loaded is
+    // compared with no rules at all, so that all of its rules are added.
+    const std::shared_ptr<const RegionRules> loaded_rules =
+        cache_->Find(region_code_);
+    const RegionRules no_rules;
+    const RegionRules& previous =
+        loaded_rules != nullptr ? *loaded_rules : no_rules;
+    const size_t max_depth = loaded_rules != nullptr
+                                 ? loaded_rules->max_depth
+                                 : size(LookupKey::kHierarchy) - 1;
+    RuleReader reader(0, max_depth, &previous);
+    PreloadSupplier::RuleChanges changes;
+
+    if (success && Json::ParseSubDictionariesInSitu(data, &reader) &&
+        reader.success()) {
+      reader.GetChanges(&changes);
+      if (loaded_rules == nullptr || !changes.added.empty() ||
+          !changes.changed.empty() || !changes.removed.empty()) {
+        Publish(previous, max_depth, changes, &reader);
       }
+    } else {
+      success = false;
+    }
 
-      std::string human_id(ptr->GetId().substr(0, sizeof "data/ZZ" - 1));
-      std::string latin_id(human_id);
-
-      // Append the names from all Rule objects on the hierarchy stack.
-      for (; !hierarchy.empty(); hierarchy.pop()) {
-        const Rule* rule = hierarchy.top();
-
-        human_id.push_back('/');
-        if (!rule->GetName().empty()) {
-          human_id.append(rule->GetName());
-        } else {
-          // If the "name" field is empty, the name is the last part of the ID.
-          const std::string& id = rule->GetId();
-          std::string::size_type pos = id.rfind('/');
-          assert(pos != std::string::npos);
-          human_id.append(id.substr(pos + 1));
-        }
+    timer_.Record(PRELOAD_LOAD_TIME, region_code_);
+    AddToCounter(PRELOAD_RULES_LOADED, region_code_,
+                 success ? reader.built().size() : 0);
+    span_.End(success, data_size);
+    reloaded_(success, region_code_, changes);
+    delete this;
+  }
+
+  // Publishes the rules of the |reader| down to |max_depth|, which has found
+  // the |changes| to the |previous| rules of the region, replacing the index
+  // entries of the changed rules only. The entries that other rules collide
+  // with are rebuilt from all the rules, so that the index maps them to the
+  // same rules as the index of a region that is loaded anew.
+  void Publish(const RegionRules& previous,
+               size_t max_depth,
+               const PreloadSupplier::RuleChanges& changes,
+               RuleReader* reader) {
+    assert(reader != nullptr);
+    auto region = std::make_shared<RegionRules>();
+    reader->ReleaseRules(&region->rules, &region->digests);
+    region->rules_by_id = previous.rules_by_id;
+    region->index = previous.index;
+    region->language_index = previous.language_index;
+    region->collisions = previous.collisions;
 
-        if (!rule->GetLatinName().empty()) {
-          latin_id.push_back('/');
-          latin_id.append(rule->GetLatinName());
+    // The IDs built from names include the names of the parents of a rule, so
+    // they're replaced for all the rules below a changed rule as well.
+    std::map<std::string, const Rule*> renamed;
+    for (const auto* ids : {&changes.changed, &changes.removed}) {
+      for (const std::string& id : *ids) {
+        GetSubtree(previous.rules_by_id, id, &renamed);
+      }
+    }
+    IndexKeys reindex;
+    for (const auto& pair : renamed) {
+      if (IsSubRule(*pair.second)) {
+        RemoveNamesFromIndex(*pair.second, previous.rules_by_id, &reindex,
+                             region.get());
+      }
+    }
+    for (const auto* ids : {&changes.changed, &changes.removed}) {
+      for (const std::string& id : *ids) {
+        auto it = region->rules_by_id.find(id);
+        assert(it != region->rules_by_id.end());
+        EraseFromIndex(id, it->second, &region->index);
+        if (region->collisions.count(id) != 0) {
+          reindex.insert(id);
         }
+        region->rules_by_id.erase(it);
       }
+    }
 
-      // If the ID has a language tag, copy it.
-      {
-        const std::string& id = ptr->GetId();
-        std::string::size_type pos = id.rfind("--");
-        if (pos != std::string::npos) {
-          language_index_it = language_rule_index_->emplace_hint(
-              language_index_it, human_id, ptr);
-          human_id.append(id, pos, id.size() - pos);
-        }
+    auto index_it = region->index.end();
+    for (const Rule* rule : reader->built()) {
+      region->rules_by_id.emplace(rule->GetId(), rule);
+      AddToIndex(rule->GetId(), rule, nullptr, &reindex, &region->index,
+                 &index_it);
+    }
+    renamed.clear();
+    for (const auto* ids : {&changes.changed, &changes.added}) {
+      for (const std::string& id : *ids) {
+        GetSubtree(region->rules_by_id, id, &renamed);
       }
+    }
+    std::vector<const Rule*> sub_rules;
+    for (const auto& pair : renamed) {
+      if (IsSubRule(*pair.second)) {
+        sub_rules.push_back(pair.second);
+      }
+    }
+    AddNamesToIndex(sub_rules, nullptr, &reindex, region.get());
+    if (!reindex.empty()) {
+      Reindex(reindex, region.get());
+    }
 
-      last_index_it = rule_index_->emplace_hint(last_index_it, human_id, ptr);
+    region->tree.reset(new RuleTree(region_code_, region->rules_by_id));
+    region->max_depth = max_depth;
+    region->usage = EstimateMemoryUsage(*region);
+    cache_->Publish(region_code_, region);
+  }
 
-      // Add the Latin script ID, if a Latin script name could be found for
-      // every part of the ID.
-      if (std::count(human_id.begin(), human_id.end(), '/') ==
-          std::count(latin_id.begin(), latin_id.end(), '/')) {
-        last_latin_it = rule_index_->emplace_hint(last_latin_it, latin_id, ptr);
+  // Rebuilds the entries of the |keys| in the indexes of |region| from all of
+  // its rules, in the order of the data, as LoadRules() builds them.
+  static void Reindex(const IndexKeys& keys, RegionRules* region) {
+    assert(region != nullptr);
+    for (const std::string& key : keys) {
+      region->index.erase(key);
+      region->language_index.erase(key);
+      region->collisions.insert(key);
+    }
+    IndexKeys collisions;
+    auto index_it = region->index.end();
+    std::vector<const Rule*> sub_rules;
+    for (const auto& rule : region->rules) {
+      AddToIndex(rule->GetId(), rule.get(), &keys, &collisions, &region->index,
+                 &index_it);
+      if (IsSubRule(*rule)) {
+        sub_rules.push_back(rule.get());
       }
     }
-
-  callback:
-    loaded_(success, region_code_, rule_count);
-    delete this;
+    AddNamesToIndex(sub_rules, &keys, &collisions, region);
   }
 
   const std::string region_code_;
-  const PreloadSupplier::Callback& loaded_;
+  const PreloadSupplier::ReloadCallback& reloaded_;
   std::set<std::string>* const pending_;
-  IndexMap* const rule_index_;
-  IndexMap* const language_rule_index_;
-  std::vector<const Rule*>* const rule_storage_;
-  std::map<std::string, const Rule*>* const region_rules_;
+  RuleCache* const cache_;
   const std::unique_ptr<const Retriever::Callback> retrieved_;
+  const MetricsTimer timer_;
+  TraceSpanRecorder span_;
 };
 
 std::string KeyFromRegionCode(const std::string& region_code) {
@@ -256,24 +1044,26 @@ std::string KeyFromRegionCode(const std::string& region_code) {
   address.region_code = region_code;
   LookupKey lookup_key;
   lookup_key.FromAddress(address);
-  return lookup_key.ToKeyString(0);  // Zero depth = COUNTRY level.
+  return std::string(lookup_key.ToKeyString(0));  // Zero depth = COUNTRY level.
 }
 
 }  // namespace
 
+// static
+const size_t PreloadSupplier::kUnlimitedMemory =
+    std::numeric_limits<size_t>::max();
+
 PreloadSupplier::PreloadSupplier(const Source* source, Storage* storage)
+    : PreloadSupplier(source, storage, kUnlimitedMemory) {}
+
+PreloadSupplier::PreloadSupplier(const Source* source,
+                                 Storage* storage,
+                                 size_t memory_budget)
     : retriever_(new Retriever(source, storage)),
       pending_(),
-      rule_index_(new IndexMap),
-      language_rule_index_(new IndexMap),
-      rule_storage_(),
-      region_rules_() {}
+      cache_(new RuleCache(memory_budget)) {}
 
-PreloadSupplier::~PreloadSupplier() {
-  for (auto ptr : rule_storage_) {
-    delete ptr;
-  }
-}
+PreloadSupplier::~PreloadSupplier() = default;
 
 void PreloadSupplier::Supply(const LookupKey& lookup_key,
                              const Supplier::Callback& supplied) {
@@ -290,7 +1080,6 @@ void PreloadSupplier::SupplyGlobally(const LookupKey& lookup_key,
 }
 
 const Rule* PreloadSupplier::GetRule(const LookupKey& lookup_key) const {
-  assert(IsLoaded(lookup_key.GetRegionCode()));
   Supplier::RuleHierarchy hierarchy;
   if (!GetRuleHierarchy(lookup_key, &hierarchy, false)) {
     return nullptr;
@@ -300,30 +1089,85 @@ const Rule* PreloadSupplier::GetRule(const LookupKey& lookup_key) const {
 
 void PreloadSupplier::LoadRules(const std::string& region_code,
                                 const Callback& loaded) {
+  LoadRules(region_code, size(LookupKey::kHierarchy) - 1, loaded);
+}
+
+void PreloadSupplier::LoadRules(const std::string& region_code,
+                                size_t max_depth,
+                                const Callback& loaded) {
+  assert(max_depth < size(LookupKey::kHierarchy));
   const std::string key = KeyFromRegionCode(region_code);
 
-  if (IsLoadedKey(key)) {
-    loaded(true, region_code, 0);
+  // The rules of a region that has been loaded only down to a smaller depth
+  // are loaded again, keeping the rules that are already built.
+  std::shared_ptr<const RegionRules> loaded_rules = cache_->Find(region_code);
+  if (loaded_rules != nullptr) {
+    cache_->Touch(region_code);
+    if (loaded_rules->max_depth >= max_depth) {
+      loaded(true, region_code, 0);
+      return;
+    }
+  }
+
+  if (IsPendingKey(key)) {
     return;
   }
 
+  ScopedCorrelationId correlation(NewCorrelationId());
+  new Helper(region_code, key, max_depth, loaded, *retriever_, &pending_,
+             cache_.get());
+}
+
+bool PreloadSupplier::UnloadRules(const std::string& region_code) {
+  return cache_->Remove(region_code);
+}
+
+void PreloadSupplier::ReloadRules(const std::string& region_code,
+                                  const ReloadCallback& reloaded) {
+  const std::string key = KeyFromRegionCode(region_code);
   if (IsPendingKey(key)) {
     return;
   }
 
-  new Helper(region_code, key, loaded, *retriever_, &pending_,
-             rule_index_.get(), language_rule_index_.get(), &rule_storage_,
-             &region_rules_[region_code]);
+  ScopedCorrelationId correlation(NewCorrelationId());
+  new ReloadHelper(region_code, key, reloaded, *retriever_, &pending_,
+                   cache_.get());
 }
 
 const std::map<std::string, const Rule*>& PreloadSupplier::GetRulesForRegion(
     const std::string& region_code) const {
-  assert(IsLoaded(region_code));
-  return region_rules_.find(region_code)->second;
+  static const auto* const kNoRules = new std::map<std::string, const Rule*>;
+  std::shared_ptr<const RegionRules> rules = cache_->Find(region_code);
+  // The snapshot keeps the rules until it's replaced, see the header.
+  return rules != nullptr ? rules->rules_by_id : *kNoRules;
+}
+
+std::shared_ptr<const std::map<std::string, const Rule*>>
+PreloadSupplier::GetSharedRulesForRegion(const std::string& region_code) const {
+  std::shared_ptr<const RegionRules> rules = cache_->Find(region_code);
+  if (rules == nullptr) {
+    return nullptr;
+  }
+  return std::shared_ptr<const std::map<std::string, const Rule*>>(
+      rules, &rules->rules_by_id);
+}
+
+std::shared_ptr<const RuleTree> PreloadSupplier::GetRuleTree(
+    const std::string& region_code) const {
+  std::shared_ptr<const RegionRules> rules = cache_->Find(region_code);
+  if (rules == nullptr) {
+    return nullptr;
+  }
+  // The tree keeps all the rules of the region.
+  return std::shared_ptr<const RuleTree>(rules, rules->tree.get());
+}
+
+size_t PreloadSupplier::GetGeneration() const {
+  return cache_->GetGeneration();
 }
 
 bool PreloadSupplier::IsLoaded(const std::string& region_code) const {
-  return IsLoadedKey(KeyFromRegionCode(region_code));
+  return cache_->Find(region_code) != nullptr;
 }
 
 bool PreloadSupplier::IsPending(const std::string& region_code) const {
@@ -333,56 +1177,97 @@ bool PreloadSupplier::IsPending(const std::string& region_code) const {
 bool PreloadSupplier::GetRuleHierarchy(const LookupKey& lookup_key,
                                        RuleHierarchy* hierarchy,
                                        const bool search_globally) const {
+  size_t loaded_depth;
+  return GetRuleHierarchy(lookup_key, hierarchy, search_globally,
+                          &loaded_depth);
+}
+
+bool PreloadSupplier::GetRuleHierarchy(const LookupKey& lookup_key,
+                                       RuleHierarchy* hierarchy,
+                                       const bool search_globally,
+                                       size_t* loaded_depth) const {
   assert(hierarchy != nullptr);
+  assert(loaded_depth != nullptr);
+
+  std::shared_ptr<const RegionRules> rules =
+      cache_->Find(lookup_key.GetRegionCode());
+  *loaded_depth = rules != nullptr ? GetLoadedDepth(*rules->tree) : 0;
 
   if (RegionDataConstants::IsSupported(lookup_key.GetRegionCode())) {
+    if (rules == nullptr) {
+      return false;  // No data on COUNTRY level is failure.
+    }
+
     size_t max_depth = std::min(
         lookup_key.GetDepth(),
         RegionDataConstants::GetMaxLookupKeyDepth(lookup_key.GetRegionCode()));
 
-    for (size_t depth = 0; depth <= max_depth; ++depth) {
-      const std::string key = lookup_key.ToKeyString(depth);
+    // Most keys consist of exact sub-keys, which can be found by walking the
+    // rule tree without building any key strings. Keys with human readable
+    // names (or anything else that isn't an exact match) need the rule index.
+    bool found = GetRuleHierarchyFromTree(*rules->tree, lookup_key,
+                                          max_depth, hierarchy);
+    for (size_t depth = 0; !found && depth <= max_depth; ++depth) {
+      const std::string key(lookup_key.ToKeyString(depth));
       const Rule* rule = nullptr;
-      auto it = rule_index_->find(key);
-      if (it != rule_index_->end()) {
+      auto it = rules->index.find(key);
+      if (it != rules->index.end()) {
         rule = it->second;
       } else if (search_globally && depth > 0 &&
                  !hierarchy->rule[0]->GetLanguages().empty()) {
-        it = language_rule_index_->find(key);
-        if (it != language_rule_index_->end()) {
+        it = rules->language_index.find(key);
+        if (it != rules->language_index.end()) {
           rule = it->second;
         }
       }
       if (rule == nullptr) {
-        return depth > 0;  // No data on COUNTRY level is failure.
+        if (depth == 0) {
+          return false;  // No data on COUNTRY level is failure.
+        }
+        break;
       }
       hierarchy->rule[depth] = rule;
     }
+    hierarchy->owner = std::move(rules);
   }
 
   return true;
 }
 
+MemoryUsageMap PreloadSupplier::GetMemoryUsage() const {
+  std::shared_ptr<const RuleCache::Snapshot> snapshot = cache_->GetSnapshot();
+  MemoryUsageMap usage;
+  std::set<const RE2ptr*> matchers;
+  for (const auto& pair : *snapshot) {
+    MemoryUsage* region_usage = &usage[pair.first];
+    *region_usage += pair.second->usage;
+    region_usage->region_rules += GetTreeNodeSize<RuleCache::Snapshot>() +
+                                  GetHeapSize(pair.first);
+    // A matcher is often shared by the rules of the languages of a region.
+    matchers.clear();
+    for (const auto& rule : pair.second->rules) {
+      const RE2ptr* matcher = rule->GetCompiledPostalCodeMatcher();
+      if (matcher != nullptr && matchers.insert(matcher).second) {
+        region_usage->postal_code_matchers +=
+            Rule::EstimateMemoryUsage(*matcher);
+      }
+    }
+  }
+  return usage;
+}
+
 size_t PreloadSupplier::GetLoadedRuleDepth(
     const std::string& region_code) const {
   // We care for the code which has the format of "data/ZZ". Ignore what comes
   // after, such as language code.
+  const size_t prefix_size = sizeof "data/" - 1;
   const size_t code_size = 7;
-  std::string full_code = region_code.substr(0, code_size);
-  size_t depth = 0;
-  auto it = rule_index_->find(full_code);
-  while (it != rule_index_->end()) {
-    const Rule* rule = it->second;
-    depth++;
-    if (rule->GetSubKeys().empty()) return depth;
-    full_code += "/" + rule->GetSubKeys()[0];
-    it = rule_index_->find(full_code);
+  if (region_code.size() < code_size) {
+    return 0;
   }
-  return depth;
-}
-
-bool PreloadSupplier::IsLoadedKey(const std::string& key) const {
-  return rule_index_->find(key) != rule_index_->end();
+  std::shared_ptr<const RuleTree> tree = GetRuleTree(
+      region_code.substr(prefix_size, code_size - prefix_size));
+  return tree != nullptr ? GetLoadedDepth(*tree) : 0;
 }
 
 bool PreloadSupplier::IsPendingKey(const std::string& key) const {
@@ -14,166 +14,366 @@
 
 #include <libaddressinput/region_data_builder.h>
 
-#include <libaddressinput/address_data.h>
+#include <libaddressinput/memory_usage.h>
 #include <libaddressinput/preload_supplier.h>
 #include <libaddressinput/region_data.h>
+#include <libaddressinput/region_tree.h>
 
 #include <cassert>
 #include <cstddef>
+#include <initializer_list>
+#include <limits>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 #include "language.h"
-#include "lookup_key.h"
 #include "region_data_constants.h"
 #include "rule.h"
-#include "util/size.h"
+#include "rule_tree.h"
+#include "util/md5.h"
 
 namespace i18n {
 namespace addressinput {
 
 namespace {
 
-// The maximum depth of lookup keys.
-const size_t kLookupKeysMaxDepth = size(LookupKey::kHierarchy) - 1;
-
 // Does not take ownership of |parent_region|, which is not allowed to be
 // nullptr.
-void BuildRegionTreeRecursively(
-    const std::map<std::string, const Rule*>& rules,
-    std::map<std::string, const Rule*>::const_iterator hint,
-    const LookupKey& parent_key,
-    RegionData* parent_region,
-    const std::vector<std::string>& keys,
-    bool prefer_latin_name,
-    size_t region_max_depth) {
+void BuildRegionTreeRecursively(const RegionTree& tree,
+                                size_t parent,
+                                RegionData* parent_region) {
   assert(parent_region != nullptr);
 
-  LookupKey lookup_key;
-  for (const auto& key : keys) {
-    lookup_key.FromLookupKey(parent_key, key);
-    const std::string lookup_key_string =
-        lookup_key.ToKeyString(kLookupKeysMaxDepth);
-
-    ++hint;
-    if (hint == rules.end() || hint->first != lookup_key_string) {
-      hint = rules.find(lookup_key_string);
-      if (hint == rules.end()) {
-        return;
-      }
-    }
-
-    const Rule* rule = hint->second;
-    assert(rule != nullptr);
-
-    const std::string& local_name = rule->GetName().empty()
-        ? key : rule->GetName();
-    const std::string& name =
-        prefer_latin_name && !rule->GetLatinName().empty()
-            ? rule->GetLatinName() : local_name;
-    RegionData* region = parent_region->AddSubRegion(key, name);
-
-    if (!rule->GetSubKeys().empty() &&
-        region_max_depth > parent_key.GetDepth()) {
-      BuildRegionTreeRecursively(rules,
-                                 hint,
-                                 lookup_key,
-                                 region,
-                                 rule->GetSubKeys(),
-                                 prefer_latin_name,
-                                 region_max_depth);
-    }
+  for (size_t child = tree.GetFirstChild(parent);
+       child < tree.GetChildEnd(parent); ++child) {
+    RegionData* region =
+        parent_region->AddSubRegion(tree.GetKey(child), tree.GetName(child));
+    BuildRegionTreeRecursively(tree, child, region);
   }
 }
 
-// The caller owns the result.
-RegionData* BuildRegion(const std::map<std::string, const Rule*>& rules,
-                        const std::string& region_code,
-                        const Language& language) {
-  AddressData address;
-  address.region_code = region_code;
-
-  LookupKey lookup_key;
-  lookup_key.FromAddress(address);
-
-  auto hint = rules.find(lookup_key.ToKeyString(kLookupKeysMaxDepth));
-  assert(hint != rules.end());
-
-  const Rule* rule = hint->second;
-  assert(rule != nullptr);
-
-  auto* region = new RegionData(region_code);
-
-  // If there are sub-keys for field X, but field X is not used in this region
-  // code, then these sub-keys are skipped over. For example, CH has sub-keys
-  // for field ADMIN_AREA, but CH does not use ADMIN_AREA field.
-  size_t region_max_depth =
-      RegionDataConstants::GetMaxLookupKeyDepth(region_code);
-  if (region_max_depth > 0) {
-    BuildRegionTreeRecursively(rules,
-                               hint,
-                               lookup_key,
-                               region,
-                               rule->GetSubKeys(),
-                               language.has_latin_script,
-                               region_max_depth);
+// Estimates the memory used by the nodes of |tree|, with their pointers in the
+// vectors of their parents. The keys and names are those of the rules, which
+// RegionData only refers to.
+size_t EstimateSize(const RegionTree& tree, size_t node) {
+  size_t size = sizeof(RegionData) + sizeof(RegionData*);
+  for (size_t child = tree.GetFirstChild(node);
+       child < tree.GetChildEnd(node); ++child) {
+    size += EstimateSize(tree, child);
   }
-
-  return region;
+  return size;
 }
 
+// A RegionData, with the tree whose keys and names it refers to.
+struct RegionDataWithRules {
+  explicit RegionDataWithRules(std::shared_ptr<const RegionTree> region_tree)
+      : tree(std::move(region_tree)),
+        data(tree->GetKey(RegionTree::kRoot)) {}
+
+  const std::shared_ptr<const RegionTree> tree;
+  RegionData data;
+};
+
 }  // namespace
 
+// A RegionTree, with the rule tree that it refers to, which keeps the rules
+// from being deleted when the supplier unloads them. That is the rule tree that
+// the supplier had loaded, or one with only the root node if it had none.
+struct RegionDataBuilder::CachedTree {
+  CachedTree(const std::string& region_code,
+             std::shared_ptr<const RuleTree> rule_tree,
+             bool prefer_latin_name,
+             size_t max_depth)
+      : loaded(std::move(rule_tree)),
+        rules(loaded != nullptr
+                  ? loaded
+                  : std::make_shared<const RuleTree>(
+                        region_code, std::map<std::string, const Rule*>())),
+        tree(rules.get(), prefer_latin_name, max_depth) {}
+
+  // What the supplier returned, with which the tree is found to be stale.
+  const std::shared_ptr<const RuleTree> loaded;
+  const std::shared_ptr<const RuleTree> rules;
+  const RegionTree tree;
+};
+
+// A cached result, which is built at most once, by the first thread that asks
+// for it. Only one of |region_data| and |serialized| is used.
+struct RegionDataBuilder::CacheEntry {
+  std::once_flag built;
+  std::shared_ptr<const RegionData> region_data;
+  std::shared_ptr<const SerializedRegionTree> serialized;
+  // The estimated size of the result, which is 0 until it is added to
+  // |cached_size_|.
+  size_t size = 0;
+  // Whether the entry is still in |cache_|.
+  bool cached = true;
+  // The position of the key of the entry in |cache_order_|.
+  CacheKeyList::iterator position;
+};
+
+// static
+const size_t RegionDataBuilder::kUnlimitedMemory =
+    std::numeric_limits<size_t>::max();
+
+// static
+const int RegionDataBuilder::kRegionDataContent = -1;
+
 RegionDataBuilder::RegionDataBuilder(PreloadSupplier* supplier)
+    : RegionDataBuilder(supplier, kUnlimitedMemory) {}
+
+RegionDataBuilder::RegionDataBuilder(PreloadSupplier* supplier,
+                                     size_t memory_budget)
     : supplier_(supplier),
-      cache_() {
+      memory_budget_(memory_budget),
+      mutex_(),
+      cache_(),
+      cache_order_(),
+      cached_size_(0),
+      tree_cache_(),
+      supplier_generation_(0),
+      country_rules_() {
   assert(supplier_ != nullptr);
 }
 
-RegionDataBuilder::~RegionDataBuilder() {
-  for (const auto& outer : cache_) {
-    assert(outer.second != nullptr);
-    for (const auto& inner : *outer.second) {
-      delete inner.second;
-    }
-    delete outer.second;
-  }
-}
+RegionDataBuilder::~RegionDataBuilder() = default;
 
 const RegionData& RegionDataBuilder::Build(
     const std::string& region_code,
     const std::string& ui_language_tag,
     std::string* best_region_tree_language_tag) {
-  assert(supplier_->IsLoaded(region_code));
+  return *BuildShared(region_code, ui_language_tag,
+                      best_region_tree_language_tag);
+}
+
+std::shared_ptr<const RegionData> RegionDataBuilder::BuildShared(
+    const std::string& region_code,
+    const std::string& ui_language_tag,
+    std::string* best_region_tree_language_tag) {
+  std::shared_ptr<CacheEntry> entry = GetCacheEntry(
+      region_code, ui_language_tag, kRegionDataContent,
+      best_region_tree_language_tag,
+      [](const std::shared_ptr<const RegionTree>& tree, CacheEntry* entry) {
+        auto region = std::make_shared<RegionDataWithRules>(tree);
+        BuildRegionTreeRecursively(*tree, RegionTree::kRoot, &region->data);
+        entry->region_data =
+            std::shared_ptr<const RegionData>(region, &region->data);
+        return EstimateSize(*tree, RegionTree::kRoot);
+      });
+  return entry->region_data;
+}
+
+const RegionTree& RegionDataBuilder::BuildTree(
+    const std::string& region_code,
+    const std::string& ui_language_tag,
+    std::string* best_region_tree_language_tag) {
+  assert(best_region_tree_language_tag != nullptr);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::shared_ptr<const Language> best_language =
+      ChooseBestLanguage(region_code, ui_language_tag);
+  *best_region_tree_language_tag = best_language->tag;
+  return *GetRegionTree(region_code, best_language->has_latin_script);
+}
+
+std::shared_ptr<const SerializedRegionTree> RegionDataBuilder::BuildSerialized(
+    const std::string& region_code,
+    const std::string& ui_language_tag,
+    RegionTreeFormat format,
+    std::string* best_region_tree_language_tag) {
+  std::shared_ptr<CacheEntry> entry = GetCacheEntry(
+      region_code, ui_language_tag, format, best_region_tree_language_tag,
+      [format](const std::shared_ptr<const RegionTree>& tree,
+               CacheEntry* entry) {
+        auto serialized = std::make_shared<SerializedRegionTree>();
+        tree->Serialize(format, &serialized->data);
+        serialized->content_hash = MD5String(serialized->data);
+        size_t size = sizeof *serialized + serialized->data.capacity() +
+                      serialized->content_hash.capacity();
+        entry->serialized = std::move(serialized);
+        return size;
+      });
+  return entry->serialized;
+}
+
+void RegionDataBuilder::DropRegion(const std::string& region_code) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (bool prefer_latin_name : {false, true}) {
+    DropTree(region_code, prefer_latin_name);
+  }
+}
+
+void RegionDataBuilder::DropStaleTrees() {
+  // Most calls find that nothing has changed, without looking at the trees.
+  size_t generation = supplier_->GetGeneration();
+  if (supplier_generation_ == generation) {
+    return;
+  }
+  supplier_generation_ = generation;
+  // The supplier has loaded a region to a greater depth, or reloaded, unloaded
+  // or evicted it, so everything built from its old tree is stale.
+  std::vector<std::pair<std::string, bool>> stale;
+  for (const auto& pair : tree_cache_) {
+    if (pair.second->loaded != supplier_->GetRuleTree(pair.first.first)) {
+      stale.push_back(pair.first);
+    }
+  }
+  for (const auto& key : stale) {
+    DropTree(key.first, key.second);
+  }
+}
+
+void RegionDataBuilder::DropTree(const std::string& region_code,
+                                 bool prefer_latin_name) {
+  tree_cache_.erase(std::make_pair(region_code, prefer_latin_name));
+  for (auto it = cache_.begin(); it != cache_.end();) {
+    if (std::get<0>(it->first) == region_code &&
+        std::get<1>(it->first) == prefer_latin_name) {
+      // An entry that is being built is never added to |cached_size_|.
+      cached_size_ -= it->second->size;
+      it->second->cached = false;
+      cache_order_.erase(it->second->position);
+      it = cache_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+size_t RegionDataBuilder::GetCachedSize() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return cached_size_;
+}
+
+MemoryUsageMap RegionDataBuilder::GetMemoryUsage() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  MemoryUsageMap usage;
+  for (const auto& pair : cache_) {
+    usage[std::get<0>(pair.first)].region_data += pair.second->size;
+  }
+  for (const auto& pair : tree_cache_) {
+    usage[pair.first.first].region_data +=
+        pair.second->tree.EstimateMemoryUsage();
+  }
+  for (const auto& pair : country_rules_) {
+    usage[pair.first].rules += pair.second->EstimateMemoryUsage();
+  }
+  return usage;
+}
+
+std::shared_ptr<const Language> RegionDataBuilder::ChooseBestLanguage(
+    const std::string& region_code,
+    const std::string& ui_language_tag) {
+  auto it = country_rules_.find(region_code);
+  if (it == country_rules_.end()) {
+    // No need to copy from default rule first, because only languages and
+    // Latin format are going to be used, which do not exist in the default
+    // rule.
+    auto rule = std::make_unique<Rule>();
+    rule->ParseSerializedRule(RegionDataConstants::GetRegionData(region_code));
+    it = country_rules_.emplace(region_code, std::move(rule)).first;
+  }
+  const Rule& rule = *it->second;
+  return rule.GetLanguages().empty()
+             ? Language::Get("und")
+             : ChooseBestAddressLanguage(rule, *Language::Get(ui_language_tag));
+}
+
+std::shared_ptr<const RegionTree> RegionDataBuilder::GetRegionTree(
+    const std::string& region_code,
+    bool prefer_latin_name) {
+  DropStaleTrees();
+  auto key = std::make_pair(region_code, prefer_latin_name);
+  auto it = tree_cache_.find(key);
+  if (it == tree_cache_.end()) {
+    // If there are sub-keys for field X, but field X is not used in this
+    // region code, then these sub-keys are skipped over. For example, CH has
+    // sub-keys for field ADMIN_AREA, but CH does not use ADMIN_AREA field.
+    size_t region_max_depth =
+        RegionDataConstants::GetMaxLookupKeyDepth(region_code);
+    it = tree_cache_
+             .emplace(key, std::make_shared<const CachedTree>(
+                               region_code, supplier_->GetRuleTree(region_code),
+                               prefer_latin_name, region_max_depth))
+             .first;
+  }
+  return std::shared_ptr<const RegionTree>(it->second, &it->second->tree);
+}
+
+template <typename BuildFunction>
+std::shared_ptr<RegionDataBuilder::CacheEntry>
+RegionDataBuilder::GetCacheEntry(const std::string& region_code,
+                                 const std::string& ui_language_tag,
+                                 int content,
+                                 std::string* best_region_tree_language_tag,
+                                 BuildFunction build) {
   assert(best_region_tree_language_tag != nullptr);
 
-  // Look up the region tree in cache first before building it.
-  auto region_it = cache_.find(region_code);
-  if (region_it == cache_.end()) {
-    region_it = cache_.emplace(region_code, new LanguageRegionMap).first;
+  std::shared_ptr<CacheEntry> entry;
+  std::shared_ptr<const RegionTree> tree;
+  CacheKey key;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::shared_ptr<const Language> best_language =
+        ChooseBestLanguage(region_code, ui_language_tag);
+    *best_region_tree_language_tag = best_language->tag;
+    tree = GetRegionTree(region_code, best_language->has_latin_script);
+
+    key = std::make_tuple(region_code, best_language->has_latin_script,
+                          content);
+    auto it = cache_.find(key);
+    if (it == cache_.end()) {
+      entry = std::make_shared<CacheEntry>();
+      entry->position = cache_order_.insert(cache_order_.end(), key);
+      cache_.emplace(key, entry);
+    } else {
+      entry = it->second;
+      cache_order_.splice(cache_order_.end(), cache_order_, entry->position);
+    }
   }
 
-  // No need to copy from default rule first, because only languages and Latin
-  // format are going to be used, which do not exist in the default rule.
-  Rule rule;
-  rule.ParseSerializedRule(RegionDataConstants::GetRegionData(region_code));
-  static const Language kUndefinedLanguage("und");
-  const Language best_language =
-      rule.GetLanguages().empty()
-          ? kUndefinedLanguage
-          : ChooseBestAddressLanguage(rule, Language(ui_language_tag));
-  *best_region_tree_language_tag = best_language.tag;
-
-  auto language_it = region_it->second->find(best_language.tag);
-  if (language_it == region_it->second->end()) {
-    const auto& rules = supplier_->GetRulesForRegion(region_code);
-    language_it = region_it->second
-                      ->emplace(best_language.tag,
-                                BuildRegion(rules, region_code, best_language))
-                      .first;
+  // Build outside of the lock, so that other trees can be built and returned
+  // meanwhile. The threads that ask for this entry wait here until it's built.
+  size_t size = 0;
+  std::call_once(entry->built,
+                 [&]() { size = build(tree, entry.get()); });
+
+  if (size > 0) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // The entry may have been dropped while it was being built, when it was
+    // the least recently used one.
+    if (entry->cached) {
+      entry->size = size;
+      cached_size_ += size;
+      Evict(key);
+    }
   }
+  return entry;
+}
 
-  return *language_it->second;
+void RegionDataBuilder::Evict(const CacheKey& keep) {
+  // |keep| is not necessarily the most recently used entry, as other threads
+  // may have used others while it was being built. The entries that are still
+  // being built take no memory yet, so dropping them would gain nothing.
+  auto key = cache_order_.begin();
+  while (cached_size_ > memory_budget_ && key != cache_order_.end()) {
+    auto it = cache_.find(*key);
+    assert(it != cache_.end());
+    if (*key == keep || it->second->size == 0) {
+      ++key;
+      continue;
+    }
+    cached_size_ -= it->second->size;
+    it->second->cached = false;
+    cache_.erase(it);
+    key = cache_order_.erase(key);
+  }
 }
 
 }  // namespace addressinput
@@ -0,0 +1,171 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libaddressinput/region_tree.h>
+
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "rule.h"
+#include "rule_tree.h"
+#include "util/memory_usage.h"
+
+namespace i18n {
+namespace addressinput {
+
+namespace {
+
+void AppendJsonString(const std::string& value, std::string* output) {
+  static const char kHexDigits[] = "0123456789abcdef";
+  output->push_back('"');
+  for (char c : value) {
+    if (c == '"' || c == '\\') {
+      output->push_back('\\');
+      output->push_back(c);
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      output->append("\\u00");
+      output->push_back(kHexDigits[(c >> 4) & 0xF]);
+      output->push_back(kHexDigits[c & 0xF]);
+    } else {
+      output->push_back(c);
+    }
+  }
+  output->push_back('"');
+}
+
+void AppendJson(const RegionTree& tree, size_t node, std::string* output) {
+  output->append("{\"key\":");
+  AppendJsonString(tree.GetKey(node), output);
+  output->append(",\"name\":");
+  AppendJsonString(tree.GetName(node), output);
+  if (tree.GetFirstChild(node) < tree.GetChildEnd(node)) {
+    output->append(",\"sub_regions\":[");
+    for (size_t child = tree.GetFirstChild(node);
+         child < tree.GetChildEnd(node); ++child) {
+      if (child != tree.GetFirstChild(node)) {
+        output->push_back(',');
+      }
+      AppendJson(tree, child, output);
+    }
+    output->push_back(']');
+  }
+  output->push_back('}');
+}
+
+void AppendVarint(size_t value, std::string* output) {
+  while (value >= 0x80) {
+    output->push_back(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  output->push_back(static_cast<char>(value));
+}
+
+void AppendBinary(const RegionTree& tree, size_t node, std::string* output) {
+  const std::string& key = tree.GetKey(node);
+  AppendVarint(key.size(), output);
+  output->append(key);
+  const std::string& name = tree.GetName(node);
+  AppendVarint(name.size(), output);
+  output->append(name);
+  AppendVarint(tree.GetChildEnd(node) - tree.GetFirstChild(node), output);
+  for (size_t child = tree.GetFirstChild(node);
+       child < tree.GetChildEnd(node); ++child) {
+    AppendBinary(tree, child, output);
+  }
+}
+
+}  // namespace
+
+// static
+const size_t RegionTree::kRoot = 0;
+
+// static
+const size_t RegionTree::kNoNode = std::numeric_limits<size_t>::max();
+
+RegionTree::RegionTree(const RuleTree* rule_tree,
+                       bool prefer_latin_name,
+                       size_t max_depth)
+    : rule_tree_(rule_tree),
+      prefer_latin_name_(prefer_latin_name),
+      child_ends_() {
+  assert(rule_tree_ != nullptr);
+  assert(kRoot == RuleTree::kRoot);
+  assert(kNoNode == RuleTree::kNoNode);
+  child_ends_.reserve(rule_tree_->size());
+  for (size_t node = 0; node < rule_tree_->size(); ++node) {
+    size_t end = rule_tree_->GetFirstChild(node);
+    if (rule_tree_->GetDepth(node) < max_depth &&
+        rule_tree_->GetRule(node) != nullptr) {
+      while (end < rule_tree_->GetChildEnd(node) &&
+             rule_tree_->GetRule(end) != nullptr) {
+        ++end;
+      }
+    }
+    child_ends_.push_back(end);
+  }
+}
+
+RegionTree::~RegionTree() = default;
+
+const std::string& RegionTree::GetKey(size_t node) const {
+  return rule_tree_->GetSubKey(node);
+}
+
+const std::string& RegionTree::GetName(size_t node) const {
+  const std::string& key = rule_tree_->GetSubKey(node);
+  if (node == kRoot) {
+    return key;
+  }
+  const Rule* rule = rule_tree_->GetRule(node);
+  assert(rule != nullptr);
+  if (prefer_latin_name_ && !rule->GetLatinName().empty()) {
+    return rule->GetLatinName();
+  }
+  return rule->GetName().empty() ? key : rule->GetName();
+}
+
+size_t RegionTree::GetParent(size_t node) const {
+  return rule_tree_->GetParent(node);
+}
+
+size_t RegionTree::GetFirstChild(size_t node) const {
+  return rule_tree_->GetFirstChild(node);
+}
+
+size_t RegionTree::FindChild(size_t node, const std::string& key) const {
+  size_t child = rule_tree_->FindChild(node, key);
+  return child < child_ends_[node] ? child : kNoNode;
+}
+
+void RegionTree::Serialize(RegionTreeFormat format, std::string* output) const {
+  assert(output != nullptr);
+  switch (format) {
+    case REGION_TREE_JSON:
+      AppendJson(*this, kRoot, output);
+      break;
+    case REGION_TREE_BINARY:
+      AppendBinary(*this, kRoot, output);
+      break;
+  }
+}
+
+size_t RegionTree::EstimateMemoryUsage() const {
+  return sizeof *this + GetHeapSize(child_ends_);
+}
+
+}  // namespace addressinput
+}  // namespace i18n
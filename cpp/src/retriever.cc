@@ -15,6 +15,8 @@
 #include "retriever.h"
 
 #include <libaddressinput/callback.h>
+#include <libaddressinput/cancellation.h>
+#include <libaddressinput/metrics.h>
 #include <libaddressinput/source.h>
 #include <libaddressinput/storage.h>
 
@@ -22,8 +24,12 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 
+#include "cancellation_util.h"
+#include "metrics_util.h"
+#include "tracing_util.h"
 #include "validating_storage.h"
 
 namespace i18n {
@@ -36,20 +42,31 @@ class Helper {
   Helper(const Helper&) = delete;
   Helper& operator=(const Helper&) = delete;
 
-  // Does not take ownership of its parameters.
+  // Does not take ownership of its parameters. Copies |token| if it isn't
+  // nullptr. Skips looking for the data in |storage| if |from_source| is true.
   Helper(const std::string& key,
          const Retriever::Callback& retrieved,
          const Source& source,
-         ValidatingStorage* storage)
+         ValidatingStorage* storage,
+         const CancellationToken* token,
+         bool from_source)
       : retrieved_(retrieved),
         source_(source),
         storage_(storage),
         fresh_data_ready_(BuildCallback(this, &Helper::OnFreshDataReady)),
         validated_data_ready_(
             BuildCallback(this, &Helper::OnValidatedDataReady)),
-        stale_data_() {
+        stale_data_(),
+        source_timer_(),
+        span_(TRACE_RETRIEVE, key),
+        source_span_(),
+        token_(CopyToken(token)) {
     assert(storage_ != nullptr);
-    storage_->Get(key, *validated_data_ready_);
+    if (from_source) {
+      GetFreshData(key);
+    } else {
+      storage_->Get(key, *validated_data_ready_);
+    }
   }
 
  private:
@@ -57,9 +74,17 @@ class Helper {
 
   void OnValidatedDataReady(bool success, const std::string& key,
                             std::optional<std::string> data) {
+    ScopedCorrelationId correlation(span_.correlation_id());
     if (success) {
       assert(data != std::nullopt);
-      retrieved_(success, key, *data);
+      span_.End(true, data->size());
+      retrieved_(success, key, &*data);
+      delete this;
+    } else if (IsCancelled(token_)) {
+      // Nobody is waiting for the data anymore, so don't download it.
+      span_.End(false, 0);
+      std::string empty;
+      retrieved_(false, key, &empty);
       delete this;
     } else {
       // Validating storage returns (false, key, stale-data) for valid but stale
@@ -67,22 +92,44 @@ class Helper {
       if (data.has_value() && !data->empty()) {
         stale_data_ = std::move(data).value();
       }
-      source_.Get(key, *fresh_data_ready_);
+      GetFreshData(key);
     }
   }
 
+  void GetFreshData(const std::string& key) {
+    source_timer_.emplace();
+    source_span_.emplace(TRACE_SOURCE_GET, key);
+    source_.Get(key, *fresh_data_ready_);
+  }
+
   void OnFreshDataReady(bool success, const std::string& key,
                         std::optional<std::string> data) {
+    ScopedCorrelationId correlation(span_.correlation_id());
+    assert(source_timer_.has_value());
+    source_timer_->Record(RETRIEVER_SOURCE_TIME, std::string_view());
+    assert(source_span_.has_value());
+    source_span_->End(success, success ? data->size() : 0);
     if (success) {
       assert(data.has_value());
-      retrieved_(true, key, *data);
-      storage_->Put(key, std::move(data).value());
-    } else if (!stale_data_.empty()) {
-      // Reuse the stale data if a download fails. It's better to have slightly
-      // outdated validation rules than to suddenly lose validation ability.
-      retrieved_(true, key, stale_data_);
+      AddToCounter(RETRIEVER_SOURCE_BYTES, std::string_view(), data->size());
+      span_.End(true, data->size());
+      // The callback may consume the buffer, so the storage gets a copy first.
+      // This is the only copy of the data on its way from the source.
+      storage_->PutCopy(key, *data);
+      retrieved_(true, key, &*data);
     } else {
-      retrieved_(false, key, std::string());
+      AddToCounter(RETRIEVER_SOURCE_FAILURES, std::string_view(), 1);
+      if (!stale_data_.empty()) {
+        // Reuse the stale data if a download fails. It's better to have
+        // slightly outdated validation rules than to suddenly lose validation
+        // ability.
+        span_.End(true, stale_data_.size());
+        retrieved_(true, key, &stale_data_);
+      } else {
+        span_.End(false, 0);
+        std::string empty;
+        retrieved_(false, key, &empty);
+      }
     }
     delete this;
   }
@@ -93,6 +140,12 @@ class Helper {
   const std::unique_ptr<const Source::Callback> fresh_data_ready_;
   const std::unique_ptr<const Storage::Callback> validated_data_ready_;
   std::string stale_data_;
+  // Started when the data is requested from the source.
+  std::optional<MetricsTimer> source_timer_;
+  TraceSpanRecorder span_;
+  // Begun when the data is requested from the source.
+  std::optional<TraceSpanRecorder> source_span_;
+  const std::optional<CancellationToken> token_;
 };
 
 }  // namespace
@@ -107,7 +160,18 @@ Retriever::~Retriever() = default;
 
 void Retriever::Retrieve(const std::string& key,
                          const Callback& retrieved) const {
-  new Helper(key, retrieved, *source_, storage_.get());
+  new Helper(key, retrieved, *source_, storage_.get(), nullptr, false);
+}
+
+void Retriever::Retrieve(const std::string& key,
+                         const Callback& retrieved,
+                         const CancellationToken& token) const {
+  new Helper(key, retrieved, *source_, storage_.get(), &token, false);
+}
+
+void Retriever::RetrieveFromSource(const std::string& key,
+                                   const Callback& retrieved) const {
+  new Helper(key, retrieved, *source_, storage_.get(), nullptr, true);
 }
 
 }  // namespace addressinput
@@ -25,11 +25,13 @@
 namespace i18n {
 namespace addressinput {
 
+class CancellationToken;
 class Source;
 class Storage;
 class ValidatingStorage;
 
-// Retrieves data. Sample usage:
+// Retrieves data, passing the buffer that the source or storage delivered it in
+// on to the callback without copying it. Sample usage:
 //    Source* source = ...;
 //    Storage* storage = ...;
 //    Retriever retriever(source, storage);
@@ -38,8 +40,10 @@ class ValidatingStorage;
 //    retriever.Retrieve("data/CA/AB--fr", *retrieved);
 class Retriever {
  public:
+  // The |data| is never nullptr. The callback is free to modify it or to take
+  // its buffer, e.g. to parse it in situ or to swap it into a member variable.
   using Callback =
-      i18n::addressinput::Callback<const std::string&, const std::string&>;
+      i18n::addressinput::Callback<const std::string&, std::string*>;
 
   Retriever(const Retriever&) = delete;
   Retriever& operator=(const Retriever&) = delete;
@@ -57,6 +61,21 @@ class Retriever {
   // Retrieve() will attempt to get fresh data again.
   void Retrieve(const std::string& key, const Callback& retrieved) const;
 
+  // Like the above, but if |token| is cancelled when the data isn't found in
+  // storage, then doesn't request it from the source and invokes |retrieved|
+  // with |success| false right away. Data that the source returns after the
+  // token is cancelled is still placed in storage.
+  void Retrieve(const std::string& key,
+                const Callback& retrieved,
+                const CancellationToken& token) const;
+
+  // Like Retrieve(), but gets the data from |source_| even if |storage_| has
+  // fresh data for |key|, to find out whether the data has changed, and places
+  // it in storage. If the request fails, then invokes |retrieved| with
+  // |success| false, without falling back to the data in storage.
+  void RetrieveFromSource(const std::string& key,
+                          const Callback& retrieved) const;
+
  private:
   std::unique_ptr<const Source> source_;
   std::unique_ptr<ValidatingStorage> storage_;
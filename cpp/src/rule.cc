@@ -17,6 +17,9 @@
 #include <algorithm>
 #include <cassert>
 #include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 
@@ -28,6 +31,7 @@
 #include "messages.h"
 #include "region_data_constants.h"
 #include "util/json.h"
+#include "util/memory_usage.h"
 #include "util/re2ptr.h"
 #include "util/size.h"
 #include "util/string_split.h"
@@ -162,6 +166,51 @@ bool ContainsRegExSpecialCharacters(const std::string& input) {
   return input.find_first_of(R"(([\{?)") != std::string::npos;
 }
 
+// The postal code matchers that are in use, by pattern, and the mutex that
+// guards the table and Rule::postal_code_matcher_owner_. Both are leaked on
+// shutdown, so that matchers can still be deleted while static objects are.
+std::mutex* GetMatcherMutex() {
+  static auto* const mutex = new std::mutex;
+  return mutex;
+}
+
+std::map<std::string, std::weak_ptr<const RE2ptr>>* GetMatchers() {
+  static auto* const matchers =
+      new std::map<std::string, std::weak_ptr<const RE2ptr>>;
+  return matchers;
+}
+
+// Deletes |matcher| and removes it from the table, unless the table has a new
+// matcher for the same pattern already.
+void DeleteMatcher(const RE2ptr* matcher) {
+  {
+    std::lock_guard<std::mutex> lock(*GetMatcherMutex());
+    auto* matchers = GetMatchers();
+    auto it = matchers->find(matcher->ptr->pattern());
+    if (it != matchers->end() && it->second.expired()) {
+      matchers->erase(it);
+    }
+  }
+  delete matcher;
+}
+
+// Returns the matcher for |pattern|, compiling it unless another Rule object
+// uses it already. The matcher is deleted with the last Rule object that uses
+// it. Must be called with the matcher mutex locked. The result is never
+// nullptr, but the matcher might not be ok().
+std::shared_ptr<const RE2ptr> InternPostalCodeMatcher(
+    const std::string& pattern) {
+  std::weak_ptr<const RE2ptr>& interned = (*GetMatchers())[pattern];
+  std::shared_ptr<const RE2ptr> matcher = interned.lock();
+  if (matcher == nullptr) {
+    RE2::Options options;
+    options.set_never_capture(true);
+    matcher.reset(new RE2ptr(new RE2(pattern, options)), &DeleteMatcher);
+    interned = matcher;
+  }
+  return matcher;
+}
+
 }  // namespace
 
 Rule::Rule()
@@ -171,7 +220,9 @@ Rule::Rule()
       required_(),
       sub_keys_(),
       languages_(),
+      postal_code_pattern_(),
       postal_code_matcher_(nullptr),
+      postal_code_matcher_owner_(),
       sole_postal_code_(),
       admin_area_name_message_id_(INVALID_MESSAGE_ID),
       postal_code_name_message_id_(INVALID_MESSAGE_ID),
@@ -186,13 +237,13 @@ Rule::~Rule() = default;
 
 // static
 const Rule& Rule::GetDefault() {
-  // Allocated once and leaked on shutdown.
-  static Rule* default_rule = nullptr;
-  if (default_rule == nullptr) {
-    default_rule = new Rule;
-    default_rule->ParseSerializedRule(
-        RegionDataConstants::GetDefaultRegionData());
-  }
+  // Allocated once and leaked on shutdown. The initialization of a static local
+  // variable is thread-safe.
+  static const Rule* const default_rule = [] {
+    auto* rule = new Rule;
+    rule->ParseSerializedRule(RegionDataConstants::GetDefaultRegionData());
+    return rule;
+  }();
   return *default_rule;
 }
 
@@ -204,11 +255,17 @@ void Rule::CopyFrom(const Rule& rule) {
   required_ = rule.required_;
   sub_keys_ = rule.sub_keys_;
   languages_ = rule.languages_;
-  postal_code_matcher_.reset(
-      rule.postal_code_matcher_ == nullptr
-          ? nullptr
-          : new RE2ptr(new RE2(rule.postal_code_matcher_->ptr->pattern(),
-                               rule.postal_code_matcher_->ptr->options())));
+  postal_code_pattern_ = rule.postal_code_pattern_;
+  {
+    // The previous matcher is released after unlocking, as deleting it locks
+    // the mutex again.
+    std::shared_ptr<const RE2ptr> previous;
+    std::lock_guard<std::mutex> lock(*GetMatcherMutex());
+    previous.swap(postal_code_matcher_owner_);
+    postal_code_matcher_owner_ = rule.postal_code_matcher_owner_;
+    postal_code_matcher_.store(postal_code_matcher_owner_.get(),
+                               std::memory_order_release);
+  }
   sole_postal_code_ = rule.sole_postal_code_;
   admin_area_name_message_id_ = rule.admin_area_name_message_id_;
   postal_code_name_message_id_ = rule.postal_code_name_message_id_;
@@ -220,6 +277,62 @@ void Rule::CopyFrom(const Rule& rule) {
   post_service_url_ = rule.post_service_url_;
 }
 
+const RE2ptr* Rule::GetPostalCodeMatcher() const {
+  const RE2ptr* matcher = postal_code_matcher_.load(std::memory_order_acquire);
+  if (matcher == nullptr) {
+    if (postal_code_pattern_.empty()) {
+      return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(*GetMatcherMutex());
+    if (postal_code_matcher_owner_ == nullptr) {
+      postal_code_matcher_owner_ =
+          InternPostalCodeMatcher(postal_code_pattern_);
+      postal_code_matcher_.store(postal_code_matcher_owner_.get(),
+                                 std::memory_order_release);
+    }
+    matcher = postal_code_matcher_owner_.get();
+  }
+  return matcher->ptr->ok() ? matcher : nullptr;
+}
+
+// static
+size_t Rule::EstimateMemoryUsage(const RE2ptr& matcher) {
+  // What RE2 allocates isn't exposed, but it's dominated by the program and
+  // the parsed regular expression, so the estimate is based on the number of
+  // instructions and the pattern. The factors were measured for the patterns
+  // of the postal codes, which compile to between 5 and 200 instructions.
+  static const size_t kBytesPerInstruction = 96;
+  static const size_t kBytesPerPatternByte = 8;
+  static const size_t kFixedBytes = 800;
+  int program_size = matcher.ptr->ok() ? matcher.ptr->ProgramSize() : 0;
+  return sizeof matcher + sizeof *matcher.ptr + kFixedBytes +
+         kBytesPerInstruction * program_size +
+         kBytesPerPatternByte * matcher.ptr->pattern().size();
+}
+
+size_t Rule::EstimateMemoryUsage() const {
+  size_t size = sizeof *this + GetHeapSize(id_) + GetHeapSize(format_) +
+                GetHeapSize(latin_format_) + GetHeapSize(required_) +
+                GetHeapSize(sub_keys_) + GetHeapSize(languages_) +
+                GetHeapSize(postal_code_pattern_) +
+                GetHeapSize(sole_postal_code_) + GetHeapSize(name_) +
+                GetHeapSize(latin_name_) + GetHeapSize(postal_code_example_) +
+                GetHeapSize(post_service_url_);
+  for (const auto& element : format_) {
+    size += GetHeapSize(element.GetLiteral());
+  }
+  for (const auto& element : latin_format_) {
+    size += GetHeapSize(element.GetLiteral());
+  }
+  for (const auto& sub_key : sub_keys_) {
+    size += GetHeapSize(sub_key);
+  }
+  for (const auto& language : languages_) {
+    size += GetHeapSize(language);
+  }
+  return size;
+}
+
 bool Rule::ParseSerializedRule(const std::string& serialized_rule) {
   Json json;
   if (!json.ParseObject(serialized_rule)) {
@@ -229,39 +342,68 @@ bool Rule::ParseSerializedRule(const std::string& serialized_rule) {
   return true;
 }
 
-void Rule::ParseJsonRule(const Json& json) {
-#ifndef _NDEBUG
-  // Don't remove, see StaticMapChecker comments above.
-  static StaticMapChecker map_checker;
-#endif  // !_NDEBUG
-
-  std::string value;
-  if (json.GetStringValueForKey("id", &value)) {
-    id_.swap(value);
-  }
-
-  if (json.GetStringValueForKey("fmt", &value)) {
-    ParseFormatRule(value, &format_);
-  }
-
-  if (json.GetStringValueForKey("lfmt", &value)) {
-    ParseFormatRule(value, &latin_format_);
+bool Rule::ParseSerializedRuleInSitu(std::string* serialized_rule) {
+  assert(serialized_rule != nullptr);
+  Json json;
+  if (!json.ParseObjectInSitu(serialized_rule)) {
+    return false;
   }
+  ParseJsonRule(json);
+  return true;
+}
 
-  if (json.GetStringValueForKey("require", &value)) {
-    ParseAddressFieldsRequired(value, &required_);
-  }
+void Rule::ParseJsonRule(const Json& json) {
+  // The fields of a serialized rule, in the order that they are read.
+  static const char* const kFields[] = {
+      "id",
+      "fmt",
+      "lfmt",
+      "require",
+      "sub_keys",
+      "languages",
+      "zip",
+      "state_name_type",
+      "zip_name_type",
+      "locality_name_type",
+      "sublocality_name_type",
+      "name",
+      "lname",
+      "zipex",
+      "posturl",
+  };
 
-  if (json.GetStringValueForKey("sub_keys", &value)) {
-    SplitString(value, kSeparator, &sub_keys_);
+  sole_postal_code_.clear();
+  std::string key;
+  std::string value;
+  for (const char* field : kFields) {
+    key.assign(field);
+    if (json.GetStringValueForKey(key, &value)) {
+      ParseJsonField(key, &value);
+    }
   }
+}
 
-  if (json.GetStringValueForKey("languages", &value)) {
-    SplitString(value, kSeparator, &languages_);
-  }
+void Rule::ParseJsonField(const std::string& key, std::string* value) {
+#ifndef _NDEBUG
+  // Don't remove, see StaticMapChecker comments above.
+  static StaticMapChecker map_checker;
+#endif  // !_NDEBUG
 
-  sole_postal_code_.clear();
-  if (json.GetStringValueForKey("zip", &value)) {
+  assert(value != nullptr);
+
+  if (key == "id") {
+    id_.swap(*value);
+  } else if (key == "fmt") {
+    ParseFormatRule(*value, &format_);
+  } else if (key == "lfmt") {
+    ParseFormatRule(*value, &latin_format_);
+  } else if (key == "require") {
+    ParseAddressFieldsRequired(*value, &required_);
+  } else if (key == "sub_keys") {
+    SplitString(*value, kSeparator, &sub_keys_);
+  } else if (key == "languages") {
+    SplitString(*value, kSeparator, &languages_);
+  } else if (key == "zip") {
     // The "zip" field in the JSON data is used in two different ways to
     // validate the postal code. At the country level, the "zip" field indicates
     // a Java compatible regular expression corresponding to all postal codes in
@@ -273,52 +415,36 @@ void Rule::ParseJsonRule(const Json& json) {
     // anchor it at the beginning of the string so that it can be used with
     // RE2::PartialMatch() to perform prefix matching or else with
     // RE2::FullMatch() to perform matching against the entire string.
-    RE2::Options options;
-    options.set_never_capture(true);
-    RE2* matcher = new RE2("^(" + value + ")", options);
-    if (matcher->ok()) {
-      postal_code_matcher_.reset(new RE2ptr(matcher));
-    } else {
-      postal_code_matcher_.reset(nullptr);
-      delete matcher;
-    }
+    //
+    // Most rules never have their postal code validated, so the RE2 object is
+    // only created by GetPostalCodeMatcher().
+    postal_code_pattern_ = "^(" + *value + ")";
+    postal_code_matcher_.store(nullptr, std::memory_order_release);
+    postal_code_matcher_owner_.reset();
     // If the "zip" field is not a regular expression, then it is the sole
     // postal code for this rule.
-    if (!ContainsRegExSpecialCharacters(value)) {
-      sole_postal_code_.swap(value);
+    if (!ContainsRegExSpecialCharacters(*value)) {
+      sole_postal_code_.swap(*value);
+    } else {
+      sole_postal_code_.clear();
     }
-  }
-
-  if (json.GetStringValueForKey("state_name_type", &value)) {
-    admin_area_name_message_id_ = kAdminAreaMessageIds.GetIdFromName(value);
-  }
-
-  if (json.GetStringValueForKey("zip_name_type", &value)) {
-    postal_code_name_message_id_ = kPostalCodeMessageIds.GetIdFromName(value);
-  }
-
-  if (json.GetStringValueForKey("locality_name_type", &value)) {
-    locality_name_message_id_ = kLocalityMessageIds.GetIdFromName(value);
-  }
-
-  if (json.GetStringValueForKey("sublocality_name_type", &value)) {
-    sublocality_name_message_id_ = kSublocalityMessageIds.GetIdFromName(value);
-  }
-
-  if (json.GetStringValueForKey("name", &value)) {
-    name_.swap(value);
-  }
-
-  if (json.GetStringValueForKey("lname", &value)) {
-    latin_name_.swap(value);
-  }
-
-  if (json.GetStringValueForKey("zipex", &value)) {
-    postal_code_example_.swap(value);
-  }
-
-  if (json.GetStringValueForKey("posturl", &value)) {
-    post_service_url_.swap(value);
+  } else if (key == "state_name_type") {
+    admin_area_name_message_id_ = kAdminAreaMessageIds.GetIdFromName(*value);
+  } else if (key == "zip_name_type") {
+    postal_code_name_message_id_ = kPostalCodeMessageIds.GetIdFromName(*value);
+  } else if (key == "locality_name_type") {
+    locality_name_message_id_ = kLocalityMessageIds.GetIdFromName(*value);
+  } else if (key == "sublocality_name_type") {
+    sublocality_name_message_id_ =
+        kSublocalityMessageIds.GetIdFromName(*value);
+  } else if (key == "name") {
+    name_.swap(*value);
+  } else if (key == "lname") {
+    latin_name_.swap(*value);
+  } else if (key == "zipex") {
+    postal_code_example_.swap(*value);
+  } else if (key == "posturl") {
+    post_service_url_.swap(*value);
   }
 }
 
@@ -22,6 +22,8 @@
 
 #include <libaddressinput/address_field.h>
 
+#include <atomic>
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <vector>
@@ -59,9 +61,18 @@ class Rule {
   // format (JSON dictionary).
   bool ParseSerializedRule(const std::string& serialized_rule);
 
+  // Like ParseSerializedRule(), but parses |serialized_rule| in situ, which
+  // leaves it modified in an unspecified way.
+  bool ParseSerializedRuleInSitu(std::string* serialized_rule);
+
   // Reads data from |json|, which must already have parsed a serialized rule.
   void ParseJsonRule(const Json& json);
 
+  // Reads the string |value| of the field |key| of a serialized rule, e.g.
+  // while streaming it with Json::ParseSubDictionaries(). Leaves |value| in an
+  // unspecified state. Ignores keys that aren't rule fields.
+  void ParseJsonField(const std::string& key, std::string* value);
+
   // Returns the ID string for this rule.
   const std::string& GetId() const { return id_; }
 
@@ -95,10 +106,23 @@ class Rule {
   // expression is anchored to the beginning of the string so that it can be
   // used either with RE2::PartialMatch() to perform prefix matching or else
   // with RE2::FullMatch() to perform matching against the entire string.
-  const RE2ptr* GetPostalCodeMatcher() const {
-    return postal_code_matcher_.get();
+  //
+  // The regular expression is compiled on the first call (which is safe to do
+  // concurrently from multiple threads) and shared with all other Rule objects
+  // that have the same postal code format string. It's deleted with the last of
+  // them.
+  const RE2ptr* GetPostalCodeMatcher() const;
+
+  // Returns the postal code matcher if GetPostalCodeMatcher() has compiled it
+  // already, whether it's ok() or not, without compiling it. Otherwise returns
+  // nullptr.
+  const RE2ptr* GetCompiledPostalCodeMatcher() const {
+    return postal_code_matcher_.load(std::memory_order_acquire);
   }
 
+  // Returns the estimated bytes of memory used by |matcher|.
+  static size_t EstimateMemoryUsage(const RE2ptr& matcher);
+
   // Returns the sole postal code for this rule, if there is one.
   const std::string& GetSolePostalCode() const { return sole_postal_code_; }
 
@@ -140,6 +164,10 @@ class Rule {
   // Returns the post service URL string for this rule.
   const std::string& GetPostServiceUrl() const { return post_service_url_; }
 
+  // Returns the estimated bytes of memory used by this object, including its
+  // strings and vectors but not the postal code matcher, which is shared.
+  size_t EstimateMemoryUsage() const;
+
  private:
   std::string id_;
   std::vector<FormatElement> format_;
@@ -147,7 +175,13 @@ class Rule {
   std::vector<AddressField> required_;
   std::vector<std::string> sub_keys_;
   std::vector<std::string> languages_;
-  std::unique_ptr<const RE2ptr> postal_code_matcher_;
+  // The pattern of the postal code matcher, or empty if there is none.
+  std::string postal_code_pattern_;
+  // Set from |postal_code_pattern_| on first use. Owned, together with the
+  // other Rule objects that share it, by |postal_code_matcher_owner_|, which is
+  // guarded by the mutex of the matcher table.
+  mutable std::atomic<const RE2ptr*> postal_code_matcher_;
+  mutable std::shared_ptr<const RE2ptr> postal_code_matcher_owner_;
   std::string sole_postal_code_;
   int admin_area_name_message_id_;
   int postal_code_name_message_id_;
@@ -47,12 +47,12 @@ class Helper {
 
   void OnDataRetrieved(bool success,
                        const std::string& key,
-                       const std::string& data) {
+                       std::string* data) {
     Rule rule;
     if (!success) {
       rule_ready_(false, key, rule);
     } else {
-      success = rule.ParseSerializedRule(data);
+      success = rule.ParseSerializedRuleInSitu(data);
       rule_ready_(success, key, rule);
     }
     delete this;
@@ -0,0 +1,143 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rule_tree.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "rule.h"
+#include "util/memory_usage.h"
+
+namespace i18n {
+namespace addressinput {
+
+namespace {
+
+const char kData[] = "data/";
+const char kSlashDelim[] = "/";
+const char kDashDelim[] = "--";
+
+const Rule* FindRule(const std::map<std::string, const Rule*>& rules,
+                     const std::string& id) {
+  auto it = rules.find(id);
+  return it != rules.end() ? it->second : nullptr;
+}
+
+}  // namespace
+
+const size_t RuleTree::kRoot = 0;
+const size_t RuleTree::kNoNode = std::numeric_limits<size_t>::max();
+const size_t RuleTree::kNoLanguage = std::numeric_limits<size_t>::max();
+
+RuleTree::RuleTree(const std::string& region_code,
+                   const std::map<std::string, const Rule*>& rules)
+    : region_code_(region_code),
+      nodes_(),
+      sorted_children_(),
+      language_count_(1),
+      languages_(1),
+      rules_() {
+  std::vector<std::string> ids(1, kData + region_code_);
+  const Rule* root_rule = FindRule(rules, ids[0]);
+
+  // The default language doesn't have a tag in the ID of a rule, so it's
+  // stored as an empty string.
+  if (root_rule != nullptr && root_rule->GetLanguages().size() > 1) {
+    const std::vector<std::string>& languages = root_rule->GetLanguages();
+    languages_.insert(languages_.end(), languages.begin() + 1,
+                      languages.end());
+    language_count_ = languages_.size();
+  }
+
+  nodes_.push_back({&region_code_, kNoNode, 0, 0, 0});
+
+  // Add the nodes in breadth-first order, so that the children of every node
+  // get consecutive IDs. The IDs of the rules are kept only while building.
+  for (size_t node = 0; node < nodes_.size(); ++node) {
+    // Copied, as |ids| grows below.
+    const std::string id(ids[node]);
+    rules_.push_back(FindRule(rules, id));
+    for (size_t l = 1; l < language_count_; ++l) {
+      rules_.push_back(FindRule(rules, id + kDashDelim + languages_[l]));
+    }
+
+    const Rule* rule = rules_[node * language_count_];
+    nodes_[node].first_child = nodes_.size();
+    if (rule == nullptr) {
+      continue;
+    }
+    const std::vector<std::string>& sub_keys = rule->GetSubKeys();
+    nodes_[node].child_count = sub_keys.size();
+    for (const auto& sub_key : sub_keys) {
+      nodes_.push_back({&sub_key, node, nodes_[node].depth + 1, 0, 0});
+      ids.push_back(id + kSlashDelim + sub_key);
+    }
+  }
+
+  sorted_children_.resize(nodes_.size());
+  std::iota(sorted_children_.begin(), sorted_children_.end(), kRoot);
+  for (const auto& node : nodes_) {
+    auto begin = sorted_children_.begin() + node.first_child;
+    std::sort(begin, begin + node.child_count, [this](size_t a, size_t b) {
+      return *nodes_[a].key < *nodes_[b].key;
+    });
+  }
+}
+
+RuleTree::~RuleTree() = default;
+
+size_t RuleTree::FindLanguage(const std::string& language_tag) const {
+  auto it = std::find(languages_.begin(), languages_.end(), language_tag);
+  return it != languages_.end()
+             ? static_cast<size_t>(it - languages_.begin())
+             : kNoLanguage;
+}
+
+const Rule* RuleTree::GetRule(size_t node, size_t language) const {
+  assert(node < nodes_.size());
+  assert(language < language_count_);
+  return rules_[node * language_count_ + language];
+}
+
+size_t RuleTree::FindChild(size_t node, std::string_view sub_key) const {
+  assert(node < nodes_.size());
+  auto begin = sorted_children_.begin() + nodes_[node].first_child;
+  auto end = begin + nodes_[node].child_count;
+  auto it = std::lower_bound(begin, end, sub_key,
+                             [this](size_t child, std::string_view key) {
+                               return *nodes_[child].key < key;
+                             });
+  return it != end && *nodes_[*it].key == sub_key ? *it : kNoNode;
+}
+
+size_t RuleTree::EstimateMemoryUsage() const {
+  size_t size = sizeof *this + GetHeapSize(region_code_) + GetHeapSize(nodes_) +
+                GetHeapSize(sorted_children_) + GetHeapSize(languages_) +
+                GetHeapSize(rules_);
+  for (const auto& language : languages_) {
+    size += GetHeapSize(language);
+  }
+  return size;
+}
+
+}  // namespace addressinput
+}  // namespace i18n
@@ -0,0 +1,134 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// A tree of the Rule objects loaded for one region, addressed by integers.
+
+#ifndef I18N_ADDRESSINPUT_RULE_TREE_H_
+#define I18N_ADDRESSINPUT_RULE_TREE_H_
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace i18n {
+namespace addressinput {
+
+class Rule;
+
+// Stores the hierarchy of Rule objects of a region as a tree of nodes with
+// dense integer IDs, so that the hierarchy can be walked by array index
+// instead of by building lookup key strings and searching for them. The root
+// node (COUNTRY level) has ID 0, and the children of every node have
+// consecutive IDs, in the same order as the sub-keys of the parent rule.
+// Sample usage:
+//    const RuleTree& tree = ...;
+//    for (size_t child = tree.GetFirstChild(RuleTree::kRoot);
+//         child < tree.GetChildEnd(RuleTree::kRoot); ++child) {
+//      Process(tree.GetSubKey(child), tree.GetRule(child));
+//    }
+//
+// The tree also stores pointers to the Rule objects of all the languages of
+// the region, indexed in the order of the languages of the root rule, where
+// index 0 is the default language.
+//
+// A node is created for every sub-key, even when there is no Rule object for
+// it, in which case GetRule() returns nullptr and the node has no children.
+class RuleTree {
+ public:
+  static const size_t kRoot;
+  static const size_t kNoNode;
+  static const size_t kNoLanguage;
+
+  RuleTree(const RuleTree&) = delete;
+  RuleTree& operator=(const RuleTree&) = delete;
+
+  // Builds the tree for |region_code| out of |rules|, which maps rule IDs to
+  // Rule objects, like PreloadSupplier::GetRulesForRegion() does. Does not
+  // take ownership of the Rule objects, which must outlive this object. If
+  // there is no rule for the root node in |rules|, the tree has only the root
+  // node.
+  RuleTree(const std::string& region_code,
+           const std::map<std::string, const Rule*>& rules);
+  ~RuleTree();
+
+  // Returns the number of nodes in the tree.
+  size_t size() const { return nodes_.size(); }
+
+  // Returns the number of languages of the region, which is at least 1.
+  size_t GetLanguageCount() const { return language_count_; }
+
+  // Returns the index of |language_tag| in the languages of the region, where
+  // the empty string is the default language, or kNoLanguage if the region has
+  // no such language.
+  size_t FindLanguage(const std::string& language_tag) const;
+
+  // Returns the Rule object of |node| in the default language, or nullptr if
+  // there is none.
+  const Rule* GetRule(size_t node) const { return GetRule(node, 0); }
+
+  // Returns the Rule object of |node| in the language with index |language|,
+  // or nullptr if there is none.
+  const Rule* GetRule(size_t node, size_t language) const;
+
+  // Returns the parent of |node|, or kNoNode for the root node.
+  size_t GetParent(size_t node) const { return nodes_[node].parent; }
+
+  // Returns the depth of |node|, which is 0 for the root node.
+  size_t GetDepth(size_t node) const { return nodes_[node].depth; }
+
+  // Returns the range [GetFirstChild(), GetChildEnd()) of the children of
+  // |node|, which is empty if the node has no children.
+  size_t GetFirstChild(size_t node) const { return nodes_[node].first_child; }
+  size_t GetChildEnd(size_t node) const {
+    return nodes_[node].first_child + nodes_[node].child_count;
+  }
+
+  // Returns the sub-key of the parent rule that |node| corresponds to, or the
+  // region code for the root node.
+  const std::string& GetSubKey(size_t node) const { return *nodes_[node].key; }
+
+  // Returns the child of |node| with sub-key |sub_key| (by exact string
+  // comparison), or kNoNode if there is none.
+  size_t FindChild(size_t node, std::string_view sub_key) const;
+
+  // Returns the estimated bytes of memory used by this object, not including
+  // the Rule objects.
+  size_t EstimateMemoryUsage() const;
+
+ private:
+  struct Node {
+    const std::string* key;  // Not owned.
+    size_t parent;
+    size_t depth;
+    size_t first_child;
+    size_t child_count;
+  };
+
+  const std::string region_code_;
+  std::vector<Node> nodes_;
+  // The children of every node, sorted by sub-key, at the same positions as
+  // the children themselves are stored in |nodes_|.
+  std::vector<size_t> sorted_children_;
+  size_t language_count_;
+  std::vector<std::string> languages_;
+  // The Rule objects, at position (node * language_count_ + language).
+  std::vector<const Rule*> rules_;  // Not owned.
+};
+
+}  // namespace addressinput
+}  // namespace i18n
+
+#endif  // I18N_ADDRESSINPUT_RULE_TREE_H_
@@ -0,0 +1,43 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libaddressinput/supplier.h>
+
+#include <libaddressinput/cancellation.h>
+
+namespace i18n {
+namespace addressinput {
+
+void Supplier::Supply(const LookupKey& lookup_key,
+                      const Callback& supplied,
+                      const CancellationToken& token) {
+  if (token.IsCancelled()) {
+    supplied(false, lookup_key, RuleHierarchy());
+  } else {
+    Supply(lookup_key, supplied);
+  }
+}
+
+void Supplier::SupplyGlobally(const LookupKey& lookup_key,
+                              const Callback& supplied,
+                              const CancellationToken& token) {
+  if (token.IsCancelled()) {
+    supplied(false, lookup_key, RuleHierarchy());
+  } else {
+    SupplyGlobally(lookup_key, supplied);
+  }
+}
+
+}  // namespace addressinput
+}  // namespace i18n
@@ -0,0 +1,173 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libaddressinput/tracing.h>
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include "tracing_util.h"
+#include "util/size.h"
+
+namespace i18n {
+namespace addressinput {
+
+namespace {
+
+std::atomic<uint64_t> last_correlation_id(0);
+std::atomic<uint64_t> last_span_id(0);
+thread_local uint64_t current_correlation_id = 0;
+
+const char* GetSpanName(TraceSpanKind kind) {
+  static const char* const kSpanNames[] = {
+      "validate",    "load_rules",  "retrieve",    "storage_get",
+      "source_get",  "storage_put", "supply_load",
+  };
+  static_assert(TRACE_VALIDATE == 0, "bad_base");
+  static_assert(TRACE_SUPPLY_LOAD == size(kSpanNames) - 1, "bad_length");
+  assert(kind >= 0 && static_cast<size_t>(kind) < size(kSpanNames));
+  return kSpanNames[kind];
+}
+
+void AppendJsonString(std::string_view value, std::string* output) {
+  static const char kHexDigits[] = "0123456789abcdef";
+  output->push_back('"');
+  for (char c : value) {
+    if (c == '"' || c == '\\') {
+      output->push_back('\\');
+      output->push_back(c);
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      output->append("\\u00");
+      output->push_back(kHexDigits[(c >> 4) & 0xF]);
+      output->push_back(kHexDigits[c & 0xF]);
+    } else {
+      output->push_back(c);
+    }
+  }
+  output->push_back('"');
+}
+
+}  // namespace
+
+std::atomic<TraceSink*> installed_trace_sink(nullptr);
+
+void SetTraceSink(TraceSink* sink) {
+  installed_trace_sink.store(sink, std::memory_order_release);
+}
+
+TraceSink* GetTraceSink() {
+  return installed_trace_sink.load(std::memory_order_acquire);
+}
+
+uint64_t NewCorrelationId() {
+  return installed_trace_sink.load(std::memory_order_acquire) != nullptr
+             ? last_correlation_id.fetch_add(1, std::memory_order_relaxed) + 1
+             : 0;
+}
+
+uint64_t GetCurrentCorrelationId() { return current_correlation_id; }
+
+ScopedCorrelationId::ScopedCorrelationId(uint64_t correlation_id)
+    : previous_(current_correlation_id) {
+  current_correlation_id = correlation_id;
+}
+
+ScopedCorrelationId::~ScopedCorrelationId() {
+  current_correlation_id = previous_;
+}
+
+void TraceSpanRecorder::Begin(TraceSpanKind kind, std::string_view key) {
+  assert(sink_ != nullptr);
+  key_ = key;
+  span_.id = last_span_id.fetch_add(1, std::memory_order_relaxed) + 1;
+  span_.correlation_id = current_correlation_id;
+  span_.kind = kind;
+  span_.key = key_;
+  sink_->BeginSpan(span_);
+}
+
+void TraceSpanRecorder::Finish(bool success, size_t bytes) {
+  assert(sink_ != nullptr);
+  span_.success = success;
+  span_.bytes = bytes;
+  TraceSink* sink = sink_;
+  sink_ = nullptr;
+  sink->EndSpan(span_);
+}
+
+ChromeTraceExporter::ChromeTraceExporter()
+    : start_(std::chrono::steady_clock::now()), mutex_(), events_() {}
+
+ChromeTraceExporter::~ChromeTraceExporter() = default;
+
+void ChromeTraceExporter::BeginSpan(const TraceSpan& span) {
+  AddEvent(true, span);
+}
+
+void ChromeTraceExporter::EndSpan(const TraceSpan& span) {
+  AddEvent(false, span);
+}
+
+std::string ChromeTraceExporter::GetJson() const {
+  // The spans are async events, which are grouped by their "id" into tracks,
+  // so every correlation ID gets a track of its own with the spans nested.
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::string json = "{\"traceEvents\":[";
+  for (const auto& event : events_) {
+    if (&event != &events_.front()) {
+      json.push_back(',');
+    }
+    json.append("{\"name\":\"");
+    json.append(GetSpanName(event.span.kind));
+    json.append("\",\"cat\":\"libaddressinput\",\"ph\":\"");
+    json.push_back(event.begin ? 'b' : 'e');
+    json.append("\",\"id\":");
+    json.append(std::to_string(event.span.correlation_id));
+    json.append(",\"pid\":1,\"tid\":1,\"ts\":");
+    json.append(std::to_string(event.timestamp));
+    json.append(",\"args\":{\"span\":");
+    json.append(std::to_string(event.span.id));
+    if (event.begin) {
+      json.append(",\"key\":");
+      AppendJsonString(event.key, &json);
+    } else {
+      json.append(",\"success\":");
+      json.append(event.span.success ? "true" : "false");
+      json.append(",\"bytes\":");
+      json.append(std::to_string(event.span.bytes));
+    }
+    json.append("}}");
+  }
+  json.append("],\"displayTimeUnit\":\"ms\"}");
+  return json;
+}
+
+void ChromeTraceExporter::AddEvent(bool begin, const TraceSpan& span) {
+  int64_t timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+                          std::chrono::steady_clock::now() - start_)
+                          .count();
+  std::lock_guard<std::mutex> lock(mutex_);
+  events_.push_back({begin, span, std::string(span.key), timestamp});
+  // The key of the copy must not point to the string of the caller.
+  events_.back().span.key = std::string_view();
+}
+
+}  // namespace addressinput
+}  // namespace i18n
@@ -0,0 +1,101 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Reports spans to the sink installed by SetTraceSink(). The correlation ID of
+// the current operation is kept per thread: every object that continues the
+// operation in a callback takes the ID when it's constructed, and makes it the
+// current one again in its callbacks with ScopedCorrelationId.
+
+#ifndef I18N_ADDRESSINPUT_TRACING_UTIL_H_
+#define I18N_ADDRESSINPUT_TRACING_UTIL_H_
+
+#include <libaddressinput/tracing.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace i18n {
+namespace addressinput {
+
+// The sink installed by SetTraceSink(). Use GetTraceSink() outside of the
+// functions in this file.
+extern std::atomic<TraceSink*> installed_trace_sink;
+
+// Returns a new correlation ID for an operation that starts now, or 0 if no
+// sink is installed.
+uint64_t NewCorrelationId();
+
+// Returns the correlation ID of the operation that the calling thread works on,
+// or 0 if there is none.
+uint64_t GetCurrentCorrelationId();
+
+// Makes |correlation_id| the current one of the calling thread for the lifetime
+// of the object.
+class ScopedCorrelationId {
+ public:
+  ScopedCorrelationId(const ScopedCorrelationId&) = delete;
+  ScopedCorrelationId& operator=(const ScopedCorrelationId&) = delete;
+
+  explicit ScopedCorrelationId(uint64_t correlation_id);
+  ~ScopedCorrelationId();
+
+ private:
+  const uint64_t previous_;
+};
+
+// Begins a span of the current operation when constructed, if a sink is
+// installed, and ends it when End() is called or, as a failure, when destroyed.
+class TraceSpanRecorder {
+ public:
+  TraceSpanRecorder(const TraceSpanRecorder&) = delete;
+  TraceSpanRecorder& operator=(const TraceSpanRecorder&) = delete;
+
+  TraceSpanRecorder(TraceSpanKind kind, std::string_view key)
+      : sink_(installed_trace_sink.load(std::memory_order_acquire)),
+        span_(),
+        key_() {
+    if (sink_ != nullptr) {
+      Begin(kind, key);
+    }
+  }
+
+  ~TraceSpanRecorder() { End(false, 0); }
+
+  // Ends the span, unless it has already ended.
+  void End(bool success, size_t bytes) {
+    if (sink_ != nullptr) {
+      Finish(success, bytes);
+    }
+  }
+
+  // Returns the correlation ID that the span belongs to, or 0 if no sink was
+  // installed when the span began.
+  uint64_t correlation_id() const { return span_.correlation_id; }
+
+ private:
+  void Begin(TraceSpanKind kind, std::string_view key);
+  void Finish(bool success, size_t bytes);
+
+  TraceSink* sink_;  // Not owned. Reset to nullptr when the span ends.
+  TraceSpan span_;
+  std::string key_;
+};
+
+}  // namespace addressinput
+}  // namespace i18n
+
+#endif  // I18N_ADDRESSINPUT_TRACING_UTIL_H_
@@ -26,10 +26,103 @@
 namespace i18n {
 namespace addressinput {
 
+using rapidjson::BaseReaderHandler;
 using rapidjson::Document;
+using rapidjson::InsituStringStream;
+using rapidjson::kParseInsituFlag;
 using rapidjson::kParseValidateEncodingFlag;
+using rapidjson::Reader;
+using rapidjson::SizeType;
+using rapidjson::StringStream;
+using rapidjson::UTF8;
 using rapidjson::Value;
 
+namespace {
+
+// Handles the events of a rapidjson::Reader, passing the string values of the
+// sub dictionaries of the top-level dictionary to a SubDictionaryHandler and
+// ignoring everything else. The key and value buffers are reused for all
+// events, so that they don't need to be allocated again for every string.
+class SubDictionaryReader
+    : public BaseReaderHandler<UTF8<>, SubDictionaryReader> {
+ public:
+  SubDictionaryReader(const SubDictionaryReader&) = delete;
+  SubDictionaryReader& operator=(const SubDictionaryReader&) = delete;
+
+  // Does not take ownership of |handler|, which is not allowed to be nullptr.
+  explicit SubDictionaryReader(Json::SubDictionaryHandler* handler)
+      : handler_(handler),
+        depth_(0),
+        root_is_object_(false),
+        in_sub_dictionary_(false),
+        key_(),
+        value_() {
+    assert(handler_ != nullptr);
+  }
+
+  bool root_is_object() const { return root_is_object_; }
+
+  bool Default() { return true; }
+
+  bool String(const char* str, SizeType length, bool copy) {
+    if (in_sub_dictionary_ && depth_ == 2) {
+      value_.assign(str, length);
+      handler_->StringValue(key_, &value_);
+    }
+    return true;
+  }
+
+  bool Key(const char* str, SizeType length, bool copy) {
+    // The key of a sub dictionary is needed only at its start, so both kinds
+    // of keys can share the same buffer.
+    if (depth_ == 1 || (in_sub_dictionary_ && depth_ == 2)) {
+      key_.assign(str, length);
+    }
+    return true;
+  }
+
+  bool StartObject() {
+    if (depth_ == 0) {
+      root_is_object_ = true;
+    } else if (depth_ == 1) {
+      in_sub_dictionary_ = true;
+      handler_->BeginSubDictionary(key_);
+    }
+    ++depth_;
+    return true;
+  }
+
+  bool EndObject(SizeType member_count) {
+    --depth_;
+    if (in_sub_dictionary_ && depth_ == 1) {
+      in_sub_dictionary_ = false;
+      handler_->EndSubDictionary();
+    }
+    return true;
+  }
+
+  bool StartArray() {
+    ++depth_;
+    return true;
+  }
+
+  bool EndArray(SizeType element_count) {
+    --depth_;
+    return true;
+  }
+
+ private:
+  Json::SubDictionaryHandler* const handler_;
+  // The number of objects and arrays that the current event is nested in.
+  size_t depth_;
+  bool root_is_object_;
+  bool in_sub_dictionary_;
+  std::string key_;
+  std::string value_;
+};
+
+}  // namespace
+
 class Json::JsonImpl {
  public:
   JsonImpl(const JsonImpl&) = delete;
@@ -44,6 +137,17 @@ class Json::JsonImpl {
     valid_ = !document_->HasParseError() && document_->IsObject();
   }
 
+  // Parses |json| in situ, so that it must outlive this object.
+  explicit JsonImpl(std::string* json)
+      : document_(new Document),
+        value_(document_.get()),
+        dictionaries_(),
+        valid_(false) {
+    assert(json != nullptr);
+    document_->ParseInsitu<kParseValidateEncodingFlag>(&(*json)[0]);
+    valid_ = !document_->HasParseError() && document_->IsObject();
+  }
+
   ~JsonImpl() {
     for (auto ptr : dictionaries_) {
       delete ptr;
@@ -114,6 +218,15 @@ bool Json::ParseObject(const std::string& json) {
   return impl_ != nullptr;
 }
 
+bool Json::ParseObjectInSitu(std::string* json) {
+  assert(impl_ == nullptr);
+  impl_.reset(new JsonImpl(json));
+  if (!impl_->valid()) {
+    impl_.reset();
+  }
+  return impl_ != nullptr;
+}
+
 const std::vector<const Json*>& Json::GetSubDictionaries() const {
   assert(impl_ != nullptr);
   return impl_->GetSubDictionaries();
@@ -125,6 +238,30 @@ bool Json::GetStringValueForKey(const std::string& key,
   return impl_->GetStringValueForKey(key, value);
 }
 
+// static
+bool Json::ParseSubDictionaries(const std::string& json,
+                                SubDictionaryHandler* handler) {
+  assert(handler != nullptr);
+  SubDictionaryReader sub_dictionary_reader(handler);
+  StringStream stream(json.c_str());
+  Reader reader;
+  reader.Parse<kParseValidateEncodingFlag>(stream, sub_dictionary_reader);
+  return !reader.HasParseError() && sub_dictionary_reader.root_is_object();
+}
+
+// static
+bool Json::ParseSubDictionariesInSitu(std::string* json,
+                                      SubDictionaryHandler* handler) {
+  assert(json != nullptr);
+  assert(handler != nullptr);
+  SubDictionaryReader sub_dictionary_reader(handler);
+  InsituStringStream stream(&(*json)[0]);
+  Reader reader;
+  reader.Parse<kParseInsituFlag | kParseValidateEncodingFlag>(
+      stream, sub_dictionary_reader);
+  return !reader.HasParseError() && sub_dictionary_reader.root_is_object();
+}
+
 Json::Json(JsonImpl* impl) : impl_(impl) {}
 
 }  // namespace addressinput
@@ -30,16 +30,54 @@ namespace addressinput {
 //    }
 class Json {
  public:
+  // Receives the string values of the sub dictionaries of a JSON dictionary
+  // from ParseSubDictionaries(), in the order that they appear in the JSON.
+  class SubDictionaryHandler {
+   public:
+    virtual ~SubDictionaryHandler() = default;
+
+    // Called at the start of the sub dictionary that is the value of |key| in
+    // the top-level dictionary.
+    virtual void BeginSubDictionary(const std::string& key) = 0;
+
+    // Called for every string value of the current sub dictionary. The handler
+    // is free to modify |value|, e.g. to swap it into a member variable.
+    virtual void StringValue(const std::string& key, std::string* value) = 0;
+
+    // Called at the end of the current sub dictionary.
+    virtual void EndSubDictionary() = 0;
+  };
+
   Json(const Json&) = delete;
   Json& operator=(const Json&) = delete;
 
   Json();
   ~Json();
 
+  // Parses the |json| string in a single pass, without building a document,
+  // and passes the string values of its sub dictionaries to |handler|, which
+  // is the same data that GetSubDictionaries() and GetStringValueForKey() would
+  // give access to. Returns true if |json| is valid and it is an object. If it
+  // isn't, |handler| may already have received some of the data.
+  static bool ParseSubDictionaries(const std::string& json,
+                                   SubDictionaryHandler* handler);
+
+  // Like ParseSubDictionaries(), but parses |json| in situ, decoding the
+  // strings within its buffer instead of copying them into temporary buffers
+  // first, which leaves |json| modified in an unspecified way.
+  static bool ParseSubDictionariesInSitu(std::string* json,
+                                         SubDictionaryHandler* handler);
+
   // Parses the |json| string and returns true if |json| is valid and it is an
   // object.
   bool ParseObject(const std::string& json);
 
+  // Like ParseObject(), but parses |json| in situ, so that the strings of the
+  // document refer to its buffer instead of being copied into the document.
+  // Leaves |json| modified in an unspecified way, and it must be kept available
+  // for as long as this object is used.
+  bool ParseObjectInSitu(std::string* json);
+
   // Returns the list of sub dictionaries. The JSON object must be parsed
   // successfully in ParseObject() before invoking this method. The caller does
   // not own the result.
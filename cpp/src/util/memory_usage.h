@@ -0,0 +1,67 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Helpers for estimating the memory used by standard library containers, for
+// MemoryUsage. The estimates count the bytes requested from the allocator, not
+// what the allocator adds to them.
+
+#ifndef I18N_ADDRESSINPUT_UTIL_MEMORY_USAGE_H_
+#define I18N_ADDRESSINPUT_UTIL_MEMORY_USAGE_H_
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace i18n {
+namespace addressinput {
+
+// The bytes of a node of a std::map or std::set besides its value: the
+// pointers to the parent and the children, and the color.
+const size_t kTreeNodeOverhead = 4 * sizeof(void*);
+
+// Returns the bytes that |str| has allocated, which are none when the string is
+// short enough to be stored inside the object itself.
+inline size_t GetHeapSize(const std::string& str) {
+  const char* data = str.data();
+  const char* object = reinterpret_cast<const char*>(&str);
+  std::less<const char*> less;
+  bool is_inline = !less(data, object) && less(data, object + sizeof str);
+  return is_inline ? 0 : str.capacity() + 1;
+}
+
+// Returns the bytes that |vector| has allocated for its elements, which doesn't
+// include what the elements have allocated themselves.
+template <typename T>
+size_t GetHeapSize(const std::vector<T>& vector) {
+  return vector.capacity() * sizeof(T);
+}
+
+// Returns the bytes of a node of the std::map or std::set type |Tree|.
+template <typename Tree>
+constexpr size_t GetTreeNodeSize() {
+  return kTreeNodeOverhead + sizeof(typename Tree::value_type);
+}
+
+// Returns the region code of a rule ID or a key with the same prefix, for
+// example "CH" for "data/CH/BE--fr", to attribute the memory used for it.
+inline std::string GetRegionCodeOfKey(const std::string& key) {
+  static const size_t kPrefixSize = sizeof "data/" - 1;
+  return key.substr(kPrefixSize < key.size() ? kPrefixSize : key.size(), 2);
+}
+
+}  // namespace addressinput
+}  // namespace i18n
+
+#endif  // I18N_ADDRESSINPUT_UTIL_MEMORY_USAGE_H_
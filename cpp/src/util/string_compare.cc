@@ -42,19 +42,27 @@ std::string ComputeMinPossibleMatch(const std::string& str) {
   return min;
 }
 
+// Returns ComputeMinPossibleMatch(str) from a cache of the calling thread, so
+// that concurrent callers (eg. threads searching the same PreloadSupplier
+// index) neither compute it again nor wait for each other.
+std::string MinPossibleMatch(const std::string& str) {
+  enum { MAX_CACHE_SIZE = 1 << 15 };
+  thread_local lru_cache_using_std<std::string, std::string> cache(
+      &ComputeMinPossibleMatch, MAX_CACHE_SIZE);
+  return cache(str);
+}
+
 }  // namespace
 
 namespace i18n {
 namespace addressinput {
 
 class StringCompare::Impl {
-  enum { MAX_CACHE_SIZE = 1 << 15 };
-
  public:
   Impl(const Impl&) = delete;
   Impl& operator=(const Impl&) = delete;
 
-  Impl() : min_possible_match_(&ComputeMinPossibleMatch, MAX_CACHE_SIZE) {
+  Impl() {
     options_.set_literal(true);
     options_.set_case_sensitive(false);
   }
@@ -67,14 +75,11 @@ class StringCompare::Impl {
   }
 
   bool NaturalLess(const std::string& a, const std::string& b) const {
-    const std::string& min_a(min_possible_match_(a));
-    const std::string& min_b(min_possible_match_(b));
-    return min_a < min_b;
+    return MinPossibleMatch(a) < MinPossibleMatch(b);
   }
 
  private:
   RE2::Options options_;
-  mutable lru_cache_using_std<std::string, std::string> min_possible_match_;
 };
 
 StringCompare::StringCompare() : impl_(new Impl) {}
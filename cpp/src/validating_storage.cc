@@ -18,15 +18,20 @@
 #include "validating_storage.h"
 
 #include <libaddressinput/callback.h>
+#include <libaddressinput/metrics.h>
 #include <libaddressinput/storage.h>
 
 #include <cassert>
+#include <cstddef>
 #include <ctime>
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 
+#include "metrics_util.h"
+#include "tracing_util.h"
 #include "validating_util.h"
 
 namespace i18n {
@@ -43,7 +48,8 @@ class Helper {
          const ValidatingStorage::Callback& data_ready,
          const Storage& wrapped_storage)
       : data_ready_(data_ready),
-        wrapped_data_ready_(BuildCallback(this, &Helper::OnWrappedDataReady)) {
+        wrapped_data_ready_(BuildCallback(this, &Helper::OnWrappedDataReady)),
+        span_(TRACE_STORAGE_GET, key) {
     wrapped_storage.Get(key, *wrapped_data_ready_);
   }
 
@@ -54,22 +60,30 @@ class Helper {
                           std::optional<std::string> data) {
     if (success) {
       assert(data != std::nullopt);
-      bool is_stale =
-          !ValidatingUtil::UnwrapTimestamp(&*data, std::time(nullptr));
-      bool is_corrupted = !ValidatingUtil::UnwrapChecksum(&*data);
-      success = !is_corrupted && !is_stale;
+      bool is_fresh = false;
+      bool is_corrupted =
+          !ValidatingUtil::Unwrap(std::time(nullptr), &*data, &is_fresh);
+      success = !is_corrupted && is_fresh;
       if (is_corrupted) {
+        AddToCounter(RETRIEVER_STORAGE_CORRUPT, std::string_view(), 1);
         data = std::nullopt;
+      } else {
+        AddToCounter(
+            is_fresh ? RETRIEVER_STORAGE_HITS : RETRIEVER_STORAGE_STALE,
+            std::string_view(), 1);
       }
     } else {
+      AddToCounter(RETRIEVER_STORAGE_MISSES, std::string_view(), 1);
       data = std::nullopt;
     }
-    data_ready_(success, key, data);
+    span_.End(success, data.has_value() ? data->size() : 0);
+    data_ready_(success, key, std::move(data));
     delete this;
   }
 
   const Storage::Callback& data_ready_;
   const std::unique_ptr<const Storage::Callback> wrapped_data_ready_;
+  TraceSpanRecorder span_;
 };
 
 }  // namespace
@@ -82,8 +96,19 @@ ValidatingStorage::ValidatingStorage(Storage* storage)
 ValidatingStorage::~ValidatingStorage() = default;
 
 void ValidatingStorage::Put(const std::string& key, std::string data) {
+  TraceSpanRecorder span(TRACE_STORAGE_PUT, key);
+  size_t bytes = data.size();
   ValidatingUtil::Wrap(std::time(nullptr), &data);
   wrapped_storage_->Put(key, std::move(data));
+  span.End(true, bytes);
+}
+
+void ValidatingStorage::PutCopy(const std::string& key,
+                                std::string_view data) {
+  TraceSpanRecorder span(TRACE_STORAGE_PUT, key);
+  wrapped_storage_->Put(key,
+                        ValidatingUtil::WrapCopy(std::time(nullptr), data));
+  span.End(true, data.size());
 }
 
 void ValidatingStorage::Get(const std::string& key,
@@ -23,6 +23,7 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
 
 namespace i18n {
 namespace addressinput {
@@ -46,6 +47,11 @@ class ValidatingStorage : public Storage {
   // Storage implementation.
   void Put(const std::string& key, std::string data) override;
 
+  // Like Put(), but stores a copy of |data|, which the caller keeps. The data
+  // is copied only once, directly into the buffer that is passed on to the
+  // wrapped storage.
+  void PutCopy(const std::string& key, std::string_view data);
+
   // Storage implementation.
   // If the data is invalid, then |data_ready| will be called with (false, key,
   // empty-string). If the data is valid, but stale, then |data_ready| will be
@@ -34,6 +34,7 @@
 #include <cstdlib>
 #include <ctime>
 #include <string>
+#include <string_view>
 
 #include "util/md5.h"
 
@@ -50,6 +51,63 @@ const size_t kChecksumPrefixLength = sizeof kChecksumPrefix - 1;
 
 const char kSeparator = '\n';
 
+// Returns the hexadecimal MD5 checksum of |data|.
+std::string Checksum(std::string_view data) {
+  MD5Digest digest;
+  MD5Sum(data.data(), data.size(), &digest);
+  return MD5DigestToBase16(digest);
+}
+
+// Finds the header that starts at |*offset| in |data|, places its value into
+// |header_value| and moves |*offset| past it, without modifying |data|.
+// Returns |true| if the header format is valid.
+bool FindHeader(const char* header_prefix,
+                size_t header_prefix_length,
+                std::string_view data,
+                size_t* offset,
+                std::string_view* header_value) {
+  assert(header_prefix != nullptr);
+  assert(offset != nullptr);
+  assert(header_value != nullptr);
+
+  if (data.compare(*offset, header_prefix_length, header_prefix,
+                   header_prefix_length) != 0) {
+    return false;
+  }
+
+  size_t value_begin = *offset + header_prefix_length;
+  size_t separator_position = data.find(kSeparator, value_begin);
+  if (separator_position == std::string_view::npos) {
+    return false;
+  }
+
+  *header_value = data.substr(value_begin, separator_position - value_begin);
+  *offset = separator_position + 1;
+  return true;
+}
+
+// Returns |true| if |timestamp_string| is a valid timestamp that is recent with
+// respect to |now|.
+bool IsFresh(const std::string& timestamp_string, time_t now) {
+  if (now < 0) {
+    return false;
+  }
+
+  time_t timestamp = atol(timestamp_string.c_str());
+  if (timestamp < 0) {
+    return false;
+  }
+
+  // One month contains:
+  //    30 days *
+  //    24 hours per day *
+  //    60 minutes per hour *
+  //    60 seconds per minute.
+  static const double kOneMonthInSeconds = 30.0 * 24.0 * 60.0 * 60.0;
+  double age_in_seconds = difftime(now, timestamp);
+  return !(age_in_seconds < 0.0) && age_in_seconds < kOneMonthInSeconds;
+}
+
 // Places the header value into |header_value| parameter and erases the header
 // from |data|. Returns |true| if the header format is valid.
 bool UnwrapHeader(const char* header_prefix,
@@ -83,24 +141,31 @@ bool UnwrapHeader(const char* header_prefix,
 // static
 void ValidatingUtil::Wrap(time_t timestamp, std::string* data) {
   assert(data != nullptr);
+  *data = WrapCopy(timestamp, *data);
+}
+
+// static
+std::string ValidatingUtil::WrapCopy(time_t timestamp, std::string_view data) {
   char timestamp_string[2 + 3 * sizeof timestamp];
   int size = std::snprintf(timestamp_string, sizeof(timestamp_string), "%ld",
                            static_cast<long>(timestamp));
   assert(size > 0);
   assert(size < sizeof timestamp_string);
-  (void)size;
 
-  std::string header;
-  header.append(kTimestampPrefix, kTimestampPrefixLength);
-  header.append(timestamp_string);
-  header.push_back(kSeparator);
+  const std::string checksum = Checksum(data);
+  std::string wrapped;
+  wrapped.reserve(kTimestampPrefixLength + size + kChecksumPrefixLength +
+                  checksum.size() + 2 + data.size());
+  wrapped.append(kTimestampPrefix, kTimestampPrefixLength);
+  wrapped.append(timestamp_string, size);
+  wrapped.push_back(kSeparator);
 
-  header.append(kChecksumPrefix, kChecksumPrefixLength);
-  header.append(MD5String(*data));
-  header.push_back(kSeparator);
+  wrapped.append(kChecksumPrefix, kChecksumPrefixLength);
+  wrapped.append(checksum);
+  wrapped.push_back(kSeparator);
 
-  data->reserve(header.size() + data->size());
-  data->insert(0, header);
+  wrapped.append(data);
+  return wrapped;
 }
 
 // static
@@ -116,19 +181,7 @@ bool ValidatingUtil::UnwrapTimestamp(std::string* data, time_t now) {
     return false;
   }
 
-  time_t timestamp = atol(timestamp_string.c_str());
-  if (timestamp < 0) {
-    return false;
-  }
-
-  // One month contains:
-  //    30 days *
-  //    24 hours per day *
-  //    60 minutes per hour *
-  //    60 seconds per minute.
-  static const double kOneMonthInSeconds = 30.0 * 24.0 * 60.0 * 60.0;
-  double age_in_seconds = difftime(now, timestamp);
-  return !(age_in_seconds < 0.0) && age_in_seconds < kOneMonthInSeconds;
+  return IsFresh(timestamp_string, now);
 }
 
 // static
@@ -141,5 +194,24 @@ bool ValidatingUtil::UnwrapChecksum(std::string* data) {
   return checksum == MD5String(*data);
 }
 
+// static
+bool ValidatingUtil::Unwrap(time_t now, std::string* data, bool* is_fresh) {
+  assert(data != nullptr);
+  assert(is_fresh != nullptr);
+  size_t offset = 0;
+  std::string_view timestamp_string;
+  std::string_view checksum;
+  if (!FindHeader(kTimestampPrefix, kTimestampPrefixLength, *data, &offset,
+                  &timestamp_string) ||
+      !FindHeader(kChecksumPrefix, kChecksumPrefixLength, *data, &offset,
+                  &checksum) ||
+      checksum != Checksum(std::string_view(*data).substr(offset))) {
+    return false;
+  }
+  *is_fresh = IsFresh(std::string(timestamp_string), now);
+  data->erase(0, offset);
+  return true;
+}
+
 }  // namespace addressinput
 }  // namespace i18n
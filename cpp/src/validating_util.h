@@ -21,6 +21,7 @@
 
 #include <ctime>
 #include <string>
+#include <string_view>
 
 namespace i18n {
 namespace addressinput {
@@ -40,6 +41,10 @@ class ValidatingUtil {
   // Adds checksum and given |timestamp| to |data|.
   static void Wrap(time_t timestamp, std::string* data);
 
+  // Returns a copy of |data| with checksum and given |timestamp|, which copies
+  // the bytes of |data| only once, for data that the caller keeps using.
+  static std::string WrapCopy(time_t timestamp, std::string_view data);
+
   // Strips out the timestamp from |data|. Returns |true| if the timestamp is
   // present, formatted correctly, valid, and recent with respect to |now|.
   static bool UnwrapTimestamp(std::string* data, time_t now);
@@ -48,6 +53,13 @@ class ValidatingUtil {
   // present, formatted correctly, and valid for this data.
   static bool UnwrapChecksum(std::string* data);
 
+  // Strips out both the timestamp and the checksum from |data|, moving the
+  // bytes of the data within its buffer only once. Returns |false|, leaving
+  // |data| unchanged, if the data is corrupted, i.e. if UnwrapChecksum() would
+  // fail after UnwrapTimestamp(). Otherwise sets |is_fresh| to what
+  // UnwrapTimestamp() would return.
+  static bool Unwrap(time_t now, std::string* data, bool* is_fresh);
+
   ValidatingUtil(const ValidatingUtil&) = delete;
   ValidatingUtil& operator=(const ValidatingUtil&) = delete;
 };
@@ -15,21 +15,28 @@
 #include "validation_task.h"
 
 #include <libaddressinput/address_data.h>
+#include <libaddressinput/address_data_view.h>
 #include <libaddressinput/address_field.h>
 #include <libaddressinput/address_metadata.h>
 #include <libaddressinput/address_problem.h>
 #include <libaddressinput/address_validator.h>
 #include <libaddressinput/callback.h>
+#include <libaddressinput/cancellation.h>
+#include <libaddressinput/metrics.h>
+#include <libaddressinput/preload_supplier.h>
 #include <libaddressinput/supplier.h>
 
 #include <algorithm>
 #include <cassert>
 #include <cstddef>
+#include <sstream>
 #include <string>
 
 #include <re2/re2.h>
 
+#include "cancellation_util.h"
 #include "lookup_key.h"
+#include "metrics_util.h"
 #include "post_box_matchers.h"
 #include "rule.h"
 #include "util/re2ptr.h"
@@ -41,36 +48,99 @@ namespace addressinput {
 ValidationTask::ValidationTask(const AddressData& address, bool allow_postal,
                                bool require_name, const FieldProblemMap* filter,
                                FieldProblemMap* problems,
-                               const AddressValidator::Callback& validated)
+                               const AddressValidator::Callback& validated,
+                               const CancellationToken* token)
     : address_(address),
+      address_data_(&address),
       allow_postal_(allow_postal),
       require_name_(require_name),
       filter_(filter),
       problems_(problems),
-      validated_(validated),
+      validated_(&validated),
       supplied_(BuildCallback(this, &ValidationTask::Validate)),
-      lookup_key_(new LookupKey),
-      max_depth_(size(LookupKey::kHierarchy)) {
+      lookup_key_(),
+      max_depth_(size(LookupKey::kHierarchy)),
+      span_(),
+      token_(CopyToken(token)) {
   assert(problems_ != nullptr);
   assert(supplied_ != nullptr);
-  assert(lookup_key_ != nullptr);
+}
+
+ValidationTask::ValidationTask(const AddressDataView& address,
+                               bool allow_postal, bool require_name,
+                               const FieldProblemMap* filter,
+                               FieldProblemMap* problems)
+    : address_(address),
+      address_data_(nullptr),
+      allow_postal_(allow_postal),
+      require_name_(require_name),
+      filter_(filter),
+      problems_(problems),
+      validated_(nullptr),
+      supplied_(),
+      lookup_key_(),
+      max_depth_(size(LookupKey::kHierarchy)),
+      span_(),
+      token_() {
+  assert(problems_ != nullptr);
 }
 
 ValidationTask::~ValidationTask() = default;
 
 void ValidationTask::Run(Supplier* supplier) {
   assert(supplier != nullptr);
+  assert(supplied_ != nullptr);
+  span_.emplace(TRACE_VALIDATE, address_.region_code);
+  problems_->clear();
+  lookup_key_.FromAddress(address_);
+  max_depth_ =
+      supplier->GetLoadedRuleDepth(std::string(lookup_key_.ToKeyString(0)));
+  if (token_.has_value()) {
+    supplier->SupplyGlobally(lookup_key_, *supplied_, *token_);
+  } else {
+    supplier->SupplyGlobally(lookup_key_, *supplied_);
+  }
+}
+
+bool ValidationTask::RunNow(const PreloadSupplier& supplier) {
+  assert(validated_ == nullptr);  // Not to be used with a callback.
   problems_->clear();
-  lookup_key_->FromAddress(address_);
-  max_depth_ = supplier->GetLoadedRuleDepth(lookup_key_->ToKeyString(0));
-  supplier->SupplyGlobally(*lookup_key_, *supplied_);
+  lookup_key_.FromAddress(address_);
+  Supplier::RuleHierarchy hierarchy;
+  bool success =
+      supplier.GetRuleHierarchy(lookup_key_, &hierarchy, true, &max_depth_);
+  Check(success, hierarchy);
+  return success;
 }
 
 void ValidationTask::Validate(bool success,
                               const LookupKey& lookup_key,
                               const Supplier::RuleHierarchy& hierarchy) {
-  assert(&lookup_key == lookup_key_.get());  // Sanity check.
+  assert(&lookup_key == &lookup_key_);  // Sanity check.
+  assert(validated_ != nullptr);
+
+  // The caller may have deleted the address, the problems and the callback
+  // once the token is cancelled, so none of them can be accessed then.
+  CancellationLock lock(token_);
+  if (lock.IsCancelled()) {
+    if (span_.has_value()) {
+      span_->End(false, 0);
+    }
+    delete this;
+    return;
+  }
+
+  Check(success, hierarchy);
+  if (span_.has_value()) {
+    span_->End(success, 0);
+  }
 
+  (*validated_)(success, *address_data_, *problems_);
+  delete this;
+}
+
+void ValidationTask::Check(bool success,
+                           const Supplier::RuleHierarchy& hierarchy) const {
   if (success) {
     if (address_.IsFieldEmpty(COUNTRY)) {
       ReportProblemMaybe(COUNTRY, MISSING_REQUIRED_FIELD);
@@ -78,7 +148,7 @@ void ValidationTask::Validate(bool success,
       ReportProblemMaybe(COUNTRY, UNKNOWN_VALUE);
     } else {
       // Checks which use statically linked metadata.
-      const std::string& region_code = address_.region_code;
+      const std::string region_code(address_.region_code);
       CheckUnexpectedField(region_code);
       CheckMissingRequiredField(region_code);
 
@@ -92,8 +162,17 @@ void ValidationTask::Validate(bool success,
     }
   }
 
-  validated_(success, address_, *problems_);
-  delete this;
+  const char* outcome =
+      !success ? "failed" : problems_->empty() ? "valid" : "invalid";
+  AddToCounter(VALIDATOR_VALIDATIONS, outcome, 1);
+  // Don't even format the problem names unless there is a sink to report to.
+  if (GetMetricsSink() != nullptr) {
+    for (const auto& problem : *problems_) {
+      std::ostringstream check;
+      check << problem.second;
+      AddToCounter(VALIDATOR_PROBLEMS, check.str(), 1);
+    }
+  }
 }
 
 // A field will return an UNEXPECTED_FIELD problem type if the current value of
@@ -151,7 +230,10 @@ void ValidationTask::CheckMissingRequiredField(
 // of that field to one of those possible values, therefore returning nullptr.
 void ValidationTask::CheckUnknownValue(
     const Supplier::RuleHierarchy& hierarchy) const {
-  for (size_t depth = 1; depth < size(LookupKey::kHierarchy); ++depth) {
+  // The values of the fields below the loaded rules can't be known, which
+  // CheckUnsupportedField() reports instead.
+  const size_t max_depth = std::min(max_depth_, size(LookupKey::kHierarchy));
+  for (size_t depth = 1; depth < max_depth; ++depth) {
     AddressField field = LookupKey::kHierarchy[depth];
     if (!(address_.IsFieldEmpty(field) ||
           hierarchy.rule[depth - 1] == nullptr ||
@@ -230,10 +312,10 @@ void ValidationTask::CheckUsesPoBox(
   }
 
   const auto matchers = PostBoxMatchers::GetMatchers(country_rule);
-  for (const auto& line : address_.address_line) {
+  for (size_t i = 0; i < address_.address_line.size(); ++i) {
     for (auto ptr : matchers) {
       assert(ptr != nullptr);
-      if (RE2::PartialMatch(line, *ptr->ptr)) {
+      if (RE2::PartialMatch(address_.address_line[i], *ptr->ptr)) {
         ReportProblem(STREET_ADDRESS, USES_P_O_BOX);
         return;
       }
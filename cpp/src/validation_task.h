@@ -15,24 +15,38 @@
 #ifndef I18N_ADDRESSINPUT_VALIDATION_TASK_H_
 #define I18N_ADDRESSINPUT_VALIDATION_TASK_H_
 
+#include <libaddressinput/address_data_view.h>
 #include <libaddressinput/address_field.h>
 #include <libaddressinput/address_problem.h>
 #include <libaddressinput/address_validator.h>
+#include <libaddressinput/cancellation.h>
 #include <libaddressinput/supplier.h>
 
 #include <memory>
+#include <optional>
 #include <string>
 
+#include "lookup_key.h"
+#include "tracing_util.h"
+
 namespace i18n {
 namespace addressinput {
 
-class LookupKey;
+class PreloadSupplier;
 struct AddressData;
 
 // A ValidationTask object encapsulates the information necessary to perform
 // validation of one particular address and call a callback when that has been
 // done. Calling the Run() method will load required metadata, then perform
 // validation, call the callback and delete the ValidationTask object itself.
+//
+// A ValidationTask object constructed without a callback can instead be
+// allocated on the stack and used for synchronous validation by calling the
+// RunNow() method, which neither calls any callback nor deletes the object.
+//
+// If the task is given a CancellationToken, then once the token is cancelled it
+// neither writes to the problems nor calls the callback, and only deletes
+// itself when the supplier calls back.
 class ValidationTask {
  public:
   ValidationTask(const ValidationTask&) = delete;
@@ -43,13 +57,27 @@ class ValidationTask {
                  bool require_name,
                  const FieldProblemMap* filter,
                  FieldProblemMap* problems,
-                 const AddressValidator::Callback& validated);
+                 const AddressValidator::Callback& validated,
+                 const CancellationToken* token);
+
+  // Constructs a ValidationTask for use with RunNow() only.
+  ValidationTask(const AddressDataView& address,
+                 bool allow_postal,
+                 bool require_name,
+                 const FieldProblemMap* filter,
+                 FieldProblemMap* problems);
 
   ~ValidationTask();
 
   // Calls supplier->Load(), with Validate() as callback.
   void Run(Supplier* supplier);
 
+  // Uses the address metadata already loaded into |supplier| to validate
+  // |address_|, writing problems found into |problems_|. Returns the success
+  // status that Run() would have passed to the callback. Does not allocate any
+  // memory except for the problems reported.
+  bool RunNow(const PreloadSupplier& supplier);
+
  private:
   friend class ValidationTaskTest;
 
@@ -60,6 +88,10 @@ class ValidationTask {
                 const LookupKey& lookup_key,
                 const Supplier::RuleHierarchy& hierarchy);
 
+  // Uses the address metadata of |hierarchy| to validate |address_|, writing
+  // problems found into |problems_|, if |success| is true.
+  void Check(bool success, const Supplier::RuleHierarchy& hierarchy) const;
+
   // Checks all fields for UNEXPECTED_FIELD problems.
   void CheckUnexpectedField(const std::string& region_code) const;
 
@@ -88,15 +120,21 @@ class ValidationTask {
   // Returns whether (|field|,|problem|) should be reported.
   bool ShouldReport(AddressField field, AddressProblem problem) const;
 
-  const AddressData& address_;
+  const AddressDataView address_;
+  // The address passed back to the |validated_| callback, or nullptr if there
+  // is no callback.
+  const AddressData* const address_data_;
   const bool allow_postal_;
   const bool require_name_;
   const FieldProblemMap* filter_;
   FieldProblemMap* const problems_;
-  const AddressValidator::Callback& validated_;
+  const AddressValidator::Callback* const validated_;
   const std::unique_ptr<const Supplier::Callback> supplied_;
-  const std::unique_ptr<LookupKey> lookup_key_;
+  LookupKey lookup_key_;
   size_t max_depth_;
+  // Begun by Run() and ended by Validate(), if Run() was called.
+  std::optional<TraceSpanRecorder> span_;
+  const std::optional<CancellationToken> token_;
 };
 
 }  // namespace addressinput
@@ -0,0 +1,201 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libaddressinput/address_data_view.h>
+
+#include <libaddressinput/address_data.h>
+#include <libaddressinput/address_field.h>
+#include <libaddressinput/address_formatter.h>
+#include <libaddressinput/address_validator.h>
+#include <libaddressinput/callback.h>
+#include <libaddressinput/null_storage.h>
+#include <libaddressinput/preload_supplier.h>
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "lookup_key.h"
+#include "testdata_source.h"
+
+namespace {
+
+using i18n::addressinput::AddressData;
+using i18n::addressinput::AddressDataView;
+using i18n::addressinput::AddressLinesView;
+using i18n::addressinput::AddressValidator;
+using i18n::addressinput::BuildCallback;
+using i18n::addressinput::FieldProblemMap;
+using i18n::addressinput::GetFormattedNationalAddress;
+using i18n::addressinput::GetStreetAddressLinesAsSingleLine;
+using i18n::addressinput::LookupKey;
+using i18n::addressinput::NullStorage;
+using i18n::addressinput::PreloadSupplier;
+using i18n::addressinput::TestdataSource;
+
+using i18n::addressinput::COUNTRY;
+using i18n::addressinput::ADMIN_AREA;
+using i18n::addressinput::LOCALITY;
+using i18n::addressinput::DEPENDENT_LOCALITY;
+using i18n::addressinput::SORTING_CODE;
+using i18n::addressinput::POSTAL_CODE;
+using i18n::addressinput::STREET_ADDRESS;
+using i18n::addressinput::ORGANIZATION;
+using i18n::addressinput::RECIPIENT;
+
+// The fields of an address as they would be stored in the buffers of a caller,
+// with the street address lines next to each other.
+const std::string_view kStreet[] = {"Brandschenkestrasse 110", "Floor 4"};
+
+AddressDataView BuildView() {
+  AddressDataView address;
+  address.region_code = "CH";
+  address.address_line = AddressLinesView(kStreet, 2);
+  address.locality = "Zürich";
+  address.postal_code = "8002";
+  address.language_code = "de";
+  address.organization = "Google";
+  address.recipient = "Test";
+  return address;
+}
+
+TEST(AddressDataViewTest, ViewOfAddressData) {
+  const AddressData address{
+      .region_code = "rrr",
+      .address_line{"aaa", "222"},
+      .administrative_area = "sss",
+      .locality = "ccc",
+      .dependent_locality = "ddd",
+      .postal_code = "zzz",
+      .sorting_code = "xxx",
+      .language_code = "lll",
+      .organization = "ooo",
+      .recipient = "nnn",
+  };
+  const AddressDataView view(address);
+
+  // The view refers to the strings of the address instead of copying them.
+  EXPECT_EQ(address.region_code.data(), view.region_code.data());
+  EXPECT_EQ(address.address_line[1].data(), view.address_line[1].data());
+
+  EXPECT_EQ("rrr", view.GetFieldValue(COUNTRY));
+  EXPECT_EQ("sss", view.GetFieldValue(ADMIN_AREA));
+  EXPECT_EQ("ccc", view.GetFieldValue(LOCALITY));
+  EXPECT_EQ("ddd", view.GetFieldValue(DEPENDENT_LOCALITY));
+  EXPECT_EQ("xxx", view.GetFieldValue(SORTING_CODE));
+  EXPECT_EQ("zzz", view.GetFieldValue(POSTAL_CODE));
+  EXPECT_EQ("ooo", view.GetFieldValue(ORGANIZATION));
+  EXPECT_EQ("nnn", view.GetFieldValue(RECIPIENT));
+  EXPECT_EQ("lll", view.language_code);
+  ASSERT_EQ(2U, view.address_line.size());
+  EXPECT_EQ("aaa", view.address_line.front());
+  EXPECT_EQ("222", view.address_line.back());
+
+  EXPECT_EQ(address, view.ToAddressData());
+}
+
+TEST(AddressDataViewTest, LinesOfViews) {
+  const std::vector<std::string_view> lines{"aaa", "bbb", "ccc"};
+  const AddressLinesView view(lines);
+  ASSERT_EQ(3U, view.size());
+  EXPECT_FALSE(view.empty());
+  EXPECT_EQ(lines[1].data(), view[1].data());
+  EXPECT_TRUE(AddressLinesView().empty());
+  EXPECT_TRUE(AddressLinesView(nullptr, 0).empty());
+}
+
+TEST(AddressDataViewTest, IsFieldEmpty) {
+  AddressDataView address;
+  EXPECT_TRUE(address.IsFieldEmpty(COUNTRY));
+  EXPECT_TRUE(address.IsFieldEmpty(STREET_ADDRESS));
+
+  address.region_code = " \t";
+  EXPECT_TRUE(address.IsFieldEmpty(COUNTRY));
+  address.region_code = "rrr";
+  EXPECT_FALSE(address.IsFieldEmpty(COUNTRY));
+
+  const std::string_view kBlankLines[] = {"", " "};
+  address.address_line = AddressLinesView(kBlankLines, 2);
+  EXPECT_TRUE(address.IsFieldEmpty(STREET_ADDRESS));
+  address.address_line = AddressLinesView(kStreet, 1);
+  EXPECT_FALSE(address.IsFieldEmpty(STREET_ADDRESS));
+}
+
+TEST(AddressDataViewTest, LookupKeyFromView) {
+  const AddressDataView view = BuildView();
+  const AddressData address = view.ToAddressData();
+  LookupKey from_view;
+  from_view.FromAddress(view);
+  LookupKey from_address;
+  from_address.FromAddress(address);
+  EXPECT_EQ(from_address.ToKeyString(3), from_view.ToKeyString(3));
+  EXPECT_EQ(view.region_code, from_view.GetRegionCode());
+}
+
+TEST(AddressDataViewTest, FormatView) {
+  const AddressDataView view = BuildView();
+  const AddressData address = view.ToAddressData();
+  std::vector<std::string> from_view;
+  GetFormattedNationalAddress(view, &from_view);
+  std::vector<std::string> from_address;
+  GetFormattedNationalAddress(address, &from_address);
+  EXPECT_EQ(from_address, from_view);
+  EXPECT_EQ("Google", from_view.front());
+
+  std::string line;
+  GetStreetAddressLinesAsSingleLine(view, &line);
+  EXPECT_EQ("Brandschenkestrasse 110, Floor 4", line);
+}
+
+class AddressDataViewValidationTest : public testing::Test {
+ public:
+  AddressDataViewValidationTest(const AddressDataViewValidationTest&) = delete;
+  AddressDataViewValidationTest& operator=(
+      const AddressDataViewValidationTest&) = delete;
+
+ protected:
+  AddressDataViewValidationTest()
+      : supplier_(new TestdataSource(true), new NullStorage),
+        loaded_(BuildCallback(this, &AddressDataViewValidationTest::Loaded)) {
+    supplier_.LoadRules("CH", *loaded_);
+  }
+
+  PreloadSupplier supplier_;
+  const std::unique_ptr<const PreloadSupplier::Callback> loaded_;
+
+ private:
+  void Loaded(bool success, const std::string&, int) { ASSERT_TRUE(success); }
+};
+
+TEST_F(AddressDataViewValidationTest, ValidateNowView) {
+  AddressDataView view = BuildView();
+  for (const char* postal_code : {"8002", "80020"}) {
+    view.postal_code = postal_code;
+    FieldProblemMap from_view;
+    EXPECT_TRUE(AddressValidator::ValidateNow(supplier_, view, false, false,
+                                              nullptr, &from_view));
+    FieldProblemMap from_address;
+    EXPECT_TRUE(AddressValidator::ValidateNow(supplier_, view.ToAddressData(),
+                                              false, false, nullptr,
+                                              &from_address));
+    EXPECT_EQ(from_address, from_view);
+    EXPECT_EQ(view.postal_code == "8002" ? 0U : 1U,
+              from_view.count(POSTAL_CODE));
+  }
+}
+
+}  // namespace
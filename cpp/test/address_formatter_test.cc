@@ -15,18 +15,60 @@
 #include <libaddressinput/address_formatter.h>
 
 #include <libaddressinput/address_data.h>
+#include <libaddressinput/task_runner.h>
 
+#include <atomic>
+#include <cstddef>
+#include <functional>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <gtest/gtest.h>
 
+#include "region_data_constants.h"
+
 namespace {
 
 using i18n::addressinput::AddressData;
+using i18n::addressinput::AppendFormattedNationalAddress;
+using i18n::addressinput::AppendFormattedNationalAddressLine;
+using i18n::addressinput::FORMAT_BATCH_LINES;
+using i18n::addressinput::FORMAT_BATCH_SINGLE_LINE;
+using i18n::addressinput::FormatBatch;
+using i18n::addressinput::FormattedAddressBatch;
 using i18n::addressinput::GetFormattedNationalAddress;
 using i18n::addressinput::GetFormattedNationalAddressLine;
 using i18n::addressinput::GetStreetAddressLinesAsSingleLine;
+using i18n::addressinput::RegionDataConstants;
+using i18n::addressinput::TaskRunner;
+
+// Runs the tasks on a few threads that each take the next task that hasn't
+// been taken yet.
+class ThreadTaskRunner : public TaskRunner {
+ public:
+  ThreadTaskRunner(const ThreadTaskRunner&) = delete;
+  ThreadTaskRunner& operator=(const ThreadTaskRunner&) = delete;
+
+  ThreadTaskRunner() = default;
+  ~ThreadTaskRunner() override = default;
+
+  void RunTasks(size_t task_count,
+                const std::function<void(size_t)>& task) override {
+    std::atomic<size_t> next_task(0);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < 4; ++i) {
+      threads.emplace_back([&] {
+        for (size_t t = next_task++; t < task_count; t = next_task++) {
+          task(t);
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+};
 
 TEST(AddressFormatterTest, GetStreetAddressLinesAsSingleLine_EmptyAddress) {
   const AddressData address;
@@ -411,4 +453,118 @@ TEST(AddressFormatterTest,
   EXPECT_EQ(expected, lines);
 }
 
+TEST(AddressFormatterTest, AppendFormattedNationalAddress) {
+  const AddressData address{
+      .region_code = "TW",
+      .address_line{"No. 33, Section 3 Xinyi Rd"},
+      .administrative_area = "Taipei City",
+      .locality = "Da-an District",
+      .postal_code = "106",
+      .language_code = "zh-Latn",
+  };
+
+  std::string text("Previous text\n");
+  AppendFormattedNationalAddress(address, &text);
+  EXPECT_EQ(
+      "Previous text\n"
+      "No. 33, Section 3 Xinyi Rd\n"
+      "Da-an District, Taipei City 106",
+      text);
+}
+
+TEST(AddressFormatterTest, AppendFormattedNationalAddressLine) {
+  const AddressData address{
+      .region_code = "US",
+      .address_line{
+          "1098 Alta Ave",
+          "Apt 2",
+      },
+      .administrative_area = "CA",
+      .locality = "Mountain View",
+      .postal_code = "94043",
+      .language_code = "en",
+  };
+
+  std::string expected;
+  GetFormattedNationalAddressLine(address, &expected);
+  EXPECT_EQ("1098 Alta Ave, Apt 2, Mountain View, CA 94043", expected);
+
+  // Appending twice to the same buffer gives the same line twice.
+  std::string line;
+  AppendFormattedNationalAddressLine(address, &line);
+  EXPECT_EQ(expected, line);
+  AppendFormattedNationalAddressLine(address, &line);
+  EXPECT_EQ(expected + expected, line);
+}
+
+TEST(AddressFormatterTest, FormatBatchEmpty) {
+  FormattedAddressBatch batch;
+  FormatBatch(nullptr, 0, FORMAT_BATCH_LINES, nullptr, &batch);
+  EXPECT_TRUE(batch.text.empty());
+  EXPECT_EQ(std::vector<size_t>{0}, batch.address_offsets);
+  EXPECT_EQ(std::vector<size_t>{0}, batch.line_offsets);
+}
+
+TEST(AddressFormatterTest, FormatBatchAllRegions) {
+  // Addresses for all regions, in local and Latin script, with different
+  // fields left empty, and in an order that isn't grouped by region.
+  std::vector<AddressData> addresses;
+  for (const char* language_code : {"", "und-Latn", "ja", "ar"}) {
+    for (const auto& region_code : RegionDataConstants::GetRegionCodes()) {
+      addresses.push_back({
+          .region_code = region_code,
+          .address_line{"Line 1", "", "Line 3"},
+          .administrative_area = "Admin",
+          .locality = "Locality",
+          .dependent_locality = "Dependent",
+          .postal_code = "12345",
+          .sorting_code = "CEDEX",
+          .language_code = language_code,
+          .organization = "Organization",
+          .recipient = "Recipient",
+      });
+      addresses.push_back({
+          .region_code = region_code,
+          .address_line{"Line 1"},
+          .locality = "Locality",
+          .language_code = language_code,
+      });
+      addresses.push_back({
+          .region_code = region_code,
+          .postal_code = "12345",
+          .language_code = language_code,
+          .recipient = "Recipient",
+      });
+    }
+  }
+
+  ThreadTaskRunner runner;
+  for (TaskRunner* task_runner : {static_cast<TaskRunner*>(nullptr),
+                                  static_cast<TaskRunner*>(&runner)}) {
+    FormattedAddressBatch batch;
+    FormatBatch(addresses.data(), addresses.size(), FORMAT_BATCH_LINES,
+                task_runner, &batch);
+    ASSERT_EQ(addresses.size() + 1, batch.address_offsets.size());
+    for (size_t i = 0; i < addresses.size(); ++i) {
+      std::vector<std::string> expected;
+      GetFormattedNationalAddress(addresses[i], &expected);
+      std::vector<std::string> lines;
+      for (size_t line = 0; line < batch.GetLineCount(i); ++line) {
+        lines.emplace_back(batch.GetLine(i, line));
+      }
+      EXPECT_EQ(expected, lines) << addresses[i].region_code;
+    }
+
+    FormatBatch(addresses.data(), addresses.size(), FORMAT_BATCH_SINGLE_LINE,
+                task_runner, &batch);
+    ASSERT_EQ(addresses.size() + 1, batch.address_offsets.size());
+    for (size_t i = 0; i < addresses.size(); ++i) {
+      std::string expected;
+      GetFormattedNationalAddressLine(addresses[i], &expected);
+      ASSERT_EQ(1U, batch.GetLineCount(i));
+      EXPECT_EQ(expected, batch.GetLine(i, 0)) << addresses[i].region_code;
+    }
+  }
+}
+
 }  // namespace
@@ -130,6 +130,19 @@ TEST_F(AddressNormalizerTest, CaliforniaShortNameCa) {
   EXPECT_EQ("CA", address.administrative_area);
 }
 
+TEST_F(AddressNormalizerTest, UnloadedRegionStaysUnchanged) {
+  supplier_.LoadRules("US", *loaded_);
+  EXPECT_TRUE(supplier_.UnloadRules("US"));
+  AddressData address{
+      .region_code = "US",
+      .administrative_area = "California",
+      .locality = "Mountain View",
+      .language_code = "en-US",
+  };
+  normalizer_.Normalize(&address);
+  EXPECT_EQ("California", address.administrative_area);
+}
+
 TEST_F(AddressNormalizerTest, CountryWithNonStandardData) {
   // This test is to make sure that Normalize would not crash for the case where
   // the data is not standard and key--language does not exist.
@@ -18,6 +18,7 @@
 #include <libaddressinput/address_ui_component.h>
 #include <libaddressinput/localization.h>
 
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
@@ -27,6 +28,7 @@
 namespace {
 
 using i18n::addressinput::AddressField;
+using i18n::addressinput::AddressUiCache;
 using i18n::addressinput::AddressUiComponent;
 using i18n::addressinput::BuildComponents;
 using i18n::addressinput::GetRegionCodes;
@@ -75,6 +77,30 @@ testing::AssertionResult ComponentsAreValid(
 }
 
 // Tests for address UI functions.
+testing::AssertionResult ComponentsAreEqual(
+    const std::vector<AddressUiComponent>& expected,
+    const std::vector<AddressUiComponent>& actual) {
+  if (expected.size() != actual.size()) {
+    return testing::AssertionFailure()
+           << expected.size() << " != " << actual.size() << " components";
+  }
+
+  for (size_t i = 0; i < expected.size(); ++i) {
+    // Only the literal string of literals is set.
+    if (expected[i].literal != actual[i].literal ||
+        (expected[i].literal.empty() &&
+         (expected[i].field != actual[i].field ||
+          expected[i].name != actual[i].name ||
+          expected[i].length_hint != actual[i].length_hint))) {
+      return testing::AssertionFailure() << "component " << i << " differs";
+    }
+  }
+
+  return testing::AssertionSuccess();
+}
+
+std::string GetTestString(int message_id) { return "test"; }
+
 class AddressUiTest : public testing::TestWithParam<std::string> {
  public:
   AddressUiTest(const AddressUiTest&) = delete;
@@ -131,6 +157,30 @@ TEST_P(AddressUiTest, UniqueFieldTypesByBuildComponentsWithLiterals) {
   }
 }
 
+// Verifies that AddressUiCache returns the same components as
+// BuildComponents() and BuildComponentsWithLiterals().
+TEST_P(AddressUiTest, CachedComponentsAreEqual) {
+  AddressUiCache cache(&localization_);
+  for (const char* ui_language_tag : {"", "en", "zh-Latn", "ar", "ja"}) {
+    SCOPED_TRACE(ui_language_tag);
+    std::string cached_language_tag;
+    EXPECT_TRUE(ComponentsAreEqual(
+        BuildComponents(GetParam(), localization_, ui_language_tag,
+                        &best_address_language_tag_),
+        *cache.GetComponents(GetParam(), ui_language_tag, false,
+                             &cached_language_tag)));
+    EXPECT_EQ(best_address_language_tag_, cached_language_tag);
+
+    EXPECT_TRUE(ComponentsAreEqual(
+        BuildComponentsWithLiterals(GetParam(), localization_,
+                                    ui_language_tag,
+                                    &best_address_language_tag_),
+        *cache.GetComponents(GetParam(), ui_language_tag, true,
+                             &cached_language_tag)));
+    EXPECT_EQ(best_address_language_tag_, cached_language_tag);
+  }
+}
+
 // Test all regions codes.
 INSTANTIATE_TEST_SUITE_P(AllRegions, AddressUiTest,
                          testing::ValuesIn(GetRegionCodes()));
@@ -143,6 +193,55 @@ TEST_F(AddressUiTest, InvalidRegionCodeReturnsEmptyVector) {
       &best_address_language_tag_).empty());
 }
 
+TEST_F(AddressUiTest, CacheReturnsEmptyVectorForInvalidRegionCode) {
+  AddressUiCache cache(&localization_);
+  EXPECT_TRUE(cache.GetComponents("INVALID-REGION-CODE", kUiLanguageTag, false,
+                                  &best_address_language_tag_)->empty());
+}
+
+TEST_F(AddressUiTest, CacheSharesComponents) {
+  AddressUiCache cache(&localization_);
+  std::shared_ptr<const std::vector<AddressUiComponent>> components =
+      cache.GetComponents("CH", "fr", false, &best_address_language_tag_);
+  EXPECT_EQ("fr", best_address_language_tag_);
+  // The layout doesn't depend on the language, only on the script.
+  EXPECT_EQ(components, cache.GetComponents("CH", "de", false,
+                                            &best_address_language_tag_));
+  EXPECT_EQ("de", best_address_language_tag_);
+  EXPECT_NE(components, cache.GetComponents("CH", "fr", true,
+                                            &best_address_language_tag_));
+}
+
+TEST_F(AddressUiTest, CacheWarmUp) {
+  AddressUiCache cache(&localization_);
+  cache.WarmUp();
+  std::shared_ptr<const std::vector<AddressUiComponent>> components =
+      cache.GetComponents("EG", "ar-Latn", true, &best_address_language_tag_);
+  EXPECT_EQ("ar-Latn", best_address_language_tag_);
+  EXPECT_TRUE(ComponentsAreValid(*components));
+  EXPECT_EQ(components, cache.GetComponents("EG", "fr", true,
+                                            &best_address_language_tag_));
+}
+
+TEST_F(AddressUiTest, CacheIsInvalidatedBySetGetter) {
+  AddressUiCache cache(&localization_);
+  std::shared_ptr<const std::vector<AddressUiComponent>> components =
+      cache.GetComponents("US", kUiLanguageTag, false,
+                          &best_address_language_tag_);
+  ASSERT_FALSE(components->empty());
+  EXPECT_NE("test", components->front().name);
+
+  localization_.SetGetter(&GetTestString);
+  std::shared_ptr<const std::vector<AddressUiComponent>> new_components =
+      cache.GetComponents("US", kUiLanguageTag, false,
+                          &best_address_language_tag_);
+  EXPECT_NE(components, new_components);
+  ASSERT_FALSE(new_components->empty());
+  EXPECT_EQ("test", new_components->front().name);
+  // The components that were returned before are not modified.
+  EXPECT_NE("test", components->front().name);
+}
+
 // Verifies that BuildComponentsWithLiteras() does return literals. It uses "LV"
 // as an aribtrary short example that has exactly one literal and 4 new lines.
 TEST_F(AddressUiTest, ComponentsWithLiteralsReadsLiteralsForLV) {
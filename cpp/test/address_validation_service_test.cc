@@ -0,0 +1,198 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libaddressinput/address_validation_service.h>
+
+#include <libaddressinput/address_data.h>
+#include <libaddressinput/address_formatter.h>
+#include <libaddressinput/address_validator.h>
+#include <libaddressinput/async.h>
+#include <libaddressinput/callback.h>
+#include <libaddressinput/future.h>
+#include <libaddressinput/null_storage.h>
+#include <libaddressinput/preload_supplier.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "testdata_source.h"
+
+namespace {
+
+using i18n::addressinput::AddressData;
+using i18n::addressinput::AddressValidationService;
+using i18n::addressinput::AddressValidator;
+using i18n::addressinput::BuildCallback;
+using i18n::addressinput::FieldProblemMap;
+using i18n::addressinput::FormattingResult;
+using i18n::addressinput::Future;
+using i18n::addressinput::GetFormattedNationalAddress;
+using i18n::addressinput::NormalizationResult;
+using i18n::addressinput::NullStorage;
+using i18n::addressinput::PreloadSupplier;
+using i18n::addressinput::TestdataSource;
+using i18n::addressinput::ValidationResult;
+
+class AddressValidationServiceTest : public testing::Test {
+ public:
+  AddressValidationServiceTest(const AddressValidationServiceTest&) = delete;
+  AddressValidationServiceTest& operator=(const AddressValidationServiceTest&) =
+      delete;
+
+ protected:
+  AddressValidationServiceTest()
+      : loaded_(BuildCallback(this, &AddressValidationServiceTest::OnLoaded)),
+        addresses_{
+            {.region_code = "US",
+             .address_line{"1098 Alta Ave"},
+             .administrative_area = "CA",
+             .locality = "Mountain View",
+             .postal_code = "94043",
+             .recipient = "Jane Doe"},
+            {.region_code = "US",
+             .administrative_area = "CA",
+             .postal_code = "10001"},
+            {.region_code = "CA",
+             .administrative_area = "Nouveau-Brunswick",
+             .language_code = "en-CA"},
+            {.region_code = "CH",
+             .address_line{"Brandschenkestrasse 110"},
+             .locality = "Zürich",
+             .postal_code = "8002"},
+            {.region_code = "BR",
+             .administrative_area = "Maranhão",
+             .locality = "Cantanhede"},
+            {.region_code = "FR", .locality = "Paris"},
+        } {}
+
+  // Returns a supplier with the rules of all the regions of |addresses_|
+  // loaded, except FR.
+  PreloadSupplier* BuildSupplier() {
+    auto* supplier = new PreloadSupplier(new TestdataSource(true),
+                                         new NullStorage);
+    for (const auto& address : addresses_) {
+      if (address.region_code != "FR") {
+        supplier->LoadRules(address.region_code, *loaded_);
+      }
+    }
+    return supplier;
+  }
+
+  const std::unique_ptr<const PreloadSupplier::Callback> loaded_;
+  const std::vector<AddressData> addresses_;
+
+ private:
+  void OnLoaded(bool success, const std::string& region_code, int num_rules) {
+    ASSERT_TRUE(success);
+  }
+};
+
+TEST_F(AddressValidationServiceTest, ValidateLikeValidateNow) {
+  AddressValidationService service(BuildSupplier(), 4, 16);
+  std::vector<Future<ValidationResult>> futures;
+  for (int i = 0; i < 100; ++i) {
+    for (const auto& address : addresses_) {
+      futures.push_back(service.Validate(address, true, true, nullptr));
+    }
+  }
+
+  for (size_t i = 0; i < futures.size(); ++i) {
+    const AddressData& address = addresses_[i % addresses_.size()];
+    FieldProblemMap problems;
+    bool success = AddressValidator::ValidateNow(
+        service.supplier(), address, true, true, nullptr, &problems);
+    const ValidationResult& result = futures[i].Get();
+    EXPECT_EQ(success, result.success);
+    EXPECT_EQ(address, result.address);
+    EXPECT_EQ(problems, result.problems);
+  }
+}
+
+TEST_F(AddressValidationServiceTest, Normalize) {
+  AddressValidationService service(BuildSupplier(), 2, 4);
+  Future<NormalizationResult> canada = service.Normalize(addresses_[2]);
+  EXPECT_TRUE(canada.Get().success);
+  EXPECT_EQ("NB", canada.Get().address.administrative_area);
+
+  Future<NormalizationResult> brazil = service.Normalize(addresses_[4]);
+  EXPECT_TRUE(brazil.Get().success);
+  EXPECT_EQ("MA", brazil.Get().address.administrative_area);
+
+  // The rules of FR aren't loaded.
+  Future<NormalizationResult> france = service.Normalize(addresses_[5]);
+  EXPECT_FALSE(france.Get().success);
+  EXPECT_EQ(addresses_[5], france.Get().address);
+}
+
+TEST_F(AddressValidationServiceTest, FormatLikeGetFormattedNationalAddress) {
+  AddressValidationService service(BuildSupplier(), 2, 4);
+  for (const auto& address : addresses_) {
+    std::vector<std::string> lines;
+    GetFormattedNationalAddress(address, &lines);
+    Future<FormattingResult> result = service.Format(address);
+    EXPECT_TRUE(result.Get().success);
+    EXPECT_EQ(lines, result.Get().lines);
+  }
+}
+
+TEST_F(AddressValidationServiceTest, QueueIsBounded) {
+  static const size_t kThreadCount = 4;
+  static const size_t kJobsPerThread = 200;
+  static const size_t kQueueCapacity = 2;
+  AddressValidationService service(BuildSupplier(), 1, kQueueCapacity);
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < kThreadCount; ++i) {
+    threads.emplace_back([this, &service] {
+      std::vector<Future<ValidationResult>> futures;
+      for (size_t j = 0; j < kJobsPerThread; ++j) {
+        futures.push_back(service.Validate(addresses_[j % addresses_.size()],
+                                           true, true, nullptr));
+      }
+      for (const auto& future : futures) {
+        future.Wait();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  AddressValidationService::Stats stats = service.GetStats();
+  EXPECT_EQ(0U, stats.queue_depth);
+  EXPECT_LE(stats.peak_queue_depth, kQueueCapacity);
+  EXPECT_EQ(kThreadCount * kJobsPerThread, stats.submitted_jobs);
+  EXPECT_EQ(kThreadCount * kJobsPerThread, stats.completed_jobs);
+  EXPECT_LE(stats.blocked_submissions, stats.submitted_jobs);
+}
+
+TEST_F(AddressValidationServiceTest, DestructorFinishesQueuedJobs) {
+  bool called = false;
+  {
+    AddressValidationService service(BuildSupplier(), 1, 8);
+    for (int i = 0; i < 8; ++i) {
+      service.Format(addresses_[0]);
+    }
+    service.Validate(addresses_[1], true, true, nullptr)
+        .Then([&called](const ValidationResult& result) { called = true; });
+  }
+  EXPECT_TRUE(called);
+}
+
+}  // namespace
@@ -22,8 +22,11 @@
 #include <libaddressinput/ondemand_supplier.h>
 #include <libaddressinput/preload_supplier.h>
 
+#include <cstddef>
 #include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -119,6 +122,38 @@ class PreloadValidatorWrapper : public ValidatorWrapper {
   const std::unique_ptr<const PreloadSupplier::Callback> loaded_;
 };
 
+class PreloadNowValidatorWrapper : public ValidatorWrapper {
+ public:
+  PreloadNowValidatorWrapper(const PreloadNowValidatorWrapper&) = delete;
+  PreloadNowValidatorWrapper& operator=(const PreloadNowValidatorWrapper&) =
+      delete;
+
+  static ValidatorWrapper* Build() { return new PreloadNowValidatorWrapper; }
+
+  void Validate(const AddressData& address, bool allow_postal,
+                bool require_name, const FieldProblemMap* filter,
+                FieldProblemMap* problems,
+                const AddressValidator::Callback& validated) override {
+    const std::string& region_code = address.region_code;
+    if (!region_code.empty() && !supplier_.IsLoaded(region_code)) {
+      supplier_.LoadRules(region_code, *loaded_);
+    }
+    bool success = AddressValidator::ValidateNow(
+        supplier_, address, allow_postal, require_name, filter, problems);
+    validated(success, address, *problems);
+  }
+
+ private:
+  PreloadNowValidatorWrapper()
+      : supplier_(new TestdataSource(true), new NullStorage),
+        loaded_(BuildCallback(this, &PreloadNowValidatorWrapper::Loaded)) {}
+
+  void Loaded(bool success, const std::string&, int) { ASSERT_TRUE(success); }
+
+  PreloadSupplier supplier_;
+  const std::unique_ptr<const PreloadSupplier::Callback> loaded_;
+};
+
 class AddressValidatorTest
     : public testing::TestWithParam<ValidatorWrapper* (*)()> {
  public:
@@ -169,6 +204,9 @@ INSTANTIATE_TEST_SUITE_P(OndemandSupplier, AddressValidatorTest,
 INSTANTIATE_TEST_SUITE_P(PreloadSupplier, AddressValidatorTest,
                          testing::Values(&PreloadValidatorWrapper::Build));
 
+INSTANTIATE_TEST_SUITE_P(PreloadSupplierNow, AddressValidatorTest,
+                         testing::Values(&PreloadNowValidatorWrapper::Build));
+
 TEST_P(AddressValidatorTest, EmptyAddress) {
   expected_ = {{COUNTRY, MISSING_REQUIRED_FIELD}};
 
@@ -197,7 +235,7 @@ TEST_P(AddressValidatorTest, ValidAddressUS) {
       .language_code = "en",
   };
 
-  if (GetParam() == &PreloadValidatorWrapper::Build) {
+  if (GetParam() != &OndemandValidatorWrapper::Build) {
     expected_ = {
         {LOCALITY, UNSUPPORTED_FIELD},
         {DEPENDENT_LOCALITY, UNSUPPORTED_FIELD},
@@ -222,7 +260,7 @@ TEST_P(AddressValidatorTest, InvalidAddressUS) {
       {POSTAL_CODE, INVALID_FORMAT},
   };
 
-  if (GetParam() == &PreloadValidatorWrapper::Build) {
+  if (GetParam() != &OndemandValidatorWrapper::Build) {
     expected_.emplace(DEPENDENT_LOCALITY, UNSUPPORTED_FIELD);
     expected_.emplace(LOCALITY, UNSUPPORTED_FIELD);
   }
@@ -241,7 +279,7 @@ TEST_P(AddressValidatorTest, ValidAddressCH) {
       .language_code = "de",
   };
 
-  if (GetParam() == &PreloadValidatorWrapper::Build) {
+  if (GetParam() != &OndemandValidatorWrapper::Build) {
     expected_ = {
         {LOCALITY, UNSUPPORTED_FIELD},
         {DEPENDENT_LOCALITY, UNSUPPORTED_FIELD},
@@ -265,7 +303,7 @@ TEST_P(AddressValidatorTest, InvalidAddressCH) {
       {LOCALITY, MISSING_REQUIRED_FIELD},
   };
 
-  if (GetParam() == &PreloadValidatorWrapper::Build) {
+  if (GetParam() != &OndemandValidatorWrapper::Build) {
     expected_.emplace(LOCALITY, UNSUPPORTED_FIELD);
     expected_.emplace(DEPENDENT_LOCALITY, UNSUPPORTED_FIELD);
   }
@@ -285,7 +323,7 @@ TEST_P(AddressValidatorTest, ValidPostalCodeMX) {
       .language_code = "es",
   };
 
-  if (GetParam() == &PreloadValidatorWrapper::Build) {
+  if (GetParam() != &OndemandValidatorWrapper::Build) {
     expected_ = {
         {DEPENDENT_LOCALITY, UNSUPPORTED_FIELD},
         {LOCALITY, UNSUPPORTED_FIELD},
@@ -309,7 +347,7 @@ TEST_P(AddressValidatorTest, MismatchingPostalCodeMX) {
 
   expected_ = {{POSTAL_CODE, MISMATCHING_VALUE}};
 
-  if (GetParam() == &PreloadValidatorWrapper::Build) {
+  if (GetParam() != &OndemandValidatorWrapper::Build) {
     expected_.emplace(LOCALITY, UNSUPPORTED_FIELD);
     expected_.emplace(DEPENDENT_LOCALITY, UNSUPPORTED_FIELD);
   }
@@ -351,7 +389,7 @@ TEST_P(AddressValidatorTest, ValidateClearsProblems) {
 
   expected_ = {{POSTAL_CODE, INVALID_FORMAT}};
 
-  if (GetParam() == &PreloadValidatorWrapper::Build) {
+  if (GetParam() != &OndemandValidatorWrapper::Build) {
     expected_.emplace(LOCALITY, UNSUPPORTED_FIELD);
     expected_.emplace(DEPENDENT_LOCALITY, UNSUPPORTED_FIELD);
   }
@@ -370,7 +408,7 @@ TEST_P(AddressValidatorTest, ValidKanjiAddressJP) {
       .language_code = "ja",
   };
 
-  if (GetParam() == &PreloadValidatorWrapper::Build) {
+  if (GetParam() != &OndemandValidatorWrapper::Build) {
     expected_ = {
         {DEPENDENT_LOCALITY, UNSUPPORTED_FIELD},
         {LOCALITY, UNSUPPORTED_FIELD},
@@ -474,4 +512,80 @@ TEST_P(AddressValidatorTest, ValidAddressCA_fr) {
   EXPECT_EQ(expected_, problems_);
 }
 
+class AddressValidatorNowTest : public testing::Test {
+ public:
+  AddressValidatorNowTest(const AddressValidatorNowTest&) = delete;
+  AddressValidatorNowTest& operator=(const AddressValidatorNowTest&) = delete;
+
+ protected:
+  AddressValidatorNowTest()
+      : supplier_(new TestdataSource(true), new NullStorage),
+        loaded_(BuildCallback(this, &AddressValidatorNowTest::Loaded)) {}
+
+  PreloadSupplier supplier_;
+  const std::unique_ptr<const PreloadSupplier::Callback> loaded_;
+
+ private:
+  void Loaded(bool success, const std::string&, int) { ASSERT_TRUE(success); }
+};
+
+TEST_F(AddressValidatorNowTest, ConcurrentValidation) {
+  supplier_.LoadRules("US", *loaded_);
+  supplier_.LoadRules("CA", *loaded_);
+
+  const std::vector<AddressData> addresses{
+      {
+          .region_code = "US",
+          .address_line{"1600 Amphitheatre Parkway"},
+          .administrative_area = "CA",
+          .locality = "Mountain View",
+          .postal_code = "94043",
+          .language_code = "en",
+      },
+      {
+          .region_code = "US",
+          .postal_code = "123",
+      },
+      {
+          .region_code = "CA",
+          .address_line{"..."},
+          .administrative_area = "Nouveau-Brunswick",
+          .locality = "Comté de Saint-Jean",
+          .postal_code = "E2L 4Z6",
+          .language_code = "fr",
+      },
+  };
+
+  std::vector<FieldProblemMap> expected(addresses.size());
+  for (size_t i = 0; i < addresses.size(); ++i) {
+    ASSERT_TRUE(AddressValidator::ValidateNow(supplier_, addresses[i], false,
+                                              false, nullptr, &expected[i]));
+  }
+
+  static const size_t kThreads = 4;
+  static const size_t kIterations = 50;
+  std::vector<size_t> mismatches(kThreads);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t] {
+      FieldProblemMap problems;
+      for (size_t n = 0; n < kIterations; ++n) {
+        size_t i = (t + n) % addresses.size();
+        if (!AddressValidator::ValidateNow(supplier_, addresses[i], false,
+                                           false, nullptr, &problems) ||
+            problems != expected[i]) {
+          ++mismatches[t];
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (size_t t = 0; t < kThreads; ++t) {
+    EXPECT_EQ(0U, mismatches[t]);
+  }
+}
+
 }  // namespace
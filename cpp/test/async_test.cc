@@ -0,0 +1,248 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libaddressinput/async.h>
+
+#include <libaddressinput/address_data.h>
+#include <libaddressinput/address_field.h>
+#include <libaddressinput/address_problem.h>
+#include <libaddressinput/address_validator.h>
+#include <libaddressinput/future.h>
+#include <libaddressinput/null_storage.h>
+#include <libaddressinput/ondemand_supplier.h>
+#include <libaddressinput/preload_supplier.h>
+#include <libaddressinput/supplier.h>
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include "deferred_source.h"
+#include "fake_storage.h"
+#include "lookup_key.h"
+#include "mock_source.h"
+#include "testdata_source.h"
+
+namespace {
+
+using i18n::addressinput::AddressData;
+using i18n::addressinput::AddressValidator;
+using i18n::addressinput::DataResult;
+using i18n::addressinput::DeferredSource;
+using i18n::addressinput::FakeStorage;
+using i18n::addressinput::FieldProblemMap;
+using i18n::addressinput::Future;
+using i18n::addressinput::GetAsync;
+using i18n::addressinput::LoadRulesAsync;
+using i18n::addressinput::LoadRulesResult;
+using i18n::addressinput::LookupKey;
+using i18n::addressinput::MockSource;
+using i18n::addressinput::NullStorage;
+using i18n::addressinput::OndemandSupplier;
+using i18n::addressinput::PreloadSupplier;
+using i18n::addressinput::Supplier;
+using i18n::addressinput::SupplyAsync;
+using i18n::addressinput::SupplyResult;
+using i18n::addressinput::TestdataSource;
+using i18n::addressinput::ValidateAsync;
+using i18n::addressinput::ValidationResult;
+
+using i18n::addressinput::POSTAL_CODE;
+
+using i18n::addressinput::MISMATCHING_VALUE;
+
+const AddressData kMismatchingPostalCode{
+    .region_code = "US",
+    .address_line{"1098 Alta Ave"},
+    .administrative_area = "CA",
+    .locality = "Mountain View",
+    .postal_code = "10001",
+    .recipient = "Jane Doe"};
+
+// Supplies nothing, and only when told to, but reads the lookup key then, as
+// a supplier that has to fetch the rules first would.
+class DeferredSupplier : public Supplier {
+ public:
+  DeferredSupplier(const DeferredSupplier&) = delete;
+  DeferredSupplier& operator=(const DeferredSupplier&) = delete;
+
+  DeferredSupplier() : lookup_key_(nullptr), supplied_(nullptr) {}
+  ~DeferredSupplier() override = default;
+
+  void Supply(const LookupKey& lookup_key, const Callback& supplied) override {
+    lookup_key_ = &lookup_key;
+    supplied_ = &supplied;
+  }
+
+  void SupplyGlobally(const LookupKey& lookup_key,
+                      const Callback& supplied) override {
+    Supply(lookup_key, supplied);
+  }
+
+  void Finish() {
+    ASSERT_TRUE(lookup_key_ != nullptr);
+    admin_area_ = lookup_key_->GetNode(1);
+    (*supplied_)(true, *lookup_key_, RuleHierarchy());
+  }
+
+  std::string admin_area_;
+
+ private:
+  const LookupKey* lookup_key_;
+  const Callback* supplied_;
+};
+
+TEST(AsyncTest, ValidateWithLoadedRulesIsReadyRightAway) {
+  PreloadSupplier supplier(new TestdataSource(true), new NullStorage);
+  Future<LoadRulesResult> loaded = LoadRulesAsync(&supplier, "US");
+  ASSERT_TRUE(loaded.IsReady());
+  EXPECT_TRUE(loaded.Get().success);
+  EXPECT_EQ("US", loaded.Get().region_code);
+  EXPECT_LT(0, loaded.Get().rule_count);
+
+  AddressValidator validator(&supplier);
+  Future<ValidationResult> future =
+      ValidateAsync(validator, kMismatchingPostalCode, true, true, nullptr);
+  ASSERT_TRUE(future.IsReady());
+  const ValidationResult& result = future.Get();
+  EXPECT_TRUE(result.success);
+  EXPECT_EQ(kMismatchingPostalCode, result.address);
+
+  FieldProblemMap problems;
+  AddressValidator::ValidateNow(supplier, kMismatchingPostalCode, true, true,
+                                nullptr, &problems);
+  EXPECT_EQ(problems, result.problems);
+}
+
+TEST(AsyncTest, ValidateCopiesAddressAndFilter) {
+  DeferredSource* source = new DeferredSource;
+  OndemandSupplier supplier(source, new NullStorage);
+  AddressValidator validator(&supplier);
+  auto address = std::make_unique<AddressData>(kMismatchingPostalCode);
+  auto filter = std::make_unique<FieldProblemMap>(
+      FieldProblemMap{{POSTAL_CODE, MISMATCHING_VALUE}});
+  Future<ValidationResult> future =
+      ValidateAsync(validator, *address, true, true, filter.get());
+  address.reset();
+  filter.reset();
+  EXPECT_FALSE(future.IsReady());
+  source->Finish();
+  ASSERT_TRUE(future.IsReady());
+  EXPECT_TRUE(future.Get().success);
+  EXPECT_EQ(kMismatchingPostalCode, future.Get().address);
+  EXPECT_EQ(FieldProblemMap({{POSTAL_CODE, MISMATCHING_VALUE}}),
+            future.Get().problems);
+}
+
+TEST(AsyncTest, ThenBeforeResultIsReady) {
+  DeferredSource* source = new DeferredSource;
+  OndemandSupplier supplier(source, new NullStorage);
+  AddressValidator validator(&supplier);
+  bool called = false;
+  ValidateAsync(validator, kMismatchingPostalCode, true, true, nullptr)
+      .Then([&called](const ValidationResult& result) {
+        EXPECT_TRUE(result.success);
+        EXPECT_EQ(1U, result.problems.size());
+        called = true;
+      });
+  // The future has been destroyed, but the result is still delivered.
+  EXPECT_FALSE(called);
+  source->Finish();
+  EXPECT_TRUE(called);
+}
+
+TEST(AsyncTest, LoadRulesOfPendingRegionFinishesRightAway) {
+  DeferredSource* source = new DeferredSource;
+  PreloadSupplier supplier(source, new NullStorage);
+  Future<LoadRulesResult> loading = LoadRulesAsync(&supplier, "CH");
+  EXPECT_FALSE(loading.IsReady());
+
+  Future<LoadRulesResult> future = LoadRulesAsync(&supplier, "CH");
+  ASSERT_TRUE(future.IsReady());
+  EXPECT_FALSE(future.Get().success);
+  EXPECT_EQ("CH", future.Get().region_code);
+
+  source->Finish();
+  EXPECT_TRUE(loading.IsReady());
+}
+
+TEST(AsyncTest, ThenAfterResultIsReady) {
+  PreloadSupplier supplier(new TestdataSource(true), new NullStorage);
+  Future<LoadRulesResult> future = LoadRulesAsync(&supplier, "CH");
+  ASSERT_TRUE(future.IsReady());
+  bool called = false;
+  future.Then([&called](const LoadRulesResult& result) {
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ("CH", result.region_code);
+    called = true;
+  });
+  EXPECT_TRUE(called);
+}
+
+TEST(AsyncTest, WaitForResultFromOtherThread) {
+  DeferredSource* source = new DeferredSource;
+  OndemandSupplier supplier(source, new NullStorage);
+  Future<SupplyResult> future =
+      SupplyAsync(&supplier, kMismatchingPostalCode, false);
+  std::thread thread([source] { source->Finish(); });
+  const SupplyResult& result = future.Get();
+  thread.join();
+  EXPECT_TRUE(result.success);
+  EXPECT_TRUE(result.hierarchy.rule[0] != nullptr);
+  EXPECT_TRUE(result.hierarchy.rule[1] != nullptr);
+  EXPECT_TRUE(result.hierarchy.rule[2] == nullptr);
+}
+
+TEST(AsyncTest, SupplyCopiesAddress) {
+  DeferredSupplier supplier;
+  auto address = std::make_unique<AddressData>(kMismatchingPostalCode);
+  Future<SupplyResult> future = SupplyAsync(&supplier, *address, false);
+  address.reset();
+  EXPECT_FALSE(future.IsReady());
+  supplier.Finish();
+  ASSERT_TRUE(future.IsReady());
+  EXPECT_TRUE(future.Get().success);
+  EXPECT_EQ("CA", supplier.admin_area_);
+}
+
+TEST(AsyncTest, FutureCanBeMoved) {
+  MockSource source;
+  source.data_ = {{"key", "value"}};
+  Future<DataResult> future = GetAsync(source, "key");
+  Future<DataResult> other = std::move(future);
+  EXPECT_FALSE(future.IsValid());
+  ASSERT_TRUE(other.IsValid());
+  EXPECT_TRUE(other.Get().success);
+  EXPECT_EQ("key", other.Get().key);
+  EXPECT_EQ(std::optional<std::string>("value"), other.Get().data);
+}
+
+TEST(AsyncTest, GetFromSourceAndStorage) {
+  MockSource source;
+  Future<DataResult> missing = GetAsync(source, "key");
+  EXPECT_FALSE(missing.Get().success);
+  EXPECT_FALSE(missing.Get().data.has_value());
+
+  FakeStorage storage;
+  storage.Put("key", "value");
+  Future<DataResult> stored = GetAsync(storage, "key");
+  EXPECT_TRUE(stored.Get().success);
+  EXPECT_EQ(std::optional<std::string>("value"), stored.Get().data);
+}
+
+}  // namespace
@@ -0,0 +1,264 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libaddressinput/cancellation.h>
+
+#include <libaddressinput/address_data.h>
+#include <libaddressinput/address_validator.h>
+#include <libaddressinput/callback.h>
+#include <libaddressinput/null_storage.h>
+#include <libaddressinput/ondemand_supplier.h>
+#include <libaddressinput/preload_supplier.h>
+#include <libaddressinput/storage.h>
+#include <libaddressinput/supplier.h>
+
+#include <memory>
+#include <optional>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "deferred_source.h"
+#include "fake_storage.h"
+#include "lookup_key.h"
+#include "retriever.h"
+#include "testdata_source.h"
+
+namespace {
+
+using i18n::addressinput::AddressData;
+using i18n::addressinput::AddressValidator;
+using i18n::addressinput::BuildCallback;
+using i18n::addressinput::CancellationToken;
+using i18n::addressinput::DeferredSource;
+using i18n::addressinput::FakeStorage;
+using i18n::addressinput::FieldProblemMap;
+using i18n::addressinput::LookupKey;
+using i18n::addressinput::NullStorage;
+using i18n::addressinput::OndemandSupplier;
+using i18n::addressinput::PreloadSupplier;
+using i18n::addressinput::Retriever;
+using i18n::addressinput::Storage;
+using i18n::addressinput::Supplier;
+using i18n::addressinput::TestdataSource;
+
+using i18n::addressinput::COUNTRY;
+
+using i18n::addressinput::UNKNOWN_VALUE;
+
+const AddressData kAddress{.region_code = "CH",
+                           .address_line{"Brandschenkestrasse 110"},
+                           .locality = "Zürich",
+                           .postal_code = "8002"};
+
+TEST(CancellationTokenTest, CopiesShareTheState) {
+  CancellationToken token;
+  CancellationToken copy = token;
+  EXPECT_FALSE(token.IsCancelled());
+  EXPECT_FALSE(copy.IsCancelled());
+  copy.Cancel();
+  EXPECT_TRUE(token.IsCancelled());
+  EXPECT_TRUE(copy.IsCancelled());
+  token.Cancel();  // Cancelling again does nothing.
+  EXPECT_TRUE(token.IsCancelled());
+  EXPECT_FALSE(CancellationToken().IsCancelled());
+}
+
+class CancellationTest : public testing::Test {
+ public:
+  CancellationTest(const CancellationTest&) = delete;
+  CancellationTest& operator=(const CancellationTest&) = delete;
+
+ protected:
+  CancellationTest()
+      : source_(new DeferredSource),
+        supplier_(source_, new NullStorage),
+        validator_(&supplier_),
+        problems_(),
+        validated_count_(0),
+        supplied_count_(0),
+        supplied_success_(false),
+        validated_(BuildCallback(this, &CancellationTest::Validated)),
+        supplied_(BuildCallback(this, &CancellationTest::Supplied)) {}
+
+  DeferredSource* const source_;  // Owned by |supplier_|.
+  OndemandSupplier supplier_;
+  const AddressValidator validator_;
+  FieldProblemMap problems_;
+  int validated_count_;
+  int supplied_count_;
+  bool supplied_success_;
+  std::optional<CancellationToken> cancel_in_callback_;
+  const std::unique_ptr<const AddressValidator::Callback> validated_;
+  const std::unique_ptr<const Supplier::Callback> supplied_;
+
+ private:
+  void Validated(bool success,
+                 const AddressData& address,
+                 const FieldProblemMap& problems) {
+    ++validated_count_;
+    if (cancel_in_callback_.has_value()) {
+      cancel_in_callback_->Cancel();
+    }
+  }
+
+  void Supplied(bool success,
+                const LookupKey& lookup_key,
+                const Supplier::RuleHierarchy& hierarchy) {
+    ++supplied_count_;
+    supplied_success_ = success;
+  }
+};
+
+TEST_F(CancellationTest, ValidateWithoutCancelling) {
+  CancellationToken token;
+  validator_.Validate(kAddress, true, true, nullptr, &problems_, *validated_,
+                      token);
+  EXPECT_EQ(0, validated_count_);
+  source_->Finish();
+  EXPECT_EQ(1, validated_count_);
+}
+
+TEST_F(CancellationTest, ValidateDoesNotCallBackAfterCancel) {
+  CancellationToken token;
+  validator_.Validate(kAddress, true, true, nullptr, &problems_, *validated_,
+                      token);
+  size_t request_count = source_->GetRequestCount();
+  EXPECT_LT(0U, request_count);
+  problems_.emplace(COUNTRY, UNKNOWN_VALUE);
+
+  token.Cancel();
+  source_->Finish();
+  EXPECT_EQ(0, validated_count_);
+  // The problems aren't touched after cancelling.
+  EXPECT_EQ(1U, problems_.size());
+
+  // The rules that arrived after cancelling were cached all the same, so
+  // validating again doesn't request them again.
+  validator_.Validate(kAddress, true, true, nullptr, &problems_, *validated_);
+  EXPECT_EQ(request_count, source_->GetRequestCount());
+  EXPECT_EQ(1, validated_count_);
+}
+
+TEST_F(CancellationTest, ValidateWithCancelledTokenRequestsNothing) {
+  CancellationToken token;
+  token.Cancel();
+  validator_.Validate(kAddress, true, true, nullptr, &problems_, *validated_,
+                      token);
+  EXPECT_EQ(0U, source_->GetRequestCount());
+  EXPECT_EQ(0, validated_count_);
+}
+
+TEST_F(CancellationTest, CancelFromValidatedCallback) {
+  CancellationToken token;
+  cancel_in_callback_ = token;
+  validator_.Validate(kAddress, true, true, nullptr, &problems_, *validated_,
+                      token);
+  source_->Finish();
+  EXPECT_EQ(1, validated_count_);
+  EXPECT_TRUE(token.IsCancelled());
+}
+
+TEST_F(CancellationTest, SupplyCallsBackWithFailure) {
+  LookupKey lookup_key;
+  lookup_key.FromAddress(kAddress);
+  CancellationToken token;
+  supplier_.Supply(lookup_key, *supplied_, token);
+  token.Cancel();
+  source_->Finish();
+  EXPECT_EQ(1, supplied_count_);
+  EXPECT_FALSE(supplied_success_);
+}
+
+TEST_F(CancellationTest, PreloadSupplierChecksTokenBeforeSupplying) {
+  PreloadSupplier supplier(new TestdataSource(true), new NullStorage);
+  LookupKey lookup_key;
+  lookup_key.FromAddress(kAddress);
+  CancellationToken token;
+  supplier.Supply(lookup_key, *supplied_, token);
+  EXPECT_EQ(1, supplied_count_);
+
+  token.Cancel();
+  supplier.SupplyGlobally(lookup_key, *supplied_, token);
+  EXPECT_EQ(2, supplied_count_);
+  EXPECT_FALSE(supplied_success_);
+}
+
+class RetrieverCancellationTest : public testing::Test {
+ public:
+  RetrieverCancellationTest(const RetrieverCancellationTest&) = delete;
+  RetrieverCancellationTest& operator=(const RetrieverCancellationTest&) =
+      delete;
+
+ protected:
+  RetrieverCancellationTest()
+      : source_(new DeferredSource),
+        storage_(new FakeStorage),
+        retriever_(source_, storage_),
+        retrieved_count_(0),
+        retrieved_success_(false),
+        retrieved_(BuildCallback(this, &RetrieverCancellationTest::Retrieved)),
+        stored_(false),
+        data_ready_(
+            BuildCallback(this, &RetrieverCancellationTest::DataReady)) {}
+
+  DeferredSource* const source_;  // Owned by |retriever_|.
+  FakeStorage* const storage_;    // Owned by |retriever_|.
+  const Retriever retriever_;
+  int retrieved_count_;
+  bool retrieved_success_;
+  const std::unique_ptr<const Retriever::Callback> retrieved_;
+  bool stored_;
+  const std::unique_ptr<const Storage::Callback> data_ready_;
+
+ private:
+  void Retrieved(bool success, const std::string& key,
+                 std::string* data) {
+    ++retrieved_count_;
+    retrieved_success_ = success;
+  }
+
+  void DataReady(bool success, const std::string& key,
+                 std::optional<std::string> data) {
+    stored_ = success;
+  }
+};
+
+TEST_F(RetrieverCancellationTest, CancelledBeforeSourceIsNotAsked) {
+  CancellationToken token;
+  token.Cancel();
+  retriever_.Retrieve("data/CH", *retrieved_, token);
+  EXPECT_EQ(0U, source_->GetRequestCount());
+  EXPECT_EQ(1, retrieved_count_);
+  EXPECT_FALSE(retrieved_success_);
+}
+
+TEST_F(RetrieverCancellationTest, DataArrivedAfterCancelIsStored) {
+  CancellationToken token;
+  retriever_.Retrieve("data/CH", *retrieved_, token);
+  EXPECT_EQ(1U, source_->GetRequestCount());
+  token.Cancel();
+  source_->Finish();
+  EXPECT_EQ(1, retrieved_count_);
+  storage_->Get("data/CH", *data_ready_);
+  EXPECT_TRUE(stored_);
+
+  // Data in storage is returned even with a cancelled token.
+  retriever_.Retrieve("data/CH", *retrieved_, token);
+  EXPECT_EQ(1U, source_->GetRequestCount());
+  EXPECT_EQ(2, retrieved_count_);
+  EXPECT_TRUE(retrieved_success_);
+}
+
+}  // namespace
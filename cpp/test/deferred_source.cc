@@ -0,0 +1,46 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "deferred_source.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace i18n {
+namespace addressinput {
+
+DeferredSource::DeferredSource() : DeferredSource(false) {}
+
+DeferredSource::DeferredSource(bool aggregate)
+    : source_(aggregate), pending_(), request_count_(0) {}
+
+DeferredSource::~DeferredSource() = default;
+
+void DeferredSource::Get(const std::string& key,
+                         const Callback& data_ready) const {
+  pending_.emplace_back(key, &data_ready);
+  ++request_count_;
+}
+
+void DeferredSource::Finish() {
+  std::vector<std::pair<std::string, const Callback*>> pending;
+  pending.swap(pending_);
+  for (const auto& request : pending) {
+    source_.Get(request.first, *request.second);
+  }
+}
+
+}  // namespace addressinput
+}  // namespace i18n
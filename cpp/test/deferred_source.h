@@ -0,0 +1,68 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// An implementation of the Source interface that calls back only when asked
+// to, to be used in tests of asynchronous calls.
+
+#ifndef I18N_ADDRESSINPUT_TEST_DEFERRED_SOURCE_H_
+#define I18N_ADDRESSINPUT_TEST_DEFERRED_SOURCE_H_
+
+#include <libaddressinput/source.h>
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "testdata_source.h"
+
+namespace i18n {
+namespace addressinput {
+
+// Gets the test data like TestdataSource, non-aggregated unless constructed
+// with |aggregate| true, but holds on to the requests until Finish() is called,
+// like a Source that gets the data over the network would. Sample usage:
+//    DeferredSource* source = new DeferredSource;
+//    OndemandSupplier supplier(source, new NullStorage);
+//    validator.Validate(address, true, true, nullptr, &problems, *validated_);
+//    // |validated_| hasn't been called yet.
+//    source->Finish();
+class DeferredSource : public Source {
+ public:
+  DeferredSource(const DeferredSource&) = delete;
+  DeferredSource& operator=(const DeferredSource&) = delete;
+
+  DeferredSource();
+  explicit DeferredSource(bool aggregate);
+  ~DeferredSource() override;
+
+  // Source implementation.
+  void Get(const std::string& key, const Callback& data_ready) const override;
+
+  // Calls back for every pending request, on the calling thread.
+  void Finish();
+
+  // Returns the number of requests that Get() has received.
+  size_t GetRequestCount() const { return request_count_; }
+
+ private:
+  TestdataSource source_;
+  mutable std::vector<std::pair<std::string, const Callback*>> pending_;
+  mutable size_t request_count_;
+};
+
+}  // namespace addressinput
+}  // namespace i18n
+
+#endif  // I18N_ADDRESSINPUT_TEST_DEFERRED_SOURCE_H_
@@ -0,0 +1,139 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "format_program.h"
+
+#include <libaddressinput/address_data.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+using i18n::addressinput::AddressData;
+using i18n::addressinput::FormatProgram;
+
+TEST(FormatProgramTest, ProgramsAreCached) {
+  EXPECT_EQ(&FormatProgram::Get("CH", false), &FormatProgram::Get("CH", false));
+  EXPECT_NE(&FormatProgram::Get("CH", false), &FormatProgram::Get("DE", false));
+  EXPECT_NE(&FormatProgram::Get("TW", false), &FormatProgram::Get("TW", true));
+}
+
+TEST(FormatProgramTest, ConcurrentCallsGetOneProgram) {
+  std::vector<const FormatProgram*> programs(4);
+  std::vector<std::thread> threads;
+  for (auto& program : programs) {
+    threads.emplace_back([&program]() {
+      program = &FormatProgram::Get("JP", true);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (const FormatProgram* program : programs) {
+    EXPECT_EQ(&FormatProgram::Get("JP", true), program);
+  }
+}
+
+TEST(FormatProgramTest, UnsupportedRegionsShareDefaultProgram) {
+  const FormatProgram& program = FormatProgram::Get("XA", false);
+  EXPECT_EQ(&program, &FormatProgram::Get("XB", false));
+  EXPECT_EQ(&program, &FormatProgram::Get("", false));
+  EXPECT_FALSE(program.GetFormat().empty());
+}
+
+TEST(FormatProgramTest, LatinFormat) {
+  EXPECT_NE(FormatProgram::Get("TW", false).GetFormat(),
+            FormatProgram::Get("TW", true).GetFormat());
+  // Regions without a Latin-script format use the local format.
+  EXPECT_EQ(FormatProgram::Get("US", false).GetFormat(),
+            FormatProgram::Get("US", true).GetFormat());
+}
+
+TEST(FormatProgramTest, AppendLines) {
+  const AddressData address{
+      .region_code = "US",
+      .address_line{"1098 Alta Ave"},
+      .administrative_area = "CA",
+      .locality = "Mountain View",
+      .postal_code = "94043",
+  };
+
+  std::vector<std::string> lines{"Existing line"};
+  FormatProgram::Get("US", false).AppendLines(address, &lines);
+  const std::vector<std::string> expected{
+      "Existing line",
+      "1098 Alta Ave",
+      "Mountain View, CA 94043",
+  };
+  EXPECT_EQ(expected, lines);
+}
+
+TEST(FormatProgramTest, AppendJoinedPrunesSeparators) {
+  const AddressData address{
+      .region_code = "US",
+      .address_line{"1098 Alta Ave"},
+      .locality = "Mountain View",
+  };
+
+  std::string text;
+  FormatProgram::Get("US", false).AppendJoined(address, " | ", &text);
+  EXPECT_EQ("1098 Alta Ave | Mountain View", text);
+}
+
+TEST(FormatProgramTest, AppendJoinedKeepsEmptyStreetLines) {
+  const AddressData address{
+      .region_code = "US",
+      .address_line{"Line 1", "", "Line 3"},
+      .locality = "Mountain View",
+  };
+
+  std::vector<std::string> lines;
+  FormatProgram::Get("US", false).AppendLines(address, &lines);
+  const std::vector<std::string> expected_lines{
+      "Line 1",
+      "",
+      "Line 3",
+      "Mountain View",
+  };
+  EXPECT_EQ(expected_lines, lines);
+
+  std::string text;
+  FormatProgram::Get("US", false).AppendJoined(address, "/", &text);
+  EXPECT_EQ("Line 1//Line 3/Mountain View", text);
+}
+
+TEST(FormatProgramTest, EstimateSizeIsUpperBound) {
+  const AddressData address{
+      .region_code = "CH",
+      .address_line{"Brandschenkestrasse 110", "c/o Google"},
+      .locality = "Zürich",
+      .postal_code = "8002",
+      .organization = "Google",
+      .recipient = "Jane Doe",
+  };
+
+  const FormatProgram& program = FormatProgram::Get("CH", false);
+  std::string text;
+  program.AppendJoined(address, ", ", &text);
+  EXPECT_EQ(
+      "Google, Jane Doe, Brandschenkestrasse 110, c/o Google, CH-8002 Zürich",
+      text);
+  EXPECT_LE(text.size(), program.EstimateSize(address, 2));
+}
+
+}  // namespace
@@ -14,13 +14,19 @@
 
 #include "language.h"
 
+#include <cstddef>
+#include <memory>
 #include <string>
 
 #include <gtest/gtest.h>
 
 namespace {
 
+using i18n::addressinput::ARABIC_COMMA_SEPARATOR;
+using i18n::addressinput::COMMA_SEPARATOR;
 using i18n::addressinput::Language;
+using i18n::addressinput::NO_SEPARATOR;
+using i18n::addressinput::SPACE_SEPARATOR;
 
 struct LanguageTestCase {
   LanguageTestCase(const std::string& input_language_tag,
@@ -66,4 +72,50 @@ INSTANTIATE_TEST_SUITE_P(
                     LanguageTestCase("zh-Hans", "zh-Hans", "zh", false),
                     LanguageTestCase("en_GB", "en-GB", "en", false)));
 
+TEST(LanguageGetTest, ReturnsSameLanguageForSameTag) {
+  std::shared_ptr<const Language> language = Language::Get("zh-Latn-CN");
+  EXPECT_EQ(language.get(), Language::Get("zh-Latn-CN").get());
+  EXPECT_NE(language.get(), Language::Get("zh-Hans").get());
+  EXPECT_EQ("zh-Latn-CN", language->tag);
+  EXPECT_EQ("zh", language->base);
+  EXPECT_TRUE(language->has_latin_script);
+}
+
+TEST(LanguageGetTest, NormalizesTag) {
+  std::shared_ptr<const Language> language = Language::Get("en_GB");
+  EXPECT_EQ("en-GB", language->tag);
+  EXPECT_EQ("en", language->base);
+  EXPECT_FALSE(language->has_latin_script);
+}
+
+TEST(LanguageGetTest, InternsBoundedNumberOfTags) {
+  std::shared_ptr<const Language> interned = Language::Get("de-CH");
+  for (size_t i = 0; i < Language::kMaxInternedTags; ++i) {
+    Language::Get("x-" + std::to_string(i));
+  }
+  EXPECT_EQ(interned.get(), Language::Get("de-CH").get());
+
+  std::shared_ptr<const Language> language = Language::Get("sr-Latn-RS");
+  EXPECT_NE(language.get(), Language::Get("sr-Latn-RS").get());
+  EXPECT_EQ("sr-Latn-RS", language->tag);
+  EXPECT_EQ("sr", language->base);
+  EXPECT_TRUE(language->has_latin_script);
+}
+
+TEST(LanguageLineSeparatorTest, DependsOnBaseLanguage) {
+  EXPECT_EQ(COMMA_SEPARATOR, Language("").line_separator);
+  EXPECT_EQ(COMMA_SEPARATOR, Language("en").line_separator);
+  EXPECT_EQ(SPACE_SEPARATOR, Language("ko").line_separator);
+  EXPECT_EQ(SPACE_SEPARATOR, Language("TH").line_separator);
+  EXPECT_EQ(NO_SEPARATOR, Language("zh-Hant").line_separator);
+  EXPECT_EQ(NO_SEPARATOR, Language("ja").line_separator);
+  EXPECT_EQ(ARABIC_COMMA_SEPARATOR, Language("ar-EG").line_separator);
+  EXPECT_EQ(ARABIC_COMMA_SEPARATOR, Language("ur").line_separator);
+}
+
+TEST(LanguageLineSeparatorTest, LatinScriptUsesComma) {
+  EXPECT_EQ(COMMA_SEPARATOR, Language("ja-Latn").line_separator);
+  EXPECT_EQ(COMMA_SEPARATOR, Language("ar-Latn").line_separator);
+}
+
 }  // namespace
@@ -17,7 +17,9 @@
 #include <libaddressinput/address_data.h>
 #include <libaddressinput/address_field.h>
 #include <libaddressinput/address_problem.h>
+#include <libaddressinput/message_catalog.h>
 
+#include <map>
 #include <string>
 #include <vector>
 
@@ -32,6 +34,7 @@ using i18n::addressinput::AddressData;
 using i18n::addressinput::AddressField;
 using i18n::addressinput::INVALID_MESSAGE_ID;
 using i18n::addressinput::Localization;
+using i18n::addressinput::MessageCatalog;
 
 using i18n::addressinput::COUNTRY;
 using i18n::addressinput::ADMIN_AREA;
@@ -49,6 +52,46 @@ using i18n::addressinput::INVALID_FORMAT;
 using i18n::addressinput::MISMATCHING_VALUE;
 using i18n::addressinput::USES_P_O_BOX;
 
+// All message identifiers.
+const int kMessageIds[] = {
+    IDS_LIBADDRESSINPUT_COUNTRY_OR_REGION_LABEL,
+    IDS_LIBADDRESSINPUT_LOCALITY_LABEL,
+    IDS_LIBADDRESSINPUT_ADDRESS_LINE_1_LABEL,
+    IDS_LIBADDRESSINPUT_PIN_CODE_LABEL,
+    IDS_LIBADDRESSINPUT_POSTAL_CODE_LABEL,
+    IDS_LIBADDRESSINPUT_ZIP_CODE_LABEL,
+    IDS_LIBADDRESSINPUT_AREA,
+    IDS_LIBADDRESSINPUT_COUNTY,
+    IDS_LIBADDRESSINPUT_DEPARTMENT,
+    IDS_LIBADDRESSINPUT_DISTRICT,
+    IDS_LIBADDRESSINPUT_DO_SI,
+    IDS_LIBADDRESSINPUT_EMIRATE,
+    IDS_LIBADDRESSINPUT_ISLAND,
+    IDS_LIBADDRESSINPUT_PARISH,
+    IDS_LIBADDRESSINPUT_PREFECTURE,
+    IDS_LIBADDRESSINPUT_PROVINCE,
+    IDS_LIBADDRESSINPUT_STATE,
+    IDS_LIBADDRESSINPUT_ORGANIZATION_LABEL,
+    IDS_LIBADDRESSINPUT_RECIPIENT_LABEL,
+    IDS_LIBADDRESSINPUT_MISSING_REQUIRED_FIELD,
+    IDS_LIBADDRESSINPUT_MISSING_REQUIRED_POSTAL_CODE_EXAMPLE_AND_URL,
+    IDS_LIBADDRESSINPUT_MISSING_REQUIRED_POSTAL_CODE_EXAMPLE,
+    IDS_LIBADDRESSINPUT_MISSING_REQUIRED_ZIP_CODE_EXAMPLE_AND_URL,
+    IDS_LIBADDRESSINPUT_MISSING_REQUIRED_ZIP_CODE_EXAMPLE,
+    IDS_LIBADDRESSINPUT_UNKNOWN_VALUE,
+    IDS_LIBADDRESSINPUT_UNRECOGNIZED_FORMAT_POSTAL_CODE_EXAMPLE_AND_URL,
+    IDS_LIBADDRESSINPUT_UNRECOGNIZED_FORMAT_POSTAL_CODE_EXAMPLE,
+    IDS_LIBADDRESSINPUT_UNRECOGNIZED_FORMAT_POSTAL_CODE,
+    IDS_LIBADDRESSINPUT_UNRECOGNIZED_FORMAT_ZIP_CODE_EXAMPLE_AND_URL,
+    IDS_LIBADDRESSINPUT_UNRECOGNIZED_FORMAT_ZIP_CODE_EXAMPLE,
+    IDS_LIBADDRESSINPUT_UNRECOGNIZED_FORMAT_ZIP,
+    IDS_LIBADDRESSINPUT_MISMATCHING_VALUE_POSTAL_CODE_URL,
+    IDS_LIBADDRESSINPUT_MISMATCHING_VALUE_POSTAL_CODE,
+    IDS_LIBADDRESSINPUT_MISMATCHING_VALUE_ZIP_URL,
+    IDS_LIBADDRESSINPUT_MISMATCHING_VALUE_ZIP,
+    IDS_LIBADDRESSINPUT_PO_BOX_FORBIDDEN_VALUE,
+};
+
 // Tests for Localization object.
 class LocalizationTest : public testing::TestWithParam<int> {
  public:
@@ -73,6 +116,17 @@ TEST_P(LocalizationTest, DefaultStringIsNotEmpty) {
   EXPECT_FALSE(localization_.GetString(GetParam()).empty());
 }
 
+// Verifies that the messages of a catalog can be used.
+TEST_P(LocalizationTest, CatalogCanBeUsed) {
+  std::map<std::string, MessageCatalog::Messages> messages;
+  messages["fr"][GetParam()] = kValidMessage;
+  const std::string data = MessageCatalog::Compile(messages);
+  MessageCatalog catalog;
+  ASSERT_TRUE(catalog.Load(data));
+  ASSERT_TRUE(localization_.SetCatalog(&catalog, "fr"));
+  EXPECT_EQ(kValidMessage, localization_.GetString(GetParam()));
+}
+
 // Verifies that the messages do not have newlines.
 TEST_P(LocalizationTest, NoNewline) {
   EXPECT_EQ(std::string::npos, localization_.GetString(GetParam()).find('\n'));
@@ -85,39 +139,8 @@ TEST_P(LocalizationTest, NoDoubleSpace) {
 }
 
 // Tests all message identifiers.
-INSTANTIATE_TEST_SUITE_P(
-    AllMessages, LocalizationTest,
-    testing::Values(
-        IDS_LIBADDRESSINPUT_COUNTRY_OR_REGION_LABEL,
-        IDS_LIBADDRESSINPUT_LOCALITY_LABEL,
-        IDS_LIBADDRESSINPUT_ADDRESS_LINE_1_LABEL,
-        IDS_LIBADDRESSINPUT_PIN_CODE_LABEL,
-        IDS_LIBADDRESSINPUT_POSTAL_CODE_LABEL,
-        IDS_LIBADDRESSINPUT_ZIP_CODE_LABEL, IDS_LIBADDRESSINPUT_AREA,
-        IDS_LIBADDRESSINPUT_COUNTY, IDS_LIBADDRESSINPUT_DEPARTMENT,
-        IDS_LIBADDRESSINPUT_DISTRICT, IDS_LIBADDRESSINPUT_DO_SI,
-        IDS_LIBADDRESSINPUT_EMIRATE, IDS_LIBADDRESSINPUT_ISLAND,
-        IDS_LIBADDRESSINPUT_PARISH, IDS_LIBADDRESSINPUT_PREFECTURE,
-        IDS_LIBADDRESSINPUT_PROVINCE, IDS_LIBADDRESSINPUT_STATE,
-        IDS_LIBADDRESSINPUT_ORGANIZATION_LABEL,
-        IDS_LIBADDRESSINPUT_RECIPIENT_LABEL,
-        IDS_LIBADDRESSINPUT_MISSING_REQUIRED_FIELD,
-        IDS_LIBADDRESSINPUT_MISSING_REQUIRED_POSTAL_CODE_EXAMPLE_AND_URL,
-        IDS_LIBADDRESSINPUT_MISSING_REQUIRED_POSTAL_CODE_EXAMPLE,
-        IDS_LIBADDRESSINPUT_MISSING_REQUIRED_ZIP_CODE_EXAMPLE_AND_URL,
-        IDS_LIBADDRESSINPUT_MISSING_REQUIRED_ZIP_CODE_EXAMPLE,
-        IDS_LIBADDRESSINPUT_UNKNOWN_VALUE,
-        IDS_LIBADDRESSINPUT_UNRECOGNIZED_FORMAT_POSTAL_CODE_EXAMPLE_AND_URL,
-        IDS_LIBADDRESSINPUT_UNRECOGNIZED_FORMAT_POSTAL_CODE_EXAMPLE,
-        IDS_LIBADDRESSINPUT_UNRECOGNIZED_FORMAT_POSTAL_CODE,
-        IDS_LIBADDRESSINPUT_UNRECOGNIZED_FORMAT_ZIP_CODE_EXAMPLE_AND_URL,
-        IDS_LIBADDRESSINPUT_UNRECOGNIZED_FORMAT_ZIP_CODE_EXAMPLE,
-        IDS_LIBADDRESSINPUT_UNRECOGNIZED_FORMAT_ZIP,
-        IDS_LIBADDRESSINPUT_MISMATCHING_VALUE_POSTAL_CODE_URL,
-        IDS_LIBADDRESSINPUT_MISMATCHING_VALUE_POSTAL_CODE,
-        IDS_LIBADDRESSINPUT_MISMATCHING_VALUE_ZIP_URL,
-        IDS_LIBADDRESSINPUT_MISMATCHING_VALUE_ZIP,
-        IDS_LIBADDRESSINPUT_PO_BOX_FORBIDDEN_VALUE));
+INSTANTIATE_TEST_SUITE_P(AllMessages, LocalizationTest,
+                         testing::ValuesIn(kMessageIds));
 
 // Verifies that an invalid message identifier results in an empty string in the
 // default configuration.
@@ -474,4 +497,102 @@ TEST(LocalizationGetErrorMessageTest, UsesPOBoxOtherFields) {
   }
 }
 
+// Tests for Localization objects that use a catalog.
+class LocalizationCatalogTest : public testing::Test {
+ public:
+  LocalizationCatalogTest(const LocalizationCatalogTest&) = delete;
+  LocalizationCatalogTest& operator=(const LocalizationCatalogTest&) = delete;
+
+ protected:
+  LocalizationCatalogTest() {
+    Localization english;
+    std::map<std::string, MessageCatalog::Messages> messages;
+    for (int message_id : kMessageIds) {
+      messages["en"][message_id] = english.GetString(message_id);
+      messages["xx"][message_id] = "xx";
+    }
+    data_ = MessageCatalog::Compile(messages);
+    EXPECT_TRUE(catalog_.Load(data_));
+  }
+
+  std::string data_;
+  MessageCatalog catalog_;
+  Localization localization_;
+};
+
+TEST_F(LocalizationCatalogTest, UnknownLocale) {
+  EXPECT_FALSE(localization_.SetCatalog(&catalog_, "fr"));
+  EXPECT_EQ("You can't leave this empty.",
+            localization_.GetString(
+                IDS_LIBADDRESSINPUT_MISSING_REQUIRED_FIELD));
+}
+
+TEST_F(LocalizationCatalogTest, SetGetterReplacesCatalog) {
+  ASSERT_TRUE(localization_.SetCatalog(&catalog_, "xx"));
+  EXPECT_EQ("xx", localization_.GetString(
+                      IDS_LIBADDRESSINPUT_MISSING_REQUIRED_FIELD));
+  localization_.SetGetter(&GetValidMessage);
+  EXPECT_EQ(kValidMessage, localization_.GetString(
+                               IDS_LIBADDRESSINPUT_MISSING_REQUIRED_FIELD));
+}
+
+TEST_F(LocalizationCatalogTest, SetCatalogChangesGeneration) {
+  size_t generation = localization_.GetGeneration();
+  ASSERT_TRUE(localization_.SetCatalog(&catalog_, "xx"));
+  EXPECT_NE(generation, localization_.GetGeneration());
+}
+
+// Verifies that the error messages from a catalog are the same as from the
+// default string getter.
+TEST_F(LocalizationCatalogTest, ErrorMessagesAreSame) {
+  Localization english;
+  ASSERT_TRUE(localization_.SetCatalog(&catalog_, "en"));
+
+  const std::vector<AddressField> other_fields{
+      COUNTRY,
+      ADMIN_AREA,
+      LOCALITY,
+      DEPENDENT_LOCALITY,
+      SORTING_CODE,
+      STREET_ADDRESS,
+      ORGANIZATION,
+      RECIPIENT,
+  };
+  for (const char* region_code : {"AQ", "CH", "IN", "JP", "US"}) {
+    SCOPED_TRACE(region_code);
+    const AddressData address{
+        .region_code = region_code,
+        .address_line{"bad address line"},
+        .administrative_area = "bad admin area",
+        .locality = "bad locality",
+        .dependent_locality = "bad dependent locality",
+        .sorting_code = "bad sorting code",
+        .organization = "bad organization",
+        .recipient = "bad recipient",
+    };
+    for (bool enable_examples : {false, true}) {
+      for (bool enable_links : {false, true}) {
+        for (auto problem :
+             {MISSING_REQUIRED_FIELD, INVALID_FORMAT, MISMATCHING_VALUE}) {
+          EXPECT_EQ(english.GetErrorMessage(address, POSTAL_CODE, problem,
+                                            enable_examples, enable_links),
+                    localization_.GetErrorMessage(address, POSTAL_CODE,
+                                                  problem, enable_examples,
+                                                  enable_links));
+        }
+        for (AddressField field : other_fields) {
+          for (auto problem :
+               {MISSING_REQUIRED_FIELD, UNKNOWN_VALUE, USES_P_O_BOX}) {
+            EXPECT_EQ(english.GetErrorMessage(address, field, problem,
+                                              enable_examples, enable_links),
+                      localization_.GetErrorMessage(address, field, problem,
+                                                    enable_examples,
+                                                    enable_links));
+          }
+        }
+      }
+    }
+  }
+}
+
 }  // namespace
@@ -147,6 +147,35 @@ TEST(LookupKeyTest, WithLanguageCodeAlternateLanguage) {
   EXPECT_EQ("data/CA/ON--fr", lookup_key.ToKeyString(1));
 }
 
+TEST(LookupKeyTest, WithLanguageCodeAlternateLanguageAllDepths) {
+  const AddressData address{
+      .region_code = "CA",
+      .administrative_area = "ON",
+      .locality = "333",
+      .language_code = "fr",
+  };
+  LookupKey lookup_key;
+  lookup_key.FromAddress(address);
+  EXPECT_EQ("data/CA--fr", lookup_key.ToKeyString(0));
+  EXPECT_EQ("data/CA/ON--fr", lookup_key.ToKeyString(1));
+  EXPECT_EQ("data/CA/ON/333--fr", lookup_key.ToKeyString(2));
+  EXPECT_EQ("data/CA/ON/333--fr", lookup_key.ToKeyString(kMaxDepth));
+}
+
+TEST(LookupKeyTest, FromAddressClearsLanguage) {
+  AddressData address{
+      .region_code = "CA",
+      .administrative_area = "ON",
+      .language_code = "fr",
+  };
+  LookupKey lookup_key;
+  lookup_key.FromAddress(address);
+  EXPECT_EQ("data/CA/ON--fr", lookup_key.ToKeyString(kMaxDepth));
+  address.language_code = "en";
+  lookup_key.FromAddress(address);
+  EXPECT_EQ("data/CA/ON", lookup_key.ToKeyString(kMaxDepth));
+}
+
 TEST(LookupKeyTest, WithLanguageCodeInvalidLanguage) {
   // Use real data here as the choice of adding a language requires metadata.
   const AddressData address{
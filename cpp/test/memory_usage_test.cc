@@ -0,0 +1,255 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libaddressinput/memory_usage.h>
+
+#include <libaddressinput/address_data.h>
+#include <libaddressinput/address_validator.h>
+#include <libaddressinput/callback.h>
+#include <libaddressinput/null_storage.h>
+#include <libaddressinput/ondemand_supplier.h>
+#include <libaddressinput/preload_supplier.h>
+#include <libaddressinput/region_data.h>
+#include <libaddressinput/region_data_builder.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include <gtest/gtest.h>
+
+#include "testdata_source.h"
+#include "util/string_split.h"
+
+namespace {
+
+using i18n::addressinput::AddressData;
+using i18n::addressinput::AddressValidator;
+using i18n::addressinput::BuildCallback;
+using i18n::addressinput::FieldProblemMap;
+using i18n::addressinput::MemoryUsage;
+using i18n::addressinput::MemoryUsageMap;
+using i18n::addressinput::NullStorage;
+using i18n::addressinput::OndemandSupplier;
+using i18n::addressinput::PreloadSupplier;
+using i18n::addressinput::RegionData;
+using i18n::addressinput::RegionDataBuilder;
+using i18n::addressinput::SplitString;
+using i18n::addressinput::TestdataSource;
+
+// Returns the bytes currently allocated, according to the allocator, or 0 if
+// the allocator doesn't tell.
+size_t GetAllocatedBytes() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+  return mallinfo2().uordblks;
+#else
+  return 0;
+#endif
+}
+
+// Checks that the |reported| estimate is close to the |allocated| bytes, which
+// include the overhead of the allocator for every block.
+testing::AssertionResult IsCloseToAllocated(size_t reported,
+                                            size_t allocated) {
+  if (reported < allocated * 0.6 || reported > allocated * 1.1) {
+    return testing::AssertionFailure()
+           << reported << " reported, " << allocated << " allocated";
+  }
+  return testing::AssertionSuccess();
+}
+
+class MemoryUsageTest : public testing::Test {
+ public:
+  MemoryUsageTest(const MemoryUsageTest&) = delete;
+  MemoryUsageTest& operator=(const MemoryUsageTest&) = delete;
+
+ protected:
+  MemoryUsageTest()
+      : loaded_(BuildCallback(this, &MemoryUsageTest::OnLoaded)),
+        validated_(BuildCallback(this, &MemoryUsageTest::OnValidated)) {}
+
+  void SetUp() override {
+    if (GetAllocatedBytes() == 0) {
+      GTEST_SKIP() << "The allocator doesn't report the bytes allocated.";
+    }
+    // Load some rules first, so that what is allocated only once in the
+    // process isn't counted in the tests.
+    PreloadSupplier supplier(new TestdataSource(true), new NullStorage);
+    supplier.LoadRules("CH", *loaded_);
+  }
+
+  const std::unique_ptr<const PreloadSupplier::Callback> loaded_;
+  const std::unique_ptr<const AddressValidator::Callback> validated_;
+
+ private:
+  void OnLoaded(bool success, const std::string& region_code, int num_rules) {
+    ASSERT_TRUE(success);
+  }
+
+  void OnValidated(bool success, const AddressData& address,
+                   const FieldProblemMap& problems) {
+    ASSERT_TRUE(success);
+  }
+};
+
+TEST_F(MemoryUsageTest, PreloadSupplierReportsWhatLoadRulesAllocated) {
+  // What is allocated only the first time that the rules of a region are
+  // loaded isn't counted either.
+  {
+    PreloadSupplier supplier(new TestdataSource(true), new NullStorage);
+    supplier.LoadRules("CN", *loaded_);
+    supplier.LoadRules("US", *loaded_);
+  }
+  PreloadSupplier supplier(new TestdataSource(true), new NullStorage);
+  size_t before = GetAllocatedBytes();
+  supplier.LoadRules("CN", *loaded_);
+  supplier.LoadRules("US", *loaded_);
+  size_t allocated = GetAllocatedBytes() - before;
+
+  MemoryUsageMap usage = supplier.GetMemoryUsage();
+  ASSERT_EQ(2U, usage.size());
+  MemoryUsage total;
+  for (const auto& pair : usage) {
+    EXPECT_LT(0U, pair.second.rules);
+    EXPECT_LT(0U, pair.second.rule_index);
+    EXPECT_LT(0U, pair.second.region_rules);
+    EXPECT_EQ(0U, pair.second.region_data);
+    total += pair.second;
+  }
+  // CN has many more rules than US.
+  EXPECT_LT(usage["US"].GetTotal(), usage["CN"].GetTotal());
+  EXPECT_TRUE(IsCloseToAllocated(total.GetTotal(), allocated));
+}
+
+TEST_F(MemoryUsageTest, PreloadSupplierReportsCompiledMatchers) {
+  PreloadSupplier supplier(new TestdataSource(true), new NullStorage);
+  supplier.LoadRules("CA", *loaded_);
+  EXPECT_EQ(0U, supplier.GetMemoryUsage()["CA"].postal_code_matchers);
+
+  const AddressData address{.region_code = "CA",
+                            .administrative_area = "ON",
+                            .postal_code = "K1A 0B1"};
+  FieldProblemMap problems;
+  AddressValidator::ValidateNow(supplier, address, true, true, nullptr,
+                                &problems);
+  EXPECT_LT(0U, supplier.GetMemoryUsage()["CA"].postal_code_matchers);
+}
+
+TEST_F(MemoryUsageTest, UnloadRulesDeletesCompiledMatchers) {
+  const AddressData address{.region_code = "CA",
+                            .administrative_area = "ON",
+                            .postal_code = "K1A 0B1"};
+  FieldProblemMap problems;
+  // What is allocated only the first time that a matcher is compiled isn't
+  // counted.
+  {
+    PreloadSupplier supplier(new TestdataSource(true), new NullStorage);
+    supplier.LoadRules("US", *loaded_);
+    AddressValidator::ValidateNow(
+        supplier, AddressData{.region_code = "US", .postal_code = "94043"},
+        true, true, nullptr, &problems);
+  }
+  PreloadSupplier supplier(new TestdataSource(true), new NullStorage);
+  size_t before = GetAllocatedBytes();
+  supplier.LoadRules("CA", *loaded_);
+  size_t loaded = GetAllocatedBytes();
+  AddressValidator::ValidateNow(supplier, address, true, true, nullptr,
+                                &problems);
+  size_t matchers = GetAllocatedBytes() - loaded;
+  ASSERT_LT(0U, matchers);
+
+  supplier.UnloadRules("CA");
+  EXPECT_LT(GetAllocatedBytes(), before + matchers / 10);
+}
+
+TEST_F(MemoryUsageTest, OndemandSupplierReportsWhatSupplyAllocated) {
+  // Validate an address in every city of CN, to have enough rules for the
+  // overhead of the allocator to even out.
+  PreloadSupplier preload_supplier(new TestdataSource(true), new NullStorage);
+  preload_supplier.LoadRules("CN", *loaded_);
+  std::vector<AddressData> addresses;
+  for (const auto& pair : preload_supplier.GetRulesForRegion("CN")) {
+    std::vector<std::string> parts;
+    SplitString(pair.first, '/', &parts);
+    if (parts.size() == 4 && pair.first.find("--") == std::string::npos) {
+      addresses.push_back({.region_code = "CN",
+                           .administrative_area = parts[2],
+                           .locality = parts[3]});
+    }
+  }
+  ASSERT_LT(100U, addresses.size());
+
+  OndemandSupplier supplier(new TestdataSource(false), new NullStorage);
+  AddressValidator validator(&supplier);
+  FieldProblemMap problems;
+  size_t before = GetAllocatedBytes();
+  for (const auto& address : addresses) {
+    validator.Validate(address, true, true, nullptr, &problems, *validated_);
+  }
+  size_t allocated = GetAllocatedBytes() - before;
+
+  MemoryUsageMap usage = supplier.GetMemoryUsage();
+  ASSERT_EQ(1U, usage.size());
+  const MemoryUsage& cn = usage["CN"];
+  EXPECT_LT(0U, cn.rules);
+  EXPECT_LT(0U, cn.region_rules);
+  EXPECT_EQ(0U, cn.rule_index);
+  EXPECT_TRUE(IsCloseToAllocated(cn.GetTotal(), allocated));
+}
+
+TEST_F(MemoryUsageTest, RegionDataBuilderReportsCachedTrees) {
+  PreloadSupplier supplier(new TestdataSource(true), new NullStorage);
+  supplier.LoadRules("CN", *loaded_);
+  RegionDataBuilder builder(&supplier);
+  std::string best_language;
+  size_t before = GetAllocatedBytes();
+  const RegionData& tree = builder.Build("CN", "zh-Hans", &best_language);
+  size_t allocated = GetAllocatedBytes() - before;
+
+  MemoryUsageMap usage = builder.GetMemoryUsage();
+  ASSERT_EQ(1U, usage.size());
+  const MemoryUsage& cn = usage["CN"];
+  EXPECT_LT(0U, cn.rules);
+  EXPECT_EQ(0U, cn.rule_index);
+  EXPECT_TRUE(IsCloseToAllocated(cn.GetTotal(), allocated));
+  EXPECT_LE(builder.GetCachedSize(), cn.region_data);
+  EXPECT_FALSE(tree.sub_regions().empty());
+
+  // A tree that is dropped from the cache is no longer counted.
+  RegionDataBuilder small_builder(&supplier, 0);
+  std::shared_ptr<const RegionData> small_tree =
+      small_builder.BuildShared("CN", "zh-Hans", &best_language);
+  small_tree = small_builder.BuildShared("CN", "en", &best_language);
+  EXPECT_LT(small_builder.GetMemoryUsage()["CN"].region_data,
+            2 * cn.region_data);
+}
+
+TEST(MemoryUsageSumTest, AddsUpAllParts) {
+  MemoryUsage usage{.rules = 1,
+                    .postal_code_matchers = 2,
+                    .rule_index = 3,
+                    .region_rules = 4,
+                    .region_data = 5};
+  EXPECT_EQ(15U, usage.GetTotal());
+  usage += usage;
+  EXPECT_EQ(30U, usage.GetTotal());
+  EXPECT_EQ(10U, usage.region_data);
+}
+
+}  // namespace
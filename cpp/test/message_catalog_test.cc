@@ -0,0 +1,166 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libaddressinput/message_catalog.h>
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "util/string_util.h"
+
+namespace {
+
+using i18n::addressinput::DoReplaceStringPlaceholders;
+using i18n::addressinput::MessageCatalog;
+
+class MessageCatalogTest : public testing::Test {
+ public:
+  MessageCatalogTest(const MessageCatalogTest&) = delete;
+  MessageCatalogTest& operator=(const MessageCatalogTest&) = delete;
+
+ protected:
+  MessageCatalogTest() : data_(), catalog_() {
+    std::map<std::string, MessageCatalog::Messages> messages;
+    messages["en"][1] = "City";
+    messages["en"][2] = "$1 is not known.";
+    messages["fr"][1] = "Ville";
+    messages["fr"][3] = "";
+    messages["zh-Hant"][2] = "$1 未知";
+    data_ = MessageCatalog::Compile(messages);
+  }
+
+  std::string data_;
+  MessageCatalog catalog_;
+};
+
+TEST_F(MessageCatalogTest, EmptyCatalog) {
+  EXPECT_EQ(0U, catalog_.GetLocaleCount());
+  EXPECT_EQ(MessageCatalog::kNoLocale, catalog_.FindLocale("en"));
+
+  ASSERT_TRUE(catalog_.Load(MessageCatalog::Compile(
+      std::map<std::string, MessageCatalog::Messages>())));
+  EXPECT_EQ(0U, catalog_.GetLocaleCount());
+}
+
+TEST_F(MessageCatalogTest, FindLocale) {
+  ASSERT_TRUE(catalog_.Load(data_));
+  ASSERT_EQ(3U, catalog_.GetLocaleCount());
+  for (size_t i = 0; i < catalog_.GetLocaleCount(); ++i) {
+    EXPECT_EQ(i, catalog_.FindLocale(catalog_.GetLanguageTag(i)));
+  }
+  EXPECT_EQ("fr", catalog_.GetLanguageTag(catalog_.FindLocale("fr")));
+  EXPECT_EQ(MessageCatalog::kNoLocale, catalog_.FindLocale("de"));
+  EXPECT_EQ(MessageCatalog::kNoLocale, catalog_.FindLocale("zh"));
+}
+
+TEST_F(MessageCatalogTest, GetString) {
+  ASSERT_TRUE(catalog_.Load(data_));
+  size_t en = catalog_.FindLocale("en");
+  size_t fr = catalog_.FindLocale("fr");
+  size_t zh = catalog_.FindLocale("zh-Hant");
+  EXPECT_EQ("City", catalog_.GetString(en, 1));
+  EXPECT_EQ("Ville", catalog_.GetString(fr, 1));
+  EXPECT_EQ("$1 未知", catalog_.GetString(zh, 2));
+  EXPECT_TRUE(catalog_.GetString(fr, 2).empty());
+  EXPECT_TRUE(catalog_.GetString(fr, 3).empty());
+  EXPECT_TRUE(catalog_.GetString(zh, 1).empty());
+}
+
+TEST_F(MessageCatalogTest, StringsPointIntoData) {
+  ASSERT_TRUE(catalog_.Load(data_));
+  std::string_view city = catalog_.GetString(catalog_.FindLocale("en"), 1);
+  EXPECT_GE(city.data(), data_.data());
+  EXPECT_LE(city.data() + city.size(), data_.data() + data_.size());
+}
+
+TEST_F(MessageCatalogTest, AppendMessage) {
+  ASSERT_TRUE(catalog_.Load(data_));
+  std::string output = "Error: ";
+  catalog_.AppendMessage(catalog_.FindLocale("en"), 2, {"Foo"}, &output);
+  EXPECT_EQ("Error: Foo is not known.", output);
+
+  output.clear();
+  catalog_.AppendMessage(catalog_.FindLocale("fr"), 2, {"Foo"}, &output);
+  EXPECT_TRUE(output.empty());
+}
+
+TEST_F(MessageCatalogTest, PlaceholdersAreSameAsReplaceStringPlaceholders) {
+  static const char* const kTemplates[] = {
+      "",
+      "No placeholders",
+      "$1",
+      "$1$2$3",
+      "Before $1, between $2 and $3 after",
+      "$3 in $2 reverse $1 order",
+      "$1 $1 repeated",
+      "Missing $4 parameter",
+      "$10 and $12",
+      "Dollars $$ and $$$ and $$1 and $$$2",
+      "Trailing $",
+      "$$",
+      "$x not a placeholder",
+  };
+  const std::vector<std::string> parameters{
+      "one", "two", "three", "4", "5", "6", "7", "8", "9", "ten", "11", "12",
+  };
+
+  std::map<std::string, MessageCatalog::Messages> messages;
+  for (size_t i = 0; i < sizeof kTemplates / sizeof *kTemplates; ++i) {
+    messages["en"][i] = kTemplates[i];
+  }
+  data_ = MessageCatalog::Compile(messages);
+  ASSERT_TRUE(catalog_.Load(data_));
+
+  for (size_t i = 0; i < sizeof kTemplates / sizeof *kTemplates; ++i) {
+    SCOPED_TRACE(kTemplates[i]);
+    std::string output;
+    catalog_.AppendMessage(0, i, parameters, &output);
+    EXPECT_EQ(DoReplaceStringPlaceholders(kTemplates[i], parameters), output);
+  }
+}
+
+TEST_F(MessageCatalogTest, MalformedDataIsRejected) {
+  EXPECT_FALSE(catalog_.Load(""));
+  EXPECT_FALSE(catalog_.Load("ABCD"));
+
+  std::string bad_magic = data_;
+  bad_magic[0] = 'X';
+  EXPECT_FALSE(catalog_.Load(bad_magic));
+
+  for (size_t size = 0; size < data_.size(); ++size) {
+    std::string_view truncated(data_.data(), size);
+    ASSERT_TRUE(catalog_.Load(data_));
+    // Only the strings can be cut off without the tables pointing past the end
+    // of the data, and the last string is not empty.
+    EXPECT_FALSE(catalog_.Load(truncated)) << size;
+    EXPECT_EQ(0U, catalog_.GetLocaleCount());
+  }
+}
+
+TEST_F(MessageCatalogTest, UnsortedDataIsRejected) {
+  // Swap the first two message identifiers of "en", which come right after the
+  // magic number, the locale count and the 3 locale entries.
+  std::string unsorted = data_;
+  const size_t kFirstMessage = 4 + 4 + 3 * 12;
+  std::swap(unsorted[kFirstMessage], unsorted[kFirstMessage + 12]);
+  EXPECT_FALSE(catalog_.Load(unsorted));
+}
+
+}  // namespace
@@ -0,0 +1,262 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libaddressinput/metrics.h>
+
+#include <libaddressinput/address_data.h>
+#include <libaddressinput/address_field.h>
+#include <libaddressinput/address_problem.h>
+#include <libaddressinput/address_validator.h>
+#include <libaddressinput/callback.h>
+#include <libaddressinput/null_storage.h>
+#include <libaddressinput/ondemand_supplier.h>
+#include <libaddressinput/preload_supplier.h>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "fake_storage.h"
+#include "metrics_util.h"
+#include "mock_source.h"
+#include "retriever.h"
+#include "testdata_source.h"
+
+namespace {
+
+using i18n::addressinput::AddressData;
+using i18n::addressinput::AddressValidator;
+using i18n::addressinput::BuildCallback;
+using i18n::addressinput::FakeStorage;
+using i18n::addressinput::FieldProblemMap;
+using i18n::addressinput::GetMetricsSink;
+using i18n::addressinput::Metric;
+using i18n::addressinput::MetricsSink;
+using i18n::addressinput::MetricsTimer;
+using i18n::addressinput::MockSource;
+using i18n::addressinput::NullStorage;
+using i18n::addressinput::OndemandSupplier;
+using i18n::addressinput::PreloadSupplier;
+using i18n::addressinput::Retriever;
+using i18n::addressinput::SetMetricsSink;
+using i18n::addressinput::TestdataSource;
+
+using i18n::addressinput::ADMIN_AREA;
+using i18n::addressinput::UNKNOWN_VALUE;
+
+using i18n::addressinput::ONDEMAND_CACHE_HITS;
+using i18n::addressinput::ONDEMAND_CACHE_MISSES;
+using i18n::addressinput::ONDEMAND_PENDING_TASKS;
+using i18n::addressinput::PRELOAD_INDEX_SIZE;
+using i18n::addressinput::PRELOAD_LOAD_TIME;
+using i18n::addressinput::PRELOAD_REGIONS_EVICTED;
+using i18n::addressinput::PRELOAD_RULES_LOADED;
+using i18n::addressinput::RETRIEVER_SOURCE_BYTES;
+using i18n::addressinput::RETRIEVER_SOURCE_FAILURES;
+using i18n::addressinput::RETRIEVER_SOURCE_TIME;
+using i18n::addressinput::RETRIEVER_STORAGE_HITS;
+using i18n::addressinput::RETRIEVER_STORAGE_MISSES;
+using i18n::addressinput::VALIDATOR_PROBLEMS;
+using i18n::addressinput::VALIDATOR_VALIDATIONS;
+
+// Records all the metrics that it receives.
+class RecordingSink : public MetricsSink {
+ public:
+  RecordingSink(const RecordingSink&) = delete;
+  RecordingSink& operator=(const RecordingSink&) = delete;
+
+  RecordingSink() = default;
+  ~RecordingSink() override = default;
+
+  void AddToCounter(Metric metric, std::string_view label,
+                    int64_t value) override {
+    counters_[std::make_pair(metric, std::string(label))] += value;
+  }
+
+  void AddToHistogram(Metric metric, std::string_view label,
+                      int64_t value) override {
+    histograms_[std::make_pair(metric, std::string(label))].push_back(value);
+  }
+
+  int64_t GetCounter(Metric metric, const std::string& label) const {
+    auto it = counters_.find(std::make_pair(metric, label));
+    return it != counters_.end() ? it->second : 0;
+  }
+
+  std::vector<int64_t> GetHistogram(Metric metric,
+                                    const std::string& label) const {
+    auto it = histograms_.find(std::make_pair(metric, label));
+    return it != histograms_.end() ? it->second : std::vector<int64_t>();
+  }
+
+  bool empty() const { return counters_.empty() && histograms_.empty(); }
+
+ private:
+  std::map<std::pair<Metric, std::string>, int64_t> counters_;
+  std::map<std::pair<Metric, std::string>, std::vector<int64_t>> histograms_;
+};
+
+class MetricsTest : public testing::Test {
+ public:
+  MetricsTest(const MetricsTest&) = delete;
+  MetricsTest& operator=(const MetricsTest&) = delete;
+
+ protected:
+  MetricsTest()
+      : sink_(),
+        loaded_(BuildCallback(this, &MetricsTest::OnLoaded)),
+        retrieved_(BuildCallback(this, &MetricsTest::OnRetrieved)),
+        validated_(BuildCallback(this, &MetricsTest::OnValidated)) {
+    SetMetricsSink(&sink_);
+  }
+
+  ~MetricsTest() override { SetMetricsSink(nullptr); }
+
+  RecordingSink sink_;
+  const std::unique_ptr<const PreloadSupplier::Callback> loaded_;
+  const std::unique_ptr<const Retriever::Callback> retrieved_;
+  const std::unique_ptr<const AddressValidator::Callback> validated_;
+
+ private:
+  void OnLoaded(bool success, const std::string& region_code, int num_rules) {
+    EXPECT_TRUE(success);
+  }
+
+  void OnRetrieved(bool success, const std::string& key,
+                   std::string* data) {}
+
+  void OnValidated(bool success, const AddressData& address,
+                   const FieldProblemMap& problems) {
+    EXPECT_TRUE(success);
+  }
+};
+
+TEST_F(MetricsTest, SinkIsInstalled) {
+  EXPECT_EQ(&sink_, GetMetricsSink());
+}
+
+TEST_F(MetricsTest, PreloadSupplierReportsLoads) {
+  PreloadSupplier supplier(new TestdataSource(true), new NullStorage);
+  supplier.LoadRules("CH", *loaded_);
+  EXPECT_EQ(1U, sink_.GetHistogram(PRELOAD_LOAD_TIME, "CH").size());
+  int64_t rule_count = sink_.GetCounter(PRELOAD_RULES_LOADED, "CH");
+  EXPECT_LT(0, rule_count);
+  std::vector<int64_t> index_sizes =
+      sink_.GetHistogram(PRELOAD_INDEX_SIZE, "CH");
+  ASSERT_EQ(1U, index_sizes.size());
+  EXPECT_LE(rule_count, index_sizes.front());
+}
+
+TEST_F(MetricsTest, PreloadSupplierReportsEvictions) {
+  // The region loaded last is kept even if it's larger than the budget.
+  PreloadSupplier supplier(new TestdataSource(true), new NullStorage, 1);
+  supplier.LoadRules("CH", *loaded_);
+  EXPECT_EQ(0, sink_.GetCounter(PRELOAD_REGIONS_EVICTED, "CH"));
+  supplier.LoadRules("US", *loaded_);
+  EXPECT_EQ(1, sink_.GetCounter(PRELOAD_REGIONS_EVICTED, "CH"));
+  EXPECT_FALSE(supplier.IsLoaded("CH"));
+  EXPECT_TRUE(supplier.IsLoaded("US"));
+}
+
+TEST_F(MetricsTest, RetrieverReportsStorageAndSource) {
+  Retriever retriever(new TestdataSource(false), new FakeStorage);
+  retriever.Retrieve("data/CA", *retrieved_);
+  EXPECT_EQ(1, sink_.GetCounter(RETRIEVER_STORAGE_MISSES, ""));
+  EXPECT_EQ(1U, sink_.GetHistogram(RETRIEVER_SOURCE_TIME, "").size());
+  EXPECT_LT(0, sink_.GetCounter(RETRIEVER_SOURCE_BYTES, ""));
+  EXPECT_EQ(0, sink_.GetCounter(RETRIEVER_SOURCE_FAILURES, ""));
+
+  // The second time, the data is found in the storage.
+  retriever.Retrieve("data/CA", *retrieved_);
+  EXPECT_EQ(1, sink_.GetCounter(RETRIEVER_STORAGE_HITS, ""));
+  EXPECT_EQ(1U, sink_.GetHistogram(RETRIEVER_SOURCE_TIME, "").size());
+
+  // An empty MockSource will fail for any request.
+  Retriever bad_retriever(new MockSource, new NullStorage);
+  bad_retriever.Retrieve("data/CA", *retrieved_);
+  EXPECT_EQ(1, sink_.GetCounter(RETRIEVER_SOURCE_FAILURES, ""));
+}
+
+TEST_F(MetricsTest, OndemandSupplierReportsCacheHitsAndMisses) {
+  OndemandSupplier supplier(new TestdataSource(false), new NullStorage);
+  AddressValidator validator(&supplier);
+  const AddressData address{.region_code = "CH"};
+  FieldProblemMap problems;
+  validator.Validate(address, true, true, nullptr, &problems, *validated_);
+  EXPECT_EQ(0, sink_.GetCounter(ONDEMAND_CACHE_HITS, "CH"));
+  EXPECT_LT(0, sink_.GetCounter(ONDEMAND_CACHE_MISSES, "CH"));
+  // The task was pending only while the rules were retrieved.
+  EXPECT_EQ(0, sink_.GetCounter(ONDEMAND_PENDING_TASKS, ""));
+
+  validator.Validate(address, true, true, nullptr, &problems, *validated_);
+  EXPECT_LT(0, sink_.GetCounter(ONDEMAND_CACHE_HITS, "CH"));
+}
+
+TEST_F(MetricsTest, ValidatorReportsOutcomesAndProblems) {
+  PreloadSupplier supplier(new TestdataSource(true), new NullStorage);
+  supplier.LoadRules("US", *loaded_);
+  AddressValidator validator(&supplier);
+  // Only check the administrative area.
+  const FieldProblemMap filter{{ADMIN_AREA, UNKNOWN_VALUE}};
+  FieldProblemMap problems;
+
+  const AddressData valid{.region_code = "US",
+                          .address_line{"1098 Alta Ave"},
+                          .administrative_area = "CA",
+                          .locality = "Mountain View",
+                          .postal_code = "94043",
+                          .recipient = "John Doe"};
+  validator.Validate(valid, true, true, &filter, &problems, *validated_);
+  EXPECT_TRUE(problems.empty());
+  EXPECT_EQ(1, sink_.GetCounter(VALIDATOR_VALIDATIONS, "valid"));
+
+  const AddressData invalid{.region_code = "US",
+                            .address_line{"1098 Alta Ave"},
+                            .administrative_area = "XX",
+                            .locality = "Mountain View",
+                            .postal_code = "94043",
+                            .recipient = "John Doe"};
+  validator.Validate(invalid, true, true, &filter, &problems, *validated_);
+  EXPECT_EQ(1, sink_.GetCounter(VALIDATOR_VALIDATIONS, "invalid"));
+  EXPECT_EQ(1, sink_.GetCounter(VALIDATOR_PROBLEMS, "UNKNOWN_VALUE"));
+}
+
+TEST_F(MetricsTest, NothingIsReportedWithoutSink) {
+  SetMetricsSink(nullptr);
+  EXPECT_EQ(nullptr, GetMetricsSink());
+  MetricsTimer timer;
+  PreloadSupplier supplier(new TestdataSource(true), new NullStorage);
+  supplier.LoadRules("CH", *loaded_);
+  // Installing a sink after the timer started doesn't make it report.
+  SetMetricsSink(&sink_);
+  timer.Record(PRELOAD_LOAD_TIME, "CH");
+  EXPECT_TRUE(sink_.empty());
+}
+
+TEST(MetricTest, PrintsName) {
+  std::ostringstream oss;
+  oss << PRELOAD_LOAD_TIME << " " << VALIDATOR_PROBLEMS << " "
+      << static_cast<Metric>(-1);
+  EXPECT_EQ("PRELOAD_LOAD_TIME VALIDATOR_PROBLEMS [INVALID ENUM VALUE -1]",
+            oss.str());
+}
+
+}  // namespace
@@ -58,7 +58,8 @@ class OndemandSupplyTaskTest : public testing::Test {
         rule_cache_(),
         retriever_(new Retriever(source_, new NullStorage)),
         supplied_(BuildCallback(this, &OndemandSupplyTaskTest::Supplied)),
-        task_(new OndemandSupplyTask(lookup_key_, &rule_cache_, *supplied_)) {}
+        task_(new OndemandSupplyTask(lookup_key_, &rule_cache_, *supplied_,
+                                     nullptr)) {}
 
   ~OndemandSupplyTaskTest() override {
     for (const auto& pair : rule_cache_) {
@@ -15,31 +15,56 @@
 #include <libaddressinput/preload_supplier.h>
 
 #include <libaddressinput/address_data.h>
+#include <libaddressinput/address_field.h>
+#include <libaddressinput/address_problem.h>
+#include <libaddressinput/address_validator.h>
 #include <libaddressinput/callback.h>
 #include <libaddressinput/null_storage.h>
+#include <libaddressinput/region_data.h>
+#include <libaddressinput/region_data_builder.h>
 #include <libaddressinput/supplier.h>
 
 #include <cstddef>
+#include <atomic>
 #include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <gtest/gtest.h>
 
+#include "deferred_source.h"
 #include "lookup_key.h"
+#include "mock_source.h"
 #include "rule.h"
+#include "rule_tree.h"
 #include "testdata_source.h"
 
 namespace {
 
 using i18n::addressinput::AddressData;
+using i18n::addressinput::AddressValidator;
 using i18n::addressinput::BuildCallback;
+using i18n::addressinput::DeferredSource;
+using i18n::addressinput::FieldProblemMap;
 using i18n::addressinput::LookupKey;
+using i18n::addressinput::MockSource;
 using i18n::addressinput::NullStorage;
 using i18n::addressinput::PreloadSupplier;
+using i18n::addressinput::RegionData;
+using i18n::addressinput::RegionDataBuilder;
 using i18n::addressinput::Rule;
+using i18n::addressinput::RuleTree;
 using i18n::addressinput::Supplier;
 using i18n::addressinput::TestdataSource;
 
+using i18n::addressinput::ADMIN_AREA;
+using i18n::addressinput::DEPENDENT_LOCALITY;
+using i18n::addressinput::LOCALITY;
+
+using i18n::addressinput::UNKNOWN_VALUE;
+using i18n::addressinput::UNSUPPORTED_FIELD;
+
 class PreloadSupplierTest : public testing::Test {
  public:
   PreloadSupplierTest(const PreloadSupplierTest&) = delete;
@@ -49,11 +74,15 @@ class PreloadSupplierTest : public testing::Test {
   PreloadSupplierTest()
       : supplier_(new TestdataSource(true), new NullStorage),
         loaded_callback_(BuildCallback(this, &PreloadSupplierTest::OnLoaded)),
+        already_loaded_callback_(
+            BuildCallback(this, &PreloadSupplierTest::OnAlreadyLoaded)),
         supplied_callback_(
             BuildCallback(this, &PreloadSupplierTest::OnSupplied)) {}
 
   PreloadSupplier supplier_;
   const std::unique_ptr<const PreloadSupplier::Callback> loaded_callback_;
+  const std::unique_ptr<const PreloadSupplier::Callback>
+      already_loaded_callback_;
   const std::unique_ptr<const Supplier::Callback> supplied_callback_;
   Supplier::RuleHierarchy hierarchy_;
 
@@ -65,6 +94,12 @@ class PreloadSupplierTest : public testing::Test {
     ASSERT_TRUE(supplier_.IsLoaded(region_code));
   }
 
+  void OnAlreadyLoaded(bool success, const std::string& region_code,
+                       int num_rules) {
+    ASSERT_TRUE(success);
+    ASSERT_EQ(0, num_rules);
+  }
+
   void OnSupplied(bool success, const LookupKey& lookup_key,
                   const Supplier::RuleHierarchy& hierarchy) {
     ASSERT_TRUE(success);
@@ -150,6 +185,20 @@ TEST_F(PreloadSupplierTest, GetRulesForRegion) {
   EXPECT_LT(1U, rules.size());
 }
 
+TEST_F(PreloadSupplierTest, GetRulesForUnloadedRegion) {
+  supplier_.LoadRules("CN", *loaded_callback_);
+  auto rules = supplier_.GetSharedRulesForRegion("CN");
+  ASSERT_TRUE(rules != nullptr);
+  EXPECT_EQ(supplier_.GetRulesForRegion("CN").size(), rules->size());
+
+  EXPECT_TRUE(supplier_.UnloadRules("CN"));
+  EXPECT_TRUE(supplier_.GetRulesForRegion("CN").empty());
+  EXPECT_TRUE(supplier_.GetSharedRulesForRegion("CN") == nullptr);
+  // The rules that are still referenced are still there.
+  ASSERT_TRUE(rules->find("data/CN") != rules->end());
+  EXPECT_EQ("data/CN", rules->at("data/CN")->GetId());
+}
+
 TEST_F(PreloadSupplierTest, SupplyRegionCode) {
   supplier_.LoadRules("CA", *loaded_callback_);
   LookupKey key;
@@ -370,4 +419,462 @@ TEST_F(PreloadSupplierTest, GetLoadedRuleDepth) {
       0, supplier_.GetLoadedRuleDepth("data/PP"));  // Not a valid region code.
 }
 
+TEST_F(PreloadSupplierTest, LoadRulesToDepth) {
+  supplier_.LoadRules("CN", 1, *loaded_callback_);
+  EXPECT_TRUE(supplier_.IsLoaded("CN"));
+  EXPECT_EQ(2, supplier_.GetLoadedRuleDepth("data/CN"));  // country, admin area
+
+  PreloadSupplier complete(new TestdataSource(true), new NullStorage);
+  complete.LoadRules("CN", *loaded_callback_);
+  EXPECT_GT(complete.GetRulesForRegion("CN").size(),
+            supplier_.GetRulesForRegion("CN").size());
+
+  const AddressData address{
+      .region_code = "CN",
+      .administrative_area = "云南省",
+      .locality = "临沧市",
+  };
+  LookupKey key;
+  key.FromAddress(address);
+  supplier_.Supply(key, *supplied_callback_);
+  ASSERT_TRUE(hierarchy_.rule[1] != nullptr);
+  EXPECT_EQ("data/CN/云南省", hierarchy_.rule[1]->GetId());
+  EXPECT_TRUE(hierarchy_.rule[2] == nullptr);
+}
+
+TEST_F(PreloadSupplierTest, LoadRulesToGreaterDepth) {
+  supplier_.LoadRules("CN", 1, *loaded_callback_);
+  size_t count = supplier_.GetRulesForRegion("CN").size();
+  supplier_.LoadRules("CN", *loaded_callback_);
+  EXPECT_EQ(4, supplier_.GetLoadedRuleDepth("data/CN"));
+
+  PreloadSupplier complete(new TestdataSource(true), new NullStorage);
+  complete.LoadRules("CN", *loaded_callback_);
+  EXPECT_LT(count, supplier_.GetRulesForRegion("CN").size());
+  EXPECT_EQ(complete.GetRulesForRegion("CN").size(),
+            supplier_.GetRulesForRegion("CN").size());
+
+  const AddressData address{
+      .region_code = "CN",
+      .administrative_area = "云南省",
+      .locality = "临沧市",
+      .dependent_locality = "临翔区",
+  };
+  LookupKey key;
+  key.FromAddress(address);
+  supplier_.Supply(key, *supplied_callback_);
+  ASSERT_TRUE(hierarchy_.rule[3] != nullptr);
+  EXPECT_EQ("data/CN/云南省/临沧市/临翔区", hierarchy_.rule[3]->GetId());
+}
+
+TEST_F(PreloadSupplierTest, ValidateWithRulesLoadedToDepth) {
+  supplier_.LoadRules("CN", 1, *loaded_callback_);
+  const AddressData address{
+      .region_code = "CN",
+      .address_line{"Test"},
+      .administrative_area = "云南省",
+      .locality = "临沧市",
+      .dependent_locality = "临翔区",
+      .postal_code = "677000",
+      .recipient = "Test",
+  };
+  FieldProblemMap problems;
+  EXPECT_TRUE(AddressValidator::ValidateNow(supplier_, address, false, false,
+                                            nullptr, &problems));
+  EXPECT_EQ(0U, problems.count(ADMIN_AREA));
+  EXPECT_EQ(1U, problems.count(LOCALITY));
+  EXPECT_EQ(1U, problems.count(DEPENDENT_LOCALITY));
+  for (const auto& problem : problems) {
+    EXPECT_NE(UNKNOWN_VALUE, problem.second);
+  }
+  EXPECT_TRUE(problems.find(LOCALITY)->second == UNSUPPORTED_FIELD);
+  EXPECT_TRUE(problems.find(DEPENDENT_LOCALITY)->second == UNSUPPORTED_FIELD);
+}
+
+TEST_F(PreloadSupplierTest, RegionCodesMatchInAnyCase) {
+  supplier_.LoadRules("US", *loaded_callback_);
+  EXPECT_TRUE(supplier_.IsLoaded("us"));
+  EXPECT_EQ(supplier_.GetRuleTree("US"), supplier_.GetRuleTree("us"));
+  EXPECT_TRUE(supplier_.UnloadRules("us"));
+  EXPECT_FALSE(supplier_.IsLoaded("US"));
+}
+
+TEST_F(PreloadSupplierTest, UnloadRules) {
+  EXPECT_FALSE(supplier_.UnloadRules("US"));
+  supplier_.LoadRules("US", *loaded_callback_);
+  const std::shared_ptr<const RuleTree> tree = supplier_.GetRuleTree("US");
+  const AddressData address{.region_code = "US", .administrative_area = "CA"};
+  LookupKey key;
+  key.FromAddress(address);
+  supplier_.Supply(key, *supplied_callback_);
+
+  EXPECT_TRUE(supplier_.UnloadRules("US"));
+  EXPECT_FALSE(supplier_.IsLoaded("US"));
+  EXPECT_TRUE(supplier_.GetRuleTree("US") == nullptr);
+  EXPECT_EQ(0, supplier_.GetLoadedRuleDepth("data/US"));
+  EXPECT_TRUE(supplier_.GetMemoryUsage().empty());
+  EXPECT_FALSE(supplier_.UnloadRules("US"));
+
+  // The rules that are still referred to are still there.
+  EXPECT_EQ("data/US", tree->GetRule(RuleTree::kRoot)->GetId());
+  ASSERT_TRUE(hierarchy_.rule[1] != nullptr);
+  EXPECT_EQ("data/US/CA", hierarchy_.rule[1]->GetId());
+
+  supplier_.LoadRules("US", *loaded_callback_);
+  EXPECT_NE(tree, supplier_.GetRuleTree("US"));
+}
+
+TEST_F(PreloadSupplierTest, ReadersKeepRulesThatAreUnloaded) {
+  supplier_.LoadRules("CA", *loaded_callback_);
+  const AddressData address{.region_code = "CA",
+                            .administrative_area = "QC",
+                            .postal_code = "H3B 2Y5"};
+  std::atomic<bool> done(false);
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; ++i) {
+    readers.emplace_back([this, &address, &done]() {
+      while (!done) {
+        FieldProblemMap problems;
+        if (AddressValidator::ValidateNow(supplier_, address, true, true,
+                                          nullptr, &problems)) {
+          EXPECT_EQ(0U, problems.count(ADMIN_AREA));
+        }
+      }
+    });
+  }
+  for (int i = 0; i < 20; ++i) {
+    EXPECT_TRUE(supplier_.UnloadRules("CA"));
+    supplier_.LoadRules("CA", *loaded_callback_);
+  }
+  done = true;
+  for (auto& reader : readers) {
+    reader.join();
+  }
+}
+
+TEST_F(PreloadSupplierTest, LeastRecentlyUsedRegionsAreEvicted) {
+  // Find out how much memory the rules of each region take.
+  supplier_.LoadRules("CH", *loaded_callback_);
+  supplier_.LoadRules("US", *loaded_callback_);
+  supplier_.LoadRules("CA", *loaded_callback_);
+  auto usage = supplier_.GetMemoryUsage();
+
+  // A supplier with room for CH and US, but not also for CA.
+  PreloadSupplier supplier(new TestdataSource(true), new NullStorage,
+                           usage["CH"].GetTotal() + usage["US"].GetTotal() +
+                               usage["CA"].GetTotal() / 2);
+  supplier.LoadRules("CH", *loaded_callback_);
+  supplier.LoadRules("US", *loaded_callback_);
+
+  // Using CH makes US the least recently used region.
+  supplier.LoadRules("CH", *already_loaded_callback_);
+  supplier.LoadRules("CA", *loaded_callback_);
+  EXPECT_TRUE(supplier.IsLoaded("CH"));
+  EXPECT_FALSE(supplier.IsLoaded("US"));
+  EXPECT_TRUE(supplier.IsLoaded("CA"));
+
+  // An evicted region is loaded again when it's asked for.
+  supplier.LoadRules("US", *loaded_callback_);
+  EXPECT_TRUE(supplier.IsLoaded("US"));
+}
+
+TEST_F(PreloadSupplierTest, ReadingRulesUsesRegion) {
+  supplier_.LoadRules("CH", *loaded_callback_);
+  supplier_.LoadRules("US", *loaded_callback_);
+  supplier_.LoadRules("CA", *loaded_callback_);
+  auto usage = supplier_.GetMemoryUsage();
+
+  PreloadSupplier supplier(new TestdataSource(true), new NullStorage,
+                           usage["CH"].GetTotal() + usage["US"].GetTotal() +
+                               usage["CA"].GetTotal() / 2);
+  supplier.LoadRules("CH", *loaded_callback_);
+  supplier.LoadRules("US", *loaded_callback_);
+
+  // Validating an address in CH makes US the least recently used region.
+  LookupKey key;
+  const AddressData address{.region_code = "CH"};
+  key.FromAddress(address);
+  supplier.Supply(key, *supplied_callback_);
+  ASSERT_TRUE(hierarchy_.rule[0] != nullptr);
+
+  supplier.LoadRules("CA", *loaded_callback_);
+  EXPECT_TRUE(supplier.IsLoaded("CH"));
+  EXPECT_FALSE(supplier.IsLoaded("US"));
+  EXPECT_TRUE(supplier.IsLoaded("CA"));
+}
+
+TEST_F(PreloadSupplierTest, GetRuleTree) {
+  EXPECT_TRUE(supplier_.GetRuleTree("US") == nullptr);
+  supplier_.LoadRules("US", *loaded_callback_);
+  const std::shared_ptr<const RuleTree> tree = supplier_.GetRuleTree("US");
+  ASSERT_TRUE(tree != nullptr);
+  EXPECT_EQ("data/US", tree->GetRule(RuleTree::kRoot)->GetId());
+
+  size_t ca = tree->FindChild(RuleTree::kRoot, "CA");
+  ASSERT_NE(RuleTree::kNoNode, ca);
+  ASSERT_TRUE(tree->GetRule(ca) != nullptr);
+  EXPECT_EQ("data/US/CA", tree->GetRule(ca)->GetId());
+  EXPECT_EQ(RuleTree::kNoNode, tree->FindChild(RuleTree::kRoot, "California"));
+}
+
+class DeferredLoadTest : public testing::Test {
+ public:
+  DeferredLoadTest(const DeferredLoadTest&) = delete;
+  DeferredLoadTest& operator=(const DeferredLoadTest&) = delete;
+
+ protected:
+  DeferredLoadTest()
+      : source_(new DeferredSource(true)),
+        supplier_(source_, new NullStorage),
+        loaded_(BuildCallback(this, &DeferredLoadTest::OnLoaded)) {}
+
+  DeferredSource* const source_;  // Owned by |supplier_|.
+  PreloadSupplier supplier_;
+  const std::unique_ptr<const PreloadSupplier::Callback> loaded_;
+
+ private:
+  void OnLoaded(bool success, const std::string& region_code, int num_rules) {
+    ASSERT_TRUE(success);
+  }
+};
+
+TEST_F(DeferredLoadTest, LoadRulesToGreaterDepthOfUnloadedRegion) {
+  supplier_.LoadRules("CN", 1, *loaded_);
+  source_->Finish();
+  const std::shared_ptr<const RuleTree> shallow = supplier_.GetRuleTree("CN");
+  ASSERT_TRUE(shallow != nullptr);
+
+  supplier_.LoadRules("CN", *loaded_);
+  EXPECT_TRUE(supplier_.UnloadRules("CN"));
+  source_->Finish();
+
+  // The rules that were unloaded meanwhile are built again, instead of being
+  // published again.
+  const std::shared_ptr<const RuleTree> tree = supplier_.GetRuleTree("CN");
+  ASSERT_TRUE(tree != nullptr);
+  EXPECT_NE(shallow->GetRule(RuleTree::kRoot), tree->GetRule(RuleTree::kRoot));
+  EXPECT_EQ(4, supplier_.GetLoadedRuleDepth("data/CN"));
+}
+
+// The aggregated data of a region, before and after some of its rules changed:
+// AL is removed, CA is renamed and NY is added.
+const char kUsData[] = R"({
+  "data/US": {"id": "data/US", "zip": "(\\d{5})(?:[ \\-](\\d{4}))?"},
+  "data/US/AL": {"id": "data/US/AL", "name": "Alabama"},
+  "data/US/CA": {"id": "data/US/CA", "name": "California"}
+})";
+const char kUpdatedUsData[] = R"({
+  "data/US": {"id": "data/US", "zip": "(\\d{5})(?:[ \\-](\\d{4}))?"},
+  "data/US/CA": {"id": "data/US/CA", "name": "Kalifornien"},
+  "data/US/NY": {"id": "data/US/NY", "name": "New York"}
+})";
+
+// The aggregated data of a region with names that collide, before and after
+// the rule indexed by "Georgia" is removed and a rule that is indexed by
+// "California" instead of CA is added.
+const char kCollidingUsData[] = R"({
+  "data/US": {"id": "data/US"},
+  "data/US/AL": {"id": "data/US/AL", "name": "Georgia"},
+  "data/US/CA": {"id": "data/US/CA", "name": "California"},
+  "data/US/GA": {"id": "data/US/GA", "name": "Georgia"}
+})";
+const char kUpdatedCollidingUsData[] = R"({
+  "data/US": {"id": "data/US"},
+  "data/US/AK": {"id": "data/US/AK", "name": "California"},
+  "data/US/CA": {"id": "data/US/CA", "name": "California"},
+  "data/US/GA": {"id": "data/US/GA", "name": "Georgia"}
+})";
+
+class ReloadRulesTest : public testing::Test {
+ public:
+  ReloadRulesTest(const ReloadRulesTest&) = delete;
+  ReloadRulesTest& operator=(const ReloadRulesTest&) = delete;
+
+ protected:
+  ReloadRulesTest()
+      : source_(new MockSource),
+        supplier_(source_, new NullStorage),
+        loaded_(BuildCallback(this, &ReloadRulesTest::OnLoaded)),
+        reloaded_(BuildCallback(this, &ReloadRulesTest::OnReloaded)),
+        success_(false),
+        changes_() {
+    source_->data_ = {{"data/US", kUsData}};
+  }
+
+  // Returns the rule of the ADMIN_AREA of US named |name| in |supplier|, or
+  // nullptr.
+  static const Rule* GetStateRule(const PreloadSupplier& supplier,
+                                  const std::string& name) {
+    const AddressData address{.region_code = "US",
+                              .administrative_area = name};
+    LookupKey key;
+    key.FromAddress(address);
+    return supplier.GetRule(key);
+  }
+
+  const Rule* GetStateRule(const std::string& name) const {
+    return GetStateRule(supplier_, name);
+  }
+
+  // Returns the ID of the rule of the ADMIN_AREA of US named |name| in
+  // |supplier|, or an empty string.
+  static std::string GetStateId(const PreloadSupplier& supplier,
+                                const std::string& name) {
+    const Rule* rule = GetStateRule(supplier, name);
+    return rule != nullptr ? rule->GetId() : std::string();
+  }
+
+  MockSource* const source_;  // Owned by |supplier_|.
+  PreloadSupplier supplier_;
+  const std::unique_ptr<const PreloadSupplier::Callback> loaded_;
+  const std::unique_ptr<const PreloadSupplier::ReloadCallback> reloaded_;
+  bool success_;
+  PreloadSupplier::RuleChanges changes_;
+
+ private:
+  void OnLoaded(bool success, const std::string& region_code, int num_rules) {
+    ASSERT_TRUE(success);
+  }
+
+  void OnReloaded(bool success, const std::string& region_code,
+                  const PreloadSupplier::RuleChanges& changes) {
+    ASSERT_FALSE(region_code.empty());
+    success_ = success;
+    changes_ = changes;
+  }
+};
+
+TEST_F(ReloadRulesTest, ReplacesChangedRules) {
+  supplier_.LoadRules("US", *loaded_);
+  const Rule* country = supplier_.GetRulesForRegion("US").at("data/US");
+  const Rule* california = GetStateRule("California");
+  ASSERT_TRUE(california != nullptr);
+  ASSERT_TRUE(GetStateRule("Alabama") != nullptr);
+  const std::shared_ptr<const RuleTree> tree = supplier_.GetRuleTree("US");
+
+  source_->data_ = {{"data/US", kUpdatedUsData}};
+  supplier_.ReloadRules("US", *reloaded_);
+  ASSERT_TRUE(success_);
+  EXPECT_EQ(std::vector<std::string>{"data/US/NY"}, changes_.added);
+  EXPECT_EQ(std::vector<std::string>{"data/US/CA"}, changes_.changed);
+  EXPECT_EQ(std::vector<std::string>{"data/US/AL"}, changes_.removed);
+
+  // The unchanged rule is reused, and the changed rules are indexed by their
+  // new names only.
+  EXPECT_EQ(country, supplier_.GetRulesForRegion("US").at("data/US"));
+  EXPECT_EQ(3U, supplier_.GetRulesForRegion("US").size());
+  const Rule* kalifornien = GetStateRule("Kalifornien");
+  ASSERT_TRUE(kalifornien != nullptr);
+  EXPECT_NE(california, kalifornien);
+  EXPECT_EQ(kalifornien, GetStateRule("CA"));
+  EXPECT_TRUE(GetStateRule("California") == nullptr);
+  EXPECT_TRUE(GetStateRule("Alabama") == nullptr);
+  EXPECT_TRUE(GetStateRule("AL") == nullptr);
+  ASSERT_TRUE(GetStateRule("New York") != nullptr);
+  EXPECT_EQ("data/US/NY", GetStateRule("New York")->GetId());
+
+  // The tree that was published before the reload keeps the old rules.
+  EXPECT_NE(tree, supplier_.GetRuleTree("US"));
+  EXPECT_EQ("California", california->GetName());
+}
+
+TEST_F(ReloadRulesTest, LoadsRulesThatAreNotLoaded) {
+  supplier_.ReloadRules("US", *reloaded_);
+  ASSERT_TRUE(success_);
+  EXPECT_EQ((std::vector<std::string>{"data/US", "data/US/AL", "data/US/CA"}),
+            changes_.added);
+  EXPECT_TRUE(changes_.changed.empty());
+  EXPECT_TRUE(supplier_.IsLoaded("US"));
+  ASSERT_TRUE(GetStateRule("California") != nullptr);
+  EXPECT_EQ("data/US/CA", GetStateRule("California")->GetId());
+}
+
+TEST_F(ReloadRulesTest, FailureKeepsRules) {
+  supplier_.LoadRules("US", *loaded_);
+  const std::shared_ptr<const RuleTree> tree = supplier_.GetRuleTree("US");
+
+  source_->data_.clear();
+  success_ = true;
+  supplier_.ReloadRules("US", *reloaded_);
+  EXPECT_FALSE(success_);
+  EXPECT_TRUE(changes_.added.empty());
+  EXPECT_EQ(tree, supplier_.GetRuleTree("US"));
+}
+
+TEST_F(ReloadRulesTest, UnchangedRulesPublishNothing) {
+  PreloadSupplier supplier(new TestdataSource(true), new NullStorage);
+  supplier.LoadRules("CA", *loaded_);
+  const std::shared_ptr<const RuleTree> tree = supplier.GetRuleTree("CA");
+
+  supplier.ReloadRules("CA", *reloaded_);
+  ASSERT_TRUE(success_);
+  EXPECT_TRUE(changes_.added.empty());
+  EXPECT_TRUE(changes_.changed.empty());
+  EXPECT_TRUE(changes_.removed.empty());
+  EXPECT_EQ(tree, supplier.GetRuleTree("CA"));
+}
+
+TEST_F(ReloadRulesTest, KeepsLoadedDepth) {
+  PreloadSupplier supplier(new TestdataSource(true), new NullStorage);
+  supplier.LoadRules("CN", 1, *loaded_);
+  supplier.ReloadRules("CN", *reloaded_);
+  ASSERT_TRUE(success_);
+  EXPECT_TRUE(changes_.added.empty());
+  EXPECT_TRUE(changes_.removed.empty());
+  EXPECT_EQ(2, supplier.GetLoadedRuleDepth("data/CN"));
+}
+
+TEST_F(ReloadRulesTest, IndexesCollidingNamesAsLoadRules) {
+  source_->data_ = {{"data/US", kCollidingUsData}};
+  supplier_.LoadRules("US", *loaded_);
+  EXPECT_EQ("data/US/AL", GetStateId(supplier_, "Georgia"));
+  EXPECT_EQ("data/US/CA", GetStateId(supplier_, "California"));
+
+  source_->data_ = {{"data/US", kUpdatedCollidingUsData}};
+  supplier_.ReloadRules("US", *reloaded_);
+  ASSERT_TRUE(success_);
+  auto* source = new MockSource;
+  source->data_ = source_->data_;
+  PreloadSupplier supplier(source, new NullStorage);
+  supplier.LoadRules("US", *loaded_);
+
+  for (const char* name : {"Georgia", "California", "AK", "AL", "CA", "GA"}) {
+    EXPECT_EQ(GetStateId(supplier, name), GetStateId(supplier_, name))
+        << name;
+  }
+  EXPECT_EQ("data/US/GA", GetStateId(supplier_, "Georgia"));
+  EXPECT_EQ("data/US/AK", GetStateId(supplier_, "California"));
+}
+
+TEST_F(ReloadRulesTest, BuilderServesReloadedRules) {
+  // The region data is built from the sub-keys of the country.
+  source_->data_ = {{"data/US", R"({
+    "data/US": {"id": "data/US", "sub_keys": "AL~CA"},
+    "data/US/AL": {"id": "data/US/AL", "name": "Alabama"},
+    "data/US/CA": {"id": "data/US/CA", "name": "California"}
+  })"}};
+  supplier_.LoadRules("US", *loaded_);
+  RegionDataBuilder builder(&supplier_);
+  std::string best_language;
+  std::shared_ptr<const RegionData> tree =
+      builder.BuildShared("US", "en", &best_language);
+  ASSERT_EQ(2U, tree->sub_regions().size());
+  EXPECT_EQ("California", tree->sub_regions()[1]->name());
+
+  source_->data_ = {{"data/US", R"({
+    "data/US": {"id": "data/US", "sub_keys": "CA~NY"},
+    "data/US/CA": {"id": "data/US/CA", "name": "Kalifornien"},
+    "data/US/NY": {"id": "data/US/NY", "name": "New York"}
+  })"}};
+  supplier_.ReloadRules("US", *reloaded_);
+  ASSERT_TRUE(success_);
+  const RegionData& reloaded = builder.Build("US", "en", &best_language);
+  ASSERT_EQ(2U, reloaded.sub_regions().size());
+  EXPECT_EQ("Kalifornien", reloaded.sub_regions()[0]->name());
+  EXPECT_EQ("New York", reloaded.sub_regions()[1]->name());
+
+  // The tree that was built before the reload keeps the old rules.
+  EXPECT_EQ("California", tree->sub_regions()[1]->name());
+}
+
 }  // namespace
@@ -18,12 +18,16 @@
 #include <libaddressinput/null_storage.h>
 #include <libaddressinput/preload_supplier.h>
 #include <libaddressinput/region_data.h>
+#include <libaddressinput/region_tree.h>
 
 #include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <gtest/gtest.h>
 
+#include "rule_tree.h"
 #include "testdata_source.h"
 
 namespace {
@@ -32,9 +36,38 @@ using i18n::addressinput::BuildCallback;
 using i18n::addressinput::NullStorage;
 using i18n::addressinput::PreloadSupplier;
 using i18n::addressinput::RegionData;
+using i18n::addressinput::REGION_TREE_BINARY;
+using i18n::addressinput::REGION_TREE_JSON;
 using i18n::addressinput::RegionDataBuilder;
+using i18n::addressinput::RegionTree;
+using i18n::addressinput::RuleTree;
+using i18n::addressinput::SerializedRegionTree;
 using i18n::addressinput::TestdataSource;
 
+testing::AssertionResult TreesAreEqual(const RegionData& expected,
+                                       const RegionTree& actual,
+                                       size_t node) {
+  if (expected.key() != actual.GetKey(node) ||
+      expected.name() != actual.GetName(node)) {
+    return testing::AssertionFailure()
+           << expected.key() << ":" << expected.name() << " != "
+           << actual.GetKey(node) << ":" << actual.GetName(node);
+  }
+  size_t child = actual.GetFirstChild(node);
+  if (expected.sub_regions().size() != actual.GetChildEnd(node) - child) {
+    return testing::AssertionFailure()
+           << "different number of children for " << expected.key();
+  }
+  for (const RegionData* sub_region : expected.sub_regions()) {
+    testing::AssertionResult result =
+        TreesAreEqual(*sub_region, actual, child++);
+    if (!result) {
+      return result;
+    }
+  }
+  return testing::AssertionSuccess();
+}
+
 class RegionDataBuilderTest : public testing::Test {
  public:
   RegionDataBuilderTest(const RegionDataBuilderTest&) = delete;
@@ -118,4 +151,238 @@ TEST_F(RegionDataBuilderTest, KrWithKoKrLanguageHasKoreanKeysAndNames) {
   EXPECT_EQ("강원", tree.sub_regions().front()->name());
 }
 
+TEST_F(RegionDataBuilderTest, BuildTreeIsSameAsBuild) {
+  const struct {
+    const char* region_code;
+    const char* ui_language_tag;
+  } kTestCases[] = {
+      {"US", "en-US"},
+      {"CN", "zh-Hans"},
+      {"CN", "zh-Latn"},
+      {"CH", "de-CH"},
+      {"KR", "ko-KR"},
+      {"KR", "ko-Latn"},
+      {"JP", "ja"},
+      {"ZW", "en-ZW"},
+  };
+  for (const auto& test_case : kTestCases) {
+    SCOPED_TRACE(test_case.ui_language_tag);
+    if (!supplier_.IsLoaded(test_case.region_code)) {
+      supplier_.LoadRules(test_case.region_code, *loaded_callback_);
+    }
+    const RegionData& expected = builder_.Build(
+        test_case.region_code, test_case.ui_language_tag, &best_language_);
+    std::string tree_language;
+    const RegionTree& tree = builder_.BuildTree(
+        test_case.region_code, test_case.ui_language_tag, &tree_language);
+    EXPECT_EQ(best_language_, tree_language);
+    EXPECT_TRUE(TreesAreEqual(expected, tree, RegionTree::kRoot));
+  }
+}
+
+TEST_F(RegionDataBuilderTest, BuildTreeIsCached) {
+  supplier_.LoadRules("KR", *loaded_callback_);
+  const RegionTree& tree = builder_.BuildTree("KR", "ko-KR", &best_language_);
+  EXPECT_EQ(&tree, &builder_.BuildTree("KR", "ko", &best_language_));
+  // Both of these get Latin-script names.
+  const RegionTree& latin_tree =
+      builder_.BuildTree("KR", "ko-Latn", &best_language_);
+  EXPECT_NE(&tree, &latin_tree);
+  EXPECT_EQ(&latin_tree, &builder_.BuildTree("KR", "en", &best_language_));
+}
+
+TEST_F(RegionDataBuilderTest, CnTreeChildrenOfProvince) {
+  supplier_.LoadRules("CN", *loaded_callback_);
+  const RegionTree& tree =
+      builder_.BuildTree("CN", "zh-Hans", &best_language_);
+  size_t province = tree.FindChild(RegionTree::kRoot, "广东省");
+  ASSERT_NE(RegionTree::kNoNode, province);
+  EXPECT_LT(tree.GetFirstChild(province), tree.GetChildEnd(province));
+  EXPECT_NE(RegionTree::kNoNode, tree.FindChild(province, "广州市"));
+}
+
+TEST_F(RegionDataBuilderTest, BuildSerializedUsJson) {
+  supplier_.LoadRules("US", *loaded_callback_);
+  const SerializedRegionTree& json = *builder_.BuildSerialized(
+      "US", "en-US", REGION_TREE_JSON, &best_language_);
+  EXPECT_EQ("en", best_language_);
+  EXPECT_EQ(0U, json.data.find(R"({"key":"US","name":"US","sub_regions":[)"
+                               R"({"key":"AL","name":"Alabama"},)"));
+  EXPECT_EQ(32U, json.content_hash.size());
+
+  std::string expected;
+  builder_.BuildTree("US", "en-US", &best_language_)
+      .Serialize(REGION_TREE_JSON, &expected);
+  EXPECT_EQ(expected, json.data);
+}
+
+TEST_F(RegionDataBuilderTest, BuildSerializedIsCached) {
+  supplier_.LoadRules("KR", *loaded_callback_);
+  std::shared_ptr<const SerializedRegionTree> json = builder_.BuildSerialized(
+      "KR", "ko-KR", REGION_TREE_JSON, &best_language_);
+  EXPECT_EQ(json, builder_.BuildSerialized("KR", "ko", REGION_TREE_JSON,
+                                           &best_language_));
+
+  std::shared_ptr<const SerializedRegionTree> binary =
+      builder_.BuildSerialized("KR", "ko-KR", REGION_TREE_BINARY,
+                               &best_language_);
+  EXPECT_NE(json->data, binary->data);
+  EXPECT_NE(json->content_hash, binary->content_hash);
+
+  std::shared_ptr<const SerializedRegionTree> latin_json =
+      builder_.BuildSerialized("KR", "ko-Latn", REGION_TREE_JSON,
+                               &best_language_);
+  EXPECT_EQ("ko-Latn", best_language_);
+  EXPECT_NE(json->data, latin_json->data);
+  EXPECT_NE(json->content_hash, latin_json->content_hash);
+}
+
+TEST_F(RegionDataBuilderTest, BuildIsCached) {
+  supplier_.LoadRules("US", *loaded_callback_);
+  EXPECT_EQ(0U, builder_.GetCachedSize());
+  const RegionData& tree = builder_.Build("US", "en-US", &best_language_);
+  EXPECT_LT(0U, builder_.GetCachedSize());
+  EXPECT_EQ(&tree, &builder_.Build("US", "en", &best_language_));
+  EXPECT_EQ(&tree, builder_.BuildShared("US", "en", &best_language_).get());
+}
+
+TEST_F(RegionDataBuilderTest, ConcurrentBuildsShareOneTree) {
+  supplier_.LoadRules("CN", *loaded_callback_);
+  supplier_.LoadRules("US", *loaded_callback_);
+  static const size_t kThreadCount = 8;
+  std::shared_ptr<const RegionData> trees[kThreadCount];
+  std::shared_ptr<const SerializedRegionTree> serialized[kThreadCount];
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < kThreadCount; ++i) {
+    threads.emplace_back([this, i, &trees, &serialized]() {
+      std::string best_language;
+      trees[i] = builder_.BuildShared("CN", "zh-Hans", &best_language);
+      serialized[i] = builder_.BuildSerialized("US", "en", REGION_TREE_JSON,
+                                               &best_language);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (size_t i = 0; i < kThreadCount; ++i) {
+    ASSERT_TRUE(trees[i] != nullptr);
+    EXPECT_EQ(trees[0], trees[i]);
+    EXPECT_EQ(serialized[0], serialized[i]);
+  }
+}
+
+TEST_F(RegionDataBuilderTest, LeastRecentlyUsedTreesAreDropped) {
+  supplier_.LoadRules("US", *loaded_callback_);
+  supplier_.LoadRules("KR", *loaded_callback_);
+
+  // Find out how much memory each tree takes.
+  RegionDataBuilder unlimited(&supplier_);
+  unlimited.BuildShared("US", "en", &best_language_);
+  const size_t us_size = unlimited.GetCachedSize();
+  unlimited.BuildShared("KR", "ko", &best_language_);
+  const size_t kr_size = unlimited.GetCachedSize() - us_size;
+
+  // A builder with room for both trees, but not for three of them.
+  RegionDataBuilder builder(&supplier_, us_size + kr_size);
+  std::shared_ptr<const RegionData> us =
+      builder.BuildShared("US", "en", &best_language_);
+  std::shared_ptr<const RegionData> kr =
+      builder.BuildShared("KR", "ko", &best_language_);
+  EXPECT_EQ(us_size + kr_size, builder.GetCachedSize());
+
+  // Using the US tree makes the KR tree the least recently used one.
+  EXPECT_EQ(us, builder.BuildShared("US", "en", &best_language_));
+  std::shared_ptr<const RegionData> kr_latin =
+      builder.BuildShared("KR", "ko-Latn", &best_language_);
+  EXPECT_EQ(us, builder.BuildShared("US", "en", &best_language_));
+  EXPECT_LE(builder.GetCachedSize(), us_size + kr_size);
+
+  // The dropped tree remains valid, but a new one gets built.
+  std::shared_ptr<const RegionData> kr_again =
+      builder.BuildShared("KR", "ko", &best_language_);
+  EXPECT_NE(kr, kr_again);
+  EXPECT_TRUE(TreesAreEqual(*kr, builder.BuildTree("KR", "ko", &best_language_),
+                            RegionTree::kRoot));
+}
+
+TEST_F(RegionDataBuilderTest, TreeLargerThanBudgetIsStillReturned) {
+  supplier_.LoadRules("US", *loaded_callback_);
+  RegionDataBuilder builder(&supplier_, 1);
+  std::shared_ptr<const RegionData> us =
+      builder.BuildShared("US", "en", &best_language_);
+  ASSERT_TRUE(us != nullptr);
+  EXPECT_FALSE(us->sub_regions().empty());
+  EXPECT_EQ(us, builder.BuildShared("US", "en", &best_language_));
+}
+
+TEST_F(RegionDataBuilderTest, TreesKeepUnloadedRules) {
+  supplier_.LoadRules("US", *loaded_callback_);
+  std::shared_ptr<const RegionData> us =
+      builder_.BuildShared("US", "en", &best_language_);
+  const RegionTree& tree = builder_.BuildTree("US", "en", &best_language_);
+  EXPECT_TRUE(supplier_.UnloadRules("US"));
+  EXPECT_FALSE(supplier_.IsLoaded("US"));
+
+  // The trees still refer to the rules, which are still there.
+  EXPECT_TRUE(TreesAreEqual(*us, tree, RegionTree::kRoot));
+
+  // Once the region is dropped, its trees are built from the rules that are
+  // loaded again, but the trees that were returned before remain valid.
+  builder_.DropRegion("US");
+  EXPECT_EQ(0U, builder_.GetCachedSize());
+  supplier_.LoadRules("US", *loaded_callback_);
+  std::shared_ptr<const RegionData> us_again =
+      builder_.BuildShared("US", "en", &best_language_);
+  EXPECT_NE(us, us_again);
+  EXPECT_TRUE(TreesAreEqual(
+      *us, builder_.BuildTree("US", "en", &best_language_), RegionTree::kRoot));
+}
+
+TEST_F(RegionDataBuilderTest, DeeperLoadIsBuiltAgain) {
+  supplier_.LoadRules("CN", 1, *loaded_callback_);
+  std::shared_ptr<const RegionData> shallow =
+      builder_.BuildShared("CN", "zh-Hans", &best_language_);
+  ASSERT_FALSE(shallow->sub_regions().empty());
+  EXPECT_TRUE(shallow->sub_regions().front()->sub_regions().empty());
+  EXPECT_TRUE(TreesAreEqual(
+      *shallow, builder_.BuildTree("CN", "zh-Hans", &best_language_),
+      RegionTree::kRoot));
+
+  supplier_.LoadRules("CN", *loaded_callback_);
+  const RegionData& deep = builder_.Build("CN", "zh-Hans", &best_language_);
+  ASSERT_FALSE(deep.sub_regions().empty());
+  EXPECT_FALSE(deep.sub_regions().front()->sub_regions().empty());
+  EXPECT_TRUE(TreesAreEqual(
+      deep, builder_.BuildTree("CN", "zh-Hans", &best_language_),
+      RegionTree::kRoot));
+}
+
+TEST_F(RegionDataBuilderTest, TreesOfUnloadedRegionsAreDropped) {
+  supplier_.LoadRules("US", *loaded_callback_);
+  supplier_.LoadRules("CN", *loaded_callback_);
+  builder_.Build("CN", "zh-Hans", &best_language_);
+  builder_.BuildTree("CN", "zh-Latn", &best_language_);
+  std::weak_ptr<const RuleTree> cn = supplier_.GetRuleTree("CN");
+  EXPECT_TRUE(supplier_.UnloadRules("CN"));
+  EXPECT_FALSE(cn.expired());
+
+  // Building any tree drops what was built from the rules of CN, which lets
+  // them be deleted, without having to call DropRegion().
+  builder_.Build("US", "en", &best_language_);
+  EXPECT_TRUE(cn.expired());
+  EXPECT_LT(0U, builder_.GetMemoryUsage()["US"].region_data);
+  EXPECT_EQ(0U, builder_.GetMemoryUsage()["CN"].region_data);
+}
+
+TEST_F(RegionDataBuilderTest, UnloadedRegionHasNoSubRegions) {
+  supplier_.LoadRules("US", *loaded_callback_);
+  EXPECT_TRUE(supplier_.UnloadRules("US"));
+  const RegionData& tree = builder_.Build("US", "en-US", &best_language_);
+  EXPECT_EQ("US", tree.key());
+  EXPECT_TRUE(tree.sub_regions().empty());
+  EXPECT_TRUE(TreesAreEqual(
+      tree, builder_.BuildTree("US", "en-US", &best_language_),
+      RegionTree::kRoot));
+}
+
 }  // namespace
@@ -0,0 +1,189 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libaddressinput/region_tree.h>
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "rule.h"
+#include "rule_tree.h"
+
+namespace {
+
+using i18n::addressinput::REGION_TREE_BINARY;
+using i18n::addressinput::REGION_TREE_JSON;
+using i18n::addressinput::RegionTree;
+using i18n::addressinput::Rule;
+using i18n::addressinput::RuleTree;
+
+class RegionTreeTest : public testing::Test {
+ public:
+  RegionTreeTest(const RegionTreeTest&) = delete;
+  RegionTreeTest& operator=(const RegionTreeTest&) = delete;
+
+ protected:
+  RegionTreeTest() : rules_(), storage_(), rule_tree_() {
+    // There is no rule for "C", so it and all the sub-keys after it are left
+    // out of the tree. The same goes for "y".
+    AddRule(R"({"id":"data/XX","sub_keys":"B~A~C~D","name":"Country"})");
+    AddRule(R"({"id":"data/XX/A","sub_keys":"x~y~z","name":"Ay",)"
+            R"("lname":"Latin A"})");
+    AddRule(R"({"id":"data/XX/A/x"})");
+    AddRule(R"({"id":"data/XX/A/z"})");
+    AddRule(R"({"id":"data/XX/B","name":"Bee"})");
+    AddRule(R"({"id":"data/XX/D"})");
+    rule_tree_.reset(new RuleTree("XX", rules_));
+  }
+
+  std::map<std::string, const Rule*> rules_;
+
+ private:
+  void AddRule(const std::string& json) {
+    storage_.emplace_back(new Rule);
+    ASSERT_TRUE(storage_.back()->ParseSerializedRule(json));
+    rules_[storage_.back()->GetId()] = storage_.back().get();
+  }
+
+  std::vector<std::unique_ptr<Rule>> storage_;
+
+ protected:
+  std::unique_ptr<const RuleTree> rule_tree_;
+};
+
+TEST_F(RegionTreeTest, Root) {
+  const RegionTree tree(rule_tree_.get(), false, 3);
+  EXPECT_EQ("XX", tree.GetKey(RegionTree::kRoot));
+  EXPECT_EQ("XX", tree.GetName(RegionTree::kRoot));
+  EXPECT_EQ(RegionTree::kNoNode, tree.GetParent(RegionTree::kRoot));
+}
+
+TEST_F(RegionTreeTest, ChildrenStopAtMissingRule) {
+  const RegionTree tree(rule_tree_.get(), false, 3);
+  size_t first = tree.GetFirstChild(RegionTree::kRoot);
+  ASSERT_EQ(first + 2, tree.GetChildEnd(RegionTree::kRoot));
+  EXPECT_EQ("B", tree.GetKey(first));
+  EXPECT_EQ("A", tree.GetKey(first + 1));
+  EXPECT_EQ(RegionTree::kRoot, tree.GetParent(first));
+
+  size_t a = first + 1;
+  ASSERT_EQ(tree.GetFirstChild(a) + 1, tree.GetChildEnd(a));
+  EXPECT_EQ("x", tree.GetKey(tree.GetFirstChild(a)));
+  EXPECT_EQ(a, tree.GetParent(tree.GetFirstChild(a)));
+}
+
+TEST_F(RegionTreeTest, Names) {
+  const RegionTree local(rule_tree_.get(), false, 3);
+  const RegionTree latin(rule_tree_.get(), true, 3);
+  size_t b = local.FindChild(RegionTree::kRoot, "B");
+  size_t a = local.FindChild(RegionTree::kRoot, "A");
+  size_t x = local.FindChild(a, "x");
+  ASSERT_NE(RegionTree::kNoNode, b);
+  ASSERT_NE(RegionTree::kNoNode, a);
+  ASSERT_NE(RegionTree::kNoNode, x);
+
+  EXPECT_EQ("Bee", local.GetName(b));
+  EXPECT_EQ("Bee", latin.GetName(b));
+  EXPECT_EQ("Ay", local.GetName(a));
+  EXPECT_EQ("Latin A", latin.GetName(a));
+  // Without a name, the key is used.
+  EXPECT_EQ("x", local.GetName(x));
+  EXPECT_EQ("x", latin.GetName(x));
+}
+
+TEST_F(RegionTreeTest, FindChild) {
+  const RegionTree tree(rule_tree_.get(), false, 3);
+  size_t a = tree.FindChild(RegionTree::kRoot, "A");
+  ASSERT_NE(RegionTree::kNoNode, a);
+  EXPECT_EQ("A", tree.GetKey(a));
+  EXPECT_NE(RegionTree::kNoNode, tree.FindChild(a, "x"));
+  EXPECT_EQ(RegionTree::kNoNode, tree.FindChild(a, "y"));
+  EXPECT_EQ(RegionTree::kNoNode, tree.FindChild(a, "z"));
+  EXPECT_EQ(RegionTree::kNoNode, tree.FindChild(RegionTree::kRoot, "C"));
+  EXPECT_EQ(RegionTree::kNoNode, tree.FindChild(RegionTree::kRoot, "D"));
+  EXPECT_EQ(RegionTree::kNoNode, tree.FindChild(RegionTree::kRoot, "a"));
+}
+
+TEST_F(RegionTreeTest, MaxDepth) {
+  const RegionTree shallow(rule_tree_.get(), false, 1);
+  size_t a = shallow.FindChild(RegionTree::kRoot, "A");
+  ASSERT_NE(RegionTree::kNoNode, a);
+  EXPECT_EQ(shallow.GetFirstChild(a), shallow.GetChildEnd(a));
+  EXPECT_EQ(RegionTree::kNoNode, shallow.FindChild(a, "x"));
+
+  const RegionTree flat(rule_tree_.get(), false, 0);
+  EXPECT_EQ(flat.GetFirstChild(RegionTree::kRoot),
+            flat.GetChildEnd(RegionTree::kRoot));
+  EXPECT_EQ(RegionTree::kNoNode, flat.FindChild(RegionTree::kRoot, "A"));
+}
+
+TEST_F(RegionTreeTest, SerializeJson) {
+  const RegionTree tree(rule_tree_.get(), true, 3);
+  std::string json = "prefix";
+  tree.Serialize(REGION_TREE_JSON, &json);
+  EXPECT_EQ(
+      "prefix"
+      R"({"key":"XX","name":"XX","sub_regions":[)"
+      R"({"key":"B","name":"Bee"},)"
+      R"({"key":"A","name":"Latin A","sub_regions":[{"key":"x","name":"x"}]})"
+      R"(]})",
+      json);
+}
+
+TEST_F(RegionTreeTest, SerializeBinary) {
+  const RegionTree tree(rule_tree_.get(), false, 3);
+  std::string binary;
+  tree.Serialize(REGION_TREE_BINARY, &binary);
+  static const char kExpected[] =
+      "\x02XX\x02XX\x02"
+      "\x01" "B\x03" "Bee\x00"
+      "\x01" "A\x02" "Ay\x01"
+      "\x01x\x01x\x00";
+  EXPECT_EQ(std::string(kExpected, sizeof kExpected - 1), binary);
+}
+
+TEST(RegionTreeSerializeTest, JsonIsEscaped) {
+  Rule root;
+  ASSERT_TRUE(root.ParseSerializedRule(R"({"id":"data/XX","sub_keys":"A"})"));
+  Rule a;
+  ASSERT_TRUE(a.ParseSerializedRule(
+      R"({"id":"data/XX/A","name":"\"Quoted\" back\\slash\ttab é"})"));
+  const std::map<std::string, const Rule*> rules{
+      {"data/XX", &root},
+      {"data/XX/A", &a},
+  };
+  const RuleTree rule_tree("XX", rules);
+  const RegionTree tree(&rule_tree, false, 1);
+  std::string json;
+  tree.Serialize(REGION_TREE_JSON, &json);
+  EXPECT_EQ(R"({"key":"XX","name":"XX","sub_regions":[)"
+            R"({"key":"A","name":"\"Quoted\" back\\slash\u0009tab é"}]})",
+            json);
+}
+
+TEST(RegionTreeEmptyTest, NoRules) {
+  const std::map<std::string, const Rule*> rules;
+  const RuleTree rule_tree("XX", rules);
+  const RegionTree tree(&rule_tree, false, 3);
+  EXPECT_EQ("XX", tree.GetName(RegionTree::kRoot));
+  EXPECT_EQ(tree.GetFirstChild(RegionTree::kRoot),
+            tree.GetChildEnd(RegionTree::kRoot));
+}
+
+}  // namespace
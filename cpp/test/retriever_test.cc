@@ -24,6 +24,7 @@
 
 #include <gtest/gtest.h>
 
+#include "fake_storage.h"
 #include "mock_source.h"
 #include "testdata_source.h"
 
@@ -34,6 +35,7 @@
 namespace {
 
 using i18n::addressinput::BuildCallback;
+using i18n::addressinput::FakeStorage;
 using i18n::addressinput::MockSource;
 using i18n::addressinput::NullStorage;
 using i18n::addressinput::Retriever;
@@ -65,21 +67,28 @@ class RetrieverTest : public testing::Test {
         success_(false),
         key_(),
         data_(),
+        take_data_(false),
         data_ready_(BuildCallback(this, &RetrieverTest::OnDataReady)) {}
 
   Retriever retriever_;
   bool success_;
   std::string key_;
   std::string data_;
+  // Whether the callback takes the buffer of the data instead of copying it.
+  bool take_data_;
   const std::unique_ptr<const Retriever::Callback> data_ready_;
 
  private:
   void OnDataReady(bool success,
                    const std::string& key,
-                   const std::string& data) {
+                   std::string* data) {
     success_ = success;
     key_ = key;
-    data_ = data;
+    if (take_data_) {
+      data_.swap(*data);
+    } else {
+      data_ = *data;
+    }
   }
 };
 
@@ -102,6 +111,26 @@ TEST_F(RetrieverTest, ReadDataFromStorage) {
   EXPECT_NE(kEmptyData, data_);
 }
 
+TEST_F(RetrieverTest, CallbackCanTakeTheData) {
+  // Owned by |retriever|.
+  auto* source = new MockSource;
+  source->data_ = {{kKey, kStaleData}};
+  Retriever retriever(source, new FakeStorage);
+  take_data_ = true;
+
+  retriever.Retrieve(kKey, *data_ready_);
+  EXPECT_TRUE(success_);
+  EXPECT_EQ(kStaleData, data_);
+
+  // The data was stored before the callback took it, so it's still found in
+  // storage once the source doesn't have it anymore.
+  source->data_.clear();
+  data_.clear();
+  retriever.Retrieve(kKey, *data_ready_);
+  EXPECT_TRUE(success_);
+  EXPECT_EQ(kStaleData, data_);
+}
+
 TEST_F(RetrieverTest, MissingKeyReturnsEmptyData) {
   static const char kMissingKey[] = "junk";
 
@@ -173,4 +202,35 @@ TEST_F(RetrieverTest, DoNotUseStaleDataWhenSourceSucceeds) {
   EXPECT_TRUE(stale_storage->data_updated_);
 }
 
+TEST_F(RetrieverTest, RetrieveFromSourceIgnoresFreshStorage) {
+  // Owned by |retriever|.
+  auto* source = new MockSource;
+  source->data_ = {{kKey, kStaleData}};
+  Retriever retriever(source, new FakeStorage);
+  retriever.Retrieve(kKey, *data_ready_);
+
+  source->data_ = {{kKey, kEmptyData}};
+  retriever.Retrieve(kKey, *data_ready_);
+  EXPECT_EQ(kStaleData, data_);
+
+  retriever.RetrieveFromSource(kKey, *data_ready_);
+  EXPECT_TRUE(success_);
+  EXPECT_EQ(kEmptyData, data_);
+
+  // The fresh data replaced the data in storage.
+  retriever.Retrieve(kKey, *data_ready_);
+  EXPECT_EQ(kEmptyData, data_);
+}
+
+TEST_F(RetrieverTest, RetrieveFromSourceDoesNotUseStaleData) {
+  // An empty MockSource will fail for any request.
+  Retriever resilient_retriever(new MockSource, new StaleStorage);
+
+  resilient_retriever.RetrieveFromSource(kKey, *data_ready_);
+
+  EXPECT_FALSE(success_);
+  EXPECT_EQ(kKey, key_);
+  EXPECT_TRUE(data_.empty());
+}
+
 }  // namespace
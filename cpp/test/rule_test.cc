@@ -235,6 +235,28 @@ TEST(RuleTest, PostalCodeMatcherInvalidRegExp) {
   EXPECT_TRUE(rule.GetPostalCodeMatcher() == nullptr);
 }
 
+TEST(RuleTest, PostalCodeMatcherIsShared) {
+  Rule rule;
+  ASSERT_TRUE(rule.ParseSerializedRule(R"({"zip":"\\d{4}"})"));
+  Rule other;
+  ASSERT_TRUE(other.ParseSerializedRule(R"({"zip":"\\d{4}"})"));
+  Rule copy;
+  copy.CopyFrom(rule);
+  ASSERT_TRUE(rule.GetPostalCodeMatcher() != nullptr);
+  EXPECT_EQ(rule.GetPostalCodeMatcher(), other.GetPostalCodeMatcher());
+  EXPECT_EQ(rule.GetPostalCodeMatcher(), copy.GetPostalCodeMatcher());
+}
+
+TEST(RuleTest, PostalCodeMatcherIsReplaced) {
+  Rule rule;
+  ASSERT_TRUE(rule.ParseSerializedRule(R"({"zip":"\\d{4}"})"));
+  const auto* matcher = rule.GetPostalCodeMatcher();
+  ASSERT_TRUE(matcher != nullptr);
+  ASSERT_TRUE(rule.ParseSerializedRule(R"({"zip":"\\d{5}"})"));
+  EXPECT_TRUE(rule.GetPostalCodeMatcher() != nullptr);
+  EXPECT_NE(matcher, rule.GetPostalCodeMatcher());
+}
+
 TEST(RuleTest, ParsesJsonRuleCorrectly) {
   Json json;
   ASSERT_TRUE(json.ParseObject(R"({"zip":"\\d{3}"})"));
@@ -0,0 +1,135 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rule_tree.h"
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "rule.h"
+
+namespace {
+
+using i18n::addressinput::Rule;
+using i18n::addressinput::RuleTree;
+
+class RuleTreeTest : public testing::Test {
+ public:
+  RuleTreeTest(const RuleTreeTest&) = delete;
+  RuleTreeTest& operator=(const RuleTreeTest&) = delete;
+
+ protected:
+  RuleTreeTest() : rules_(), storage_() {
+    AddRule(R"({"id":"data/XX","sub_keys":"B~A","languages":"en~fr"})");
+    AddRule(R"({"id":"data/XX--fr","sub_keys":"B~A"})");
+    AddRule(R"({"id":"data/XX/A","sub_keys":"y~x"})");
+    AddRule(R"({"id":"data/XX/A--fr"})");
+    AddRule(R"({"id":"data/XX/A/x"})");
+    AddRule(R"({"id":"data/XX/B","name":"Bee"})");
+  }
+
+  const Rule* GetRule(const std::string& id) const {
+    auto it = rules_.find(id);
+    return it != rules_.end() ? it->second : nullptr;
+  }
+
+  std::map<std::string, const Rule*> rules_;
+
+ private:
+  void AddRule(const std::string& json) {
+    storage_.emplace_back(new Rule);
+    ASSERT_TRUE(storage_.back()->ParseSerializedRule(json));
+    rules_[storage_.back()->GetId()] = storage_.back().get();
+  }
+
+  std::vector<std::unique_ptr<Rule>> storage_;
+};
+
+TEST_F(RuleTreeTest, EmptyRules) {
+  const std::map<std::string, const Rule*> rules;
+  const RuleTree tree("XX", rules);
+  ASSERT_EQ(1, tree.size());
+  EXPECT_EQ(nullptr, tree.GetRule(RuleTree::kRoot));
+  EXPECT_EQ(1, tree.GetLanguageCount());
+  EXPECT_EQ(RuleTree::kNoNode, tree.GetParent(RuleTree::kRoot));
+  EXPECT_EQ(tree.GetFirstChild(RuleTree::kRoot),
+            tree.GetChildEnd(RuleTree::kRoot));
+  EXPECT_EQ("XX", tree.GetSubKey(RuleTree::kRoot));
+}
+
+TEST_F(RuleTreeTest, ChildrenInSubKeyOrder) {
+  const RuleTree tree("XX", rules_);
+  // Root, B, A, y, x.
+  ASSERT_EQ(5, tree.size());
+  EXPECT_EQ(GetRule("data/XX"), tree.GetRule(RuleTree::kRoot));
+
+  size_t first = tree.GetFirstChild(RuleTree::kRoot);
+  ASSERT_EQ(first + 2, tree.GetChildEnd(RuleTree::kRoot));
+  EXPECT_EQ("B", tree.GetSubKey(first));
+  EXPECT_EQ("A", tree.GetSubKey(first + 1));
+  EXPECT_EQ(GetRule("data/XX/B"), tree.GetRule(first));
+  EXPECT_EQ(GetRule("data/XX/A"), tree.GetRule(first + 1));
+  EXPECT_EQ(RuleTree::kRoot, tree.GetParent(first));
+  EXPECT_EQ(1, tree.GetDepth(first));
+}
+
+TEST_F(RuleTreeTest, MissingRuleHasNoChildren) {
+  const RuleTree tree("XX", rules_);
+  size_t a = tree.FindChild(RuleTree::kRoot, "A");
+  ASSERT_NE(RuleTree::kNoNode, a);
+  size_t y = tree.FindChild(a, "y");
+  ASSERT_NE(RuleTree::kNoNode, y);
+  EXPECT_EQ(nullptr, tree.GetRule(y));
+  EXPECT_EQ(tree.GetFirstChild(y), tree.GetChildEnd(y));
+  EXPECT_EQ(2, tree.GetDepth(y));
+  EXPECT_EQ(a, tree.GetParent(y));
+}
+
+TEST_F(RuleTreeTest, FindChild) {
+  const RuleTree tree("XX", rules_);
+  size_t a = tree.FindChild(RuleTree::kRoot, "A");
+  ASSERT_NE(RuleTree::kNoNode, a);
+  EXPECT_EQ("A", tree.GetSubKey(a));
+  size_t x = tree.FindChild(a, "x");
+  ASSERT_NE(RuleTree::kNoNode, x);
+  EXPECT_EQ(GetRule("data/XX/A/x"), tree.GetRule(x));
+
+  // Only exact sub-keys are found, not names or case insensitive matches.
+  EXPECT_EQ(RuleTree::kNoNode, tree.FindChild(RuleTree::kRoot, "a"));
+  EXPECT_EQ(RuleTree::kNoNode, tree.FindChild(RuleTree::kRoot, "Bee"));
+  EXPECT_EQ(RuleTree::kNoNode, tree.FindChild(RuleTree::kRoot, "C"));
+  EXPECT_EQ(RuleTree::kNoNode, tree.FindChild(x, "A"));
+}
+
+TEST_F(RuleTreeTest, Languages) {
+  const RuleTree tree("XX", rules_);
+  ASSERT_EQ(2, tree.GetLanguageCount());
+  EXPECT_EQ(0, tree.FindLanguage(""));
+  size_t fr = tree.FindLanguage("fr");
+  ASSERT_EQ(1, fr);
+  EXPECT_EQ(RuleTree::kNoLanguage, tree.FindLanguage("en"));
+  EXPECT_EQ(RuleTree::kNoLanguage, tree.FindLanguage("de"));
+
+  EXPECT_EQ(GetRule("data/XX--fr"), tree.GetRule(RuleTree::kRoot, fr));
+  EXPECT_EQ(GetRule("data/XX/A--fr"),
+            tree.GetRule(tree.FindChild(RuleTree::kRoot, "A"), fr));
+  EXPECT_EQ(nullptr, tree.GetRule(tree.FindChild(RuleTree::kRoot, "B"), fr));
+}
+
+}  // namespace
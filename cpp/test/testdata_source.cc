@@ -22,6 +22,7 @@
 #include <map>
 #include <optional>
 #include <string>
+#include <utility>
 
 namespace i18n {
 namespace addressinput {
@@ -167,7 +168,7 @@ void TestdataSource::Get(const std::string& key,
     success = true;
     data = "{}";
   }
-  data_ready(success, key, data);
+  data_ready(success, key, std::move(data));
 }
 
 }  // namespace addressinput
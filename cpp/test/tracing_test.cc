@@ -0,0 +1,258 @@
+// Copyright (C) 2026 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <libaddressinput/tracing.h>
+
+#include <libaddressinput/address_data.h>
+#include <libaddressinput/address_validator.h>
+#include <libaddressinput/callback.h>
+#include <libaddressinput/null_storage.h>
+#include <libaddressinput/ondemand_supplier.h>
+#include <libaddressinput/preload_supplier.h>
+
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "testdata_source.h"
+#include "tracing_util.h"
+
+namespace {
+
+using i18n::addressinput::AddressData;
+using i18n::addressinput::AddressValidator;
+using i18n::addressinput::BuildCallback;
+using i18n::addressinput::ChromeTraceExporter;
+using i18n::addressinput::FieldProblemMap;
+using i18n::addressinput::GetCurrentCorrelationId;
+using i18n::addressinput::GetTraceSink;
+using i18n::addressinput::NullStorage;
+using i18n::addressinput::OndemandSupplier;
+using i18n::addressinput::PreloadSupplier;
+using i18n::addressinput::ScopedCorrelationId;
+using i18n::addressinput::SetTraceSink;
+using i18n::addressinput::TestdataSource;
+using i18n::addressinput::TraceSink;
+using i18n::addressinput::TraceSpan;
+using i18n::addressinput::TraceSpanKind;
+using i18n::addressinput::TraceSpanRecorder;
+
+using i18n::addressinput::TRACE_LOAD_RULES;
+using i18n::addressinput::TRACE_RETRIEVE;
+using i18n::addressinput::TRACE_SOURCE_GET;
+using i18n::addressinput::TRACE_STORAGE_GET;
+using i18n::addressinput::TRACE_STORAGE_PUT;
+using i18n::addressinput::TRACE_SUPPLY_LOAD;
+using i18n::addressinput::TRACE_VALIDATE;
+
+// Records all the spans that it receives.
+class RecordingSink : public TraceSink {
+ public:
+  struct Event {
+    bool begin;
+    TraceSpan span;
+    std::string key;
+  };
+
+  RecordingSink(const RecordingSink&) = delete;
+  RecordingSink& operator=(const RecordingSink&) = delete;
+
+  RecordingSink() = default;
+  ~RecordingSink() override = default;
+
+  void BeginSpan(const TraceSpan& span) override {
+    events_.push_back({true, span, std::string(span.key)});
+  }
+
+  void EndSpan(const TraceSpan& span) override {
+    events_.push_back({false, span, std::string(span.key)});
+  }
+
+  const std::vector<Event>& events() const { return events_; }
+
+  std::set<TraceSpanKind> GetKinds() const {
+    std::set<TraceSpanKind> kinds;
+    for (const auto& event : events_) {
+      kinds.insert(event.span.kind);
+    }
+    return kinds;
+  }
+
+  std::set<uint64_t> GetCorrelationIds() const {
+    std::set<uint64_t> correlation_ids;
+    for (const auto& event : events_) {
+      correlation_ids.insert(event.span.correlation_id);
+    }
+    return correlation_ids;
+  }
+
+  // Returns whether every span began once and then ended once.
+  bool IsBalanced() const {
+    std::set<uint64_t> open;
+    std::set<uint64_t> ended;
+    for (const auto& event : events_) {
+      if (event.begin) {
+        if (!open.insert(event.span.id).second) {
+          return false;
+        }
+      } else {
+        if (open.erase(event.span.id) != 1 ||
+            !ended.insert(event.span.id).second) {
+          return false;
+        }
+      }
+    }
+    return open.empty();
+  }
+
+ private:
+  std::vector<Event> events_;
+};
+
+class TracingTest : public testing::Test {
+ public:
+  TracingTest(const TracingTest&) = delete;
+  TracingTest& operator=(const TracingTest&) = delete;
+
+ protected:
+  TracingTest()
+      : sink_(),
+        loaded_(BuildCallback(this, &TracingTest::OnLoaded)),
+        validated_(BuildCallback(this, &TracingTest::OnValidated)) {
+    SetTraceSink(&sink_);
+  }
+
+  ~TracingTest() override { SetTraceSink(nullptr); }
+
+  RecordingSink sink_;
+  const std::unique_ptr<const PreloadSupplier::Callback> loaded_;
+  const std::unique_ptr<const AddressValidator::Callback> validated_;
+
+ private:
+  void OnLoaded(bool success, const std::string& region_code, int num_rules) {
+    EXPECT_TRUE(success);
+  }
+
+  void OnValidated(bool success, const AddressData& address,
+                   const FieldProblemMap& problems) {
+    EXPECT_TRUE(success);
+  }
+};
+
+TEST_F(TracingTest, SinkIsInstalled) {
+  EXPECT_EQ(&sink_, GetTraceSink());
+}
+
+TEST_F(TracingTest, LoadRulesIsOneCorrelatedTrace) {
+  PreloadSupplier supplier(new TestdataSource(true), new NullStorage);
+  supplier.LoadRules("CH", *loaded_);
+
+  EXPECT_TRUE(sink_.IsBalanced());
+  EXPECT_EQ((std::set<TraceSpanKind>{TRACE_LOAD_RULES, TRACE_RETRIEVE,
+                                     TRACE_STORAGE_GET, TRACE_SOURCE_GET,
+                                     TRACE_STORAGE_PUT}),
+            sink_.GetKinds());
+  std::set<uint64_t> correlation_ids = sink_.GetCorrelationIds();
+  ASSERT_EQ(1U, correlation_ids.size());
+  EXPECT_NE(0U, *correlation_ids.begin());
+
+  // The outermost span comes first, and has the region code as key.
+  ASSERT_FALSE(sink_.events().empty());
+  const RecordingSink::Event& first = sink_.events().front();
+  EXPECT_TRUE(first.begin);
+  EXPECT_EQ(TRACE_LOAD_RULES, first.span.kind);
+  EXPECT_EQ("CH", first.key);
+  for (const auto& event : sink_.events()) {
+    if (!event.begin && event.span.id == first.span.id) {
+      EXPECT_TRUE(event.span.success);
+      EXPECT_LT(0U, event.span.bytes);
+    }
+  }
+
+  // Nothing is left behind on the thread.
+  EXPECT_EQ(0U, GetCurrentCorrelationId());
+}
+
+TEST_F(TracingTest, EachValidationHasItsOwnCorrelationId) {
+  OndemandSupplier supplier(new TestdataSource(false), new NullStorage);
+  AddressValidator validator(&supplier);
+  const AddressData address{.region_code = "CH"};
+  FieldProblemMap problems;
+  validator.Validate(address, true, true, nullptr, &problems, *validated_);
+  EXPECT_TRUE(sink_.IsBalanced());
+  EXPECT_EQ((std::set<TraceSpanKind>{TRACE_VALIDATE, TRACE_RETRIEVE,
+                                     TRACE_STORAGE_GET, TRACE_SOURCE_GET,
+                                     TRACE_STORAGE_PUT, TRACE_SUPPLY_LOAD}),
+            sink_.GetKinds());
+  EXPECT_EQ(1U, sink_.GetCorrelationIds().size());
+
+  // The rules are cached now, so the validation has a span of its own only.
+  size_t event_count = sink_.events().size();
+  validator.Validate(address, true, true, nullptr, &problems, *validated_);
+  EXPECT_TRUE(sink_.IsBalanced());
+  EXPECT_EQ(event_count + 2, sink_.events().size());
+  EXPECT_EQ(2U, sink_.GetCorrelationIds().size());
+}
+
+TEST_F(TracingTest, SpanEndsAsFailureWhenDestroyed) {
+  ScopedCorrelationId correlation(42);
+  { TraceSpanRecorder span(TRACE_RETRIEVE, "data/XX"); }
+  ASSERT_EQ(2U, sink_.events().size());
+  EXPECT_FALSE(sink_.events().back().span.success);
+  EXPECT_EQ(42U, sink_.events().back().span.correlation_id);
+  EXPECT_EQ("data/XX", sink_.events().back().key);
+}
+
+TEST_F(TracingTest, NothingIsReportedWithoutSink) {
+  SetTraceSink(nullptr);
+  EXPECT_EQ(nullptr, GetTraceSink());
+  TraceSpanRecorder span(TRACE_RETRIEVE, "data/XX");
+  EXPECT_EQ(0U, span.correlation_id());
+  PreloadSupplier supplier(new TestdataSource(true), new NullStorage);
+  supplier.LoadRules("CH", *loaded_);
+  // Installing a sink after the span began doesn't make it report.
+  SetTraceSink(&sink_);
+  span.End(true, 0);
+  EXPECT_TRUE(sink_.events().empty());
+}
+
+TEST(ChromeTraceExporterTest, ExportsAsyncEvents) {
+  ChromeTraceExporter exporter;
+  SetTraceSink(&exporter);
+  {
+    ScopedCorrelationId correlation(7);
+    TraceSpanRecorder span(TRACE_STORAGE_GET, "data/\"CH\"");
+    span.End(true, 12);
+  }
+  SetTraceSink(nullptr);
+
+  std::string json = exporter.GetJson();
+  EXPECT_EQ(0U, json.find("{\"traceEvents\":[{\"name\":\"storage_get\""));
+  EXPECT_NE(std::string::npos, json.find("\"ph\":\"b\",\"id\":7,"));
+  EXPECT_NE(std::string::npos, json.find("\"ph\":\"e\",\"id\":7,"));
+  EXPECT_NE(std::string::npos, json.find("\"key\":\"data/\\\"CH\\\"\""));
+  EXPECT_NE(std::string::npos, json.find("\"success\":true,\"bytes\":12"));
+}
+
+TEST(ChromeTraceExporterTest, ExportsNothingWithoutSpans) {
+  ChromeTraceExporter exporter;
+  EXPECT_EQ("{\"traceEvents\":[],\"displayTimeUnit\":\"ms\"}",
+            exporter.GetJson());
+}
+
+}  // namespace
@@ -15,6 +15,7 @@
 #include "util/json.h"
 
 #include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -22,6 +23,28 @@ namespace {
 
 using i18n::addressinput::Json;
 
+// Records the events from Json::ParseSubDictionaries() as strings.
+class RecordingHandler : public Json::SubDictionaryHandler {
+ public:
+  RecordingHandler(const RecordingHandler&) = delete;
+  RecordingHandler& operator=(const RecordingHandler&) = delete;
+
+  RecordingHandler() : events_() {}
+  ~RecordingHandler() override = default;
+
+  void BeginSubDictionary(const std::string& key) override {
+    events_.push_back("begin " + key);
+  }
+
+  void StringValue(const std::string& key, std::string* value) override {
+    events_.push_back(key + "=" + *value);
+  }
+
+  void EndSubDictionary() override { events_.push_back("end"); }
+
+  std::vector<std::string> events_;
+};
+
 TEST(JsonTest, EmptyStringIsNotValid) {
   Json json;
   EXPECT_FALSE(json.ParseObject(std::string()));
@@ -149,4 +172,84 @@ TEST(JsonTest, DictionariesHaveSubDictionaries) {
   EXPECT_EQ("value", value);
 }
 
+TEST(JsonTest, ParseSubDictionariesEmptyStringIsNotValid) {
+  RecordingHandler handler;
+  EXPECT_FALSE(Json::ParseSubDictionaries(std::string(), &handler));
+}
+
+TEST(JsonTest, ParseSubDictionariesListIsNotValid) {
+  RecordingHandler handler;
+  EXPECT_FALSE(Json::ParseSubDictionaries(R"([{"key":"value"}])", &handler));
+}
+
+TEST(JsonTest, ParseSubDictionariesInvalidUtf8IsNotValid) {
+  RecordingHandler handler;
+  EXPECT_FALSE(
+      Json::ParseSubDictionaries("{\"key\":{\"a\":\"\xC3\x28\"}}", &handler));
+}
+
+TEST(JsonTest, ParseSubDictionariesNoDictionaryFound) {
+  RecordingHandler handler;
+  ASSERT_TRUE(Json::ParseSubDictionaries(R"({"key":"value"})", &handler));
+  EXPECT_TRUE(handler.events_.empty());
+}
+
+TEST(JsonTest, ParseSubDictionariesStringValues) {
+  RecordingHandler handler;
+  ASSERT_TRUE(Json::ParseSubDictionaries(
+      R"({"a":{"x":"1","y":"2"},"top":"ignored","b":{},"c":{"z":"3"}})",
+      &handler));
+  const std::vector<std::string> expected{
+      "begin a", "x=1", "y=2", "end", "begin b", "end",
+      "begin c", "z=3", "end",
+  };
+  EXPECT_EQ(expected, handler.events_);
+}
+
+TEST(JsonTest, ParseSubDictionariesIgnoresOtherValues) {
+  RecordingHandler handler;
+  ASSERT_TRUE(Json::ParseSubDictionaries(
+      R"({"list":[{"a":"b"}],)"
+      R"("key":{"n":1,"inner":{"c":"d"},"list":["e"],"after":"f"}})",
+      &handler));
+  const std::vector<std::string> expected{"begin key", "after=f", "end"};
+  EXPECT_EQ(expected, handler.events_);
+}
+
+TEST(JsonTest, ParseSubDictionariesInSitu) {
+  RecordingHandler handler;
+  std::string data(
+      R"({"a":{"x":"1\u00e9","y":"\"2\""},"top":"ignored","c":{"z":"3"}})");
+  ASSERT_TRUE(Json::ParseSubDictionariesInSitu(&data, &handler));
+  const std::vector<std::string> expected{
+      "begin a", "x=1\xC3\xA9", "y=\"2\"", "end", "begin c", "z=3", "end",
+  };
+  EXPECT_EQ(expected, handler.events_);
+}
+
+TEST(JsonTest, ParseSubDictionariesInSituInvalidUtf8IsNotValid) {
+  RecordingHandler handler;
+  std::string data("{\"key\":{\"a\":\"\xC3\x28\"}}");
+  EXPECT_FALSE(Json::ParseSubDictionariesInSitu(&data, &handler));
+}
+
+TEST(JsonTest, ParseObjectInSitu) {
+  std::string data(R"({"key":{"inner_key":"va\nlue"},"a":"b"})");
+  Json json;
+  ASSERT_TRUE(json.ParseObjectInSitu(&data));
+  std::string value;
+  EXPECT_TRUE(json.GetStringValueForKey("a", &value));
+  EXPECT_EQ("b", value);
+  const auto& sub_dicts = json.GetSubDictionaries();
+  ASSERT_EQ(1U, sub_dicts.size());
+  EXPECT_TRUE(sub_dicts.front()->GetStringValueForKey("inner_key", &value));
+  EXPECT_EQ("va\nlue", value);
+}
+
+TEST(JsonTest, ParseObjectInSituListIsNotValid) {
+  std::string data(R"([{"key":"value"}])");
+  Json json;
+  EXPECT_FALSE(json.ParseObjectInSitu(&data));
+}
+
 }  // namespace
@@ -14,7 +14,10 @@
 
 #include "util/string_compare.h"
 
+#include <atomic>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -66,6 +69,25 @@ TEST_P(StringCompareTest, CorrectLess) {
   }
 }
 
+TEST_P(StringCompareTest, CorrectLessFromManyThreads) {
+  std::atomic<int> wrong(0);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([this, &wrong]() {
+      for (int j = 0; j < 100; ++j) {
+        if (compare_.NaturalLess(GetParam().left, GetParam().right) !=
+            GetParam().should_be_less) {
+          ++wrong;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(0, wrong);
+}
+
 INSTANTIATE_TEST_SUITE_P(
     Comparisons, StringCompareTest,
     testing::Values(TestCase("foo", "foo", true, false),
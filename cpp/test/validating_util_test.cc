@@ -153,4 +153,41 @@ TEST(ValidatingUtilTest, WrapUnwrapIt) {
   EXPECT_EQ(kUnwrappedData, data);
 }
 
+TEST(ValidatingUtilTest, WrapCopy) {
+  const std::string data = kUnwrappedData;
+  EXPECT_EQ(kWrappedData, ValidatingUtil::WrapCopy(kTimestamp, data));
+  EXPECT_EQ(kUnwrappedData, data);
+}
+
+TEST(ValidatingUtilTest, Unwrap) {
+  std::string data(kWrappedData);
+  bool is_fresh = false;
+  EXPECT_TRUE(ValidatingUtil::Unwrap(kTimestamp, &data, &is_fresh));
+  EXPECT_TRUE(is_fresh);
+  EXPECT_EQ(kUnwrappedData, data);
+}
+
+TEST(ValidatingUtilTest, Unwrap_Stale) {
+  std::string data = ValidatingUtil::WrapCopy(TIMESTAMP_TWO_MONTHS_AGO, DATA);
+  bool is_fresh = true;
+  EXPECT_TRUE(ValidatingUtil::Unwrap(kTimestamp, &data, &is_fresh));
+  EXPECT_FALSE(is_fresh);
+  EXPECT_EQ(kUnwrappedData, data);
+}
+
+TEST(ValidatingUtilTest, Unwrap_CorruptedData) {
+  for (const char* wrapped : {kCorruptedWrappedData, kChecksummedData,
+                              kTimestampHalfMonthAgo, "", "garbage"}) {
+    std::string data(wrapped);
+    bool is_fresh = false;
+    EXPECT_FALSE(ValidatingUtil::Unwrap(kTimestamp, &data, &is_fresh));
+    EXPECT_EQ(wrapped, data);
+  }
+
+  // The checksum doesn't match the data.
+  std::string data = std::string(kWrappedData) + " ";
+  bool is_fresh = false;
+  EXPECT_FALSE(ValidatingUtil::Unwrap(kTimestamp, &data, &is_fresh));
+}
+
 }  // namespace
@@ -94,7 +94,8 @@ class ValidationTaskTest : public testing::Test {
         require_name_,
         &filter_,
         &problems_,
-        *validated_);
+        *validated_,
+        nullptr);
 
     Supplier::RuleHierarchy hierarchy;
 
@@ -104,7 +105,7 @@ class ValidationTaskTest : public testing::Test {
       hierarchy.rule[i] = &rule[i];
     }
 
-    (*task->supplied_)(success_, *task->lookup_key_, hierarchy);
+    (*task->supplied_)(success_, task->lookup_key_, hierarchy);
   }
 
   const char* json_[size(LookupKey::kHierarchy)];